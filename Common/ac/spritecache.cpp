@@ -12,6 +12,7 @@
 //
 //=============================================================================
 #include "core/platform.h"
+#include <algorithm>
 #include "ac/spritecache.h"
 #include "ac/gamestructdefines.h"
 #include "debug/out.h"
@@ -56,6 +57,11 @@ SpriteCache::SpriteCache(std::vector<SpriteInfo> &sprInfos, const Callbacks &cal
     _placeholder.reset(BitmapHelper::CreateTransparentBitmap(1, 1));
 }
 
+SpriteCache::~SpriteCache()
+{
+    SetAsyncLoading(false);
+}
+
 size_t SpriteCache::GetSpriteSlotCount() const
 {
     return _spriteData.size();
@@ -74,6 +80,7 @@ bool SpriteCache::IsAssetSprite(sprkey_t index) const
 
 void SpriteCache::Reset()
 {
+    CancelPrefetch();
     _file.Close();
     ResourceCache::Clear();
     _spriteData.clear();
@@ -214,10 +221,14 @@ Bitmap *SpriteCache::operator [] (sprkey_t index)
     // Try get image from cache
     auto &image = ResourceCache::Get(index);
     if (image)
+    {
+        _stats.Hits++;
         return image.get();
+    }
     // If no ready image, but has an asset, then try loading one
     if (_spriteData[index].IsAssetSprite())
     {
+        _stats.Misses++;
         auto *bitmap = LoadSprite(index);
         if (bitmap)
             return bitmap;
@@ -260,8 +271,21 @@ Bitmap *SpriteCache::LoadSprite(sprkey_t index)
         return nullptr;
     assert((_spriteData[index].Flags & SPRCACHEFLAG_ISASSET) != 0);
 
-    Bitmap *image{};
-    HError err = _file.LoadSprite(index, image);
+    // The sprite might have been already requested for the background loading
+    std::unique_ptr<Bitmap> image;
+    HError err = HError::None();
+    if (!TakePrefetched(index, image, err, true))
+    {
+        Bitmap *loaded{};
+        std::lock_guard<std::mutex> lk(_fileMutex);
+        err = _file.LoadSprite(index, loaded);
+        image.reset(loaded);
+    }
+    return InitLoadedSprite(index, image.release(), err);
+}
+
+Bitmap *SpriteCache::InitLoadedSprite(sprkey_t index, Bitmap *image, const HError &err)
+{
     if (!image)
     {
         Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Warn,
@@ -299,6 +323,173 @@ Bitmap *SpriteCache::LoadSprite(sprkey_t index)
     return image;
 }
 
+void SpriteCache::SetAsyncLoading(bool on)
+{
+#if defined(AGS_DISABLE_THREADS)
+    (void)on; // background loading is not supported
+#else
+    if (on == _loaderRunning)
+        return;
+    if (on)
+    {
+        {
+            std::lock_guard<std::mutex> lk(_loadMutex);
+            _loaderRunning = true;
+        }
+        _loaderThread = std::thread(&SpriteCache::LoaderThread, this);
+    }
+    else
+    {
+        CancelPrefetch();
+        {
+            std::lock_guard<std::mutex> lk(_loadMutex);
+            _loaderRunning = false;
+        }
+        _loadCV.notify_all();
+        if (_loaderThread.joinable())
+            _loaderThread.join();
+    }
+#endif
+}
+
+// Estimates the sprite's image size in memory, in bytes; the final color
+// depth is not known until the sprite is initialized, so assume the largest
+static size_t EstimateSpriteSize(const SpriteInfo &info)
+{
+    return static_cast<size_t>(info.Width) * info.Height * 4;
+}
+
+void SpriteCache::Prefetch(sprkey_t index)
+{
+    if (!_loaderRunning)
+        return;
+    if (index < 0 || (size_t)index >= _spriteData.size() ||
+        !_spriteData[index].IsAssetSprite() || _spriteData[index].IsError() ||
+        ResourceCache::Exists(index))
+        return; // not an asset, or already loaded
+
+    const size_t est_size = EstimateSpriteSize(_sprInfos[index]);
+    std::lock_guard<std::mutex> lk(_loadMutex);
+    if (_loadingNow == index || _prefetched.count(index) > 0 ||
+        std::find_if(_loadQueue.begin(), _loadQueue.end(),
+            [index](const std::pair<sprkey_t, size_t> &req) { return req.first == index; }) != _loadQueue.end())
+        return; // already requested
+    // Do not let prefetched sprites take more than a half of the cache space,
+    // otherwise they would push out each other before they are even used
+    const size_t max_prefetch = (GetMaxCacheSize() - std::min(GetLockedSize(), GetMaxCacheSize())) / 2;
+    if (_prefetchSize + est_size > max_prefetch)
+        return;
+    _loadQueue.emplace_back(index, est_size);
+    _prefetchSize += est_size;
+    _loadCV.notify_all();
+}
+
+void SpriteCache::ProcessPrefetched()
+{
+    if (!_loaderRunning)
+        return;
+    std::unordered_map<sprkey_t, PrefetchedSprite> prefetched;
+    {
+        std::lock_guard<std::mutex> lk(_loadMutex);
+        if (_prefetched.empty())
+            return;
+        prefetched.swap(_prefetched);
+        for (const auto &spr : prefetched)
+            _prefetchSize -= spr.second.EstSize;
+    }
+    for (auto &spr : prefetched)
+    {
+        const sprkey_t index = spr.first;
+        // The slot could have been reassigned while the sprite was loading
+        if (!IsAssetSprite(index) || _spriteData[index].IsError() || ResourceCache::Exists(index))
+            continue;
+        InitLoadedSprite(index, spr.second.Image.release(), spr.second.Error);
+        SprCacheLog("Prefetched %d", index);
+    }
+}
+
+SpriteCache::Stats SpriteCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lk(_loadMutex);
+    Stats stats = _stats;
+    stats.InFlight = static_cast<uint32_t>(_loadQueue.size() + (_loadingNow >= 0 ? 1 : 0));
+    return stats;
+}
+
+void SpriteCache::ResetStats()
+{
+    std::lock_guard<std::mutex> lk(_loadMutex);
+    _stats = Stats();
+}
+
+bool SpriteCache::TakePrefetched(sprkey_t index, std::unique_ptr<Bitmap> &image, HError &err, bool wait)
+{
+    std::unique_lock<std::mutex> lk(_loadMutex);
+    // If the sprite is still in queue, then cancel the request:
+    // the caller will rather load it right away
+    auto it_req = std::find_if(_loadQueue.begin(), _loadQueue.end(),
+        [index](const std::pair<sprkey_t, size_t> &req) { return req.first == index; });
+    if (it_req != _loadQueue.end())
+    {
+        _prefetchSize -= it_req->second;
+        _loadQueue.erase(it_req);
+        return false;
+    }
+    if (wait && _loadingNow == index)
+    {
+        _stats.Waits++;
+        _loadCV.wait(lk, [this, index]() { return _loadingNow != index; });
+    }
+    auto it = _prefetched.find(index);
+    if (it == _prefetched.end())
+        return false;
+    image = std::move(it->second.Image);
+    err = it->second.Error;
+    _prefetchSize -= it->second.EstSize;
+    _prefetched.erase(it);
+    return true;
+}
+
+void SpriteCache::CancelPrefetch()
+{
+    std::unique_lock<std::mutex> lk(_loadMutex);
+    _loadQueue.clear();
+    _loadCV.wait(lk, [this]() { return _loadingNow < 0; });
+    _prefetched.clear();
+    _prefetchSize = 0u;
+}
+
+void SpriteCache::LoaderThread()
+{
+    std::unique_lock<std::mutex> lk(_loadMutex);
+    while (true)
+    {
+        _loadCV.wait(lk, [this]() { return !_loaderRunning || !_loadQueue.empty(); });
+        if (!_loaderRunning)
+            break;
+        const auto req = _loadQueue.front();
+        _loadQueue.pop_front();
+        _loadingNow = req.first;
+        lk.unlock();
+
+        Bitmap *image{};
+        HError err = HError::None();
+        {
+            std::lock_guard<std::mutex> file_lk(_fileMutex);
+            err = _file.LoadSprite(req.first, image);
+        }
+
+        lk.lock();
+        PrefetchedSprite &spr = _prefetched[req.first];
+        spr.Image.reset(image);
+        spr.Error = err;
+        spr.EstSize = req.second;
+        _loadingNow = -1;
+        _stats.Prefetched++;
+        _loadCV.notify_all();
+    }
+}
+
 void SpriteCache::RemapSpriteToPlaceholder(sprkey_t index)
 {
     assert((index > 0) && ((size_t)index < _spriteData.size()));
@@ -331,6 +522,7 @@ int SpriteCache::SaveToFile(const String &filename, int store_flags, SpriteCompr
             (image || _spriteData[i].IsAssetSprite()),
             image.get()));
     }
+    std::lock_guard<std::mutex> lk(_fileMutex);
     return SaveSpriteFile(filename, sprites, &_file, store_flags, compress, index);
 }
 
@@ -368,6 +560,8 @@ HError SpriteCache::InitFile(const String &filename, const String &sprindex_file
 
 void SpriteCache::DetachFile()
 {
+    CancelPrefetch();
+    std::lock_guard<std::mutex> lk(_fileMutex);
     _file.Close();
 }
 
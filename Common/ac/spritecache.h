@@ -17,6 +17,11 @@
 // SpriteCache provides bitmaps by demand; it uses SpriteFile to load sprites
 // and does MRU (most-recent-use) caching.
 //
+// SpriteCache may optionally run a background loader thread, which reads and
+// decompresses requested ("prefetched") sprites ahead of their use. Loaded
+// images are handed over to the cache on the main thread, because sprite
+// initialization callbacks are not thread-safe.
+//
 // TODO: refactor engine code to allow store and return shared_ptr<Bitmap>.
 //
 // TODO: currently inherits ResourceCache<Bitmap> as protected, because sprites
@@ -36,9 +41,14 @@
 #ifndef __AGS_CN_AC__SPRCACHE_H
 #define __AGS_CN_AC__SPRCACHE_H
 
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include "core/platform.h"
 #include "ac/spritefile.h"
@@ -81,9 +91,19 @@ public:
         PfnPrewriteSprite PrewriteSprite;
     };
 
+    // Sprite cache usage statistics
+    struct Stats
+    {
+        uint32_t Hits = 0u;       // requested sprite was found in cache
+        uint32_t Misses = 0u;     // requested sprite had to be loaded on demand
+        uint32_t Waits = 0u;      // requested sprite was being loaded in background, had to wait for it
+        uint32_t Prefetched = 0u; // sprites loaded in background
+        uint32_t InFlight = 0u;   // sprites currently queued or being loaded in background
+    };
+
 
     SpriteCache(std::vector<SpriteInfo> &sprInfos, const Callbacks &callbacks);
-    ~SpriteCache() = default;
+    ~SpriteCache();
 
     // Loads sprite reference information and inits sprite stream
     HError      InitFile(const String &filename, const String &sprindex_filename);
@@ -142,6 +162,20 @@ public:
     // Sets max cache size in bytes
     inline void SetMaxCacheSize(size_t size) { ResourceCache::SetMaxCacheSize(size); }
 
+    // Starts or stops the background loader thread; while it's not running,
+    // prefetch requests are ignored
+    void        SetAsyncLoading(bool on);
+    // Requests to load an asset sprite in background; does nothing if the
+    // sprite is already loaded, or there's not enough free space in cache
+    void        Prefetch(sprkey_t index);
+    // Puts sprites loaded in background into the cache;
+    // must be called regularly from the main thread
+    void        ProcessPrefetched();
+    // Gets cache usage statistics
+    Stats       GetStats() const;
+    // Resets the statistics counters
+    void        ResetStats();
+
     // Loads (if it's not in cache yet) and returns bitmap by the sprite index
     Bitmap *operator[] (sprkey_t index);
 
@@ -153,6 +187,15 @@ protected:
 private:
     // Load sprite from game resource and put into the cache
     Bitmap *    LoadSprite(sprkey_t index);
+    // Initialize the sprite image loaded from game resource and put into the cache
+    Bitmap *    InitLoadedSprite(sprkey_t index, Bitmap *image, const HError &err);
+    // Takes out the sprite loaded in background, if there's one, optionally
+    // waits for it if it's still being loaded; returns if the sprite was found
+    bool        TakePrefetched(sprkey_t index, std::unique_ptr<Bitmap> &image, HError &err, bool wait);
+    // Cancels all the background loading and discards any unprocessed sprites
+    void        CancelPrefetch();
+    // Background loader thread's entry point
+    void        LoaderThread();
     // Remap the given index to the sprite 0
     void        RemapSpriteToPlaceholder(sprkey_t index);
     // Initialize the empty sprite slot
@@ -194,6 +237,31 @@ private:
 
     Callbacks  _callbacks;
     SpriteFile _file;
+
+    // Background loading
+    struct PrefetchedSprite
+    {
+        std::unique_ptr<Bitmap> Image;
+        HError Error = HError::None();
+        size_t EstSize = 0u; // estimated size, reserved in cache
+    };
+    // Guards the sprite file, which is shared between the main and loader threads
+    std::mutex _fileMutex;
+    // Guards the loader queue and results
+    mutable std::mutex _loadMutex;
+    // Notifies the loader about new requests, and the main thread about loaded sprites
+    std::condition_variable _loadCV;
+    std::thread _loaderThread;
+    bool _loaderRunning = false;
+    // Sprites waiting to be loaded in background, and their estimated sizes
+    std::deque<std::pair<sprkey_t, size_t>> _loadQueue;
+    // Sprite being loaded by the thread right now
+    sprkey_t _loadingNow = -1;
+    // Sprites loaded in background, waiting to be put into the cache
+    std::unordered_map<sprkey_t, PrefetchedSprite> _prefetched;
+    // Total estimated size of queued and prefetched sprites
+    size_t _prefetchSize = 0u;
+    Stats _stats;
 };
 
 } // namespace Common
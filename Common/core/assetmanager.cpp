@@ -14,7 +14,9 @@
 #include "core/assetmanager.h"
 #include <algorithm>
 #include <regex>
+#include <string.h>
 #include "util/directory.h"
+#include "util/mappedfilestream.h"
 #include "util/multifilelib.h"
 #include "util/path.h"
 #include "util/string_utils.h" // cbuf_to_string_and_free
@@ -39,6 +41,28 @@ bool AssetManager::AssetLibEx::TestFilter(const String &filter) const
         (std::find(Filters.begin(), Filters.end(), filter) != Filters.end());
 }
 
+void AssetManager::AssetLibEx::BuildIndex()
+{
+    AssetLookup.clear();
+    AssetLookup.reserve(AssetInfos.size());
+    SortedAssets.resize(AssetInfos.size());
+    for (size_t i = 0; i < AssetInfos.size(); ++i)
+    {
+        // if there are duplicate names, the first one is used, same as before
+        AssetLookup.emplace(AssetInfos[i].FileName, i);
+        SortedAssets[i] = i;
+    }
+    const auto &infos = AssetInfos;
+    std::stable_sort(SortedAssets.begin(), SortedAssets.end(),
+        [&infos](size_t a, size_t b) { return infos[a].FileName.CompareNoCase(infos[b].FileName) < 0; });
+}
+
+const AssetInfo *AssetManager::AssetLibEx::FindAsset(const String &asset_name) const
+{
+    auto it = AssetLookup.find(asset_name);
+    return it != AssetLookup.end() ? &AssetInfos[it->second] : nullptr;
+}
+
 
 bool AssetManager::LibsByPriority::operator()(const AssetLibInfo *lib1, const AssetLibInfo *lib2) const
 {
@@ -94,6 +118,18 @@ AssetSearchPriority AssetManager::GetSearchPriority() const
     return _libsByPriority.Priority;
 }
 
+void AssetManager::SetAccessMode(AssetAccessMode mode)
+{
+    _accessMode = mode;
+    for (auto &lib : _libs)
+        UpdateLibMapping(lib.get());
+}
+
+AssetAccessMode AssetManager::GetAccessMode() const
+{
+    return _accessMode;
+}
+
 AssetError AssetManager::AddLibrary(const String &path, const AssetLibInfo **out_lib)
 {
     return AddLibrary(path, "", out_lib);
@@ -171,13 +207,9 @@ bool AssetManager::DoesAssetExist(const String &asset_name, const String &filter
             if (!filename.IsEmpty())
                 return true;
         }
-        else
+        else if (lib->FindAsset(asset_name))
         {
-            for (const auto &a : lib->AssetInfos)
-            {
-                if (a.FileName.CompareNoCase(asset_name) == 0)
-                    return true;
-            }
+            return true;
         }
     }
     return false;
@@ -189,6 +221,11 @@ void AssetManager::FindAssets(std::vector<String> &assets, const String &wildcar
     String pattern = StrUtil::WildcardToRegex(wildcard);
     const std::regex regex(pattern.GetCStr(), std::regex_constants::icase);
     std::cmatch mr;
+    // Only the names starting with the wildcard's literal part may match,
+    // and these are found in a continuous range of the sorted asset list
+    const size_t wild_at = strcspn(wildcard.GetCStr(), "*?");
+    const bool has_wildcards = wild_at < wildcard.GetLength();
+    const String prefix = wildcard.Left(wild_at);
 
     for (const auto *lib : _activeLibs)
     {
@@ -202,12 +239,22 @@ void AssetManager::FindAssets(std::vector<String> &assets, const String &wildcar
                  !ff.AtEnd(); ff.Next())
                 assets.push_back(ff.Current());
         }
+        else if (!has_wildcards)
+        {
+            const AssetInfo *a = lib->FindAsset(wildcard);
+            if (a)
+                assets.push_back(a->FileName);
+        }
         else
         {
-            for (const auto &a : lib->AssetInfos)
+            const auto &infos = lib->AssetInfos;
+            auto it = std::lower_bound(lib->SortedAssets.begin(), lib->SortedAssets.end(), prefix,
+                [&infos](size_t a, const String &name) { return infos[a].FileName.CompareNoCase(name) < 0; });
+            for (; it != lib->SortedAssets.end() &&
+                   infos[*it].FileName.CompareLeftNoCase(prefix) == 0; ++it)
             {
-                if (std::regex_match(a.FileName.GetCStr(), mr, regex))
-                    assets.push_back(a.FileName);
+                if (std::regex_match(infos[*it].FileName.GetCStr(), mr, regex))
+                    assets.push_back(infos[*it].FileName);
             }
         }
     }
@@ -254,6 +301,8 @@ AssetError AssetManager::RegisterAssetLib(const String &path, AssetLibEx *&out_l
         {
             lib->RealLibFiles.push_back(File::FindFileCI(lib->BaseDir, lib->LibFileNames[i]));
         }
+        lib->BuildIndex();
+        UpdateLibMapping(lib.get());
     }
 
     out_lib = lib.get();
@@ -261,6 +310,22 @@ AssetError AssetManager::RegisterAssetLib(const String &path, AssetLibEx *&out_l
     return kAssetNoError;
 }
 
+void AssetManager::UpdateLibMapping(AssetLibEx *lib)
+{
+    if (IsAssetLibDir(lib) || (_accessMode != kAssetAccessMapped))
+    {
+        // the open asset streams keep their mapping alive on their own
+        lib->MappedFiles.clear();
+        return;
+    }
+    lib->MappedFiles.resize(lib->RealLibFiles.size());
+    for (size_t i = 0; i < lib->RealLibFiles.size(); ++i)
+    {
+        if (!lib->MappedFiles[i] && !lib->RealLibFiles[i].IsEmpty())
+            lib->MappedFiles[i] = MappedFile::Map(lib->RealLibFiles[i]);
+    }
+}
+
 Stream *AssetManager::OpenAsset(const String &asset_name, const String &filter) const
 {
     for (const auto *lib : _activeLibs)
@@ -280,17 +345,17 @@ Stream *AssetManager::OpenAsset(const String &asset_name, const String &filter)
 
 Stream *AssetManager::OpenAssetFromLib(const AssetLibEx *lib, const String &asset_name) const
 {
-    for (const auto &a : lib->AssetInfos)
-    {
-        if (a.FileName.CompareNoCase(asset_name) == 0)
-        {
-            String libfile = lib->RealLibFiles[a.LibUid];
-            if (libfile.IsEmpty())
-                return nullptr;
-            return File::OpenFile(libfile, a.Offset, a.Offset + a.Size);
-        }
-    }
-    return nullptr;
+    const AssetInfo *a = lib->FindAsset(asset_name);
+    if (!a)
+        return nullptr;
+    if (static_cast<size_t>(a->LibUid) < lib->MappedFiles.size() && lib->MappedFiles[a->LibUid])
+        return new MappedFileStream(lib->MappedFiles[a->LibUid], a->Offset, a->Offset + a->Size);
+    String libfile = lib->RealLibFiles[a->LibUid];
+    if (libfile.IsEmpty())
+        return nullptr;
+    if (_accessMode == kAssetAccessDirect)
+        return File::OpenFileUnbuffered(libfile, a->Offset, a->Offset + a->Size);
+    return File::OpenFile(libfile, a->Offset, a->Offset + a->Size);
 }
 
 Stream *AssetManager::OpenAssetFromDir(const AssetLibEx *lib, const String &file_name) const
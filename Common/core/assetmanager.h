@@ -32,12 +32,14 @@
 #include <memory>
 #include "core/asset.h"
 #include "util/file.h" // TODO: extract filestream mode constants or introduce generic ones
+#include "util/string_types.h"
 
 namespace AGS
 {
 namespace Common
 {
 
+class MappedFile;
 class Stream;
 struct MultiFileLib;
 
@@ -47,6 +49,15 @@ enum AssetSearchPriority
     kAssetPriorityLib
 };
 
+// Defines how the assets are read from the library files
+enum AssetAccessMode
+{
+    kAssetAccessBuffered,   // open a buffered file stream for each asset
+    kAssetAccessDirect,     // open a file stream without the additional buffer
+    kAssetAccessMapped,     // map library files into memory once, and read assets from there
+    kNumAssetAccessModes
+};
+
 enum AssetError
 {
     kAssetNoError           =  0,
@@ -80,6 +91,11 @@ public:
     void         SetSearchPriority(AssetSearchPriority priority);
     // Gets current asset search priority
     AssetSearchPriority GetSearchPriority() const;
+    // Sets the way assets are read from the library files; if memory mapping
+    // fails for any library file, that file falls back to the buffered access
+    void         SetAccessMode(AssetAccessMode mode);
+    // Gets current library access mode
+    AssetAccessMode GetAccessMode() const;
 
     // Add library location to the list of asset locations
     AssetError   AddLibrary(const String &path, const AssetLibInfo **lib = nullptr);
@@ -113,12 +129,24 @@ private:
     {
         std::vector<String> Filters; // asset filters this library is matching to
         std::vector<String> RealLibFiles; // fixed up library filenames
+        std::vector<std::shared_ptr<MappedFile>> MappedFiles; // mapped library files, if enabled
+        // Case-insensitive map of asset names to their index in AssetInfos
+        std::unordered_map<String, size_t, HashStrNoCase, StrEqNoCase> AssetLookup;
+        // Indexes of AssetInfos sorted by the case-insensitive asset name,
+        // used for the wildcard search
+        std::vector<size_t> SortedAssets;
 
         bool TestFilter(const String &filter) const;
+        // Builds lookup tables for the library contents
+        void BuildIndex();
+        // Finds asset by name (case-insensitive); returns null if not found
+        const AssetInfo *FindAsset(const String &asset_name) const;
     };
 
     // Loads library and registers its contents into the cache
     AssetError  RegisterAssetLib(const String &path, AssetLibEx *&lib);
+    // Maps or unmaps library files according to the current access mode
+    void        UpdateLibMapping(AssetLibEx *lib);
 
     // Tries to find asset in the given location, and then opens a stream for reading
     Stream     *OpenAssetFromLib(const AssetLibEx *lib, const String &asset_name) const;
@@ -126,6 +154,7 @@ private:
 
     std::vector<std::unique_ptr<AssetLibEx>> _libs;
     std::vector<AssetLibEx*> _activeLibs;
+    AssetAccessMode _accessMode = kAssetAccessBuffered;
 
     struct LibsByPriority : public std::binary_function<const AssetLibInfo*, const AssetLibInfo*, bool>
     {
@@ -39,7 +39,7 @@ int ccGetOption(int optbit)
 // Returns current running script callstack as a human-readable text
 extern String cc_get_callstack(int max_lines = INT_MAX);
 
-static ScriptError ccError;
+static CC_THREADLOCAL ScriptError ccError;
 
 void cc_clear_error()
 {
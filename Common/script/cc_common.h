@@ -20,6 +20,14 @@
 
 #include "util/string.h"
 
+// The script compiler's state may be kept per thread, which lets the
+// standalone compiler build several scripts at once
+#if defined(AGS_CC_MULTITHREADED)
+#define CC_THREADLOCAL thread_local
+#else
+#define CC_THREADLOCAL
+#endif
+
 #define SCOPT_EXPORTALL      1   // export all functions automatically
 #define SCOPT_SHOWWARNINGS   2   // printf warnings to console
 #define SCOPT_LINENUMBERS    4   // include line numbers in compiled code
@@ -29,6 +37,8 @@
 #define SCOPT_LEFTTORIGHT 0x40   // left-to-right operator precedance
 #define SCOPT_OLDSTRINGS  0x80   // allow old-style strings
 #define SCOPT_UTF8        0x100  // UTF-8 text mode
+#define SCOPT_LEGACYEXEC  0x200  // execute original byte-code instead of the pre-decoded one (debugging)
+#define SCOPT_OPTIMIZE    0x400  // optimize the compiled byte-code
 
 extern void ccSetOption(int, int);
 extern int ccGetOption(int);
@@ -52,6 +62,6 @@ void cc_error(const ScriptError &err);
 // Project-dependent script error formatting
 AGS::Common::String cc_format_error(const AGS::Common::String &message);
 
-extern int currentline;
+extern CC_THREADLOCAL int currentline;
 
 #endif // __CC_ERROR_H
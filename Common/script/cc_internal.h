@@ -18,6 +18,8 @@
 #ifndef __CC_INTERNAL_H
 #define __CC_INTERNAL_H
 
+#include "script/cc_common.h"
+
 #define SCOM_VERSION 90
 #define SCOM_VERSIONSTR "0.90"
 
@@ -126,6 +128,6 @@
 extern const char scfilesig[5];
 #define ENDFILESIG 0xbeefcafe
 
-extern const char *ccCurScriptName; // name of currently compiling script
+extern CC_THREADLOCAL const char *ccCurScriptName; // name of currently compiling script
 
 #endif // __CC_INTERNAL_H
@@ -0,0 +1,182 @@
+#include <memory>
+#include <string.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "core/assetmanager.h"
+#include "util/file.h"
+#include "util/multifilelib.h"
+#include "util/stream.h"
+
+using namespace AGS::Common;
+
+static const size_t LargeAssetCount = 50000;
+
+// Writes a single-file library, where each asset contains its index as int32
+static void WriteTestLibrary(const String &filename, const std::vector<String> &names)
+{
+    AssetLibInfo lib;
+    lib.LibFileNames.push_back(filename);
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        AssetInfo asset;
+        asset.FileName = names[i];
+        asset.LibUid = 0;
+        asset.Size = sizeof(int32_t);
+        lib.AssetInfos.push_back(asset);
+    }
+
+    std::unique_ptr<Stream> out(File::CreateFile(filename));
+    ASSERT_TRUE(out != nullptr);
+    MFLUtil::WriteHeader(lib, MFLUtil::kMFLVersion_MultiV30, 0, out.get());
+    for (size_t i = 0; i < lib.AssetInfos.size(); ++i)
+    {
+        lib.AssetInfos[i].Offset = out->GetPosition();
+        out->WriteInt32(static_cast<int32_t>(i));
+    }
+    out->Seek(0, kSeekBegin);
+    MFLUtil::WriteHeader(lib, MFLUtil::kMFLVersion_MultiV30, 0, out.get());
+    out->Seek(0, kSeekEnd);
+    MFLUtil::WriteEnder(0, MFLUtil::kMFLVersion_MultiV30, out.get());
+}
+
+static std::vector<String> MakeLargeAssetNames()
+{
+    std::vector<String> names;
+    for (size_t i = 0; i < LargeAssetCount; ++i)
+        names.push_back(String::FromFormat("Speech%05zu.ogg", i));
+    return names;
+}
+
+static int32_t ReadAssetValue(const AssetManager &mgr, const String &name)
+{
+    std::unique_ptr<Stream> in(mgr.OpenAsset(name));
+    return in ? in->ReadInt32() : -1;
+}
+
+// Each test writes its own library file, as the tests may run in parallel
+static String GetTestLibFile()
+{
+    return String::FromFormat("assetmanager_test_%s.dat",
+        ::testing::UnitTest::GetInstance()->current_test_info()->name());
+}
+
+TEST(AssetManager, LibraryLookup) {
+    const String lib_file = GetTestLibFile();
+    std::vector<String> names = { "room1.crm", "Room2.crm", "SOUND1.ogg", "sound2.ogg",
+        "music.ogg", "sound1.ogg" /* duplicate name in a different case */ };
+    WriteTestLibrary(lib_file, names);
+
+    AssetManager mgr;
+    ASSERT_EQ(mgr.AddLibrary(lib_file), kAssetNoError);
+
+    // Case-insensitive lookup; first of the duplicate names wins
+    ASSERT_EQ(ReadAssetValue(mgr, "room1.crm"), 0);
+    ASSERT_EQ(ReadAssetValue(mgr, "ROOM1.CRM"), 0);
+    ASSERT_EQ(ReadAssetValue(mgr, "room2.crm"), 1);
+    ASSERT_EQ(ReadAssetValue(mgr, "sound1.ogg"), 2);
+    ASSERT_EQ(ReadAssetValue(mgr, "Sound2.OGG"), 3);
+    ASSERT_EQ(ReadAssetValue(mgr, "music.ogg"), 4);
+    ASSERT_EQ(ReadAssetValue(mgr, "room3.crm"), -1);
+
+    ASSERT_TRUE(mgr.DoesAssetExist("MUSIC.ogg"));
+    ASSERT_FALSE(mgr.DoesAssetExist("music"));
+    ASSERT_FALSE(mgr.DoesAssetExist(""));
+
+    // Wildcard search
+    std::vector<String> found;
+    mgr.FindAssets(found, "*.crm");
+    ASSERT_EQ(found.size(), 2u);
+    found.clear();
+    mgr.FindAssets(found, "sound?.ogg");
+    ASSERT_EQ(found.size(), 3u); // duplicates differ in case, so all are returned
+    found.clear();
+    mgr.FindAssets(found, "ROOM*");
+    ASSERT_EQ(found.size(), 2u);
+    found.clear();
+    mgr.FindAssets(found, "music.ogg");
+    ASSERT_EQ(found.size(), 1u);
+    ASSERT_STREQ(found[0].GetCStr(), "music.ogg");
+    found.clear();
+    mgr.FindAssets(found, "*");
+    ASSERT_EQ(found.size(), names.size());
+    found.clear();
+    mgr.FindAssets(found, "room1");
+    ASSERT_EQ(found.size(), 0u);
+
+    mgr.RemoveAllLibraries();
+    File::DeleteFile(lib_file);
+}
+
+TEST(AssetManager, LibraryAccessModes) {
+    const String lib_file = GetTestLibFile();
+    std::vector<String> names = { "room1.crm", "room2.crm", "sound1.ogg", "sound2.ogg" };
+    WriteTestLibrary(lib_file, names);
+
+    AssetManager mgr;
+    ASSERT_EQ(mgr.AddLibrary(lib_file), kAssetNoError);
+    for (int mode = 0; mode < kNumAssetAccessModes; ++mode)
+    {
+        mgr.SetAccessMode(static_cast<AssetAccessMode>(mode));
+        ASSERT_EQ(mgr.GetAccessMode(), mode);
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            std::unique_ptr<Stream> in(mgr.OpenAsset(names[i]));
+            ASSERT_TRUE(in != nullptr);
+            ASSERT_EQ(in->GetLength(), static_cast<soff_t>(sizeof(int32_t)));
+            // Memory-mapped assets must expose their data, and never read past the asset
+            if (mode == kAssetAccessMapped)
+            {
+                ASSERT_TRUE(in->GetData() != nullptr);
+                int32_t val;
+                memcpy(&val, in->GetData(), sizeof(val));
+                ASSERT_EQ(val, static_cast<int32_t>(i));
+            }
+            ASSERT_EQ(in->ReadInt32(), static_cast<int32_t>(i));
+            ASSERT_TRUE(in->EOS());
+            ASSERT_EQ(in->ReadByte(), -1);
+            ASSERT_TRUE(in->Seek(0, kSeekBegin));
+            ASSERT_EQ(in->ReadInt32(), static_cast<int32_t>(i));
+        }
+    }
+    // Mapped assets stay valid after the library is removed
+    mgr.SetAccessMode(kAssetAccessMapped);
+    std::unique_ptr<Stream> in(mgr.OpenAsset("sound2.ogg"));
+    mgr.RemoveAllLibraries();
+    ASSERT_TRUE(in != nullptr);
+    ASSERT_EQ(in->ReadInt32(), 3);
+    in.reset();
+
+    File::DeleteFile(lib_file);
+}
+
+TEST(AssetManager, LargeLibraryLookup) {
+    const String lib_file = GetTestLibFile();
+    const std::vector<String> names = MakeLargeAssetNames();
+    WriteTestLibrary(lib_file, names);
+
+    AssetManager mgr;
+    ASSERT_EQ(mgr.AddLibrary(lib_file), kAssetNoError);
+
+    // Open every 10th asset, in the upper case, as the engine would do
+    // when playing speech and sounds; test each library access mode
+    for (int mode = 0; mode < kNumAssetAccessModes; ++mode)
+    {
+        mgr.SetAccessMode(static_cast<AssetAccessMode>(mode));
+        for (size_t i = 0; i < names.size(); i += 10)
+        {
+            String name = names[i];
+            name.MakeUpper();
+            ASSERT_EQ(ReadAssetValue(mgr, name), static_cast<int32_t>(i));
+        }
+    }
+
+    for (const auto &name : names)
+        ASSERT_TRUE(mgr.DoesAssetExist(name));
+
+    std::vector<String> found;
+    mgr.FindAssets(found, "speech1*.ogg");
+    ASSERT_EQ(found.size(), 10000u);
+
+    mgr.RemoveAllLibraries();
+    File::DeleteFile(lib_file);
+}
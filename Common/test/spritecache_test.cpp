@@ -0,0 +1,94 @@
+#include <memory>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "ac/gamestructdefines.h"
+#include "ac/spritecache.h"
+#include "core/assetmanager.h"
+#include "gfx/bitmap.h"
+#include "util/file.h"
+
+using namespace AGS::Common;
+
+// Common library expects the program to provide the color conversion
+void __my_setcolor(int *ctset, int newcol, int /*wantColDep*/)
+{
+    *ctset = newcol;
+}
+
+static const char *TestSprFile = "spritecache_test.spr";
+static const sprkey_t TestSpriteCount = 200;
+
+// Writes a sprite file, where each sprite is filled with its own index
+static void WriteTestSpriteFile(const String &filename)
+{
+    std::vector<SpriteInfo> infos;
+    SpriteCache cache(infos, SpriteCache::Callbacks());
+    for (sprkey_t i = 0; i < TestSpriteCount; ++i)
+    {
+        std::unique_ptr<Bitmap> image(BitmapHelper::CreateBitmap(32, 32, 32));
+        image->Clear(i);
+        ASSERT_TRUE(cache.SetSprite(i, std::move(image)));
+    }
+    SpriteFileIndex index;
+    ASSERT_EQ(cache.SaveToFile(filename, 0, kSprCompress_LZW, index), 0);
+}
+
+TEST(SpriteCache, AsyncLoading) {
+    WriteTestSpriteFile(TestSprFile);
+    // Sprite file is opened through the global asset manager
+    AssetMgr.reset(new AssetManager());
+    ASSERT_EQ(AssetMgr->AddLibrary("."), kAssetNoError);
+
+    std::vector<SpriteInfo> infos;
+    SpriteCache cache(infos, SpriteCache::Callbacks());
+    ASSERT_TRUE(cache.InitFile(TestSprFile, ""));
+    ASSERT_EQ(cache.GetSpriteSlotCount(), static_cast<size_t>(TestSpriteCount));
+    cache.SetMaxCacheSize(16 * 1024 * 1024);
+    cache.SetAsyncLoading(true);
+
+    // Request everything, then read sprites without waiting for the loader:
+    // each sprite must be valid, whether it was prefetched, being loaded,
+    // or still waiting in queue
+    for (sprkey_t i = 1; i < TestSpriteCount; ++i)
+        cache.Prefetch(i);
+    for (sprkey_t i = 1; i < TestSpriteCount; ++i)
+    {
+        Bitmap *image = cache[i];
+        ASSERT_TRUE(image != nullptr);
+        ASSERT_EQ(image->GetWidth(), 32);
+        ASSERT_EQ(image->GetPixel(16, 16), i);
+        if (i % 10 == 0)
+            cache.ProcessPrefetched();
+    }
+    cache.ProcessPrefetched();
+    SpriteCache::Stats stats = cache.GetStats();
+    ASSERT_EQ(stats.InFlight, 0u);
+    ASSERT_EQ(stats.Hits + stats.Misses, static_cast<uint32_t>(TestSpriteCount - 1));
+
+    // Prefetched sprites are put into the cache by ProcessPrefetched
+    cache.DisposeAllCached();
+    cache.ResetStats();
+    for (sprkey_t i = 1; i < TestSpriteCount; ++i)
+        cache.Prefetch(i);
+    while (cache.GetStats().InFlight > 0)
+        std::this_thread::yield();
+    cache.ProcessPrefetched();
+    for (sprkey_t i = 1; i < TestSpriteCount; ++i)
+        ASSERT_EQ(cache[i]->GetPixel(0, 0), i);
+    stats = cache.GetStats();
+    ASSERT_EQ(stats.Hits, static_cast<uint32_t>(TestSpriteCount - 1));
+    ASSERT_EQ(stats.Misses, 0u);
+
+    // Stopping the loader discards pending requests
+    cache.DisposeAllCached();
+    for (sprkey_t i = 1; i < TestSpriteCount; ++i)
+        cache.Prefetch(i);
+    cache.SetAsyncLoading(false);
+    ASSERT_EQ(cache.GetStats().InFlight, 0u);
+    ASSERT_EQ(cache[TestSpriteCount - 1]->GetPixel(0, 0), TestSpriteCount - 1);
+
+    cache.Reset();
+    AssetMgr.reset();
+    File::DeleteFile(TestSprFile);
+}
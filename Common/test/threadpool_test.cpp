@@ -0,0 +1,37 @@
+#include <atomic>
+#include <vector>
+#include "gtest/gtest.h"
+#include "util/threadpool.h"
+
+using namespace AGS::Common;
+
+TEST(ThreadPool, RunParallel) {
+    ThreadPool pool;
+    // No workers: everything runs on the caller, in order
+    std::vector<size_t> order;
+    pool.RunParallel(10, [&order](size_t i) { order.push_back(i); });
+    ASSERT_EQ(order.size(), 10u);
+    for (size_t i = 0; i < order.size(); ++i)
+        ASSERT_EQ(order[i], i);
+
+    // Each job must be run exactly once, on every job set
+    pool.Start(3);
+    for (int set = 0; set < 100; ++set)
+    {
+        const size_t count = 1 + set % 17;
+        std::vector<std::atomic<int>> runs(count);
+        for (auto &r : runs)
+            r = 0;
+        pool.RunParallel(count, [&runs](size_t i) { runs[i]++; });
+        for (auto &r : runs)
+            ASSERT_EQ(r.load(), 1);
+    }
+
+    // Restart with a different number of workers
+    pool.Start(1);
+    std::atomic<size_t> sum{0u};
+    pool.RunParallel(1000, [&sum](size_t i) { sum += i; });
+    ASSERT_EQ(sum.load(), 999u * 1000u / 2u);
+    pool.Stop();
+    ASSERT_EQ(pool.GetWorkerCount(), 0u);
+}
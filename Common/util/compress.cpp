@@ -26,6 +26,24 @@
 
 using namespace AGS::Common;
 
+// Gets the next data_sz bytes of the input stream and advances the stream
+// past them. If the stream's data is accessible in memory, then returns
+// a pointer into it, otherwise reads the data into the provided buffer.
+static const uint8_t *GetInputData(Stream *in, size_t data_sz, std::vector<uint8_t> &buf)
+{
+    const uint8_t *data = in->GetData();
+    if (data)
+    {
+        const soff_t pos = in->GetPosition();
+        if ((pos + static_cast<soff_t>(data_sz) <= in->GetLength()) &&
+            in->Seek(data_sz, kSeekCurrent))
+            return data + pos;
+    }
+    buf.resize(data_sz);
+    in->Read(buf.data(), data_sz);
+    return buf.data();
+}
+
 //-----------------------------------------------------------------------------
 // RLE
 //-----------------------------------------------------------------------------
@@ -356,9 +374,9 @@ bool lzw_decompress(uint8_t *data, size_t data_sz, int /*image_bpp*/, Stream *in
         in->Read(data, data_sz);
         return true;
     }
-    std::vector<uint8_t> in_buf(in_sz);
-    in->Read(in_buf.data(), in_sz);
-    return lzwexpand(in_buf.data(), in_sz, data, data_sz);
+    std::vector<uint8_t> in_buf;
+    const uint8_t *in_data = GetInputData(in, in_sz, in_buf);
+    return lzwexpand(in_data, in_sz, data, data_sz);
 }
 
 void save_lzw(Stream *out, const Bitmap *bmpp, const RGB (*pal)[256])
@@ -414,10 +432,10 @@ std::unique_ptr<Bitmap> load_lzw(Stream *in, int dst_bpp, RGB (*pal)[256])
   const soff_t end_pos = in->GetPosition() + comp_sz;
 
   // First decompress data into the memory buffer
-  std::vector<uint8_t> inbuf(comp_sz);
+  std::vector<uint8_t> inbuf;
   std::vector<uint8_t> membuf(uncomp_sz);
-  in->Read(inbuf.data(), comp_sz);
-  lzwexpand(inbuf.data(), comp_sz, membuf.data(), uncomp_sz);
+  const uint8_t *in_data = GetInputData(in, comp_sz, inbuf);
+  lzwexpand(in_data, comp_sz, membuf.data(), uncomp_sz);
 
   // Open same buffer for reading and get params and pixels
   VectorStream mem_in(membuf);
@@ -520,7 +538,7 @@ bool deflate_compress(const uint8_t* data, size_t data_sz, int /*image_bpp*/, St
 
 bool inflate_decompress(uint8_t* data, size_t data_sz, int /*image_bpp*/, Stream* in, size_t in_sz)
 {
-    std::vector<uint8_t> in_buf(in_sz);
-    in->Read(in_buf.data(), in_sz);
-    return z_inflate(in_buf.data(), in_sz, data, data_sz);
+    std::vector<uint8_t> in_buf;
+    const uint8_t *in_data = GetInputData(in, in_sz, in_buf);
+    return z_inflate(in_data, in_sz, data, data_sz);
 }
@@ -407,5 +407,32 @@ Stream *File::OpenFile(const String &filename, soff_t start_off, soff_t end_off)
     }
 }
 
+Stream *File::OpenFileUnbuffered(const String &filename, soff_t start_off, soff_t end_off)
+{
+    try {
+        Stream *fs = new FileSectionStream(filename, start_off, end_off);
+        if (fs != nullptr && !fs->IsValid()) {
+            delete fs;
+            return nullptr;
+        }
+        return fs;
+    }
+    catch (std::runtime_error) {
+        Stream* fs = nullptr;
+#if AGS_PLATFORM_OS_ANDROID
+        try {
+            fs = new AAssetStream(filename, AASSET_MODE_RANDOM, start_off, end_off);
+            if (fs != nullptr && !fs->IsValid()) {
+                delete fs;
+                fs = nullptr;
+            }
+        } catch(std::runtime_error) {
+            fs = nullptr;
+        }
+#endif
+        return fs;
+    }
+}
+
 } // namespace Common
 } // namespace AGS
@@ -76,6 +76,9 @@ namespace File
     Stream      *OpenFile(const String &filename, FileOpenMode open_mode, FileWorkMode work_mode);
     // Opens file for reading restricted to the arbitrary offset range
     Stream      *OpenFile(const String &filename, soff_t start_off, soff_t end_off);
+    // Opens file for reading restricted to the arbitrary offset range,
+    // without an additional stream buffer
+    Stream      *OpenFileUnbuffered(const String &filename, soff_t start_off, soff_t end_off);
     // Convenience helpers
     // Create a totally new file, overwrite existing one
     inline Stream *CreateFile(const String &filename)
@@ -12,6 +12,8 @@
 //
 //=============================================================================
 #include "util/filestream.h"
+#include <algorithm>
+#include <cassert>
 #include <stdexcept>
 #include "util/stdio_compat.h"
 
@@ -160,5 +162,73 @@ void FileStream::Open(const String &file_name, FileOpenMode open_mode, FileWorkM
 
 FileStream::FFileCloseNotify FileStream::FileCloseNotify = nullptr;
 
+//-----------------------------------------------------------------------------
+// FileSectionStream
+//-----------------------------------------------------------------------------
+
+FileSectionStream::FileSectionStream(const String &file_name, soff_t start_pos, soff_t end_pos,
+        DataEndianess stream_endianess)
+    : FileStream(file_name, kFile_Open, kFile_Read, stream_endianess)
+{
+    assert(start_pos <= end_pos);
+    const soff_t file_end = FileStream::GetLength();
+    _end = std::min(end_pos, file_end);
+    _start = std::min(start_pos, _end);
+    _position = _start;
+    FileStream::Seek(_start, kSeekBegin);
+}
+
+bool FileSectionStream::EOS() const
+{
+    return _position >= _end;
+}
+
+soff_t FileSectionStream::GetLength() const
+{
+    return _end - _start;
+}
+
+soff_t FileSectionStream::GetPosition() const
+{
+    return _position - _start;
+}
+
+size_t FileSectionStream::Read(void *buffer, size_t size)
+{
+    size = static_cast<size_t>(std::min<soff_t>(size, _end - _position));
+    size_t read_sz = FileStream::Read(buffer, size);
+    _position += read_sz;
+    return read_sz;
+}
+
+int32_t FileSectionStream::ReadByte()
+{
+    if (_position >= _end)
+        return -1;
+    int32_t b = FileStream::ReadByte();
+    if (b >= 0)
+        _position++;
+    return b;
+}
+
+bool FileSectionStream::Seek(soff_t offset, StreamSeek origin)
+{
+    soff_t want_pos = -1;
+    switch (origin)
+    {
+    case kSeekCurrent:  want_pos = _position + offset; break;
+    case kSeekBegin:    want_pos = _start + offset; break;
+    case kSeekEnd:      want_pos = _end + offset; break;
+    default: return false;
+    }
+
+    // clamp
+    soff_t new_pos = std::min(std::max(want_pos, _start), _end);
+    if (!FileStream::Seek(new_pos, kSeekBegin))
+        return false;
+    _position = new_pos;
+    return _position == want_pos;
+}
+
 } // namespace Common
 } // namespace AGS
@@ -94,6 +94,36 @@ private:
     const FileWorkMode  _workMode;
 };
 
+
+// FileSectionStream is a read-only file stream limited by an arbitrary
+// offset range. Unlike BufferedSectionStream, it does not have a buffer
+// of its own, and passes all reads to the underlying file handle.
+class FileSectionStream : public FileStream
+{
+public:
+    // The constructor may raise std::runtime_error if there is an issue
+    // opening the file; use File::OpenFile to safely construct this object.
+    FileSectionStream(const String &file_name, soff_t start_pos, soff_t end_pos,
+        DataEndianess stream_endianess = kLittleEndian);
+
+    // Is end of stream
+    bool    EOS() const override;
+    // Total length of stream (if known)
+    soff_t  GetLength() const override;
+    // Current position (if known)
+    soff_t  GetPosition() const override;
+
+    size_t  Read(void *buffer, size_t size) override;
+    int32_t ReadByte() override;
+
+    bool    Seek(soff_t offset, StreamSeek origin) override;
+
+private:
+    soff_t _start = 0; // valid section starting offset
+    soff_t _end = 0; // valid section ending offset
+    soff_t _position = 0; // absolute read offset
+};
+
 } // namespace Common
 } // namespace AGS
 
@@ -0,0 +1,114 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "util/mappedfilestream.h"
+#include <algorithm>
+#include <stdint.h>
+#include "core/platform.h"
+#if AGS_PLATFORM_OS_WINDOWS
+#include "platform/windows/windows.h"
+#include "util/stdio_compat.h" // MAX_PATH_SZ
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace AGS
+{
+namespace Common
+{
+
+std::shared_ptr<MappedFile> MappedFile::Map(const String &filename)
+{
+#if AGS_PLATFORM_OS_WINDOWS
+    WCHAR wpath[MAX_PATH_SZ];
+    MultiByteToWideChar(CP_UTF8, 0, filename.GetCStr(), -1, wpath, MAX_PATH_SZ);
+    HANDLE file = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0 ||
+        static_cast<uint64_t>(file_size.QuadPart) > SIZE_MAX)
+    {
+        CloseHandle(file);
+        return nullptr;
+    }
+    // The view keeps a reference to the mapping object, and the mapping keeps
+    // a reference to the file, so both handles may be closed right away
+    HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping)
+        return nullptr;
+    void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!data)
+        return nullptr;
+    const size_t size = static_cast<size_t>(file_size.QuadPart);
+#else
+    int fd = open(filename.GetCStr(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 ||
+        static_cast<uint64_t>(st.st_size) > SIZE_MAX)
+    {
+        close(fd);
+        return nullptr;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    // The mapping remains valid after the file descriptor is closed
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return nullptr;
+#endif
+    return std::shared_ptr<MappedFile>(
+        new MappedFile(filename, static_cast<const uint8_t*>(data), size));
+}
+
+MappedFile::~MappedFile()
+{
+#if AGS_PLATFORM_OS_WINDOWS
+    UnmapViewOfFile(_data);
+#else
+    munmap(const_cast<uint8_t*>(_data), _size);
+#endif
+}
+
+
+static inline size_t ClampOffset(const MappedFile &file, soff_t off)
+{
+    return static_cast<size_t>(std::max<soff_t>(0, std::min<soff_t>(off, file.GetSize())));
+}
+
+MappedFileStream::MappedFileStream(std::shared_ptr<MappedFile> file, soff_t start_pos, soff_t end_pos,
+        DataEndianess stream_endianess)
+    : MemoryStream(file->GetData() + ClampOffset(*file, start_pos),
+        ClampOffset(*file, std::max(start_pos, end_pos)) - ClampOffset(*file, start_pos),
+        stream_endianess)
+    , _file(file)
+{
+    _path = file->GetPath();
+}
+
+void MappedFileStream::Close()
+{
+    MemoryStream::Close();
+    _file.reset();
+}
+
+} // namespace Common
+} // namespace AGS
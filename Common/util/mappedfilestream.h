@@ -0,0 +1,76 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// MappedFile is a read-only memory mapping of a whole file.
+//
+// MappedFileStream reads a section of the mapped file as a memory buffer,
+// without any file i/o calls. The stream shares the ownership over the
+// mapping, so it stays valid even if the mapping's original owner has
+// released it.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__MAPPEDFILESTREAM_H
+#define __AGS_CN_UTIL__MAPPEDFILESTREAM_H
+
+#include <memory>
+#include "util/memorystream.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class MappedFile
+{
+public:
+    // Maps the file into memory; returns null if the file could not be
+    // opened or mapped on this system
+    static std::shared_ptr<MappedFile> Map(const String &filename);
+    ~MappedFile();
+
+    const String  &GetPath() const { return _path; }
+    const uint8_t *GetData() const { return _data; }
+    size_t         GetSize() const { return _size; }
+
+private:
+    MappedFile(const String &path, const uint8_t *data, size_t size)
+        : _path(path), _data(data), _size(size) {}
+    MappedFile(const MappedFile&) = delete;
+    MappedFile &operator =(const MappedFile&) = delete;
+
+    const String   _path;
+    const uint8_t *_data = nullptr;
+    const size_t   _size = 0u;
+};
+
+
+class MappedFileStream : public MemoryStream
+{
+public:
+    // Constructs a read-only stream over the mapped file's section;
+    // the offset range is clamped to the mapped file size
+    MappedFileStream(std::shared_ptr<MappedFile> file, soff_t start_pos, soff_t end_pos,
+        DataEndianess stream_endianess = kLittleEndian);
+    ~MappedFileStream() override = default;
+
+    void    Close() override;
+
+private:
+    std::shared_ptr<MappedFile> _file;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__MAPPEDFILESTREAM_H
@@ -49,6 +49,8 @@ public:
 
     void    Close() override;
     bool    Flush() override;
+    // Returns the read-only buffer, if the stream was opened for reading
+    const uint8_t *GetData() const override { return _cbuf; }
 
     // Is stream valid (underlying data initialized properly)
     bool    IsValid() const override;
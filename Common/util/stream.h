@@ -54,6 +54,10 @@ public:
     virtual bool HasErrors() const { return false; }
     // Flush stream buffer to the underlying device
     virtual bool Flush() = 0;
+    // Returns pointer to the whole stream data, if it is directly accessible
+    // in memory (e.g. memory buffer or a mapped file), or null otherwise;
+    // the data at the current stream position is at GetData()[GetPosition()]
+    virtual const uint8_t *GetData() const { return nullptr; }
 
     //-----------------------------------------------------
     // Helper methods
@@ -0,0 +1,121 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "util/threadpool.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+ThreadPool::~ThreadPool()
+{
+    Stop();
+}
+
+void ThreadPool::Start(size_t worker_count)
+{
+    Stop();
+#if defined(AGS_DISABLE_THREADS)
+    (void)worker_count; // run everything on the calling thread
+#else
+    _stopping = false;
+    for (size_t i = 0; i < worker_count; ++i)
+        _workers.emplace_back(&ThreadPool::WorkerThread, this, _generation);
+#endif
+}
+
+void ThreadPool::Stop()
+{
+#if !defined(AGS_DISABLE_THREADS)
+    if (_workers.empty())
+        return;
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _stopping = true;
+    }
+    _workCV.notify_all();
+    for (auto &t : _workers)
+        t.join();
+    _workers.clear();
+#endif
+}
+
+void ThreadPool::RunParallel(size_t count, const JobFunc &job)
+{
+#if !defined(AGS_DISABLE_THREADS)
+    if (!_workers.empty() && count > 1)
+    {
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            _job = &job;
+            _jobCount = count;
+            _nextJob = 0u;
+            _busyWorkers = _workers.size();
+            _generation++;
+        }
+        _workCV.notify_all();
+        RunJobs();
+        std::unique_lock<std::mutex> lk(_mutex);
+        _doneCV.wait(lk, [this]() { return _busyWorkers == 0u; });
+        _job = nullptr;
+        return;
+    }
+#endif
+    for (size_t i = 0; i < count; ++i)
+        job(i);
+}
+
+size_t ThreadPool::GetHardwareThreads()
+{
+#if defined(AGS_DISABLE_THREADS)
+    return 1u;
+#else
+    const unsigned n = std::thread::hardware_concurrency();
+    return n > 0 ? n : 1u;
+#endif
+}
+
+void ThreadPool::WorkerThread(uint64_t start_gen)
+{
+    uint64_t last_gen = start_gen;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lk(_mutex);
+            _workCV.wait(lk, [this, last_gen]() { return _stopping || _generation != last_gen; });
+            if (_stopping)
+                return;
+            last_gen = _generation;
+        }
+
+        RunJobs();
+
+        std::lock_guard<std::mutex> lk(_mutex);
+        if (--_busyWorkers == 0u)
+            _doneCV.notify_one();
+    }
+}
+
+void ThreadPool::RunJobs()
+{
+    // Job set is assigned under the mutex before workers are woken,
+    // and stays unchanged until all of them report back
+    const JobFunc &job = *_job;
+    const size_t count = _jobCount;
+    for (size_t i = _nextJob++; i < count; i = _nextJob++)
+        job(i);
+}
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,92 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// ThreadPool keeps a number of worker threads, and runs a set of independent
+// jobs on them, blocking the caller until all of them are complete.
+// The calling thread takes part in the work too, so a pool with N workers
+// runs up to N + 1 jobs at once.
+//
+// If the program is built without thread support, or there are no workers,
+// all the jobs are run on the calling thread, in order.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__THREADPOOL_H
+#define __AGS_CN_UTIL__THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+namespace AGS
+{
+namespace Common
+{
+
+class ThreadPool
+{
+public:
+    // Job function receives the index of the job
+    typedef std::function<void(size_t)> JobFunc;
+
+    ThreadPool() = default;
+    ~ThreadPool();
+
+    // Starts the given number of worker threads, replacing existing ones;
+    // must not be called while the jobs are running
+    void   Start(size_t worker_count);
+    // Stops all worker threads
+    void   Stop();
+    // Gets the number of worker threads, not counting the caller
+    size_t GetWorkerCount() const { return _workers.size(); }
+    // Runs job(i) for every i in [0; count) range, and waits until all are
+    // done; jobs may be run in any order and in parallel, and must not throw
+    void   RunParallel(size_t count, const JobFunc &job);
+
+    // Gets the number of threads which may run concurrently on this system
+    static size_t GetHardwareThreads();
+
+private:
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool &operator =(const ThreadPool&) = delete;
+
+    // Worker thread's entry point
+    void WorkerThread(uint64_t start_gen);
+    // Takes the jobs of the current set one by one, until there are no more
+    void RunJobs();
+
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    // Notifies workers about a new job set, or a stop request
+    std::condition_variable _workCV;
+    // Notifies the caller that the workers have finished their jobs
+    std::condition_variable _doneCV;
+    bool _stopping = false;
+    // Incremented each time a new job set is issued
+    uint64_t _generation = 0u;
+    // Current job set
+    const JobFunc *_job = nullptr;
+    size_t _jobCount = 0u;
+    std::atomic<size_t> _nextJob{0u};
+    // Number of workers that have not finished the current job set yet
+    size_t _busyWorkers = 0u;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__THREADPOOL_H
@@ -11,13 +11,17 @@
 // http://www.opensource.org/licenses/artistic-license-2.0.php
 //
 //=============================================================================
+#include <algorithm>
+#include <atomic>
 #include <utility>
 #include <iostream>
+#include <thread>
 
 #include "compiler.h"
 #include "script/cs_compiler.h"
 #include "script/cc_common.h"
 #include "script/cc_internal.h"
+#include "util/directory.h"
 #include "util/filestream.h"
 #include "util/file.h"
 #include "util/path.h"
@@ -65,10 +69,24 @@ std::vector<const char *> GetScriptAPIs()
 
 void CompilerOptions::PrintToStdout() const {
     printf("\n--- Compiler Settings ---\n");
-    printf("Input: %s\n", InputScriptFile.c_str());
-    printf("Output: %s\n", OutputObjFile.c_str());
-    printf("Headers:");
+    printf("Input:");
     bool comma = false;
+    for (const auto& input : InputScriptFiles)
+    {
+        if (comma) printf(", ");
+        printf("%s", input.c_str());
+        comma = true;
+    }
+    printf("\nOutput:");
+    comma = false;
+    for (const auto& output : OutputObjFiles)
+    {
+        if (comma) printf(", ");
+        printf("%s", output.c_str());
+        comma = true;
+    }
+    printf("\nHeaders:");
+    comma = false;
     for (const auto& header : HeaderFiles)
     {
         if (comma) printf(", ");
@@ -98,10 +116,44 @@ void CompilerOptions::PrintToStdout() const {
     if (Flags.EnforceNewStrings) printf("EnforceNewStrings; ");
     if (Flags.EnforceNewAudio) printf("EnforceNewAudio; ");
     if (Flags.UseOldCustomDialogOptionsAPI) printf("UseOldCustomDialogOptionsAPI; ");
+    if (Flags.Optimize) printf("Optimize; ");
+    if(Jobs > 0) printf("\nJobs: %d", Jobs);
+    if(!CacheDir.empty()) printf("\nCache: %s", CacheDir.c_str());
     if(DebugMode) printf("\nDebugMode\n");
 }
 
 
+struct ScriptModule
+{
+    String Name;       // script name, used in error reports
+    String Text;       // script text, preprocessed before compiling
+    std::string Error; // error message, if the script failed to compile
+};
+
+// Compiles the script on top of the headers, and writes the script object;
+// may be run for several scripts at once
+static void CompileModule(const ccCompiledHeaders *headers, ScriptModule &module, const std::string &output_file)
+{
+    std::unique_ptr<ccScript> script (ccCompileTextWithHeaders(headers, module.Text.GetCStr(), module.Name.GetCStr()));
+    if (!script || (cc_has_error()))
+    {
+        const auto &error = cc_get_error();
+        module.Error = std::string("Error: compile failed at ") + ccCurScriptName + ", line " +
+            std::to_string(error.Line) + " : " + error.ErrorString.GetCStr();
+        return;
+    }
+
+    if (!output_file.empty())
+    {
+        std::unique_ptr<Stream> out (File::CreateFile(output_file.c_str()));
+        if (!out || !(out->CanWrite())) {
+            module.Error = "Error: failed to open for writing: " + output_file;
+            return;
+        }
+        script->Write(out.get());
+    }
+}
+
 int Compile(const CompilerOptions& comp_opts)
 {
     comp_opts.PrintToStdout();
@@ -182,6 +234,14 @@ int Compile(const CompilerOptions& comp_opts)
 
     ccSetOption(SCOPT_LEFTTORIGHT, comp_opts.Flags.LeftToRightPrecedence);
     ccSetOption(SCOPT_OLDSTRINGS, !comp_opts.Flags.EnforceNewStrings);
+    ccSetOption(SCOPT_OPTIMIZE, comp_opts.Flags.Optimize);
+
+    if(!comp_opts.CacheDir.empty())
+    {
+        // the cache is optional, so failing to create it is not an error
+        Directory::CreateDirectory(comp_opts.CacheDir.c_str());
+        ccSetCompileCacheDir(comp_opts.CacheDir.c_str());
+    }
 
     ccRemoveDefaultHeaders();
 
@@ -212,25 +272,35 @@ int Compile(const CompilerOptions& comp_opts)
         sr.ReleaseStream();
     }
 
-    String script_input;
-    const char* src = nullptr;
-
-    if (comp_opts.InputScriptFile.empty())
+    if (comp_opts.InputScriptFiles.empty())
     {
-        std::cerr << "Error: empty script filename." << std::endl;
+        std::cerr << "Error: no script to compile." << std::endl;
         return -1;
     }
 
-    src = comp_opts.InputScriptFile.c_str();
-    std::unique_ptr<Stream> in (File::OpenFileRead(src));
-    if (!in)
+    std::vector<ScriptModule> modules;
+    for(const auto& input: comp_opts.InputScriptFiles)
     {
-        std::cerr << "Error: failed to open script for reading: " << src << std::endl;
-        return -1;
+        if (input.empty())
+        {
+            std::cerr << "Error: empty script filename." << std::endl;
+            return -1;
+        }
+
+        std::unique_ptr<Stream> in (File::OpenFileRead(input.c_str()));
+        if (!in)
+        {
+            std::cerr << "Error: failed to open script for reading: " << input << std::endl;
+            return -1;
+        }
+
+        ScriptModule module;
+        module.Name = Path::RemoveExtension(Path::GetFilename(input.c_str()));
+        TextStreamReader sr(in.get());
+        module.Text = sr.ReadAll();
+        sr.ReleaseStream();
+        modules.push_back(module);
     }
-    TextStreamReader sr(in.get());
-    script_input = sr.ReadAll();
-    sr.ReleaseStream();
 
     //-----------------------------------------------------------------------//
     // Preprocess headers and set them for use when compiling
@@ -246,37 +316,41 @@ int Compile(const CompilerOptions& comp_opts)
     heads.clear();
 
     //-----------------------------------------------------------------------//
-    // Preprocess script
+    // Preprocess scripts
     //-----------------------------------------------------------------------//
-    String script_pp = nullptr;
-    String filename = Path::GetFilename(comp_opts.InputScriptFile.c_str());
-    String script_name = Path::RemoveExtension(filename);
-
-    script_pp = pp.Preprocess(script_input,script_name);
-    if ((script_pp == nullptr) || (cc_has_error()))
+    for(size_t i = 0; i < modules.size(); ++i)
     {
-        const auto &error = cc_get_error();
-        std::cerr << "Error: preprocessor failed at " << script_name.GetCStr() <<
-            ", line " << error.Line << " : " << error.ErrorString.GetCStr() << std::endl;
-        return -1;
+        // each script continues from the macros defined by the headers
+        AGS::Preprocessor::Preprocessor module_pp = pp;
+        ScriptModule &module = modules[i];
+        module.Text = module_pp.Preprocess(module.Text, module.Name);
+        if ((module.Text == nullptr) || (cc_has_error()))
+        {
+            const auto &error = cc_get_error();
+            std::cerr << "Error: preprocessor failed at " << module.Name.GetCStr() <<
+                ", line " << error.Line << " : " << error.ErrorString.GetCStr() << std::endl;
+            return -1;
+        }
+
+        if(comp_opts.PreprocessOnly)
+        {
+            std::unique_ptr<Stream> out (File::CreateFile(comp_opts.OutputObjFiles[i].c_str()));
+            if (!out || !(out->CanWrite())) {
+                std::cerr << "Error: failed to open for writing: " << comp_opts.OutputObjFiles[i] << std::endl;
+                return -1;
+            }
+            module.Text.Write(out.get());
+        }
     }
 
     if(comp_opts.PreprocessOnly)
-    {
-        std::unique_ptr<Stream> out (File::CreateFile(comp_opts.OutputObjFile.c_str()));
-        if (!out || !(out->CanWrite())) {
-            std::cerr << "Error: failed to open for writing: " << comp_opts.OutputObjFile << std::endl;
-            return -1;
-        }
-        script_pp.Write(out.get());
         return 0;
-    }
 
     //-----------------------------------------------------------------------//
-    // Compile script
+    // Compile headers, once for all the scripts
     //-----------------------------------------------------------------------//
-    ccScript* script = ccCompileText(script_pp.GetCStr(), script_name.GetCStr());
-    if ((script == nullptr) || (cc_has_error()))
+    PCompiledHeaders headers = ccCompileDefaultHeaders();
+    if (!headers)
     {
         const auto &error = cc_get_error();
         std::cerr << "Error: compile failed at " << ccCurScriptName << ", line " << error.Line << " : " << error.ErrorString.GetCStr() << std::endl;
@@ -284,17 +358,44 @@ int Compile(const CompilerOptions& comp_opts)
     }
 
     //-----------------------------------------------------------------------//
-    // Write script object
+    // Compile scripts and write script objects
     //-----------------------------------------------------------------------//
-    if(!comp_opts.OutputObjFile.empty())
+    int jobs = comp_opts.Jobs > 0 ? comp_opts.Jobs : static_cast<int>(std::thread::hardware_concurrency());
+#if !defined(AGS_CC_MULTITHREADED)
+    jobs = 1; // the compiler's state is shared, scripts must be compiled one by one
+#endif
+    jobs = std::max(1, std::min(jobs, static_cast<int>(modules.size())));
+
+    // the scripts are independent, so each worker takes the next one in turn
+    std::atomic<size_t> next_module(0);
+    auto compile_modules = [&]()
     {
-        std::unique_ptr<Stream> out (File::CreateFile(comp_opts.OutputObjFile.c_str()));
-        if (!out || !(out->CanWrite())) {
-            std::cerr << "Error: failed to open for writing: " << comp_opts.OutputObjFile << std::endl;
-            return -1;
-        }
-        script->Write(out.get());
+        for (size_t i = next_module++; i < modules.size(); i = next_module++)
+            CompileModule(headers.get(), modules[i], comp_opts.OutputObjFiles[i]);
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < jobs; ++i)
+        workers.emplace_back(compile_modules);
+    compile_modules();
+    for (auto &worker : workers)
+        worker.join();
+
+    if(!comp_opts.CacheDir.empty())
+    {
+        int hits, misses;
+        ccGetCompileCacheStats(&hits, &misses);
+        printf("\nCompile cache: %d hit(s), %d miss(es)\n", hits, misses);
     }
 
-    return 0;
-}
\ No newline at end of file
+    // report in the order of the scripts, regardless of which finished first
+    int result = 0;
+    for (const auto &module : modules)
+    {
+        if (!module.Error.empty())
+        {
+            std::cerr << module.Error << std::endl;
+            result = -1;
+        }
+    }
+    return result;
+}
@@ -38,6 +38,7 @@ class CompilerOptions{
         bool EnforceNewStrings = true;        // do not allow old-style strings
         bool EnforceNewAudio = true;
         bool UseOldCustomDialogOptionsAPI = false;
+        bool Optimize = true;                 // optimize the compiled byte-code
     };
 
     struct ScriptAPI {
@@ -52,8 +53,11 @@ public:
     bool DebugMode = false; // build for debug
     std::vector<std::pair<std::string, std::string>> Macros{};
     std::vector<std::string> HeaderFiles{};
-    std::string InputScriptFile{};
-    std::string OutputObjFile{};
+    // script modules, each is compiled with the same headers and options
+    std::vector<std::string> InputScriptFiles{};
+    std::vector<std::string> OutputObjFiles{};
+    int Jobs = 0; // number of modules compiled at once, 0 for the number of CPU cores
+    std::string CacheDir{}; // directory for keeping compiled modules between builds
     std::string Version{};
     CompilerOptions() = default;
     ~CompilerOptions() = default;
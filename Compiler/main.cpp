@@ -5,13 +5,14 @@
 #include <map>
 #include "util/path.h"
 #include "util/cmdlineopts.h"
+#include "util/string_utils.h"
 #include "compiler.h"
 #include "core/def_version.h"
 
 using namespace AGS::Common;
 using namespace AGS::Common::CmdLineOpts;
 
-const char *HELP_STRING = R"EOS(Usage: agscc [options] <INPUT.asc>
+const char *HELP_STRING = R"EOS(Usage: agscc [options] <INPUT.asc> [<INPUT2.asc>...]
 -A <version>                 Script API Version               (default:Highest)
 -C <version>                 Script API Compatibility version (default:Highest)
 -H, --Headers <H1>[:<H2>...] Header Files in order  (; as separator in cmd.exe)
@@ -28,10 +29,15 @@ const char *HELP_STRING = R"EOS(Usage: agscc [options] <INPUT.asc>
 -fforcenewstrings[=0]        Enforce new strings                    (default:1)
 -fforcenewaudio[=0]          Enforce new audio system               (default:1)
 -foldcustomdialogopt[=0]     Use old custom dialog API
+-foptimize[=0]               Optimize the compiled byte-code        (default:1)
 -g                           Generate debug information
+-j <N>                       Compile up to N scripts at once  (default:CPU cores)
 --tell-api-versions          Returns supported Script API Versions
 -o <OUT.o>, --output <OUT.o> Place output in specified file.  (default:INPUT.o)
+                             (only with a single input script)
 --override-version <VERSION> Overrides editor version
+--cache-dir <DIR>            Reuse the scripts compiled in DIR by previous
+                             builds, and save the new ones there
 -h, --help                   Print this usage message
 )EOS";
 
@@ -156,7 +162,23 @@ ParsedOptions parser_to_compiler_opts(const ParseResult& parseResult)
 
         if(opt_with_value.first == "-o" || opt_with_value.first == "--output")
         {
-            compilerOptions.OutputObjFile = opt_with_value.second.GetCStr();
+            compilerOptions.OutputObjFiles.push_back(opt_with_value.second.GetCStr());
+            continue;
+        }
+
+        if(opt_with_value.first == "-j")
+        {
+            compilerOptions.Jobs = StrUtil::StringToInt(opt_with_value.second, -1);
+            if(compilerOptions.Jobs < 1) {
+                std::cerr << "Error: invalid number of jobs " << opt_with_value.second.GetCStr() << std::endl;
+                return ParsedOptions(-1);
+            }
+            continue;
+        }
+
+        if(opt_with_value.first == "--cache-dir")
+        {
+            compilerOptions.CacheDir = opt_with_value.second.GetCStr();
             continue;
         }
 
@@ -223,15 +245,31 @@ ParsedOptions parser_to_compiler_opts(const ParseResult& parseResult)
                 compilerOptions.Flags.UseOldCustomDialogOptionsAPI = flag_value;
                 continue;
             }
+            if(flag_name == "optimize") {
+                compilerOptions.Flags.Optimize = flag_value;
+                continue;
+            }
         }
     }
 
-    compilerOptions.InputScriptFile = parseResult.PosArgs[0].GetCStr();
+    for(const auto& pos_arg : parseResult.PosArgs)
+    {
+        compilerOptions.InputScriptFiles.push_back(pos_arg.GetCStr());
+    }
 
-    if(compilerOptions.OutputObjFile.empty()) {
+    if(compilerOptions.OutputObjFiles.size() > 1 ||
+        (!compilerOptions.OutputObjFiles.empty() && compilerOptions.InputScriptFiles.size() > 1)) {
+        std::cerr << "Error: output file may only be set for a single input script" << std::endl;
+        return ParsedOptions(-1);
+    }
+
+    if(compilerOptions.OutputObjFiles.empty()) {
         // no output file explicitly set, let's use input.o instead
-        std::string filename = Path::RemoveExtension(compilerOptions.InputScriptFile.c_str()).GetCStr();
-        compilerOptions.OutputObjFile = filename + ".o";
+        for(const auto& input : compilerOptions.InputScriptFiles)
+        {
+            std::string filename = Path::RemoveExtension(input.c_str()).GetCStr();
+            compilerOptions.OutputObjFiles.push_back(filename + ".o");
+        }
     }
 
     if(compilerOptions.Version.empty()) {
@@ -252,7 +290,7 @@ Copyright (c) 2021 AGS Team and contributors
 )EOS"
     );
 
-    ParseResult parseResult = Parse(argc,argv,{"-D", "-H", "--Headers", "-A", "-C", "-f"});
+    ParseResult parseResult = Parse(argc,argv,{"-D", "-H", "--Headers", "-A", "-C", "-f", "-j", "-o", "--output", "--override-version", "--cache-dir"});
     ParsedOptions parsedOptions = parser_to_compiler_opts(parseResult);
 
     if(parsedOptions.Exit) return parsedOptions.ErrorCode;
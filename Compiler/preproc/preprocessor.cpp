@@ -9,8 +9,6 @@
 
 using namespace AGS::Common;
 
-extern int currentline; // in script/script_common
-
 namespace AGS {
 namespace Preprocessor {
 
@@ -0,0 +1,141 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "script/cc_compilecache.h"
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include "core/platform.h"
+#if AGS_PLATFORM_OS_WINDOWS
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#include "script/cc_common.h"
+#include "script/cc_internal.h"
+#include "script/cs_compiler.h"
+#include "util/file.h"
+#include "util/stream.h"
+
+using namespace AGS::Common;
+
+// Changes whenever the cached data may no longer be valid for the same input
+const int32_t CompileCacheVersion = 1;
+
+static std::string cacheDir;
+static std::atomic<int> cacheHits(0);
+static std::atomic<int> cacheMisses(0);
+
+ccCacheHash::ccCacheHash() {
+    value = 14695981039346656037ULL;
+}
+
+void ccCacheHash::add(const void *data, size_t len) {
+    const uint8_t *bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < len; ++i) {
+        value ^= bytes[i];
+        value *= 1099511628211ULL;
+    }
+}
+
+void ccCacheHash::add(const char *str) {
+    if (str == NULL)
+        str = "";
+    add(str, strlen(str) + 1);
+}
+
+void ccCacheHash::add(int32_t val) {
+    // hash the fixed byte order, so that the keys are same on any system
+    uint8_t bytes[4] = { (uint8_t)val, (uint8_t)(val >> 8), (uint8_t)(val >> 16), (uint8_t)(val >> 24) };
+    add(bytes, sizeof(bytes));
+}
+
+void ccSetCompileCacheDir(const char *dir) {
+    cacheDir = dir ? dir : "";
+}
+
+void ccGetCompileCacheStats(int *hits, int *misses) {
+    *hits = cacheHits;
+    *misses = cacheMisses;
+}
+
+void ccResetCompileCacheStats() {
+    cacheHits = 0;
+    cacheMisses = 0;
+}
+
+bool cc_cache_enabled() {
+    return !cacheDir.empty();
+}
+
+uint64_t cc_cache_key(uint64_t headersHash, const char *script, const char *scriptName) {
+    ccCacheHash hash;
+    hash.add(CompileCacheVersion);
+    hash.add(SCOM_VERSION);
+    hash.add(ccSoftwareVersion);
+    for (int bit = 0; bit < 32; bit++)
+        hash.add(ccGetOption(1 << bit));
+    hash.add(&headersHash, sizeof(headersHash));
+    hash.add(scriptName);
+    hash.add(script);
+    return hash.value;
+}
+
+static std::string get_cache_filename(uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.o", (unsigned long long)key);
+    return cacheDir + "/" + name;
+}
+
+ccScript *cc_cache_load(uint64_t key) {
+    ccScript *script = NULL;
+    std::unique_ptr<Stream> in(File::OpenFileRead(get_cache_filename(key).c_str()));
+    if (in) {
+        script = ccScript::CreateFromStream(in.get());
+        // a damaged file is just a miss, and will be replaced
+        if (!script)
+            cc_clear_error();
+    }
+
+    if (script)
+        cacheHits++;
+    else
+        cacheMisses++;
+    return script;
+}
+
+void cc_cache_store(uint64_t key, ccScript *script) {
+    // write the temporary file first, so that the other builds never see
+    // an incomplete one under the final name; the temporary name is unique
+    // for each process and thread, as several builds may share the cache
+#if AGS_PLATFORM_OS_WINDOWS
+    const int pid = _getpid();
+#else
+    const int pid = static_cast<int>(getpid());
+#endif
+    const std::string filename = get_cache_filename(key);
+    const std::string tempname = filename + ".tmp" + std::to_string(pid) + "_" +
+        std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    {
+        std::unique_ptr<Stream> out(File::CreateFile(tempname.c_str()));
+        if (!out)
+            return; // cache is optional, failing to write it is not an error
+        script->Write(out.get());
+    }
+    if (!File::RenameFile(tempname.c_str(), filename.c_str()))
+        File::DeleteFile(tempname.c_str());
+}
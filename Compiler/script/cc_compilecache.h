@@ -0,0 +1,54 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Persistent cache of the compiled scripts.
+//
+// Each compiled script is saved in the cache directory under the name made
+// of a hash of everything that the result depends on: the script's text and
+// name, the headers' texts and names, the compiler options and version.
+// Macros are not hashed separately, because the scripts are passed to the
+// compiler already preprocessed, so their effect is in the text.
+// Should be used only internally by cs_compiler.cpp.
+//
+//=============================================================================
+#ifndef __CC_COMPILECACHE_H
+#define __CC_COMPILECACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "script/cc_script.h"
+
+// 64-bit FNV-1a hash, for making the cache keys
+struct ccCacheHash {
+    uint64_t value;
+
+    ccCacheHash();
+    void add(const void *data, size_t len);
+    // adds the string along with its terminator, so that the neighbouring
+    // strings could not be mixed up
+    void add(const char *str);
+    void add(int32_t val);
+};
+
+// Tells if the cache directory is set
+extern bool cc_cache_enabled();
+// Makes the script's key, from the hash of the headers, the compiler's
+// options and version, and the script's own name and text
+extern uint64_t cc_cache_key(uint64_t headersHash, const char *script, const char *scriptName);
+// Loads the compiled script from the cache; returns NULL if there's none
+extern ccScript *cc_cache_load(uint64_t key);
+// Saves the compiled script in the cache
+extern void cc_cache_store(uint64_t key, ccScript *script);
+
+#endif // __CC_COMPILECACHE_H
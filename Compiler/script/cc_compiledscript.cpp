@@ -42,6 +42,23 @@ ccCompiledScript::ccCompiledScript() {
     ax_val_type = 0;
     ax_val_scope = 0;
 }
+ccCompiledScript::ccCompiledScript(const ccCompiledScript &src)
+    : ccScript(src) {
+    // the base copy allocates only as much code as there is
+    codeallocated = codesize;
+    numfunctions = src.numfunctions;
+    memset(functions, 0, sizeof(functions));
+    for (int aa = 0; aa < numfunctions; aa++) {
+        functions[aa] = (char*)malloc(strlen(src.functions[aa])+20);
+        strcpy(functions[aa], src.functions[aa]);
+    }
+    memcpy(funccodeoffs, src.funccodeoffs, sizeof(funccodeoffs));
+    memcpy(funcnumparams, src.funcnumparams, sizeof(funcnumparams));
+    cur_sp = src.cur_sp;
+    next_line = src.next_line;
+    ax_val_type = src.ax_val_type;
+    ax_val_scope = src.ax_val_scope;
+}
 ccCompiledScript::~ccCompiledScript() {
     shutdown();
 }
@@ -43,6 +43,8 @@ struct ccCompiledScript: public ccScript {
     void pop_reg(int regg);
 
     ccCompiledScript();
+    // makes a full copy, which may be continued to compile independently
+    ccCompiledScript(const ccCompiledScript &src);
     virtual ~ccCompiledScript();
 };
 
@@ -0,0 +1,847 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "script/cc_optimizer.h"
+#include <limits.h>
+#include <vector>
+#include "script/cc_internal.h"
+
+namespace
+{
+
+// Number of arguments of each of the script commands
+const int8_t CommandArgCount[CC_NUM_SCCMDS] =
+{
+    0, 2, 2, 2, 2, 0, 2, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1,
+    2, 2, 1, 2, 2, 1, 2, 1, 1, 0, 1, 1, 0, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 1, 1, 2, 2, 1, 0, 0, 1, 1, 3, 2
+};
+
+const uint32_t AllRegisters = ((1u << CC_NUM_REGISTERS) - 1) & ~1u;
+// Max number of instructions looked through when pairing push and pop
+const size_t MaxPushPopDistance = 16;
+// Max number of jumps followed when threading a jump
+const int MaxJumpThreading = 8;
+// Max number of times all the passes are repeated
+const int MaxPasses = 8;
+
+inline uint32_t RegBit(int32_t reg) { return 1u << reg; }
+
+inline bool IsRegister(int32_t reg) { return reg > 0 && reg < CC_NUM_REGISTERS; }
+
+inline bool IsJump(int32_t cmd) { return cmd == SCMD_JMP || cmd == SCMD_JZ || cmd == SCMD_JNZ; }
+
+// Tells if this is an integer operation over two registers
+inline bool IsRegOperation(int32_t cmd)
+{
+    return (cmd >= SCMD_MULREG && cmd <= SCMD_OR) ||
+        cmd == SCMD_MODREG || cmd == SCMD_XORREG || cmd == SCMD_SHIFTLEFT || cmd == SCMD_SHIFTRIGHT;
+}
+
+struct Instruction
+{
+    // Offset of the instruction in the original code
+    int32_t Offset = 0;
+    int32_t Code = 0;
+    int     ArgCount = 0;
+    int32_t Args[MAX_SCMD_ARGS] = {};
+    // Fixup type of each argument, or -1 if there's none
+    int     ArgFixup[MAX_SCMD_ARGS] = { -1, -1, -1 };
+    // Index of the argument which holds a code offset: relative for the
+    // jumps, absolute for the function addresses and bases; or -1
+    int     TargetArg = -1;
+    // Index of the instruction referenced by the code offset
+    size_t  Target = 0;
+    bool    Removed = false;
+
+    bool HasFixups() const
+    {
+        return ArgFixup[0] >= 0 || ArgFixup[1] >= 0 || ArgFixup[2] >= 0;
+    }
+
+    void SetLitToReg(int32_t reg, int32_t value)
+    {
+        Code = SCMD_LITTOREG;
+        ArgCount = 2;
+        Args[0] = reg;
+        Args[1] = value;
+    }
+
+    void SetRegToReg(int32_t reg1, int32_t reg2)
+    {
+        Code = SCMD_REGTOREG;
+        ArgCount = 2;
+        Args[0] = reg1;
+        Args[1] = reg2;
+    }
+};
+
+// Registers used by the instruction
+struct RegEffect
+{
+    // Whether the effect of the instruction is known; if not, it must be
+    // assumed that the instruction reads and changes all the registers
+    bool     Known = false;
+    // Whether the instruction does nothing except writing the registers,
+    // and so may be removed if the written values are never used
+    bool     Pure = false;
+    uint32_t Reads = 0u;
+    uint32_t Writes = 0u;
+};
+
+RegEffect GetRegEffect(const Instruction &ins)
+{
+    RegEffect eff;
+    const int32_t reg1 = ins.Args[0];
+    const int32_t reg2 = ins.Args[1];
+    switch (ins.Code)
+    {
+    case SCMD_LITTOREG:
+        if (!IsRegister(reg1))
+            return eff;
+        eff.Writes = RegBit(reg1);
+        eff.Pure = true;
+        break;
+    case SCMD_REGTOREG:
+        if (!IsRegister(reg1) || !IsRegister(reg2))
+            return eff;
+        eff.Reads = RegBit(reg1);
+        eff.Writes = RegBit(reg2);
+        eff.Pure = true;
+        break;
+    case SCMD_MULREG: case SCMD_ADDREG: case SCMD_SUBREG:
+    case SCMD_BITAND: case SCMD_BITOR: case SCMD_XORREG:
+    case SCMD_ISEQUAL: case SCMD_NOTEQUAL: case SCMD_GREATER: case SCMD_LESSTHAN:
+    case SCMD_GTE: case SCMD_LTE: case SCMD_AND: case SCMD_OR:
+    case SCMD_SHIFTLEFT: case SCMD_SHIFTRIGHT:
+    case SCMD_FMULREG: case SCMD_FADDREG: case SCMD_FSUBREG:
+    case SCMD_FGREATER: case SCMD_FLESSTHAN: case SCMD_FGTE: case SCMD_FLTE:
+        if (!IsRegister(reg1) || !IsRegister(reg2))
+            return eff;
+        eff.Reads = RegBit(reg1) | RegBit(reg2);
+        eff.Writes = RegBit(reg1);
+        eff.Pure = true;
+        break;
+    case SCMD_DIVREG: case SCMD_MODREG: case SCMD_FDIVREG:
+        // these may fail with "divide by zero"
+        if (!IsRegister(reg1) || !IsRegister(reg2))
+            return eff;
+        eff.Reads = RegBit(reg1) | RegBit(reg2);
+        eff.Writes = RegBit(reg1);
+        break;
+    case SCMD_ADD: case SCMD_MUL: case SCMD_FADD: case SCMD_FSUB: case SCMD_NOTREG:
+        if (!IsRegister(reg1))
+            return eff;
+        eff.Reads = eff.Writes = RegBit(reg1);
+        eff.Pure = reg1 != SREG_SP; // ADD on SP allocates the stack
+        break;
+    case SCMD_SUB: case SCMD_CREATESTRING: case SCMD_NEWARRAY:
+        // SUB frees the stack or gets a stack offset, depending on the register
+        if (!IsRegister(reg1))
+            return eff;
+        eff.Reads = eff.Writes = RegBit(reg1);
+        break;
+    case SCMD_NEWUSEROBJECT:
+        if (!IsRegister(reg1))
+            return eff;
+        eff.Writes = RegBit(reg1);
+        break;
+    case SCMD_MEMREAD: case SCMD_MEMREADB: case SCMD_MEMREADW: case SCMD_MEMREADPTR:
+        if (!IsRegister(reg1))
+            return eff;
+        eff.Reads = RegBit(SREG_MAR);
+        eff.Writes = RegBit(reg1);
+        break;
+    case SCMD_MEMWRITE: case SCMD_MEMWRITEB: case SCMD_MEMWRITEW:
+    case SCMD_MEMWRITEPTR: case SCMD_MEMINITPTR:
+        if (!IsRegister(reg1))
+            return eff;
+        eff.Reads = RegBit(reg1) | RegBit(SREG_MAR);
+        break;
+    case SCMD_WRITELIT: case SCMD_ZEROMEMORY: case SCMD_MEMZEROPTR: case SCMD_CHECKNULL:
+        eff.Reads = RegBit(SREG_MAR);
+        break;
+    case SCMD_MEMZEROPTRND:
+        eff.Reads = RegBit(SREG_MAR) | RegBit(SREG_AX);
+        break;
+    case SCMD_LOADSPOFFS:
+        eff.Reads = RegBit(SREG_SP);
+        eff.Writes = RegBit(SREG_MAR);
+        break;
+    case SCMD_PUSHREG:
+        if (!IsRegister(reg1))
+            return eff;
+        eff.Reads = RegBit(reg1) | RegBit(SREG_SP);
+        eff.Writes = RegBit(SREG_SP);
+        break;
+    case SCMD_POPREG:
+        if (!IsRegister(reg1))
+            return eff;
+        eff.Reads = RegBit(SREG_SP);
+        eff.Writes = RegBit(reg1) | RegBit(SREG_SP);
+        break;
+    case SCMD_CHECKBOUNDS: case SCMD_CHECKNULLREG:
+        if (!IsRegister(reg1))
+            return eff;
+        eff.Reads = RegBit(reg1);
+        break;
+    case SCMD_LINENUM: case SCMD_THISBASE: case SCMD_LOOPCHECKOFF: case SCMD_NUMFUNCARGS:
+        break;
+    default:
+        // jumps, calls, returns and the rest
+        return eff;
+    }
+    eff.Known = true;
+    if (eff.Writes & RegBit(SREG_SP))
+        eff.Pure = false;
+    return eff;
+}
+
+// Calculates the result of the integer operation over two known values,
+// the same way as the engine does; returns false if it cannot be done
+// at compile time
+bool FoldOperation(int32_t cmd, int32_t val1, int32_t val2, int32_t &result)
+{
+    const uint32_t u1 = static_cast<uint32_t>(val1);
+    const uint32_t u2 = static_cast<uint32_t>(val2);
+    switch (cmd)
+    {
+    case SCMD_ADD: case SCMD_ADDREG: result = static_cast<int32_t>(u1 + u2); return true;
+    case SCMD_SUB: case SCMD_SUBREG: result = static_cast<int32_t>(u1 - u2); return true;
+    case SCMD_MUL: case SCMD_MULREG: result = static_cast<int32_t>(u1 * u2); return true;
+    case SCMD_DIVREG: case SCMD_MODREG:
+        // leave the errors to be reported at runtime
+        if (val2 == 0 || (val1 == INT32_MIN && val2 == -1))
+            return false;
+        result = (cmd == SCMD_DIVREG) ? (val1 / val2) : (val1 % val2);
+        return true;
+    case SCMD_BITAND: result = val1 & val2; return true;
+    case SCMD_BITOR: result = val1 | val2; return true;
+    case SCMD_XORREG: result = val1 ^ val2; return true;
+    case SCMD_SHIFTLEFT: case SCMD_SHIFTRIGHT:
+        if (val2 < 0 || val2 >= 32)
+            return false;
+        result = (cmd == SCMD_SHIFTLEFT) ? static_cast<int32_t>(u1 << val2) : (val1 >> val2);
+        return true;
+    case SCMD_ISEQUAL: result = val1 == val2; return true;
+    case SCMD_NOTEQUAL: result = val1 != val2; return true;
+    case SCMD_GREATER: result = val1 > val2; return true;
+    case SCMD_LESSTHAN: result = val1 < val2; return true;
+    case SCMD_GTE: result = val1 >= val2; return true;
+    case SCMD_LTE: result = val1 <= val2; return true;
+    case SCMD_AND: result = val1 && val2; return true;
+    case SCMD_OR: result = val1 || val2; return true;
+    default: return false;
+    }
+}
+
+// Register values, tracked within a basic block
+struct RegisterValues
+{
+    // Registers with the same value number hold the same value
+    uint32_t Number[CC_NUM_REGISTERS];
+    // Whether the register holds a known integer, set from a literal
+    bool     Known[CC_NUM_REGISTERS];
+    int32_t  Value[CC_NUM_REGISTERS];
+    uint32_t NextNumber = 0u;
+
+    void Reset()
+    {
+        for (int32_t reg = 0; reg < CC_NUM_REGISTERS; ++reg)
+            Forget(reg);
+    }
+
+    void Forget(int32_t reg)
+    {
+        Number[reg] = NextNumber++;
+        Known[reg] = false;
+    }
+
+    void ForgetAll(uint32_t regs)
+    {
+        for (int32_t reg = 0; reg < CC_NUM_REGISTERS; ++reg)
+            if (regs & RegBit(reg))
+                Forget(reg);
+    }
+
+    void SetKnown(int32_t reg, int32_t value)
+    {
+        Forget(reg);
+        Known[reg] = true;
+        Value[reg] = value;
+    }
+
+    void Copy(int32_t from, int32_t to)
+    {
+        Number[to] = Number[from];
+        Known[to] = Known[from];
+        Value[to] = Value[from];
+    }
+
+    bool Same(int32_t reg1, int32_t reg2) const
+    {
+        return (Number[reg1] == Number[reg2]) ||
+            (Known[reg1] && Known[reg2] && Value[reg1] == Value[reg2]);
+    }
+};
+
+class ScriptOptimizer
+{
+public:
+    ScriptOptimizer(ccCompiledScript *scrip) : _scrip(scrip) {}
+
+    // Reads the script's code; returns false if it is not valid
+    bool Decode();
+    // Runs all the passes until there's nothing else to change
+    void Optimize();
+    // Writes the code back to the script; returns the new code size
+    int32_t Encode();
+
+private:
+    // Fixup from the script's list, either in the code or in the global data
+    struct Fixup
+    {
+        char    Type;
+        size_t  Instr; // instruction index, for the code fixups
+        int     Arg;
+        int32_t DataOffset; // for the global data fixups
+    };
+
+    // Returns index of the first instruction which is not removed,
+    // starting with the given one
+    size_t NextLive(size_t index) const
+    {
+        for (; index < _code.size() && _code[index].Removed; ++index);
+        return index;
+    }
+    // Finds instruction index by the code offset; returns false if
+    // the offset is not the start of an instruction
+    bool OffsetToIndex(int32_t offset, size_t &index) const;
+    // Marks instructions which may be reached other than from the previous one
+    void FindLabels();
+
+    // Removes the code after jumps and returns, which is never jumped to
+    bool RemoveUnreachable();
+    // Redirects jumps to jumps to the final destination, and removes jumps
+    // to the next instruction
+    bool ThreadJumps();
+    // Tracks the known register values within each basic block: folds the
+    // constants, removes moves of the values which are already in place,
+    // and resolves conditional jumps over the known values
+    bool PropagateValues();
+    // Replaces a push followed by a pop with a register move
+    bool CombinePushPop();
+    // Removes instructions which write values that are never read
+    bool RemoveDeadStores();
+    // Removes line numbers which are immediately overridden or repeated
+    bool RemoveLineNumbers();
+
+    ccCompiledScript *_scrip;
+    std::vector<Instruction> _code;
+    // Instruction index at each code offset, or -1 if it is not an instruction start
+    std::vector<int32_t> _offsetIndex;
+    std::vector<Fixup> _fixups;
+    // Instructions which may be called from outside or via function address
+    std::vector<size_t> _entries;
+    std::vector<bool> _labels;
+};
+
+bool ScriptOptimizer::OffsetToIndex(int32_t offset, size_t &index) const
+{
+    if (offset < 0 || offset > _scrip->codesize || _offsetIndex[offset] < 0)
+        return false;
+    index = static_cast<size_t>(_offsetIndex[offset]);
+    return true;
+}
+
+
+bool ScriptOptimizer::Decode()
+{
+    const int32_t codesize = _scrip->codesize;
+    _offsetIndex.assign(codesize + 1, -1);
+    for (int32_t pos = 0; pos < codesize;)
+    {
+        Instruction ins;
+        ins.Offset = pos;
+        ins.Code = _scrip->code[pos];
+        if (ins.Code <= 0 || ins.Code >= CC_NUM_SCCMDS)
+            return false;
+        ins.ArgCount = CommandArgCount[ins.Code];
+        if (pos + ins.ArgCount >= codesize)
+            return false;
+        for (int i = 0; i < ins.ArgCount; ++i)
+            ins.Args[i] = _scrip->code[pos + 1 + i];
+        _offsetIndex[pos] = static_cast<int32_t>(_code.size());
+        _code.push_back(ins);
+        pos += 1 + ins.ArgCount;
+    }
+    _offsetIndex[codesize] = static_cast<int32_t>(_code.size());
+
+    for (int i = 0; i < _scrip->numfixups; ++i)
+    {
+        Fixup fixup = {};
+        fixup.Type = _scrip->fixuptypes[i];
+        if (fixup.Type == FIXUP_DATADATA)
+        {
+            fixup.DataOffset = _scrip->fixups[i];
+            _fixups.push_back(fixup);
+            continue;
+        }
+        // the code fixups must point to the instruction arguments
+        const int32_t pos = _scrip->fixups[i];
+        if (pos <= 0 || pos >= codesize || _offsetIndex[pos] >= 0)
+            return false;
+        int32_t start = pos;
+        for (; _offsetIndex[start] < 0; --start);
+        fixup.Instr = static_cast<size_t>(_offsetIndex[start]);
+        fixup.Arg = pos - start - 1;
+        Instruction &ins = _code[fixup.Instr];
+        if (ins.ArgFixup[fixup.Arg] >= 0)
+            return false;
+        ins.ArgFixup[fixup.Arg] = fixup.Type;
+        _fixups.push_back(fixup);
+    }
+
+    // Find all the code offsets, which must be remapped when the code changes
+    _entries.push_back(0);
+    for (size_t i = 0; i < _code.size(); ++i)
+    {
+        Instruction &ins = _code[i];
+        if (IsJump(ins.Code))
+        {
+            if (ins.HasFixups() || !OffsetToIndex(ins.Offset + 2 + ins.Args[0], ins.Target))
+                return false;
+            ins.TargetArg = 0;
+            continue;
+        }
+        if (ins.Code == SCMD_THISBASE)
+            ins.TargetArg = 0;
+        for (int arg = 0; arg < ins.ArgCount; ++arg)
+        {
+            if (ins.ArgFixup[arg] == FIXUP_FUNCTION)
+                ins.TargetArg = arg;
+        }
+        if (ins.TargetArg < 0)
+            continue;
+        if (!OffsetToIndex(ins.Args[ins.TargetArg], ins.Target))
+            return false;
+        _entries.push_back(ins.Target);
+    }
+    for (long i = 0; i < _scrip->numfunctions; ++i)
+    {
+        size_t index;
+        if (!OffsetToIndex(_scrip->funccodeoffs[i], index))
+            return false;
+        _entries.push_back(index);
+    }
+    for (int i = 0; i < _scrip->numexports; ++i)
+    {
+        size_t index;
+        if (((_scrip->export_addr[i] >> 24) & 0xFF) != EXPORT_FUNCTION)
+            continue;
+        if (!OffsetToIndex(_scrip->export_addr[i] & 0x00FFFFFF, index))
+            return false;
+        _entries.push_back(index);
+    }
+    for (int i = 0; i < _scrip->numSections; ++i)
+    {
+        size_t index;
+        if (!OffsetToIndex(_scrip->sectionOffsets[i], index))
+            return false;
+    }
+    return true;
+}
+
+void ScriptOptimizer::Optimize()
+{
+    for (int pass = 0; pass < MaxPasses; ++pass)
+    {
+        bool changed = RemoveUnreachable();
+        changed |= ThreadJumps();
+        changed |= PropagateValues();
+        changed |= CombinePushPop();
+        changed |= RemoveDeadStores();
+        changed |= RemoveLineNumbers();
+        if (!changed)
+            break;
+    }
+}
+
+int32_t ScriptOptimizer::Encode()
+{
+    // New offset of each instruction; the removed ones get the offset
+    // of the next instruction which is kept
+    std::vector<int32_t> new_offsets(_code.size() + 1);
+    int32_t codesize = 0;
+    for (size_t i = 0; i < _code.size(); ++i)
+    {
+        new_offsets[i] = codesize;
+        if (!_code[i].Removed)
+            codesize += 1 + _code[i].ArgCount;
+    }
+    new_offsets[_code.size()] = codesize;
+
+    int32_t *code = _scrip->code;
+    for (size_t i = 0; i < _code.size(); ++i)
+    {
+        const Instruction &ins = _code[i];
+        if (ins.Removed)
+            continue;
+        const int32_t pos = new_offsets[i];
+        code[pos] = ins.Code;
+        for (int arg = 0; arg < ins.ArgCount; ++arg)
+            code[pos + 1 + arg] = ins.Args[arg];
+        if (IsJump(ins.Code))
+            code[pos + 1] = new_offsets[ins.Target] - (pos + 2);
+        else if (ins.TargetArg >= 0)
+            code[pos + 1 + ins.TargetArg] = new_offsets[ins.Target];
+    }
+
+    int numfixups = 0;
+    for (size_t i = 0; i < _fixups.size(); ++i)
+    {
+        const Fixup &fixup = _fixups[i];
+        if (fixup.Type == FIXUP_DATADATA)
+        {
+            _scrip->fixups[numfixups] = fixup.DataOffset;
+        }
+        else
+        {
+            if (_code[fixup.Instr].Removed)
+                continue;
+            _scrip->fixups[numfixups] = new_offsets[fixup.Instr] + 1 + fixup.Arg;
+        }
+        _scrip->fixuptypes[numfixups] = fixup.Type;
+        numfixups++;
+    }
+    _scrip->numfixups = numfixups;
+
+    for (long i = 0; i < _scrip->numfunctions; ++i)
+        _scrip->funccodeoffs[i] = new_offsets[_offsetIndex[_scrip->funccodeoffs[i]]];
+    for (int i = 0; i < _scrip->numexports; ++i)
+    {
+        const int32_t addr = _scrip->export_addr[i];
+        if (((addr >> 24) & 0xFF) == EXPORT_FUNCTION)
+            _scrip->export_addr[i] = new_offsets[_offsetIndex[addr & 0x00FFFFFF]] | (addr & 0xFF000000);
+    }
+    for (int i = 0; i < _scrip->numSections; ++i)
+        _scrip->sectionOffsets[i] = new_offsets[_offsetIndex[_scrip->sectionOffsets[i]]];
+    _scrip->codesize = codesize;
+    return codesize;
+}
+
+void ScriptOptimizer::FindLabels()
+{
+    _labels.assign(_code.size() + 1, false);
+    for (size_t i = 0; i < _entries.size(); ++i)
+        _labels[NextLive(_entries[i])] = true;
+    for (size_t i = 0; i < _code.size(); ++i)
+    {
+        if (!_code[i].Removed && _code[i].TargetArg >= 0)
+            _labels[NextLive(_code[i].Target)] = true;
+    }
+}
+
+bool ScriptOptimizer::RemoveUnreachable()
+{
+    FindLabels();
+    bool changed = false;
+    bool reachable = true;
+    for (size_t i = 0; i < _code.size(); ++i)
+    {
+        Instruction &ins = _code[i];
+        if (ins.Removed)
+            continue;
+        if (_labels[i])
+            reachable = true;
+        if (!reachable)
+        {
+            ins.Removed = true;
+            changed = true;
+            continue;
+        }
+        if (ins.Code == SCMD_JMP || ins.Code == SCMD_RET)
+            reachable = false;
+    }
+    return changed;
+}
+
+bool ScriptOptimizer::ThreadJumps()
+{
+    bool changed = false;
+    for (size_t i = 0; i < _code.size(); ++i)
+    {
+        Instruction &ins = _code[i];
+        if (ins.Removed || !IsJump(ins.Code))
+            continue;
+        // The engine checks for a hung loop only on the backward JMP, so
+        // a forward conditional jump must not be threaded into a backward one,
+        // nor a backward JMP into a forward one
+        const bool backward = ins.Target <= i;
+        size_t target = ins.Target;
+        for (int jump = 0; jump < MaxJumpThreading; ++jump)
+        {
+            const size_t next = NextLive(target);
+            if (next >= _code.size() || next == i)
+                break;
+            const Instruction &dest = _code[next];
+            size_t new_target;
+            if (dest.Code == SCMD_JMP || dest.Code == ins.Code)
+                new_target = dest.Target; // taken under the same condition
+            else if (IsJump(dest.Code) && ins.Code != SCMD_JMP)
+                new_target = next + 1; // opposite condition, never taken
+            else
+                break;
+            if (ins.Code == SCMD_JMP ? (backward && new_target > i) : (!backward && new_target <= i))
+                break;
+            target = new_target;
+        }
+        if (target != ins.Target)
+        {
+            ins.Target = target;
+            changed = true;
+        }
+        // jump to the next instruction
+        if (NextLive(target) == NextLive(i + 1))
+        {
+            ins.Removed = true;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool ScriptOptimizer::PropagateValues()
+{
+    FindLabels();
+    bool changed = false;
+    RegisterValues regs;
+    regs.Reset();
+    for (size_t i = 0; i < _code.size(); ++i)
+    {
+        Instruction &ins = _code[i];
+        if (ins.Removed)
+            continue;
+        if (_labels[i])
+            regs.Reset();
+
+        const RegEffect eff = GetRegEffect(ins);
+        if (!eff.Known)
+        {
+            if (ins.Code == SCMD_JZ || ins.Code == SCMD_JNZ)
+            {
+                // conditional jumps don't change the registers
+                if (!regs.Known[SREG_AX])
+                    continue;
+                changed = true;
+                if ((regs.Value[SREG_AX] == 0) != (ins.Code == SCMD_JZ))
+                {
+                    ins.Removed = true; // never taken
+                    continue;
+                }
+                ins.Code = SCMD_JMP;
+            }
+            regs.Reset();
+            continue;
+        }
+
+        const int32_t reg1 = ins.Args[0];
+        const int32_t reg2 = ins.Args[1];
+        int32_t result;
+        if (ins.HasFixups())
+        {
+            regs.ForgetAll(eff.Writes);
+        }
+        else if (IsRegOperation(ins.Code) && regs.Known[reg1] && regs.Known[reg2] &&
+            FoldOperation(ins.Code, regs.Value[reg1], regs.Value[reg2], result))
+        {
+            ins.SetLitToReg(reg1, result);
+            regs.SetKnown(reg1, result);
+            changed = true;
+        }
+        else if (!eff.Pure)
+        {
+            regs.ForgetAll(eff.Writes);
+        }
+        else if (ins.Code == SCMD_LITTOREG)
+        {
+            if (regs.Known[reg1] && regs.Value[reg1] == ins.Args[1])
+            {
+                ins.Removed = true;
+                changed = true;
+                continue;
+            }
+            regs.SetKnown(reg1, ins.Args[1]);
+        }
+        else if (ins.Code == SCMD_REGTOREG)
+        {
+            if (regs.Same(reg1, reg2))
+            {
+                ins.Removed = true;
+                changed = true;
+                continue;
+            }
+            if (regs.Known[reg1])
+            {
+                // copying the literal lets to drop the first write if it's unused
+                ins.SetLitToReg(reg2, regs.Value[reg1]);
+                changed = true;
+            }
+            regs.Copy(reg1, reg2);
+        }
+        else if (ins.Code == SCMD_ADD && ins.Args[1] == 0)
+        {
+            ins.Removed = true;
+            changed = true;
+        }
+        else if ((ins.Code == SCMD_ADD || ins.Code == SCMD_MUL) && regs.Known[reg1] &&
+            FoldOperation(ins.Code, regs.Value[reg1], ins.Args[1], result))
+        {
+            ins.SetLitToReg(reg1, result);
+            regs.SetKnown(reg1, result);
+            changed = true;
+        }
+        else if (ins.Code == SCMD_NOTREG && regs.Known[reg1])
+        {
+            result = !regs.Value[reg1];
+            ins.SetLitToReg(reg1, result);
+            regs.SetKnown(reg1, result);
+            changed = true;
+        }
+        else
+        {
+            regs.ForgetAll(eff.Writes);
+        }
+    }
+    return changed;
+}
+
+bool ScriptOptimizer::CombinePushPop()
+{
+    FindLabels();
+    bool changed = false;
+    for (size_t i = 0; i < _code.size(); ++i)
+    {
+        Instruction &push = _code[i];
+        if (push.Removed || push.Code != SCMD_PUSHREG ||
+            !IsRegister(push.Args[0]) || push.Args[0] == SREG_SP)
+            continue;
+        // The instructions in between must not use the stack, nor the register
+        // which receives the value
+        uint32_t used = 0u;
+        size_t j = NextLive(i + 1);
+        for (size_t count = 0; j < _code.size() && count < MaxPushPopDistance; j = NextLive(j + 1), ++count)
+        {
+            if (_labels[j] || _code[j].Code == SCMD_POPREG)
+                break;
+            const RegEffect eff = GetRegEffect(_code[j]);
+            if (!eff.Known || ((eff.Reads | eff.Writes) & RegBit(SREG_SP)))
+                break;
+            used |= eff.Reads | eff.Writes;
+        }
+        if (j >= _code.size() || _labels[j] || _code[j].Code != SCMD_POPREG)
+            continue;
+        Instruction &pop = _code[j];
+        const int32_t reg = pop.Args[0];
+        if (!IsRegister(reg) || reg == SREG_SP || (used & RegBit(reg)))
+            continue;
+        if (reg == push.Args[0])
+            push.Removed = true;
+        else
+            push.SetRegToReg(push.Args[0], reg);
+        pop.Removed = true;
+        changed = true;
+    }
+    return changed;
+}
+
+bool ScriptOptimizer::RemoveDeadStores()
+{
+    bool changed = false;
+    // Registers which may be read later; everything is assumed to be read
+    // at the jumps, calls and the end of the code, while the return
+    // only passes the result and the stack back to the caller
+    uint32_t live = AllRegisters;
+    for (size_t i = _code.size(); i-- > 0;)
+    {
+        Instruction &ins = _code[i];
+        if (ins.Removed)
+            continue;
+        if (ins.Code == SCMD_RET)
+        {
+            live = RegBit(SREG_AX) | RegBit(SREG_SP);
+            continue;
+        }
+        const RegEffect eff = GetRegEffect(ins);
+        if (!eff.Known)
+        {
+            live = AllRegisters;
+            continue;
+        }
+        if (eff.Pure && eff.Writes && !(eff.Writes & live))
+        {
+            ins.Removed = true;
+            changed = true;
+            continue;
+        }
+        live = (live & ~eff.Writes) | eff.Reads;
+    }
+    return changed;
+}
+
+bool ScriptOptimizer::RemoveLineNumbers()
+{
+    FindLabels();
+    bool changed = false;
+    bool has_line = false;
+    int32_t line = 0;
+    for (size_t i = 0; i < _code.size(); ++i)
+    {
+        Instruction &ins = _code[i];
+        if (ins.Removed)
+            continue;
+        if (_labels[i])
+            has_line = false;
+        if (ins.Code != SCMD_LINENUM)
+        {
+            // the called functions change the current line too
+            if (!GetRegEffect(ins).Known)
+                has_line = false;
+            continue;
+        }
+        const size_t next = NextLive(i + 1);
+        if ((next < _code.size() && _code[next].Code == SCMD_LINENUM) ||
+            (has_line && ins.Args[0] == line))
+        {
+            ins.Removed = true;
+            changed = true;
+            continue;
+        }
+        has_line = true;
+        line = ins.Args[0];
+    }
+    return changed;
+}
+
+} // namespace
+
+int cc_optimize(ccCompiledScript *scrip)
+{
+    const int32_t old_codesize = scrip->codesize;
+    ScriptOptimizer optimizer(scrip);
+    if (!optimizer.Decode())
+        return -1;
+    optimizer.Optimize();
+    return old_codesize - optimizer.Encode();
+}
@@ -0,0 +1,34 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Byte-code optimizer, run over the complete compiled script.
+//
+// The parser writes the code as it goes and does not look back, so the
+// result has lots of push/pop pairs, literals copied between registers,
+// values computed and never used, jumps to jumps and the code which may
+// never be reached. The optimizer decodes the instructions, rewrites them
+// within the basic blocks and then encodes them back, remapping the jumps,
+// fixups, function offsets, exports and sections.
+//
+//=============================================================================
+#ifndef __CC_OPTIMIZER_H
+#define __CC_OPTIMIZER_H
+
+#include "cc_compiledscript.h"
+
+// Optimizes the script's code in place; returns the number of code elements
+// removed, or -1 if the code could not be analyzed and was left untouched
+extern int cc_optimize(ccCompiledScript *scrip);
+
+#endif // __CC_OPTIMIZER_H
@@ -2,6 +2,7 @@
 #define __CC_SYMBOLTABLE_H
 
 #include "cs_parser_common.h"   // macro definitions
+#include "script/cc_common.h"  // CC_THREADLOCAL
 #include "script/cc_treemap.h"
 
 #include <map>
@@ -65,7 +66,7 @@ struct symbolTable {
 
 private:
 
-    std::map<int, char *> nameGenCache;
+    std::map<int, std::string> nameGenCache;
 
     ccTreeMap symbolTree;
     std::vector<char *> symbolTreeNames;
@@ -75,6 +76,6 @@ private:
 };
 
 
-extern symbolTable sym;
+extern CC_THREADLOCAL symbolTable sym;
 
 #endif //__CC_SYMBOLTABLE_H
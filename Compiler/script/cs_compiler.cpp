@@ -9,9 +9,11 @@
 #include "script/cc_common.h"
 #include "script/cc_internal.h"
 #include "script/cs_parser.h"
+#include "script/cc_optimizer.h"
+#include "script/cc_compilecache.h"
 
 const char *ccSoftwareVersion = "1.0";
-const char *ccCurScriptName = "";
+CC_THREADLOCAL const char *ccCurScriptName = "";
 
 std::vector<const char*> defaultheaders;
 std::vector<const char*> defaultHeaderNames;
@@ -34,17 +36,25 @@ void ccSetSoftwareVersion(const char *versionNumber) {
     ccSoftwareVersion = versionNumber;
 }
 
-ccScript* ccCompileText(const char *texo, const char *scriptName) {
-    ccCompiledScript *cctemp = new ccCompiledScript();
-    cctemp->init();
-
-    sym.reset();
+struct ccCompiledHeaders {
+    ccCompiledScript script; // code and data of the headers
+    symbolTable symbols;     // symbols declared by the headers
+    uint64_t hash;           // hash of the headers, for the compile cache
+};
 
-    if (scriptName == NULL)
-        scriptName = "Main script";
-
-    cc_clear_error();
+// hashes the default headers' names and texts, for the compile cache
+static uint64_t hash_default_headers() {
+    ccCacheHash hash;
+    hash.add((int32_t)defaultheaders.size());
+    for (size_t t=0;t<defaultheaders.size();t++) {
+        hash.add(defaultHeaderNames[t]);
+        hash.add(defaultheaders[t]);
+    }
+    return hash.value;
+}
 
+// compiles the default headers into the script and the global symbol table
+static void compile_default_headers(ccCompiledScript *cctemp) {
     for (size_t t=0;t<defaultheaders.size();t++) {
         if (defaultHeaderNames[t])
             ccCurScriptName = defaultHeaderNames[t];
@@ -55,6 +65,12 @@ ccScript* ccCompileText(const char *texo, const char *scriptName) {
         cc_compile(defaultheaders[t],cctemp);
         if (cc_has_error()) break;
     }
+}
+
+// compiles the main script after the headers, and finalizes the result
+static ccScript* compile_main_script(ccCompiledScript *cctemp, const char *texo, const char *scriptName) {
+    if (scriptName == NULL)
+        scriptName = "Main script";
 
     if (!cc_has_error()) {
         ccCurScriptName = scriptName;
@@ -68,6 +84,9 @@ ccScript* ccCompileText(const char *texo, const char *scriptName) {
         return NULL;
     }
 
+    if (ccGetOption(SCOPT_OPTIMIZE))
+        cc_optimize(cctemp);
+
     for (size_t t=0; t<sym.entries.size();t++) {
         int stype = sym.get_type(t);
         // blank out the name for imports that are not used, to save space
@@ -114,3 +133,61 @@ ccScript* ccCompileText(const char *texo, const char *scriptName) {
     cctemp->free_extra();
     return cctemp;
 }
+
+ccScript* ccCompileText(const char *texo, const char *scriptName) {
+    cc_clear_error();
+    const bool useCache = cc_cache_enabled();
+    uint64_t cacheKey = 0;
+    if (useCache) {
+        cacheKey = cc_cache_key(hash_default_headers(), texo, scriptName);
+        ccScript *cached = cc_cache_load(cacheKey);
+        if (cached)
+            return cached;
+    }
+
+    ccCompiledScript *cctemp = new ccCompiledScript();
+    cctemp->init();
+
+    sym.reset();
+
+    compile_default_headers(cctemp);
+    ccScript *scrip = compile_main_script(cctemp, texo, scriptName);
+    if (scrip && useCache)
+        cc_cache_store(cacheKey, scrip);
+    return scrip;
+}
+
+PCompiledHeaders ccCompileDefaultHeaders() {
+    PCompiledHeaders headers(new ccCompiledHeaders());
+
+    sym.reset();
+    cc_clear_error();
+
+    compile_default_headers(&headers->script);
+    if (cc_has_error())
+        return nullptr;
+    headers->symbols = sym;
+    headers->hash = hash_default_headers();
+    return headers;
+}
+
+ccScript* ccCompileTextWithHeaders(const ccCompiledHeaders *headers, const char *texo, const char *scriptName) {
+    cc_clear_error();
+    const bool useCache = cc_cache_enabled();
+    uint64_t cacheKey = 0;
+    if (useCache) {
+        cacheKey = cc_cache_key(headers->hash, texo, scriptName);
+        ccScript *cached = cc_cache_load(cacheKey);
+        if (cached)
+            return cached;
+    }
+
+    // continue with the copies of the headers' state, as if they were just compiled
+    ccCompiledScript *cctemp = new ccCompiledScript(headers->script);
+    sym = headers->symbols;
+
+    ccScript *scrip = compile_main_script(cctemp, texo, scriptName);
+    if (scrip && useCache)
+        cc_cache_store(cacheKey, scrip);
+    return scrip;
+}
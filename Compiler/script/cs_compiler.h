@@ -13,6 +13,7 @@
 #ifndef __CS_COMPILER_H
 #define __CS_COMPILER_H
 
+#include <memory>
 #include "script/cc_script.h"  // ccScript
 
 // ********* SCRIPT COMPILATION FUNCTIONS **************
@@ -34,6 +35,26 @@ extern void ccSetSoftwareVersion(const char *version);
 // compile the script supplied, returns NULL on failure
 extern ccScript *ccCompileText(const char *script, const char *scriptName);
 
+// default headers compiled in advance, for reusing them with any number of scripts
+struct ccCompiledHeaders;
+typedef std::shared_ptr<ccCompiledHeaders> PCompiledHeaders;
+// compile the default headers alone, returns NULL on failure
+extern PCompiledHeaders ccCompileDefaultHeaders();
+// compile the script supplied on top of the precompiled headers, returns NULL
+// on failure; the result is the same as of ccCompileText with these headers.
+// If the compiler is built with AGS_CC_MULTITHREADED, this may be called for
+// different scripts from several threads at once.
+extern ccScript *ccCompileTextWithHeaders(const ccCompiledHeaders *headers, const char *script, const char *scriptName);
+
+// set the directory where the compiled scripts are kept between the builds;
+// a script compiled again with the same text, name, headers, options and
+// version is loaded from there (without printing any warnings).
+// Empty or NULL directory disables the cache.
+extern void ccSetCompileCacheDir(const char *dir);
+// get the number of scripts loaded from the cache and compiled anew
+extern void ccGetCompileCacheStats(int *hits, int *misses);
+extern void ccResetCompileCacheStats();
+
 extern const char *ccSoftwareVersion;
 
 #endif // __CS_COMPILER_H
\ No newline at end of file
@@ -15,10 +15,8 @@
 #include "fmem.h"
 #include "util/utf8.h"
 
-extern int currentline;
-
 char ccCopyright[]="ScriptCompiler32 v" SCOM_VERSIONSTR " (c) 2000-2007 Chris Jones and 2011-2023 others";
-static char scriptNameBuffer[256];
+static CC_THREADLOCAL char scriptNameBuffer[256];
 
 int  evaluate_expression(ccInternalList*,ccCompiledScript*,int,bool insideBracketedDeclaration);
 int  evaluate_assignment(ccInternalList *targ, ccCompiledScript *scrip, bool expectCloseBracket, int cursym, long lilen, long *vnlist, bool insideBracketedDeclaration);
@@ -70,8 +68,8 @@ void clear_chunk_list(std::vector<ccChunk> *list) {
 
 static int is_part_of_symbol(char thischar, char startchar) {
     // workaround for strings
-    static int sayno_next_char = 0;
-    static int next_is_escaped = 0;
+    static CC_THREADLOCAL int sayno_next_char = 0;
+    static CC_THREADLOCAL int next_is_escaped = 0;
     if (sayno_next_char) {
         sayno_next_char = 0;
         return 0;
@@ -135,10 +133,10 @@ static int is_part_of_symbol(char thischar, char startchar) {
 
 // NOTE: global buffers meant to store parsed lines and symbols;
 // most of these were local char arrays of fixed size, refactored into global std::string for convenience
-std::string constructedMemberName;
-std::string thissymbol;
-std::string thissymbol_mangled;
-std::string constructedFunctionName;
+CC_THREADLOCAL std::string constructedMemberName;
+CC_THREADLOCAL std::string thissymbol;
+CC_THREADLOCAL std::string thissymbol_mangled;
+CC_THREADLOCAL std::string constructedFunctionName;
 
 const char *get_member_full_name(int structSym, int memberSym) {
 
@@ -1636,7 +1634,7 @@ int extractPathIntoParts(VariableSymlist *variablePath, int slilen, long *syml)
   return variablePathSize;
 }
 
-int readcmd_lastcalledwith=0;
+CC_THREADLOCAL int readcmd_lastcalledwith=0;
 int get_readcmd_for_size(int sizz, int writeinstead) {
   int readcmd = SCMD_MEMREAD;
   if (writeinstead) {
@@ -2025,7 +2023,7 @@ int do_variable_memory_access(ccCompiledScript *scrip, int variableSym,
 
 // If the variable being read is actually a property, not a
 // member variable, then read_variable_into_ax sets this
-int readonly_cannot_cause_error = 0;
+CC_THREADLOCAL int readonly_cannot_cause_error = 0;
 
 int do_variable_ax(int slilen,long*syml,ccCompiledScript*scrip,int writing, int mustBeWritable, bool negateLiteral = false) {
   // read the various types of values into AX
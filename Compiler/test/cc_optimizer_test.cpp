@@ -0,0 +1,486 @@
+#include <memory>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "script/cc_common.h"
+#include "script/cc_internal.h"
+#include "script/cs_compiler.h"
+
+namespace
+{
+
+// Minimal interpreter of the compiled script, which supports the integer
+// operations, local and global variables, and calls within the same script;
+// used to check that the optimized code gives the same results
+class TestInterpreter
+{
+public:
+    struct Result
+    {
+        bool        Ok = false;
+        int32_t     Value = 0;
+        int32_t     Line = 0; // last line number seen
+        size_t      Steps = 0; // number of executed instructions
+        std::string Error;
+    };
+
+    explicit TestInterpreter(const ccScript *script)
+        : _script(script)
+        , _code(script->code, script->code + script->codesize)
+    {
+        _globals = 16; // keep the null address invalid
+        _stack = _globals + ((script->globaldatasize + 3) & ~3);
+        _mem.resize(_stack + StackSize);
+        memcpy(&_mem[_globals], script->globaldata, script->globaldatasize);
+        for (int i = 0; i < script->numfixups; ++i)
+        {
+            const int32_t pos = script->fixups[i];
+            switch (script->fixuptypes[i])
+            {
+            case FIXUP_GLOBALDATA: _code[pos] += _globals; break;
+            case FIXUP_FUNCTION: break;
+            case FIXUP_DATADATA:
+            {
+                int32_t value;
+                memcpy(&value, &_mem[_globals + pos], sizeof(value));
+                value += _globals;
+                memcpy(&_mem[_globals + pos], &value, sizeof(value));
+                break;
+            }
+            default: _unsupported = true; break;
+            }
+        }
+    }
+
+    Result Run(const char *func_name)
+    {
+        Result res;
+        int32_t entry = -1;
+        for (int i = 0; i < _script->numexports; ++i)
+        {
+            if (strcmp(_script->exports[i], func_name) == 0)
+                entry = _script->export_addr[i] & 0x00FFFFFF;
+        }
+        if (entry < 0 || _unsupported)
+        {
+            res.Error = "cannot run";
+            return res;
+        }
+
+        int32_t reg[CC_NUM_REGISTERS] = {};
+        reg[SREG_SP] = _stack;
+        if (!Write(reg[SREG_SP], 0, sizeof(int32_t), res))
+            return res;
+        reg[SREG_SP] += sizeof(int32_t);
+        int32_t pc = entry;
+        for (; res.Steps < MaxSteps; ++res.Steps)
+        {
+            if (pc < 0 || pc >= static_cast<int32_t>(_code.size()))
+                return Fail(res, "pc out of range");
+            const int32_t cmd = _code[pc];
+            const int argc = ArgCount(cmd);
+            if (argc < 0 || pc + argc >= static_cast<int32_t>(_code.size()))
+                return Fail(res, "unsupported instruction");
+            const int32_t arg1 = argc > 0 ? _code[pc + 1] : 0;
+            const int32_t arg2 = argc > 1 ? _code[pc + 2] : 0;
+            // registers are validated for all the commands which use them
+            if ((cmd != SCMD_WRITELIT && cmd != SCMD_JZ && cmd != SCMD_JNZ && cmd != SCMD_JMP &&
+                 cmd != SCMD_LINENUM && cmd != SCMD_THISBASE && cmd != SCMD_NUMFUNCARGS &&
+                 cmd != SCMD_LOADSPOFFS && cmd != SCMD_ZEROMEMORY && argc > 0) &&
+                (arg1 <= 0 || arg1 >= CC_NUM_REGISTERS))
+                return Fail(res, "invalid register");
+            const bool two_regs = (cmd == SCMD_REGTOREG) || (cmd >= SCMD_MULREG && cmd <= SCMD_OR) ||
+                cmd == SCMD_MODREG || cmd == SCMD_XORREG || cmd == SCMD_SHIFTLEFT || cmd == SCMD_SHIFTRIGHT;
+            if (two_regs && (arg2 <= 0 || arg2 >= CC_NUM_REGISTERS))
+                return Fail(res, "invalid register");
+
+            int32_t next = pc + 1 + argc;
+            int32_t &r1 = reg[argc > 0 && arg1 > 0 && arg1 < CC_NUM_REGISTERS ? arg1 : 0];
+            const int32_t r2 = two_regs ? reg[arg2] : 0;
+            const uint32_t u1 = static_cast<uint32_t>(r1);
+            switch (cmd)
+            {
+            case SCMD_ADD: r1 = static_cast<int32_t>(u1 + arg2); break;
+            case SCMD_SUB: r1 = static_cast<int32_t>(u1 - arg2); break;
+            case SCMD_MUL: r1 = static_cast<int32_t>(u1 * arg2); break;
+            case SCMD_REGTOREG: reg[arg2] = r1; break;
+            case SCMD_LITTOREG: r1 = arg2; break;
+            case SCMD_MULREG: r1 = static_cast<int32_t>(u1 * r2); break;
+            case SCMD_ADDREG: r1 = static_cast<int32_t>(u1 + r2); break;
+            case SCMD_SUBREG: r1 = static_cast<int32_t>(u1 - r2); break;
+            case SCMD_DIVREG:
+            case SCMD_MODREG:
+                if (r2 == 0)
+                    return Fail(res, "Integer divide by zero");
+                r1 = (cmd == SCMD_DIVREG) ? r1 / r2 : r1 % r2;
+                break;
+            case SCMD_BITAND: r1 &= r2; break;
+            case SCMD_BITOR: r1 |= r2; break;
+            case SCMD_XORREG: r1 ^= r2; break;
+            case SCMD_SHIFTLEFT: r1 = static_cast<int32_t>(u1 << r2); break;
+            case SCMD_SHIFTRIGHT: r1 >>= r2; break;
+            case SCMD_ISEQUAL: r1 = r1 == r2; break;
+            case SCMD_NOTEQUAL: r1 = r1 != r2; break;
+            case SCMD_GREATER: r1 = r1 > r2; break;
+            case SCMD_LESSTHAN: r1 = r1 < r2; break;
+            case SCMD_GTE: r1 = r1 >= r2; break;
+            case SCMD_LTE: r1 = r1 <= r2; break;
+            case SCMD_AND: r1 = r1 && r2; break;
+            case SCMD_OR: r1 = r1 || r2; break;
+            case SCMD_NOTREG: r1 = !r1; break;
+            case SCMD_MEMREAD:
+            case SCMD_MEMREADW:
+            case SCMD_MEMREADB:
+            {
+                const size_t size = (cmd == SCMD_MEMREAD) ? 4 : (cmd == SCMD_MEMREADW) ? 2 : 1;
+                int32_t value;
+                if (!Read(reg[SREG_MAR], value, size, res))
+                    return res;
+                r1 = (size == 4) ? value : (size == 2) ? static_cast<int16_t>(value) : static_cast<uint8_t>(value);
+                break;
+            }
+            case SCMD_MEMWRITE:
+            case SCMD_MEMWRITEW:
+            case SCMD_MEMWRITEB:
+            {
+                const size_t size = (cmd == SCMD_MEMWRITE) ? 4 : (cmd == SCMD_MEMWRITEW) ? 2 : 1;
+                if (!Write(reg[SREG_MAR], r1, size, res))
+                    return res;
+                break;
+            }
+            case SCMD_WRITELIT:
+                if (!Write(reg[SREG_MAR], arg2, arg1, res))
+                    return res;
+                break;
+            case SCMD_ZEROMEMORY:
+                for (int32_t i = 0; i < arg1; ++i)
+                {
+                    if (!Write(reg[SREG_MAR] + i, 0, 1, res))
+                        return res;
+                }
+                break;
+            case SCMD_LOADSPOFFS: reg[SREG_MAR] = reg[SREG_SP] - arg1; break;
+            case SCMD_CHECKNULL:
+                if (reg[SREG_MAR] == 0)
+                    return Fail(res, "Null pointer referenced");
+                break;
+            case SCMD_CHECKBOUNDS:
+                if (r1 < 0 || r1 >= arg2)
+                    return Fail(res, "Array index out of bounds");
+                break;
+            case SCMD_PUSHREG:
+                if (!Write(reg[SREG_SP], r1, sizeof(int32_t), res))
+                    return res;
+                reg[SREG_SP] += sizeof(int32_t);
+                break;
+            case SCMD_POPREG:
+                reg[SREG_SP] -= sizeof(int32_t);
+                if (!Read(reg[SREG_SP], r1, sizeof(int32_t), res))
+                    return res;
+                break;
+            case SCMD_CALL:
+                if (!Write(reg[SREG_SP], next, sizeof(int32_t), res))
+                    return res;
+                reg[SREG_SP] += sizeof(int32_t);
+                next = r1;
+                break;
+            case SCMD_RET:
+                reg[SREG_SP] -= sizeof(int32_t);
+                if (!Read(reg[SREG_SP], next, sizeof(int32_t), res))
+                    return res;
+                if (next == 0)
+                {
+                    res.Ok = true;
+                    res.Value = reg[SREG_AX];
+                    return res;
+                }
+                break;
+            case SCMD_JMP: next += arg1; break;
+            case SCMD_JZ: if (reg[SREG_AX] == 0) next += arg1; break;
+            case SCMD_JNZ: if (reg[SREG_AX] != 0) next += arg1; break;
+            case SCMD_LINENUM: res.Line = arg1; break;
+            case SCMD_THISBASE:
+            case SCMD_NUMFUNCARGS:
+            case SCMD_LOOPCHECKOFF:
+                break;
+            default:
+                return Fail(res, "unsupported instruction");
+            }
+            pc = next;
+        }
+        return Fail(res, "too many steps");
+    }
+
+    // Returns the number of the command's arguments, or -1 if unsupported
+    static int ArgCount(int32_t cmd)
+    {
+        switch (cmd)
+        {
+        case SCMD_RET: case SCMD_CHECKNULL: case SCMD_LOOPCHECKOFF:
+            return 0;
+        case SCMD_MEMREAD: case SCMD_MEMWRITE: case SCMD_CALL: case SCMD_MEMREADB:
+        case SCMD_MEMREADW: case SCMD_MEMWRITEB: case SCMD_MEMWRITEW: case SCMD_JZ:
+        case SCMD_PUSHREG: case SCMD_POPREG: case SCMD_JMP: case SCMD_LINENUM:
+        case SCMD_THISBASE: case SCMD_NUMFUNCARGS: case SCMD_NOTREG: case SCMD_LOADSPOFFS:
+        case SCMD_ZEROMEMORY: case SCMD_JNZ:
+            return 1;
+        case SCMD_ADD: case SCMD_SUB: case SCMD_REGTOREG: case SCMD_WRITELIT:
+        case SCMD_LITTOREG: case SCMD_MUL: case SCMD_MODREG: case SCMD_XORREG:
+        case SCMD_SHIFTLEFT: case SCMD_SHIFTRIGHT: case SCMD_CHECKBOUNDS:
+            return 2;
+        default:
+            if (cmd >= SCMD_MULREG && cmd <= SCMD_OR)
+                return 2;
+            return -1;
+        }
+    }
+
+private:
+    static const size_t StackSize = 64 * 1024;
+    static const size_t MaxSteps = 1000000;
+
+    static Result &Fail(Result &res, const char *error)
+    {
+        res.Error = error;
+        return res;
+    }
+
+    bool Read(int32_t addr, int32_t &value, size_t size, Result &res)
+    {
+        if (addr < _globals || addr + size > _mem.size())
+            return Fail(res, "invalid memory read"), false;
+        value = 0;
+        memcpy(&value, &_mem[addr], size);
+        return true;
+    }
+
+    bool Write(int32_t addr, int32_t value, size_t size, Result &res)
+    {
+        if (addr < _globals || addr + size > _mem.size() || size > sizeof(value))
+            return Fail(res, "invalid memory write"), false;
+        memcpy(&_mem[addr], &value, size);
+        return true;
+    }
+
+    const ccScript *_script;
+    std::vector<int32_t> _code;
+    std::vector<uint8_t> _mem;
+    int32_t _globals = 0;
+    int32_t _stack = 0;
+    bool _unsupported = false;
+};
+
+std::unique_ptr<ccScript> CompileScript(const char *script, bool optimize)
+{
+    ccSetOption(SCOPT_EXPORTALL, 1);
+    ccSetOption(SCOPT_LINENUMBERS, 1);
+    ccSetOption(SCOPT_OPTIMIZE, optimize);
+    std::unique_ptr<ccScript> scrip(ccCompileText(script, "TestScript"));
+    ccSetOption(SCOPT_EXPORTALL, 0);
+    ccSetOption(SCOPT_LINENUMBERS, 0);
+    ccSetOption(SCOPT_OPTIMIZE, 0);
+    return scrip;
+}
+
+// Runs the function in the plain and optimized builds of the script,
+// and checks that both give the same result
+void CompareRuns(const char *script, const char *func_name, TestInterpreter::Result *result = nullptr)
+{
+    std::unique_ptr<ccScript> plain = CompileScript(script, false);
+    std::unique_ptr<ccScript> optimized = CompileScript(script, true);
+    ASSERT_TRUE(plain != nullptr);
+    ASSERT_TRUE(optimized != nullptr);
+    ASSERT_LT(optimized->codesize, plain->codesize);
+
+    TestInterpreter::Result res1 = TestInterpreter(plain.get()).Run(func_name);
+    TestInterpreter::Result res2 = TestInterpreter(optimized.get()).Run(func_name);
+    ASSERT_NE(res1.Error, "unsupported instruction");
+    EXPECT_EQ(res1.Ok, res2.Ok);
+    EXPECT_EQ(res1.Value, res2.Value);
+    EXPECT_EQ(res1.Error, res2.Error);
+    EXPECT_EQ(res1.Line, res2.Line);
+    EXPECT_LT(res2.Steps, res1.Steps);
+    if (result)
+        *result = res2;
+}
+
+} // namespace
+
+TEST(Optimizer, ConstantFolding) {
+    const char *inpl = "\
+        int Calc()                                      \n\
+        {                                               \n\
+            int a = 3 * 4 + 2;                          \n\
+            int b = (a << 2) - 7 / 2 + (-9 % 4);        \n\
+            int c = (5 > 3) + (2 == 2 && 1 != 1) + !0;  \n\
+            return a * b + c - (1 | 6) + (12 & 10) + (5 ^ 3) + (-16 >> 2); \n\
+        }                                               \n\
+        ";
+
+    TestInterpreter::Result res;
+    CompareRuns(inpl, "Calc$0", &res);
+    EXPECT_TRUE(res.Ok);
+    EXPECT_EQ(14 * (56 - 3 - 1) + 2 - 7 + 8 + 6 - 4, res.Value);
+}
+
+TEST(Optimizer, FoldedExpressionCode) {
+    const char *inpl = "\
+        int Calc()          \n\
+        {                   \n\
+            return 3 * 4;   \n\
+        }                   \n\
+        ";
+
+    std::unique_ptr<ccScript> scrip = CompileScript(inpl, true);
+    ASSERT_TRUE(scrip != nullptr);
+    // The whole expression is computed at compile time, and the unreachable
+    // default return is removed
+    const int32_t expected[] = { SCMD_LINENUM, 2, SCMD_THISBASE, 0, SCMD_LINENUM, 3,
+        SCMD_LITTOREG, SREG_AX, 12, SCMD_RET };
+    ASSERT_EQ(sizeof(expected) / sizeof(expected[0]), static_cast<size_t>(scrip->codesize));
+    for (int32_t i = 0; i < scrip->codesize; ++i)
+        EXPECT_EQ(expected[i], scrip->code[i]);
+}
+
+TEST(Optimizer, LoopsAndBranches) {
+    const char *inpl = "\
+        int g;                                          \n\
+        int Add(int a, int b) { return a + b; }         \n\
+        int Loops()                                     \n\
+        {                                               \n\
+            int sum = 0;                                \n\
+            int i;                                      \n\
+            for (i = 0; i < 10; i++)                    \n\
+            {                                           \n\
+                if (i % 2 == 0) sum += Add(i, 3 * 4);   \n\
+                else sum -= 1;                          \n\
+                if (i == 7) continue;                   \n\
+                sum += i;                               \n\
+            }                                           \n\
+            while (sum > 100) { sum = sum / 2; }        \n\
+            do { sum += 3; if (sum > 70) break; } while (1); \n\
+            if (1 == 2) sum = 0;                        \n\
+            g = sum;                                    \n\
+            return sum + g;                             \n\
+        }                                               \n\
+        ";
+
+    TestInterpreter::Result res;
+    CompareRuns(inpl, "Loops$0", &res);
+    EXPECT_TRUE(res.Ok);
+    EXPECT_EQ(142, res.Value);
+}
+
+TEST(Optimizer, SwitchAndArrays) {
+    const char *inpl = "\
+        int Pick(int x)                                 \n\
+        {                                               \n\
+            switch (x)                                  \n\
+            {                                           \n\
+            case 1: return 10;                          \n\
+            case 2:                                     \n\
+            case 3: x = x * 3; break;                   \n\
+            default: x = -x;                            \n\
+            }                                           \n\
+            return x;                                   \n\
+        }                                               \n\
+        int Arrays()                                    \n\
+        {                                               \n\
+            int arr[8];                                 \n\
+            int i;                                      \n\
+            for (i = 0; i < 8; i++) arr[i] = Pick(i) + i * i; \n\
+            int total = 0;                              \n\
+            i = 7;                                      \n\
+            while (i >= 0) { total += arr[i]; i--; }    \n\
+            return total;                               \n\
+        }                                               \n\
+        ";
+
+    TestInterpreter::Result res;
+    CompareRuns(inpl, "Arrays$0", &res);
+    EXPECT_TRUE(res.Ok);
+    EXPECT_EQ(0 + 10 + 6 + 9 - 4 - 5 - 6 - 7 + 140, res.Value);
+}
+
+TEST(Optimizer, Recursion) {
+    const char *inpl = "\
+        int Fib(int n)                                  \n\
+        {                                               \n\
+            if (n < 2 || n > 100) return n;             \n\
+            return Fib(n - 1) + Fib(n - 2);             \n\
+        }                                               \n\
+        int Run() { return Fib(15); }                   \n\
+        ";
+
+    TestInterpreter::Result res;
+    CompareRuns(inpl, "Run$0", &res);
+    EXPECT_TRUE(res.Ok);
+    EXPECT_EQ(610, res.Value);
+}
+
+TEST(Optimizer, RuntimeErrorIsKept) {
+    // Division by zero must not be folded, and reported at the same line
+    const char *inpl = "\
+        int Div()                   \n\
+        {                           \n\
+            int a = 2 + 3;          \n\
+            int b = 10 / 5;         \n\
+            return a / (b - 2);     \n\
+        }                           \n\
+        ";
+
+    TestInterpreter::Result res;
+    CompareRuns(inpl, "Div$0", &res);
+    EXPECT_FALSE(res.Ok);
+    EXPECT_EQ("Integer divide by zero", res.Error);
+    EXPECT_EQ(5, res.Line);
+}
+
+TEST(Optimizer, NotAppliedWhenDisabled) {
+    const char *inpl = "int Calc() { return 3 * 4; }";
+
+    std::unique_ptr<ccScript> plain = CompileScript(inpl, false);
+    ASSERT_TRUE(plain != nullptr);
+    bool has_mul = false;
+    for (int32_t i = 0; i < plain->codesize; ++i)
+        has_mul |= plain->code[i] == SCMD_MULREG;
+    EXPECT_TRUE(has_mul);
+}
+
+TEST(Optimizer, NoBackwardConditionalJumps) {
+    // The engine checks for a hung loop only on the backward JMP, so
+    // the jumps within the loops must not be threaded past it
+    const char *inpl = "\
+        int x;                                          \n\
+        int y;                                          \n\
+        int Loops()                                     \n\
+        {                                               \n\
+            while (x < 10) { if (y == 1) { x++; } }     \n\
+            int i;                                      \n\
+            for (i = 0; i < 10; i++)                    \n\
+            {                                           \n\
+                if (y == 2) continue;                   \n\
+                x += i;                                 \n\
+            }                                           \n\
+            return x;                                   \n\
+        }                                               \n\
+        ";
+
+    std::unique_ptr<ccScript> scrip = CompileScript(inpl, true);
+    ASSERT_TRUE(scrip != nullptr);
+    int backward_jumps = 0;
+    for (int32_t pc = 0; pc < scrip->codesize;)
+    {
+        const int32_t cmd = scrip->code[pc];
+        const int argc = TestInterpreter::ArgCount(cmd);
+        ASSERT_GE(argc, 0);
+        if (cmd == SCMD_JZ || cmd == SCMD_JNZ)
+            EXPECT_GE(scrip->code[pc + 1], 0) << "at " << pc;
+        else if (cmd == SCMD_JMP && scrip->code[pc + 1] < 0)
+            backward_jumps++;
+        pc += 1 + argc;
+    }
+    // each loop still ends with its backward JMP
+    EXPECT_GE(backward_jumps, 2);
+}
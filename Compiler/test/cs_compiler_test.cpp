@@ -0,0 +1,287 @@
+#include <stdio.h>
+#include <memory>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "script/cc_common.h"
+#include "script/cs_compiler.h"
+#include "util/directory.h"
+#include "util/file.h"
+
+namespace
+{
+
+const char *TestHeader =
+    "enum Mood { eMoodHappy, eMoodSad = 5, eMoodAngry };\n"
+    "struct Counter {\n"
+    "  int value;\n"
+    "  import void Add(int amount);\n"
+    "};\n"
+    "import int Clamp(int value, int min, int max);\n"
+    "import int unusedImport;\n"
+    "int headerGlobal = 3;\n"
+    "internalstring autoptr builtin managed struct String {\n"
+    "  readonly import attribute int Length;\n"
+    "};\n";
+
+const char *TestScripts[] = {
+    "int Clamp(int value, int min, int max) {\n"
+    "  if (value < min) return min;\n"
+    "  if (value > max) return max;\n"
+    "  return value;\n"
+    "}\n",
+
+    "Counter counter;\n"
+    "int Run() {\n"
+    "  int total = 0;\n"
+    "  for (int i = 0; i < 10; i++) total += Clamp(i * headerGlobal, 2, 20);\n"
+    "  counter.Add(total);\n"
+    "  return total;\n"
+    "}\n",
+
+    "int Pick(Mood m) {\n"
+    "  String text = \"a \\\"string\\\"\";\n"
+    "  if (text.Length > 10) return 0;\n"
+    "  switch (m) {\n"
+    "    case eMoodHappy: return 1;\n"
+    "    case eMoodSad: return 2;\n"
+    "  }\n"
+    "  return eMoodAngry;\n"
+    "}\n",
+};
+
+void ExpectSameScript(const ccScript *expected, const ccScript *actual)
+{
+    ASSERT_EQ(expected->globaldatasize, actual->globaldatasize);
+    EXPECT_EQ(0, memcmp(expected->globaldata, actual->globaldata, expected->globaldatasize));
+    ASSERT_EQ(expected->codesize, actual->codesize);
+    EXPECT_EQ(0, memcmp(expected->code, actual->code, expected->codesize * sizeof(int32_t)));
+    ASSERT_EQ(expected->stringssize, actual->stringssize);
+    EXPECT_EQ(0, memcmp(expected->strings, actual->strings, expected->stringssize));
+    ASSERT_EQ(expected->numfixups, actual->numfixups);
+    EXPECT_EQ(0, memcmp(expected->fixups, actual->fixups, expected->numfixups * sizeof(int32_t)));
+    EXPECT_EQ(0, memcmp(expected->fixuptypes, actual->fixuptypes, expected->numfixups));
+    ASSERT_EQ(expected->numimports, actual->numimports);
+    // unused imports are blanked, and a loaded script has them as NULL
+    for (int i = 0; i < expected->numimports; ++i)
+        EXPECT_STREQ(expected->imports[i] ? expected->imports[i] : "",
+            actual->imports[i] ? actual->imports[i] : "");
+    ASSERT_EQ(expected->numexports, actual->numexports);
+    for (int i = 0; i < expected->numexports; ++i)
+    {
+        EXPECT_STREQ(expected->exports[i], actual->exports[i]);
+        EXPECT_EQ(expected->export_addr[i], actual->export_addr[i]);
+    }
+    ASSERT_EQ(expected->numSections, actual->numSections);
+    for (int i = 0; i < expected->numSections; ++i)
+    {
+        EXPECT_STREQ(expected->sectionNames[i], actual->sectionNames[i]);
+        EXPECT_EQ(expected->sectionOffsets[i], actual->sectionOffsets[i]);
+    }
+}
+
+class CompiledHeaders : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ccSetOption(SCOPT_EXPORTALL, 1);
+        ccSetOption(SCOPT_LINENUMBERS, 1);
+        ccSetOption(SCOPT_OPTIMIZE, 1);
+        ccRemoveDefaultHeaders();
+        ccAddDefaultHeader(TestHeader, "TestHeader");
+    }
+
+    void TearDown() override
+    {
+        ccRemoveDefaultHeaders();
+        ccSetOption(SCOPT_EXPORTALL, 0);
+        ccSetOption(SCOPT_LINENUMBERS, 0);
+        ccSetOption(SCOPT_OPTIMIZE, 0);
+    }
+};
+
+class CompileCache : public CompiledHeaders
+{
+protected:
+    void SetUp() override
+    {
+        CompiledHeaders::SetUp();
+        // each test has its own cache, as the tests may run in parallel processes
+        CacheDir = AGS::Common::String::FromFormat("cs_compiler_test_cache_%s",
+            ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        AGS::Common::Directory::CreateDirectory(CacheDir);
+        ccSetCompileCacheDir(CacheDir.GetCStr());
+        ccResetCompileCacheStats();
+    }
+
+    void TearDown() override
+    {
+        ccSetCompileCacheDir(nullptr);
+        ccResetCompileCacheStats();
+        std::vector<AGS::Common::String> files;
+        AGS::Common::Directory::GetFiles(CacheDir, files);
+        for (const auto &file : files)
+            AGS::Common::File::DeleteFile(AGS::Common::String::FromFormat("%s/%s", CacheDir.GetCStr(), file.GetCStr()));
+        remove(CacheDir.GetCStr());
+        CompiledHeaders::TearDown();
+    }
+
+    void ExpectStats(int hits, int misses)
+    {
+        int actual_hits, actual_misses;
+        ccGetCompileCacheStats(&actual_hits, &actual_misses);
+        EXPECT_EQ(hits, actual_hits);
+        EXPECT_EQ(misses, actual_misses);
+    }
+
+    AGS::Common::String CacheDir;
+};
+
+} // namespace
+
+TEST_F(CompiledHeaders, SameAsFullCompile) {
+    PCompiledHeaders headers = ccCompileDefaultHeaders();
+    ASSERT_NE(nullptr, headers);
+
+    // Headers may be reused any number of times, in any order
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (const char *script : TestScripts)
+        {
+            std::unique_ptr<ccScript> expected(ccCompileText(script, "TestScript"));
+            ASSERT_NE(nullptr, expected);
+            std::unique_ptr<ccScript> actual(ccCompileTextWithHeaders(headers.get(), script, "TestScript"));
+            ASSERT_NE(nullptr, actual);
+            ExpectSameScript(expected.get(), actual.get());
+        }
+    }
+}
+
+TEST_F(CompiledHeaders, ScriptError) {
+    PCompiledHeaders headers = ccCompileDefaultHeaders();
+    ASSERT_NE(nullptr, headers);
+
+    std::unique_ptr<ccScript> script(ccCompileTextWithHeaders(headers.get(),
+        "int Fail() {\n  return undefinedThing;\n}\n", "TestScript"));
+    ASSERT_EQ(nullptr, script);
+    ASSERT_TRUE(cc_has_error());
+    EXPECT_EQ(2, cc_get_error().Line);
+
+    // The error does not affect the following scripts
+    script.reset(ccCompileTextWithHeaders(headers.get(), TestScripts[0], "TestScript"));
+    ASSERT_NE(nullptr, script);
+    EXPECT_FALSE(cc_has_error());
+}
+
+TEST_F(CompiledHeaders, HeaderError) {
+    ccAddDefaultHeader("int broken = ;\n", "BrokenHeader");
+    PCompiledHeaders headers = ccCompileDefaultHeaders();
+    ASSERT_EQ(nullptr, headers);
+    ASSERT_TRUE(cc_has_error());
+}
+
+#if defined(AGS_CC_MULTITHREADED)
+TEST_F(CompiledHeaders, ParallelCompile) {
+    PCompiledHeaders headers = ccCompileDefaultHeaders();
+    ASSERT_NE(nullptr, headers);
+
+    const size_t num_scripts = sizeof(TestScripts) / sizeof(TestScripts[0]);
+    std::vector<std::unique_ptr<ccScript>> expected;
+    for (const char *script : TestScripts)
+        expected.emplace_back(ccCompileText(script, "TestScript"));
+
+    const size_t num_threads = 4, num_runs = 8;
+    std::vector<std::unique_ptr<ccScript>> results(num_threads * num_runs);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            for (size_t i = t * num_runs; i < (t + 1) * num_runs; ++i)
+                results[i].reset(ccCompileTextWithHeaders(headers.get(), TestScripts[i % num_scripts], "TestScript"));
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        ASSERT_NE(nullptr, results[i]);
+        ExpectSameScript(expected[i % num_scripts].get(), results[i].get());
+    }
+}
+#endif // AGS_CC_MULTITHREADED
+
+TEST_F(CompileCache, HitSameAsCompile) {
+    PCompiledHeaders headers = ccCompileDefaultHeaders();
+    ASSERT_NE(nullptr, headers);
+
+    std::vector<std::unique_ptr<ccScript>> compiled;
+    for (const char *script : TestScripts)
+    {
+        compiled.emplace_back(ccCompileTextWithHeaders(headers.get(), script, "TestScript"));
+        ASSERT_NE(nullptr, compiled.back());
+    }
+    ExpectStats(0, 3);
+
+    for (size_t i = 0; i < compiled.size(); ++i)
+    {
+        std::unique_ptr<ccScript> cached(ccCompileTextWithHeaders(headers.get(), TestScripts[i], "TestScript"));
+        ASSERT_NE(nullptr, cached);
+        ExpectSameScript(compiled[i].get(), cached.get());
+    }
+    ExpectStats(3, 3);
+
+    // The full compile without the precompiled headers finds the same entries
+    std::unique_ptr<ccScript> cached(ccCompileText(TestScripts[0], "TestScript"));
+    ASSERT_NE(nullptr, cached);
+    ExpectSameScript(compiled[0].get(), cached.get());
+    ExpectStats(4, 3);
+}
+
+TEST_F(CompileCache, MissOnChange) {
+    std::unique_ptr<ccScript> script(ccCompileText(TestScripts[1], "TestScript"));
+    ASSERT_NE(nullptr, script);
+    ExpectStats(0, 1);
+
+    // Script's text
+    script.reset(ccCompileText("int Other() {\n  return headerGlobal;\n}\n", "TestScript"));
+    ASSERT_NE(nullptr, script);
+    ExpectStats(0, 2);
+    // Script's name, which is a part of the compiled code
+    script.reset(ccCompileText(TestScripts[1], "OtherScript"));
+    ASSERT_NE(nullptr, script);
+    ExpectStats(0, 3);
+    // Compiler options
+    ccSetOption(SCOPT_OPTIMIZE, 0);
+    script.reset(ccCompileText(TestScripts[1], "TestScript"));
+    ASSERT_NE(nullptr, script);
+    ExpectStats(0, 4);
+    ccSetOption(SCOPT_OPTIMIZE, 1);
+    // Headers
+    ccAddDefaultHeader("int anotherGlobal;\n", "OtherHeader");
+    script.reset(ccCompileText(TestScripts[1], "TestScript"));
+    ASSERT_NE(nullptr, script);
+    ExpectStats(0, 5);
+
+    // Everything as before
+    ccRemoveDefaultHeaders();
+    ccAddDefaultHeader(TestHeader, "TestHeader");
+    script.reset(ccCompileText(TestScripts[1], "TestScript"));
+    ASSERT_NE(nullptr, script);
+    ExpectStats(1, 5);
+}
+
+TEST_F(CompileCache, ErrorNotCached) {
+    const char *bad_script = "int Fail() {\n  return undefinedThing;\n}\n";
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        std::unique_ptr<ccScript> script(ccCompileText(bad_script, "TestScript"));
+        ASSERT_EQ(nullptr, script);
+        ASSERT_TRUE(cc_has_error());
+        EXPECT_EQ(2, cc_get_error().Line);
+    }
+    ExpectStats(0, 2);
+}
@@ -935,6 +935,8 @@ void Character_StopMoving(CharacterInfo *charp) {
     int chaa = charp->index_id;
     if (chaa == play.skip_until_char_stops)
         EndSkippingUntilCharStops();
+    // don't let the walk which was chosen but not searched for yet start later
+    cancel_queued_route(chaa + CHMLSOFFS);
 
     if (charextra[chaa].xwas != INVALID_X) {
         charp->x = charextra[chaa].xwas;
@@ -1677,6 +1679,9 @@ int Character_GetSpeakingFrame(CharacterInfo *chaa) {
 // order of loops to turn character in circle from down to down
 int turnlooporder[8] = {0, 6, 1, 7, 3, 5, 2, 4};
 
+// Starts character's walk along the found route, or stops them if there's none
+static void start_character_walk(int chac, int mslot, int ignwal, bool autoWalkAnims, int waitWas, int animWaitWas);
+
 void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims) {
     CharacterInfo*chin=&game.chars[chac];
     if (chin->room!=displayed_room)
@@ -1732,8 +1737,15 @@ void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims) {
 
     set_route_move_speed(move_speed_x, move_speed_y);
     set_color_depth(8);
-    int mslot=find_route(charX, charY, tox, toy, prepare_walkable_areas(chac), chac+CHMLSOFFS, 1, ignwal);
+    // the route may be searched for later, if the route batch is open
+    queue_route(charX, charY, tox, toy, prepare_walkable_areas(chac), chac+CHMLSOFFS, 1, ignwal,
+        [chac, ignwal, autoWalkAnims, waitWas, animWaitWas](int mslot)
+        { start_character_walk(chac, mslot, ignwal, autoWalkAnims, waitWas, animWaitWas); });
     set_color_depth(game.GetColorDepth());
+}
+
+static void start_character_walk(int chac, int mslot, int ignwal, bool autoWalkAnims, int waitWas, int animWaitWas) {
+    CharacterInfo *chin = &game.chars[chac];
     if (mslot>0) {
         chin->walking = mslot;
         mls[mslot].direct = ignwal;
@@ -2161,6 +2173,8 @@ void animate_character(CharacterInfo *chap, int loopn, int sppd, int rept,
         chap->scrname, chap->view+1, loopn, sppd, rept, sframe);
 
     Character_StopMoving(chap);
+    // Request the rest of the loop to be loaded while the first frame is shown
+    prefetch_view_loop(chap->view, loopn);
 
     chap->set_animating(rept != 0, direction == 0, sppd);
     chap->loop=loopn;
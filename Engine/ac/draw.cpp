@@ -42,15 +42,18 @@
 #include "ac/sprite.h"
 #include "ac/string.h"
 #include "ac/system.h"
+#include "ac/timer.h"
 #include "ac/viewframe.h"
 #include "ac/walkablearea.h"
 #include "ac/walkbehind.h"
 #include "ac/dynobj/scriptsystem.h"
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
+#include "debug/profiler.h"
 #include "font/fonts.h"
 #include "gui/guimain.h"
 #include "gui/guiobject.h"
+#include "main/game_run.h"
 #include "platform/base/agsplatformdriver.h"
 #include "plugin/agsplugin_evts.h"
 #include "plugin/plugin_engine.h"
@@ -59,6 +62,7 @@
 #include "gfx/graphicsdriver.h"
 #include "gfx/ali3dexception.h"
 #include "gfx/blender.h"
+#include "util/math.h"
 #include "media/audio/audio_system.h"
 #include "ac/game.h"
 #include "util/wgt2allg.h"
@@ -101,9 +105,38 @@ struct DrawState
     WalkBehindMethodEnum WalkBehindMethod = DrawAsSeparateSprite;
     // Whether there are currently remnants of a on-screen effect
     bool ScreenIsDirty = false;
+    // Whether we render extra frames in between the game updates
+    bool RenderUnlocked = false;
 };
 
 DrawState drawstate;
+
+// InterpPos keeps the position of a drawn thing on the two last game updates
+struct InterpPos
+{
+    Point Prev;
+    Point Cur;
+    // Number of the game update on which this position was last set
+    uint32_t Tick = UINT32_MAX;
+};
+
+// InterpState is used to interpolate the positions of the room sprites
+// and cameras, when rendering in between the game updates
+struct InterpState
+{
+    // Number of the game update, counted by the renders following them
+    uint32_t Tick = 0u;
+    // Whether current render follows the game update
+    bool NewTick = false;
+    // Progress from the previous to the current update positions, 0 to 1
+    float Alpha = 1.f;
+    std::vector<InterpPos> Chars;
+    std::vector<InterpPos> Objects;
+    std::vector<InterpPos> Overlays; // indexed by overlay id
+    std::vector<InterpPos> Cameras; // indexed by camera id
+};
+
+static InterpState interp;
 RGB palette[256];
 COLOR_MAP maincoltable;
 
@@ -676,6 +709,10 @@ void init_draw_method()
 {
     drawstate.SoftwareRender = !gfxDriver->HasAcceleratedTransform();
     drawstate.FullFrameRedraw = gfxDriver->RequiresFullRedrawEachFrame();
+    // Interpolated rendering requires the whole scene to be redrawn each time
+    drawstate.RenderUnlocked = usetup.RenderUnlocked && drawstate.FullFrameRedraw;
+    if (usetup.RenderUnlocked && !drawstate.RenderUnlocked)
+        Debug::Printf(kDbgMsg_Warn, "WARNING: unlocked render is not supported by the current graphics driver");
 
     if (drawstate.SoftwareRender)
     {
@@ -889,6 +926,12 @@ void init_room_drawdata()
     debug_draw_room_mask(debugRoomMask);
     debug_draw_movelist(debugMoveListChar);
 
+    // Don't interpolate the positions from the previous room
+    interp.Chars.clear();
+    interp.Objects.clear();
+    interp.Overlays.clear();
+    interp.Cameras.clear();
+
     // Following data is only updated for software renderer
     if (drawstate.FullFrameRedraw)
         return;
@@ -997,15 +1040,9 @@ void reset_drawobj_for_overlay(int objnum)
     }
 }
 
-void notify_sprite_changed(int sprnum, bool deleted)
+// Marks the drawn objects which reference this sprite for redraw
+static void sprite_drawables_changed(int sprnum)
 {
-    assert(sprnum >= 0 && sprnum < game.SpriteInfos.size());
-    // Update texture cache (regen texture or clear from cache)
-    if (deleted)
-        clear_shared_texture(sprnum);
-    else
-        update_shared_texture(sprnum);
-
     // For texture-based renderers updating a shared texture will already
     // update all the related drawn objects on screen.
     // For software renderer we should notify drawables that currently
@@ -1018,6 +1055,24 @@ void notify_sprite_changed(int sprnum, bool deleted)
     }
 }
 
+void notify_sprite_changed(int sprnum, bool deleted)
+{
+    assert(sprnum >= 0 && sprnum < game.SpriteInfos.size());
+    // Update texture cache (regen texture or clear from cache)
+    if (deleted)
+        clear_shared_texture(sprnum);
+    else
+        update_shared_texture(sprnum);
+    sprite_drawables_changed(sprnum);
+}
+
+void notify_sprite_changed(int sprnum, const Rect &dirty)
+{
+    assert(sprnum >= 0 && sprnum < game.SpriteInfos.size());
+    update_shared_texture(sprnum, dirty);
+    sprite_drawables_changed(sprnum);
+}
+
 void texturecache_get_state(size_t &max_size, size_t &cur_size, size_t &locked_size, size_t &ext_size)
 {
     max_size = texturecache.GetMaxCacheSize();
@@ -1031,7 +1086,26 @@ void texturecache_clear()
     texturecache.Clear();
 }
 
+size_t texturecache_precache(uint32_t sprite_id)
+{
+    // Textures are not shared between objects in software mode
+    if (drawstate.SoftwareRender || !spriteset.DoesSpriteExist(sprite_id))
+        return 0u;
+    if (texturecache.Get(sprite_id))
+        return 0u;
+    // NOTE: must use same texture parameters as the room objects and characters
+    auto txdata = texturecache.GetOrLoad(sprite_id, nullptr,
+        (game.SpriteInfos[sprite_id].Flags & SPF_ALPHACHANNEL) != 0, false);
+    return txdata ? txdata->GetMemSize() : 0u;
+}
+
 void update_shared_texture(uint32_t sprite_id)
+{
+    update_shared_texture(sprite_id,
+        RectWH(0, 0, game.SpriteInfos[sprite_id].Width, game.SpriteInfos[sprite_id].Height));
+}
+
+void update_shared_texture(uint32_t sprite_id, const Rect &dirty)
 {
     auto txdata = texturecache.Get(sprite_id);
     if (!txdata)
@@ -1041,8 +1115,8 @@ void update_shared_texture(uint32_t sprite_id)
     if (res.Width == game.SpriteInfos[sprite_id].Width &&
         res.Height == game.SpriteInfos[sprite_id].Height)
     {
-        gfxDriver->UpdateTexture(txdata.get(), spriteset[sprite_id],
-            (game.SpriteInfos[sprite_id].Flags & SPF_ALPHACHANNEL) != 0, false);
+        gfxDriver->UpdateTextureRect(txdata.get(), spriteset[sprite_id],
+            (game.SpriteInfos[sprite_id].Flags & SPF_ALPHACHANNEL) != 0, false, dirty);
     }
     else
     {
@@ -1131,6 +1205,7 @@ extern volatile bool want_exit, abort_engine;
 
 void render_to_screen()
 {
+    AGS_PROFILE_ZONE("Present");
     // Stage: final plugin callback (still drawn on game screen
     if (pl_any_want_hook(AGSE_FINALSCREENDRAW))
     {
@@ -1227,8 +1302,15 @@ void draw_sprite_support_alpha(Bitmap *ds, bool ds_has_alpha, int xpos, int ypos
     // Backwards-compatible drawing
     else if (src_has_alpha && alpha == 0xFF)
     {
-        set_alpha_blender();
-        ds->TransBlendBlt(image, xpos, ypos);
+        if (ds->GetColorDepth() == 32 && image->GetColorDepth() == 32)
+        {
+            GfxUtil::BlendBlt32(ds, image, xpos, ypos, kRowBlend_ArgbToRgb, 0);
+        }
+        else
+        {
+            set_alpha_blender();
+            ds->TransBlendBlt(image, xpos, ypos);
+        }
     }
     else
     {
@@ -1331,6 +1413,38 @@ static void clear_sprite_list()
     sprlist.clear();
 }
 
+// Returns the position at which to draw the thing in the current render;
+// registers the new position of the thing, if the render follows the game update
+static Point interpolate_pos(std::vector<InterpPos> &list, size_t index, const Point &pos)
+{
+    if (!drawstate.RenderUnlocked)
+        return pos;
+    if (list.size() <= index)
+        list.resize(index + 1);
+    InterpPos &ip = list[index];
+    if (interp.NewTick)
+    {
+        // Don't interpolate if the thing was not drawn on the previous
+        // update, or has jumped too far (was teleported rather than moved)
+        const Size game_res = game.GetGameRes();
+        const int jump_dist = std::max(game_res.Width, game_res.Height) / 4;
+        if ((ip.Tick + 1 != interp.Tick) ||
+            (std::abs(pos.X - ip.Cur.X) > jump_dist) || (std::abs(pos.Y - ip.Cur.Y) > jump_dist))
+            ip.Prev = pos;
+        else
+            ip.Prev = ip.Cur;
+        ip.Cur = pos;
+        ip.Tick = interp.Tick;
+    }
+    else if (ip.Tick != interp.Tick)
+    {
+        return pos;
+    }
+    return Point(
+        ip.Prev.X + static_cast<int>(std::round((ip.Cur.X - ip.Prev.X) * interp.Alpha)),
+        ip.Prev.Y + static_cast<int>(std::round((ip.Cur.Y - ip.Prev.Y) * interp.Alpha)));
+}
+
 static void add_to_sprite_list(IDriverDependantBitmap* ddb, int x, int y, int zorder, bool isWalkBehind, int id = -1)
 {
     assert(ddb);
@@ -1427,11 +1541,19 @@ void draw_gui_sprite(Bitmap *ds, bool use_alpha, int x, int y, Bitmap *sprite, b
     // Backwards-compatible drawing
     else if (use_alpha && ds_has_alpha && (game.options[OPT_NEWGUIALPHA] == kGuiAlphaRender_AdditiveAlpha) && (alpha == 0xFF))
     {
-        if (src_has_alpha)
-            set_additive_alpha_blender();
+        if (sprite->GetColorDepth() == 32)
+        {
+            GfxUtil::BlendBlt32(ds, sprite, x, y,
+                src_has_alpha ? kRowBlend_AdditiveAlpha : kRowBlend_OpaqueAlpha, 0);
+        }
         else
-            set_opaque_alpha_blender();
-        ds->TransBlendBlt(sprite, x, y);
+        {
+            if (src_has_alpha)
+                set_additive_alpha_blender();
+            else
+                set_opaque_alpha_blender();
+            ds->TransBlendBlt(sprite, x, y);
+        }
     }
     else
     {
@@ -1614,7 +1736,16 @@ static void apply_tint_or_light(ObjTexture &actsp, int light_level,
              lit_amnt = abs(light_level) * 2;
          }
 
-         active_spr->LitBlendBlt(oldwas.get(), 0, 0, lit_amnt);
+         if (active_spr->GetColorDepth() == 32 && oldwas->GetColorDepth() == 32)
+         {
+             const int lit_col = (light_level < 0) ? 8 : 248;
+             GfxUtil::LitBlendBlt32(active_spr, oldwas.get(), 0, 0, kRowBlend_TransKeepAlpha,
+                 lit_col, lit_col, lit_col, lit_amnt);
+         }
+         else
+         {
+             active_spr->LitBlendBlt(oldwas.get(), 0, 0, lit_amnt);
+         }
      }
 
      if (oldwas.get() == blitFrom)
@@ -1983,7 +2114,8 @@ void prepare_objects_for_drawing()
             Size(obj.last_width, obj.last_height), atx, aty, usebasel,
             (obj.flags & OBJF_NOWALKBEHINDS) == 0, obj.transparent, hw_accel);
         // Finally, add the texture to the draw list
-        add_to_sprite_list(actsp.Ddb, atx, aty, usebasel, false);
+        const Point pos = interpolate_pos(interp.Objects, objid, Point(atx, aty));
+        add_to_sprite_list(actsp.Ddb, pos.X, pos.Y, usebasel, false);
     }
 }
 
@@ -2004,6 +2136,9 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
     // For performance reasons, we have a seperate blender for
     // when light is being adjusted and when it is not.
     // If luminance >= 250, then normal brightness, otherwise darken
+    // 32-bit images are processed by the row blenders, others by Allegro
+    const bool use_rows = (srcimg->GetColorDepth() == 32);
+    const RowBlender row_blender = (luminance >= 250) ? kRowBlend_Tint : kRowBlend_TintLight;
     if (luminance >= 250)
         set_blender_mode (_myblender_color15, _myblender_color16, _myblender_color32, red, grn, blu, 0);
     else
@@ -2012,7 +2147,10 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
     if (light_level >= 100) {
         // fully colourised
         ds->FillTransparent();
-        ds->LitBlendBlt(srcimg, 0, 0, luminance);
+        if (use_rows)
+            GfxUtil::LitBlendBlt32(ds, srcimg, 0, 0, row_blender, red, grn, blu, luminance);
+        else
+            ds->LitBlendBlt(srcimg, 0, 0, luminance);
     }
     else {
         // light_level is between -100 and 100 normally; 0-100 in
@@ -2024,11 +2162,19 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
         // Render the colourised image to a temporary bitmap,
         // then transparently draw it over the original image
         Bitmap *finaltarget = BitmapHelper::CreateTransparentBitmap(srcimg->GetWidth(), srcimg->GetHeight(), srcimg->GetColorDepth());
-        finaltarget->LitBlendBlt(srcimg, 0, 0, luminance);
-
-        // customized trans blender to preserve alpha channel
-        set_my_trans_blender (0, 0, 0, light_level);
-        ds->TransBlendBlt (finaltarget, 0, 0);
+        if (use_rows)
+        {
+            GfxUtil::LitBlendBlt32(finaltarget, srcimg, 0, 0, row_blender, red, grn, blu, luminance);
+            // customized trans blender to preserve alpha channel
+            GfxUtil::BlendBlt32(ds, finaltarget, 0, 0, kRowBlend_TransKeepAlpha, light_level);
+        }
+        else
+        {
+            finaltarget->LitBlendBlt(srcimg, 0, 0, luminance);
+            // customized trans blender to preserve alpha channel
+            set_my_trans_blender (0, 0, 0, light_level);
+            ds->TransBlendBlt (finaltarget, 0, 0);
+        }
         delete finaltarget;
     }
 }
@@ -2093,7 +2239,8 @@ void prepare_characters_for_drawing()
             Size(chex.width, chex.height), atx, aty, usebasel,
             (chin.flags & CHF_NOWALKBEHINDS) == 0, chin.transparency, hw_accel);
         // Finally, add the texture to the draw list
-        add_to_sprite_list(actsp.Ddb, atx, aty, usebasel, false);
+        const Point pos = interpolate_pos(interp.Chars, charid, Point(atx, aty));
+        add_to_sprite_list(actsp.Ddb, pos.X, pos.Y, usebasel, false);
     }
 }
 
@@ -2126,7 +2273,7 @@ static void add_roomovers_for_drawing()
         if (over.type < 0) continue; // empty slot
         if (!over.IsRoomLayer()) continue; // not a room layer
         if (over.transparency == 255) continue; // skip fully transparent
-        Point pos = get_overlay_position(over);
+        Point pos = interpolate_pos(interp.Overlays, over.type, get_overlay_position(over));
         add_to_sprite_list(overtxs[over.type].Ddb, pos.X, pos.Y, over.zorder, false);
     }
 }
@@ -2256,9 +2403,11 @@ void draw_fps(const Rect &viewport)
     static IDriverDependantBitmap* ddb = nullptr;
     static Bitmap *fpsDisplay = nullptr;
     const int font = FONT_NORMAL;
+    const int line_height = get_font_surface_height(font) + get_fixed_pixel_size(5);
     if (fpsDisplay == nullptr)
     {
-        fpsDisplay = CreateCompatBitmap(viewport.GetWidth(), (get_font_surface_height(font) + get_fixed_pixel_size(5)));
+        // Unlocked render mode displays the loop timings on the second line
+        fpsDisplay = CreateCompatBitmap(viewport.GetWidth(), line_height * (drawstate.RenderUnlocked ? 2 : 1));
     }
     fpsDisplay->ClearTransparent();
     
@@ -2281,9 +2430,24 @@ void draw_fps(const Rect &viewport)
     wouttext_outline(fpsDisplay, 1, 1, font, text_color, fps_buffer);
 
     char loop_buffer[60];
-    snprintf(loop_buffer, sizeof(loop_buffer), "Loop %u", loopcounter);
+    RenderStats render_stats;
+    // Draw calls and the sprites drawn by them, in the last frame
+    if (gfxDriver->GetRenderStats(render_stats))
+        snprintf(loop_buffer, sizeof(loop_buffer), "Loop %u DC: %u/%u", loopcounter,
+            render_stats.DrawCalls, render_stats.Sprites);
+    else
+        snprintf(loop_buffer, sizeof(loop_buffer), "Loop %u", loopcounter);
     wouttext_outline(fpsDisplay, viewport.GetWidth() / 2, 1, font, text_color, loop_buffer);
 
+    if (drawstate.RenderUnlocked)
+    {
+        const LoopTimings &timings = get_loop_timings();
+        char timings_buffer[100];
+        snprintf(timings_buffer, sizeof(timings_buffer), "Render: %2.1f fps, %.2f ms; Update: %.2f ms; Lag: %.2f ms",
+            timings.RenderFps, timings.RenderTime, timings.UpdateTime, timings.Lag);
+        wouttext_outline(fpsDisplay, 1, 1 + line_height, font, text_color, timings_buffer);
+    }
+
     if (ddb)
         gfxDriver->UpdateDDBFromBitmap(ddb, fpsDisplay, false);
     else
@@ -2293,6 +2457,47 @@ void draw_fps(const Rect &viewport)
     invalidate_sprite_glob(1, yp, ddb);
 }
 
+#if AGS_FRAME_PROFILER
+// Draws average time spent in the profiled zones, above the fps counter
+static void draw_profiler_overlay(const Rect &viewport)
+{
+    static IDriverDependantBitmap* ddb = nullptr;
+    static std::unique_ptr<Bitmap> statDisplay;
+    const int font = FONT_NORMAL;
+    const auto &stats = Profiler::GetFrameStats();
+    if (stats.empty())
+        return;
+
+    const int line_height = get_font_surface_height(font) + get_fixed_pixel_size(1);
+    const int height = line_height * static_cast<int>(stats.size()) + get_fixed_pixel_size(2);
+    if (!statDisplay || statDisplay->GetWidth() != viewport.GetWidth() || statDisplay->GetHeight() != height)
+    {
+        statDisplay.reset(CreateCompatBitmap(viewport.GetWidth(), height));
+        if (ddb)
+            gfxDriver->DestroyDDB(ddb);
+        ddb = nullptr;
+    }
+    statDisplay->ClearTransparent();
+
+    color_t text_color = statDisplay->GetCompatibleColor(14);
+    char buffer[60];
+    for (size_t i = 0; i < stats.size(); ++i)
+    {
+        snprintf(buffer, sizeof(buffer), "%s: %.2f ms", stats[i].Name, stats[i].Time);
+        wouttext_outline(statDisplay.get(), 1, 1 + line_height * static_cast<int>(i), font, text_color, buffer);
+    }
+
+    if (ddb)
+        gfxDriver->UpdateDDBFromBitmap(ddb, statDisplay.get(), false);
+    else
+        ddb = gfxDriver->CreateDDBFromBitmap(statDisplay.get(), false);
+    const int fps_height = get_font_surface_height(font) + get_fixed_pixel_size(5);
+    int yp = viewport.GetHeight() - fps_height - statDisplay->GetHeight();
+    gfxDriver->DrawSprite(1, yp, ddb);
+    invalidate_sprite_glob(1, yp, ddb);
+}
+#endif
+
 // Draw GUI controls as separate sprites, each on their own texture
 static void construct_guictrl_tex(GUIMain &gui)
 {
@@ -2374,7 +2579,7 @@ void draw_gui_and_overlays()
         if (over.type < 0) continue; // empty slot
         if (over.IsRoomLayer()) continue; // not a ui layer
         if (over.transparency == 255) continue; // skip fully transparent
-        Point pos = get_overlay_position(over);
+        Point pos = interpolate_pos(interp.Overlays, over.type, get_overlay_position(over));
         add_to_sprite_list(overtxs[over.type].Ddb, pos.X, pos.Y, over.zorder, false);
     }
 
@@ -2528,7 +2733,12 @@ static void construct_room_view()
             continue;
 
         const Rect &view_rc = viewport->GetRect();
-        const Rect &cam_rc = camera->GetRect();
+        Rect cam_rc = camera->GetRect();
+        if (drawstate.RenderUnlocked)
+        {
+            const Point cam_pos = interpolate_pos(interp.Cameras, camera->GetID(), cam_rc.GetLT());
+            cam_rc = RectWH(cam_pos.X, cam_pos.Y, cam_rc.GetWidth(), cam_rc.GetHeight());
+        }
         const float view_sx = (float)view_rc.GetWidth() / (float)cam_rc.GetWidth();
         const float view_sy = (float)view_rc.GetHeight() / (float)cam_rc.GetHeight();
         const SpriteTransform view_trans(view_rc.Left, view_rc.Top, view_sx, view_sy);
@@ -2673,6 +2883,7 @@ static void reset_spritemodified()
 
 void construct_game_scene(bool full_redraw)
 {
+    AGS_PROFILE_ZONE("Scene");
     gfxDriver->ClearDrawLists();
 
     if (play.fast_forward)
@@ -2810,6 +3021,10 @@ void construct_engine_overlay()
 
     if (display_fps != kFPS_Hide)
         draw_fps(viewport);
+#if AGS_FRAME_PROFILER
+    if (Profiler::IsOverlayEnabled())
+        draw_profiler_overlay(viewport);
+#endif
 
     gfxDriver->EndSpriteBatch();
 }
@@ -2911,9 +3126,9 @@ void update_room_debug()
     }
 }
 
-// Draw everything 
-void render_graphics(IDriverDependantBitmap *extraBitmap, int extraX, int extraY)
+static void render_graphics_impl(IDriverDependantBitmap *extraBitmap, int extraX, int extraY)
 {
+    AGS_PROFILE_ZONE("Render");
     // Don't render if skipping cutscene
     if (play.fast_forward)
         return;
@@ -2950,3 +3165,35 @@ void render_graphics(IDriverDependantBitmap *extraBitmap, int extraX, int extraY
 
     drawstate.ScreenIsDirty = false;
 }
+
+// Gets the progress of the time from the current game update to the next one
+static float get_interp_alpha()
+{
+    return isTimerFpsMaxed() ? 1.f : Math::Clamp(GetFrameProgress(), 0.f, 1.f);
+}
+
+// Draw everything 
+void render_graphics(IDriverDependantBitmap *extraBitmap, int extraX, int extraY)
+{
+    if (drawstate.RenderUnlocked)
+    {
+        interp.NewTick = true;
+        interp.Tick++;
+        interp.Alpha = get_interp_alpha();
+    }
+    render_graphics_impl(extraBitmap, extraX, extraY);
+}
+
+bool is_render_unlocked()
+{
+    return drawstate.RenderUnlocked;
+}
+
+void render_graphics_interpolated(IDriverDependantBitmap *extraBitmap, int extraX, int extraY)
+{
+    if (!drawstate.RenderUnlocked)
+        return;
+    interp.NewTick = false;
+    interp.Alpha = get_interp_alpha();
+    render_graphics_impl(extraBitmap, extraX, extraY);
+}
@@ -76,6 +76,9 @@ void mark_object_changed(int objid);
 void reset_drawobj_for_overlay(int objnum);
 // Marks all game objects which reference this sprite for redraw
 void notify_sprite_changed(int sprnum, bool deleted);
+// Marks all game objects which reference this sprite for redraw,
+// telling that only the given rect of the sprite was changed
+void notify_sprite_changed(int sprnum, const Rect &dirty);
 
 // Get current texture cache's stats: max size, current normal items size,
 // size of locked items (included into cur_size),
@@ -83,8 +86,13 @@ void notify_sprite_changed(int sprnum, bool deleted);
 void texturecache_get_state(size_t &max_size, size_t &cur_size, size_t &locked_size, size_t &ext_size);
 // Completely resets texture cache
 void texturecache_clear();
+// Creates a texture for the sprite, unless it is already cached;
+// returns the new texture's size in memory, or 0 if nothing was created
+size_t texturecache_precache(uint32_t sprite_id);
 // Update shared and cached texture from the sprite's pixels
 void update_shared_texture(uint32_t sprite_id);
+// Update only the given rect of shared and cached texture from the sprite's pixels
+void update_shared_texture(uint32_t sprite_id, const Rect &dirty);
 // Remove a texture from cache
 void clear_shared_texture(uint32_t sprite_id);
 
@@ -111,6 +119,11 @@ Engine::IDriverDependantBitmap* recycle_ddb_sprite(Engine::IDriverDependantBitma
 Engine::IDriverDependantBitmap* recycle_render_target(Engine::IDriverDependantBitmap *ddb, int width, int height, int col_depth, bool opaque = false);
 // Draw everything 
 void render_graphics(Engine::IDriverDependantBitmap *extraBitmap = nullptr, int extraX = 0, int extraY = 0);
+// Tells whether the extra frames may be rendered in between the game updates
+bool is_render_unlocked();
+// Draw everything, in between the game updates; the positions of the room
+// sprites and cameras are interpolated between the last two updates
+void render_graphics_interpolated(Engine::IDriverDependantBitmap *extraBitmap = nullptr, int extraX = 0, int extraY = 0);
 // Construct game scene, scheduling drawing list for the renderer
 void construct_game_scene(bool full_redraw = false);
 // Construct final game screen elements; updates and draws mouse cursor
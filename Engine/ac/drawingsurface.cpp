@@ -11,6 +11,7 @@
 // http://www.opensource.org/licenses/artistic-license-2.0.php
 //
 //=============================================================================
+#include <algorithm>
 #include "ac/draw.h"
 #include "ac/drawingsurface.h"
 #include "ac/common.h"
@@ -43,6 +44,16 @@ extern SpriteCache spriteset;
 
 // ** SCRIPT DRAWINGSURFACE OBJECT
 
+// Gets the surface rect which may be touched by the printed text lines;
+// uses whole rows, because letters may be drawn outside of the formal text bounds
+static Rect get_text_draw_rect(Bitmap *ds, int font, int y, size_t num_lines, int linespacing)
+{
+    const int surf_height = get_font_surface_height(font);
+    const int outline = get_font_outline_thickness(font);
+    return Rect(0, y - surf_height - outline, ds->GetWidth() - 1,
+        y + linespacing * static_cast<int>(num_lines - 1) + 2 * surf_height + outline);
+}
+
 void DrawingSurface_Release(ScriptDrawingSurface* sds)
 {
     if (sds->roomBackgroundNumber >= 0)
@@ -71,7 +82,7 @@ void DrawingSurface_Release(ScriptDrawingSurface* sds)
     {
         if (sds->modified)
         {
-            game_sprite_updated(sds->dynamicSpriteNumber);
+            game_sprite_updated(sds->dynamicSpriteNumber, sds->GetModifiedRect());
         }
 
         sds->dynamicSpriteNumber = -1;
@@ -82,6 +93,7 @@ void DrawingSurface_Release(ScriptDrawingSurface* sds)
         sds->dynamicSurfaceNumber = -1;
     }
     sds->modified = 0;
+    sds->modifiedRect = Rect();
 }
 
 void ScriptDrawingSurface::PointToGameResolution(int *xcoord, int *ycoord)
@@ -192,7 +204,7 @@ void DrawingSurface_DrawImageImpl(ScriptDrawingSurface* sds, Bitmap* src,
     draw_sprite_support_alpha(ds, sds->hasAlphaChannel != 0, dst_x, dst_y, src, src_has_alpha,
         kBlendMode_Alpha, GfxDef::Trans100ToAlpha255(trans));
 
-    sds->FinishedDrawing();
+    sds->FinishedDrawing(RectWH(dst_x, dst_y, src->GetWidth(), src->GetHeight()));
 
     if (needToFreeBitmap)
         delete src;
@@ -299,7 +311,7 @@ void DrawingSurface_DrawCircle(ScriptDrawingSurface *sds, int x, int y, int radi
 
     Bitmap *ds = sds->StartDrawing();
     ds->FillCircle(Circle(x, y, radius), sds->currentColour);
-    sds->FinishedDrawing();
+    sds->FinishedDrawing(Rect(x - radius, y - radius, x + radius, y + radius));
 }
 
 void DrawingSurface_DrawRectangle(ScriptDrawingSurface *sds, int x1, int y1, int x2, int y2)
@@ -309,7 +321,7 @@ void DrawingSurface_DrawRectangle(ScriptDrawingSurface *sds, int x1, int y1, int
 
     Bitmap *ds = sds->StartDrawing();
     ds->FillRect(Rect(x1,y1,x2,y2), sds->currentColour);
-    sds->FinishedDrawing();
+    sds->FinishedDrawing(Rect(std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2)));
 }
 
 void DrawingSurface_DrawTriangle(ScriptDrawingSurface *sds, int x1, int y1, int x2, int y2, int x3, int y3)
@@ -320,7 +332,8 @@ void DrawingSurface_DrawTriangle(ScriptDrawingSurface *sds, int x1, int y1, int
 
     Bitmap *ds = sds->StartDrawing();
     ds->DrawTriangle(Triangle(x1,y1,x2,y2,x3,y3), sds->currentColour);
-    sds->FinishedDrawing();
+    sds->FinishedDrawing(Rect(std::min({x1, x2, x3}), std::min({y1, y2, y3}),
+        std::max({x1, x2, x3}), std::max({y1, y2, y3})));
 }
 
 void DrawingSurface_DrawString(ScriptDrawingSurface *sds, int xx, int yy, int font, const char* text)
@@ -335,7 +348,7 @@ void DrawingSurface_DrawString(ScriptDrawingSurface *sds, int xx, int yy, int fo
     }
     String res_str = GUI::ApplyTextDirection(text);
     wouttext_outline(ds, xx, yy, font, text_color, res_str.GetCStr());
-    sds->FinishedDrawing();
+    sds->FinishedDrawing(get_text_draw_rect(ds, font, yy, 1, 0));
 }
 
 void DrawingSurface_DrawStringWrapped_Old(ScriptDrawingSurface *sds, int xx, int yy, int wid, int font, int alignment, const char *msg) {
@@ -359,7 +372,7 @@ void DrawingSurface_DrawStringWrapped(ScriptDrawingSurface *sds, int xx, int yy,
             xx, xx + wid - 1, yy + linespacing*i, (FrameAlignment)alignment);
     }
 
-    sds->FinishedDrawing();
+    sds->FinishedDrawing(get_text_draw_rect(ds, font, yy, Lines.Count(), linespacing));
 }
 
 void DrawingSurface_DrawMessageWrapped(ScriptDrawingSurface *sds, int xx, int yy, int wid, int font, int msgm)
@@ -390,7 +403,8 @@ void DrawingSurface_DrawLine(ScriptDrawingSurface *sds, int fromx, int fromy, in
             ds->DrawLine (Line(fromx + xx, fromy + yy, tox + xx, toy + yy), draw_color);
         }
     }
-    sds->FinishedDrawing();
+    sds->FinishedDrawing(Rect(std::min(fromx, tox) - thickness, std::min(fromy, toy) - thickness,
+        std::max(fromx, tox) + thickness, std::max(fromy, toy) + thickness));
 }
 
 void DrawingSurface_DrawPixel(ScriptDrawingSurface *sds, int x, int y) {
@@ -408,7 +422,7 @@ void DrawingSurface_DrawPixel(ScriptDrawingSurface *sds, int x, int y) {
             ds->PutPixel(x + ii, y + jj, draw_color);
         }
     }
-    sds->FinishedDrawing();
+    sds->FinishedDrawing(RectWH(x, y, thickness, thickness));
 }
 
 int DrawingSurface_GetPixel(ScriptDrawingSurface *sds, int x, int y) {
@@ -67,6 +67,9 @@ public:
     void WriteInt16(void *address, intptr_t offset, int16_t val) override;
     void WriteInt32(void *address, intptr_t offset, int32_t val) override;
     void WriteFloat(void *address, intptr_t offset, float val) override;
+
+    // No handle storage, the pool looks the handle up by the address
+    int32_t *GetHandleSlot(void* /*address*/) override { return nullptr; }
 };
 
 
@@ -32,6 +32,8 @@ public:
         uint32_t ElemCount = 0u;
         // TODO: refactor and store "elem size" instead
         uint32_t TotalSize = 0u;
+        // Managed handle of this array
+        int32_t Handle = 0;
     };
 
     CCDynamicArray() = default;
@@ -49,6 +51,11 @@ public:
     const char *GetType() override;
     int Dispose(void *address, bool force) override;
     void Unserialize(int index, AGS::Common::Stream *in, size_t data_sz) override;
+    // Handle is kept in the array's header
+    int32_t *GetHandleSlot(void *address) override
+    {
+        return &reinterpret_cast<Header&>(*(static_cast<uint8_t*>(address) - MemHeaderSz)).Handle;
+    }
 
 private:
     // The size of the array's header in memory, prepended to the element data
@@ -86,6 +86,11 @@ struct IScriptObject
     virtual void    WriteInt32(void *address, intptr_t offset, int32_t val)   = 0;
     virtual void    WriteFloat(void *address, intptr_t offset, float val)     = 0;
 
+    // Returns the storage for the object's managed handle, kept in the object's
+    // own memory, or null if it does not have one; lets the managed pool find
+    // the handle of the object without looking up its address.
+    virtual int32_t *GetHandleSlot(void *address) = 0;
+
 protected:
     IScriptObject() = default;
     ~IScriptObject() = default;
@@ -39,6 +39,7 @@ extern CCInventory ccDynamicInv;
 extern CCGUI       ccDynamicGUI;
 extern CCObject    ccDynamicObject;
 extern CCDialog    ccDynamicDialog;
+extern ScriptString myScriptStringImpl;
 extern ScriptDrawingSurface* dialogOptionsRenderingSurface;
 extern ScriptDialogOptionsRendering ccDialogOptionsRendering;
 extern std::vector<PluginObjectReader> pluginReaders;
@@ -98,8 +99,7 @@ void AGSDeSerializer::Unserialize(int index, const char *objectType, const char
         ccDynamicObject.Unserialize(index, &mems, data_sz);
     }
     else if (strcmp(objectType, "String") == 0) {
-        ScriptString *scf = new ScriptString();
-        scf->Unserialize(index, &mems, data_sz);
+        myScriptStringImpl.Unserialize(index, &mems, data_sz);
     }
     else if (strcmp(objectType, "File") == 0) {
         // files cannot be restored properly -- so just recreate
@@ -71,11 +71,15 @@ void ccAttemptDisposeObject(int32_t handle) {
 
 // translate between object handles and memory addresses
 int32_t ccGetObjectHandleFromAddress(void *address) {
+    return ccGetObjectHandleFromAddress(address, nullptr);
+}
+
+int32_t ccGetObjectHandleFromAddress(void *address, IScriptObject *manager) {
     // set to null
     if (address == nullptr)
         return 0;
 
-    int32_t handl = pool.AddressToHandle(address);
+    int32_t handl = pool.AddressToHandle(address, manager);
 
     ManagedObjectLog("Line %d WritePtr: %08X to %d", currentline, address, handl);
 
@@ -47,6 +47,9 @@ extern int   ccUnserializeAllObjects(Common::Stream *in, ICCObjectCollectionRead
 extern void  ccAttemptDisposeObject(int32_t handle);
 // translate between object handles and memory addresses
 extern int32_t ccGetObjectHandleFromAddress(void *address);
+// same as above, but lets the object's manager provide the handle;
+// must not be used with plugin object managers
+extern int32_t ccGetObjectHandleFromAddress(void *address, IScriptObject *manager);
 extern void *ccGetObjectAddressFromHandle(int32_t handle);
 extern ScriptValueType ccGetObjectAddressAndManagerFromHandle(int32_t handle, void *&object, IScriptObject *&manager);
 
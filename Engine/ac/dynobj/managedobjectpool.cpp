@@ -22,94 +22,132 @@
 using namespace AGS::Common;
 
 const auto OBJECT_CACHE_MAGIC_NUMBER = 0xa30b;
+// Version 3 handles may have the generation bits set, so it's written
+// as a new version, which the older engines refuse instead of misreading
+const auto OBJECT_CACHE_VERSION = 3;
 const auto SERIALIZE_BUFFER_SIZE = 10240;
 const auto GARBAGE_COLLECTION_INTERVAL = 1024;
 const auto RESERVED_SIZE = 2048;
 
+void ManagedObjectPool::AddSlots(size_t count) {
+    const size_t first = objects.size();
+    objects.resize(first + count);
+    for (size_t i = first; i < objects.size(); ++i)
+        objects[i].handle = MakeHandle(static_cast<int32_t>(i), 0);
+}
+
+void ManagedObjectPool::AddGCCandidate(ManagedObject &o) {
+    if (o.gcCandidate) { return; }
+    o.gcCandidate = true;
+    gcCandidates.push_back(o.handle);
+}
+
 int ManagedObjectPool::Remove(ManagedObject &o, bool force) {
     const bool can_remove = o.callback->Dispose(o.addr, force) != 0;
     if (!(can_remove || force))
         return 0;
 
-    available_ids.push(o.handle);
-    handleByAddress.erase(o.addr);
-    ManagedObjectLog("Line %d Disposed managed object handle=%d", currentline, o.handle);
+    const int32_t handle = o.handle;
+    const int32_t index = HandleIndex(handle);
+    if (o.addressMapped)
+        handleByAddress.erase(o.addr);
+    ManagedObjectLog("Line %d Disposed managed object handle=%d", currentline, handle);
     o = ManagedObject();
+    o.handle = MakeHandle(index, (handle >> HANDLE_INDEX_BITS) + 1);
+    freeSlots.push_back(index);
     return 1;
 }
 
 int32_t ManagedObjectPool::AddRef(int32_t handle) {
-    if (handle < 1 || (size_t)handle >= objects.size())
-        return 0;
-
-    auto &o = objects[handle];
-    if (!o.isUsed()) { return 0; }
-    o.refCount++;
-    ManagedObjectLog("Line %d AddRef: handle=%d new refcount=%d", currentline, o.handle, o.refCount);
-    return o.refCount;
+    auto *o = GetObject(handle);
+    if (!o) { return 0; }
+    o->refCount++;
+    ManagedObjectLog("Line %d AddRef: handle=%d new refcount=%d", currentline, o->handle, o->refCount);
+    return o->refCount;
 }
 
 int ManagedObjectPool::CheckDispose(int32_t handle) {
-    if (handle < 1 || (size_t)handle >= objects.size())
-        return 1;
-    auto & o = objects[handle];
-    if (!o.isUsed()) { return 1; }
-    if (o.refCount >= 1) { return 0; }
-    return Remove(o);
+    auto *o = GetObject(handle);
+    if (!o) { return 1; }
+    if (o->refCount >= 1) { return 0; }
+    return Remove(*o);
 }
 
 int32_t ManagedObjectPool::SubRef(int32_t handle) {
-    if (handle < 1 || (size_t)handle >= objects.size()) { return 0; }
-    auto & o = objects[handle];
-    if (!o.isUsed()) { return 0; }
-
-    o.refCount--;
-    const auto newRefCount = o.refCount;
-    const auto canBeDisposed = (o.addr != disableDisposeForObject);
-    if (canBeDisposed && o.refCount <= 0) {
-        Remove(o);
+    auto *o = GetObject(handle);
+    if (!o) { return 0; }
+
+    o->refCount--;
+    const auto newRefCount = o->refCount;
+    const auto canBeDisposed = (o->addr != disableDisposeForObject);
+    if (newRefCount <= 0) {
+        // if it can't be disposed now, then let the garbage collector retry
+        if (!canBeDisposed || !Remove(*o))
+            AddGCCandidate(*o);
     }
     // object could be removed at this point, don't use any values.
     ManagedObjectLog("Line %d SubRef: handle=%d new refcount=%d canBeDisposed=%d", currentline, handle, newRefCount, canBeDisposed);
     return newRefCount;
 }
 
+ManagedObjectPool::ManagedObject *ManagedObjectPool::FindObject(void *addr) {
+    auto it = handleByAddress.find(addr);
+    if (it != handleByAddress.end()) { return GetObject(it->second); }
+    // The objects with the handle slots are not in the map; this is only
+    // reached when the caller does not know the object's manager, such as
+    // a plugin, so a slow search is acceptable here
+    for (int i = 1; i < nextIndex; i++) {
+        auto &o = objects[i];
+        if (o.isUsed() && o.addr == addr) { return &o; }
+    }
+    return nullptr;
+}
+
 int32_t ManagedObjectPool::AddressToHandle(void *addr) {
     if (addr == nullptr) { return 0; }
+    const auto *o = FindObject(addr);
+    return o ? o->handle : 0;
+}
+
+// this function is called often (whenever a pointer is assigned)
+int32_t ManagedObjectPool::AddressToHandle(void *addr, IScriptObject *manager) {
+    if (addr == nullptr) { return 0; }
+    const int32_t *slot = manager ? manager->GetHandleSlot(addr) : nullptr;
+    if (slot) {
+        // make sure that this is a registered object
+        const auto *o = GetObject(*slot);
+        return (o && o->addr == addr) ? o->handle : 0;
+    }
+    if (!manager) { return AddressToHandle(addr); }
     auto it = handleByAddress.find(addr);
-    if (it == handleByAddress.end()) { return 0; }
-    return it->second;
+    return (it != handleByAddress.end()) ? it->second : 0;
 }
 
 // this function is called often (whenever a pointer is used)
 void* ManagedObjectPool::HandleToAddress(int32_t handle) {
-    if (handle < 1 || (size_t)handle >= objects.size()) { return nullptr; }
-    auto & o = objects[handle];
-    if (!o.isUsed()) { return nullptr; }
-    return o.addr;
+    const auto *o = GetObject(handle);
+    return o ? o->addr : nullptr;
 }
 
 // this function is called often (whenever a pointer is used)
 ScriptValueType ManagedObjectPool::HandleToAddressAndManager(int32_t handle, void *&object, IScriptObject *&manager) {
-    if ((handle < 1 || (size_t)handle >= objects.size()) || !objects[handle].isUsed())
+    const auto *o = GetObject(handle);
+    if (!o)
     {
         object = nullptr;
         manager = nullptr;
         return kScValUndefined;
     }
-    auto &o = objects[handle];
-    object = (void *)o.addr;  // WARNING: This strips the const from the char* pointer.
-    manager = o.callback;
-    return o.obj_type;
+    object = (void *)o->addr;  // WARNING: This strips the const from the char* pointer.
+    manager = o->callback;
+    return o->obj_type;
 }
 
 int ManagedObjectPool::RemoveObject(void *address) {
     if (address == nullptr) { return 0; }
-    auto it = handleByAddress.find(address);
-    if (it == handleByAddress.end()) { return 0; }
-
-    auto & o = objects[it->second];
-    return Remove(o, true);
+    auto *o = FindObject(address);
+    if (!o) { return 0; }
+    return Remove(*o, true);
 }
 
 void ManagedObjectPool::RunGarbageCollectionIfAppropriate()
@@ -119,54 +157,76 @@ void ManagedObjectPool::RunGarbageCollectionIfAppropriate()
     objectCreationCounter = 0;
 }
 
+// Only visits the candidates, rather than every object in the pool
 void ManagedObjectPool::RunGarbageCollection()
 {
-    for (int i = 1; i < nextHandle; i++) {
-        auto & o = objects[i];
-        if (!o.isUsed()) { continue; }
-        if (o.refCount < 1) {
-            Remove(o);
+    // disposing objects may release other objects, adding new candidates
+    std::swap(gcWorkList, gcCandidates);
+    for (const int32_t handle : gcWorkList) {
+        auto *o = GetObject(handle);
+        if (!o || !o->gcCandidate) { continue; }
+        o->gcCandidate = false;
+        if (o->refCount >= 1) { continue; }
+        // the built-in objects which refuse disposal never change their mind,
+        // but the plugin objects may, so keep trying these
+        const bool retry = o->obj_type == kScValPluginObject;
+        if (!Remove(*o) && retry) {
+            AddGCCandidate(*o);
         }
     }
+    gcWorkList.clear();
     ManagedObjectLog("Ran garbage collection");
 }
 
 int ManagedObjectPool::Add(int handle, void *address, IScriptObject *callback, ScriptValueType obj_type)
 {
-    auto &o = objects[handle];
+    auto &o = objects[HandleIndex(handle)];
     assert(!o.isUsed());
 
     o = ManagedObject(obj_type, handle, address, callback);
+    // not referenced yet
+    AddGCCandidate(o);
 
-    handleByAddress.insert({address, handle});
+    int32_t *slot = (obj_type == kScValScriptObject) ? callback->GetHandleSlot(address) : nullptr;
+    if (slot) {
+        *slot = handle;
+    } else {
+        handleByAddress.insert({address, handle});
+        o.addressMapped = true;
+    }
     ManagedObjectLog("Allocated managed object type=%s, handle=%d, addr=%08X", callback->GetType(), handle, address);
     return handle;
 }
 
 int ManagedObjectPool::AddObject(void *address, IScriptObject *callback, ScriptValueType obj_type) 
 {
-    int32_t handle;
+    int32_t index;
 
-    if (!available_ids.empty()) {
-        handle = available_ids.front();
-        available_ids.pop();
+    if (!freeSlots.empty()) {
+        index = freeSlots.back();
+        freeSlots.pop_back();
     } else {
-        handle = nextHandle++;
-        if ((size_t)handle >= objects.size()) {
-           objects.resize(handle + 1024, ManagedObject());
+        if (nextIndex > HANDLE_INDEX_MASK) {
+            cc_error("Managed object pool is full: too many objects");
+            return 0;
+        }
+        index = nextIndex++;
+        if ((size_t)index >= objects.size()) {
+            AddSlots(1024);
         }
     }
 
     objectCreationCounter++;
-    return Add(handle, address, callback, obj_type);   
+    return Add(objects[index].handle, address, callback, obj_type);
 }
 
 int ManagedObjectPool::AddUnserializedObject(void *address, IScriptObject *callback,
     ScriptValueType obj_type, int handle) 
 {
-    if (handle < 1) { cc_error("Attempt to assign invalid handle: %d", handle); return 0; }
-    if ((size_t)handle >= objects.size()) {
-        objects.resize(handle + 1024, ManagedObject());
+    if (handle < 1 || HandleIndex(handle) == 0) { cc_error("Attempt to assign invalid handle: %d", handle); return 0; }
+    const int32_t index = HandleIndex(handle);
+    if ((size_t)index >= objects.size()) {
+        AddSlots(index + 1024 - objects.size());
     }
 
     return Add(handle, address, callback, obj_type);
@@ -181,10 +241,10 @@ void ManagedObjectPool::WriteToDisk(Stream *out) {
     serializeBuffer.resize(SERIALIZE_BUFFER_SIZE);
 
     out->WriteInt32(OBJECT_CACHE_MAGIC_NUMBER);
-    out->WriteInt32(2);  // version
+    out->WriteInt32(OBJECT_CACHE_VERSION);
 
     int size = 0;
-    for (int i = 1; i < nextHandle; i++) {
+    for (int i = 1; i < nextIndex; i++) {
         auto const & o = objects[i];
         if (o.isUsed()) { 
             size += 1;
@@ -192,7 +252,7 @@ void ManagedObjectPool::WriteToDisk(Stream *out) {
     }
     out->WriteInt32(size);
 
-    for (int i = 1; i < nextHandle; i++) {
+    for (int i = 1; i < nextIndex; i++) {
         auto const & o = objects[i];
         if (!o.isUsed()) { continue; }
 
@@ -251,6 +311,7 @@ int ManagedObjectPool::ReadFromDisk(Stream *in, ICCObjectCollectionReader *reade
             }
             break;
         case 2:
+        case 3: // same layout, handles may have the generation bits
             {
                 // This is actually number of objects written.
                 int objectsSize = in->ReadInt32();
@@ -266,8 +327,8 @@ int ManagedObjectPool::ReadFromDisk(Stream *in, ICCObjectCollectionReader *reade
                     in->Read(&serializeBuffer.front(), numBytes);
                     // Delegate work to ICCObjectReader
                     reader->Unserialize(handle, typeNameBuffer, &serializeBuffer.front(), numBytes);
-                    objects[handle].refCount = in->ReadInt32();
-                    ManagedObjectLog("Read handle = %d", objects[i].handle);
+                    objects[HandleIndex(handle)].refCount = in->ReadInt32();
+                    ManagedObjectLog("Read handle = %d", handle);
                 }
             }
             break;
@@ -277,17 +338,24 @@ int ManagedObjectPool::ReadFromDisk(Stream *in, ICCObjectCollectionReader *reade
     }
 
     // re-adjust next handles. (in case saved in random order)
-    available_ids = std::queue<int32_t>();
-    nextHandle = 1;
+    freeSlots.clear();
+    gcCandidates.clear();
+    nextIndex = 1;
 
     for (const auto &o : objects) {
         if (o.isUsed()) { 
-            nextHandle = o.handle + 1;
+            nextIndex = HandleIndex(o.handle) + 1;
         }
     }
-    for (int i = 1; i < nextHandle; i++) {
-        if (!objects[i].isUsed()) {
-            available_ids.push(i);
+    // push in reverse, so that the lower indexes are reused first
+    for (int i = nextIndex - 1; i >= 1; i--) {
+        auto &o = objects[i];
+        if (!o.isUsed()) {
+            freeSlots.push_back(i);
+        } else {
+            o.gcCandidate = false;
+            if (o.refCount < 1)
+                AddGCCandidate(o);
         }
     }
 
@@ -296,16 +364,22 @@ int ManagedObjectPool::ReadFromDisk(Stream *in, ICCObjectCollectionReader *reade
 
 // de-allocate all objects
 void ManagedObjectPool::reset() {
-    for (int i = 1; i < nextHandle; i++) {
+    for (int i = 1; i < nextIndex; i++) {
         auto & o = objects[i];
         if (!o.isUsed()) { continue; }
         Remove(o, true);
     }
-    available_ids = std::queue<int32_t>();
-    nextHandle = 1;
+    // freed slots keep their generations, so the old handles stay invalid
+    freeSlots.clear();
+    gcCandidates.clear();
+    nextIndex = 1;
 }
 
-ManagedObjectPool::ManagedObjectPool() : objectCreationCounter(0), nextHandle(1), available_ids(), objects(RESERVED_SIZE, ManagedObject()), handleByAddress() {
+ManagedObjectPool::ManagedObjectPool() : objectCreationCounter(0), nextIndex(1), handleByAddress() {
+    AddSlots(RESERVED_SIZE);
+    freeSlots.reserve(RESERVED_SIZE);
+    gcCandidates.reserve(RESERVED_SIZE);
+    gcWorkList.reserve(RESERVED_SIZE);
     handleByAddress.reserve(RESERVED_SIZE);
 }
 
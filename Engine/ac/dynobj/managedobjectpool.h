@@ -16,7 +16,6 @@
 #define __CC_MANAGEDOBJECTPOOL_H
 
 #include <vector>
-#include <queue>
 #include <unordered_map>
 
 #include "core/platform.h"
@@ -26,31 +25,65 @@
 namespace AGS { namespace Common { class Stream; }}
 using namespace AGS; // FIXME later
 
+// Managed object handles are made of the object's slot index in the pool,
+// and the slot's generation, which is increased each time the slot is freed;
+// this way a stale handle is never mistaken for a new object in the same slot.
 struct ManagedObjectPool final {
 private:
-    // TODO: find out if we can make handle size_t
+    static const int32_t HANDLE_INDEX_BITS = 24;
+    static const int32_t HANDLE_INDEX_MASK = (1 << HANDLE_INDEX_BITS) - 1;
+    // 7 bits, so that the handles stay positive
+    static const int32_t HANDLE_GEN_MASK = 0x7F;
+
+    static int32_t HandleIndex(int32_t handle) { return handle & HANDLE_INDEX_MASK; }
+    static int32_t MakeHandle(int32_t index, int32_t gen)
+        { return index | ((gen & HANDLE_GEN_MASK) << HANDLE_INDEX_BITS); }
+
     struct ManagedObject {
         ScriptValueType obj_type;
+        // for a free slot this is the handle that will be given to the next object
         int32_t handle;
         void *addr;
         IScriptObject *callback;
         int refCount;
+        // whether the object is in the garbage collection list
+        bool gcCandidate;
+        // whether the object is in the address map, having no handle slot
+        bool addressMapped;
 
         bool isUsed() const { return obj_type != kScValUndefined; }
 
         ManagedObject() 
-            : obj_type(kScValUndefined), handle(0), addr(nullptr), callback(nullptr), refCount(0) {}
+            : obj_type(kScValUndefined), handle(0), addr(nullptr), callback(nullptr), refCount(0), gcCandidate(false), addressMapped(false) {}
         ManagedObject(ScriptValueType obj_type, int32_t handle, void *addr, IScriptObject * callback) 
-            : obj_type(obj_type), handle(handle), addr(addr), callback(callback), refCount(0) {}
+            : obj_type(obj_type), handle(handle), addr(addr), callback(callback), refCount(0), gcCandidate(false), addressMapped(false) {}
     };
 
     int objectCreationCounter;  // used to do garbage collection every so often
 
-    int32_t nextHandle {}; // TODO: manage nextHandle's going over INT32_MAX !
-    std::queue<int32_t> available_ids;
+    int32_t nextIndex {}; // first slot index that was never used
+    std::vector<int32_t> freeSlots; // indexes of the released slots
     std::vector<ManagedObject> objects;
+    // Objects that may be disposed during next garbage collection:
+    // the ones that were not referenced yet, or whose refcount dropped
+    // to zero but could not be disposed at that moment
+    std::vector<int32_t> gcCandidates;
+    std::vector<int32_t> gcWorkList;
+    // Handles of the objects which cannot keep one in their own memory:
+    // the built-in game objects and the plugin objects
     std::unordered_map<void*, int32_t> handleByAddress;
 
+    // Returns the used object slot for the handle, or null if handle is not valid
+    inline ManagedObject *GetObject(int32_t handle) {
+        const int32_t index = HandleIndex(handle);
+        if (handle < 1 || (size_t)index >= objects.size()) { return nullptr; }
+        auto &o = objects[index];
+        return (o.isUsed() && o.handle == handle) ? &o : nullptr;
+    }
+    void AddSlots(size_t count);
+    void AddGCCandidate(ManagedObject &o);
+    // Finds the used object slot by address, or returns null
+    ManagedObject *FindObject(void *addr);
     int  Add(int handle, void *address, IScriptObject *callback, ScriptValueType obj_type);
     int  Remove(ManagedObject &o, bool force = false);
     void RunGarbageCollection();
@@ -61,6 +94,9 @@ public:
     int CheckDispose(int32_t handle);
     int32_t SubRef(int32_t handle);
     int32_t AddressToHandle(void *addr);
+    // Finds handle by address, using the object's own handle storage if
+    // the manager provides one; manager must not be a plugin object
+    int32_t AddressToHandle(void *addr, IScriptObject *manager);
     void* HandleToAddress(int32_t handle);
     ScriptValueType HandleToAddressAndManager(int32_t handle, void *&object, IScriptObject *&manager);
     int RemoveObject(void *address);
@@ -57,11 +57,38 @@ void ScriptDrawingSurface::FinishedDrawingReadOnly()
 }
 
 void ScriptDrawingSurface::FinishedDrawing()
+{
+    Bitmap *ds = GetBitmapSurface();
+    FinishedDrawing(RectWH(0, 0, ds->GetWidth(), ds->GetHeight()));
+}
+
+void ScriptDrawingSurface::FinishedDrawing(const Rect &rc)
 {
     FinishedDrawingReadOnly();
+    Bitmap *ds = GetBitmapSurface();
+    const Rect clip_rc = IntersectRects(RectWH(0, 0, ds->GetWidth(), ds->GetHeight()), rc);
+    if (clip_rc.IsEmpty())
+        return; // nothing was drawn on the surface
+    if (!modified)
+        modifiedRect = clip_rc;
+    else if (!modifiedRect.IsEmpty()) // empty rect with modified flag means whole surface
+        modifiedRect = SumRects(modifiedRect, clip_rc);
     modified = 1;
 }
 
+Rect ScriptDrawingSurface::GetModifiedRect()
+{
+    if (!modified)
+        return Rect();
+    if (modifiedRect.IsEmpty())
+    {
+        // modified part is not known (e.g. after restoring a save)
+        Bitmap *ds = GetBitmapSurface();
+        return RectWH(0, 0, ds->GetWidth(), ds->GetHeight());
+    }
+    return modifiedRect;
+}
+
 int ScriptDrawingSurface::Dispose(void* /*address*/, bool /*force*/) {
 
     // dispose the drawing surface
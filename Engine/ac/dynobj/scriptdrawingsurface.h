@@ -17,6 +17,7 @@
 #include "ac/dynobj/cc_agsdynamicobject.h"
 #include "game/roomstruct.h"
 #include "gfx/bitmap.h"
+#include "util/geometry.h"
 #include "util/stream.h"
 
 struct ScriptDrawingSurface final : AGSCCDynamicObject {
@@ -32,6 +33,9 @@ struct ScriptDrawingSurface final : AGSCCDynamicObject {
     int currentColourScript;
     int highResCoordinates;
     int modified;
+    // Part of the surface modified since it was acquired, in bitmap coordinates;
+    // may be empty while the surface is modified, which means the whole surface
+    Rect modifiedRect;
     int hasAlphaChannel;
     //Common::Bitmap* abufBackup;
 
@@ -44,8 +48,13 @@ struct ScriptDrawingSurface final : AGSCCDynamicObject {
     void SizeToGameResolution(int *width, int *height);
     void SizeToGameResolution(int *adjustValue);
     void SizeToDataResolution(int *adjustValue);
+    // Marks the whole surface as modified
     void FinishedDrawing();
+    // Marks the given rectangle of the surface as modified
+    void FinishedDrawing(const Rect &rc);
     void FinishedDrawingReadOnly();
+    // Gets the modified part of the surface, or an empty rect if it was not modified
+    Rect GetModifiedRect();
 
     ScriptDrawingSurface();
 
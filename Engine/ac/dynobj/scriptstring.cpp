@@ -12,67 +12,200 @@
 //
 //=============================================================================
 #include "ac/dynobj/scriptstring.h"
+#include <memory>
 #include <stdlib.h>
 #include <string.h>
-#include "ac/string.h"
+#include <unordered_map>
+#include <vector>
 #include "ac/dynobj/dynobj_manager.h"
 #include "util/stream.h"
+#include "util/string_types.h"
 
 using namespace AGS::Common;
 
+extern ScriptString myScriptStringImpl;
 
-DynObjectRef ScriptString::CreateString(const char *fromText) {
-    return CreateNewScriptStringObj(fromText);
+namespace
+{
+
+// Block sizes of the slab size classes, including the string's header
+const size_t SizeClasses[] = { 32, 48, 64, 96, 128, 192, 256 };
+const size_t NumSizeClasses = sizeof(SizeClasses) / sizeof(SizeClasses[0]);
+// Number of blocks allocated at once for a size class
+const size_t SlabChunkBlocks = 128;
+
+// Slab keeps the free blocks of a single size class in a linked list.
+// The memory is allocated in chunks of multiple blocks, which are never
+// returned to the system, but reused by the new strings.
+class Slab
+{
+public:
+    void *Alloc(size_t block_size)
+    {
+        if (!_free)
+        {
+            uint8_t *chunk = new uint8_t[block_size * SlabChunkBlocks];
+            _chunks.emplace_back(chunk);
+            for (size_t i = SlabChunkBlocks; i > 0; --i)
+                Free(chunk + (i - 1) * block_size);
+        }
+        FreeBlock *block = _free;
+        _free = block->Next;
+        return block;
+    }
+
+    void Free(void *block)
+    {
+        FreeBlock *free_block = static_cast<FreeBlock*>(block);
+        free_block->Next = _free;
+        _free = free_block;
+    }
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock *Next;
+    };
+
+    FreeBlock *_free = nullptr;
+    std::vector<std::unique_ptr<uint8_t[]>> _chunks;
+};
+
+Slab Slabs[NumSizeClasses];
+
+// Text of the interned string, used as a key without copying it
+struct TextKey
+{
+    const char *Text;
+    size_t Len;
+
+    TextKey(const char *text, size_t len) : Text(text), Len(len) {}
+};
+
+struct TextKeyHash
+{
+    size_t operator()(const TextKey &key) const { return FNV::Hash(key.Text, key.Len); }
+};
+
+struct TextKeyEqual
+{
+    bool operator()(const TextKey &k1, const TextKey &k2) const
+    {
+        return (k1.Len == k2.Len) && (memcmp(k1.Text, k2.Text, k1.Len) == 0);
+    }
+};
+
+// Interned strings, the keys point to the texts of the strings themselves
+std::unordered_map<TextKey, char*, TextKeyHash, TextKeyEqual> InternedStrings;
+
+} // namespace
+
+
+const char *ScriptString::TypeName = "String";
+
+/* static */ char *ScriptString::AllocBuffer(size_t len)
+{
+    const size_t block_size = MemHeaderSz + len + 1;
+    uint8_t *block;
+    uint8_t size_class = 0u;
+    for (; size_class < NumSizeClasses && SizeClasses[size_class] < block_size; ++size_class);
+    if (size_class < NumSizeClasses)
+    {
+        block = static_cast<uint8_t*>(Slabs[size_class].Alloc(SizeClasses[size_class]));
+    }
+    else
+    {
+        block = new uint8_t[block_size];
+        size_class = HeapBlock;
+    }
+    Header &hdr = *new (block) Header();
+    hdr.Length = static_cast<uint32_t>(len);
+    hdr.SizeClass = size_class;
+    char *buffer = reinterpret_cast<char*>(block + MemHeaderSz);
+    buffer[len] = 0;
+    return buffer;
 }
 
-int ScriptString::Dispose(void* /*address*/, bool /*force*/) {
-    // always dispose
-    if (_text) {
-        free(_text);
-        _text = nullptr;
+/* static */ void ScriptString::FreeBuffer(char *buffer)
+{
+    uint8_t *block = reinterpret_cast<uint8_t*>(buffer) - MemHeaderSz;
+    const uint8_t size_class = GetHeader(buffer).SizeClass;
+    if (size_class == HeapBlock)
+        delete[] block;
+    else
+        Slabs[size_class].Free(block);
+}
+
+/* static */ DynObjectRef ScriptString::Register(char *buffer)
+{
+    int32_t handle = ccRegisterManagedObject(buffer, &myScriptStringImpl);
+    if (handle == 0)
+    {
+        FreeBuffer(buffer);
+        return DynObjectRef();
     }
-    delete this;
-    return 1;
+    return DynObjectRef(handle, buffer, &myScriptStringImpl);
 }
 
-const char *ScriptString::GetType() {
-    return "String";
+/* static */ DynObjectRef ScriptString::Create(const char *text)
+{
+    const size_t len = strlen(text);
+    char *buffer = AllocBuffer(len);
+    memcpy(buffer, text, len + 1);
+    return Register(buffer);
 }
 
-size_t ScriptString::CalcSerializeSize(void* /*address*/)
+/* static */ DynObjectRef ScriptString::CreateInterned(const char *text)
 {
-    return _len + 1 + sizeof(int32_t);
+    const size_t len = strlen(text);
+    auto it = InternedStrings.find(TextKey(text, len));
+    if (it != InternedStrings.end())
+        return DynObjectRef(GetHeader(it->second).Handle, it->second, &myScriptStringImpl);
+
+    char *buffer = AllocBuffer(len);
+    memcpy(buffer, text, len + 1);
+    DynObjectRef ref = Register(buffer);
+    if (ref.Obj)
+    {
+        reinterpret_cast<Header&>(*(buffer - MemHeaderSz)).Interned = true;
+        InternedStrings.insert(std::make_pair(TextKey(buffer, len), buffer));
+    }
+    return ref;
 }
 
-void ScriptString::Serialize(void* /*address*/, Stream *out) {
-    const auto *cstr = _text ? _text : "";
-    out->WriteInt32(_len);
-    out->Write(cstr, _len + 1);
+DynObjectRef ScriptString::CreateString(const char *fromText) {
+    return CreateInterned(fromText);
 }
 
-void ScriptString::Unserialize(int index, Stream *in, size_t /*data_sz*/) {
-    _len = in->ReadInt32();
-    _text = (char*)malloc(_len + 1);
-    in->Read(_text, _len + 1);
-    _text[_len] = 0; // for safety
-    ccRegisterUnserializedObject(index, _text, this);
+int ScriptString::Dispose(void *address, bool /*force*/) {
+    // always dispose
+    char *text = static_cast<char*>(address);
+    const Header &hdr = GetHeader(text);
+    if (hdr.Interned)
+        InternedStrings.erase(TextKey(text, hdr.Length));
+    FreeBuffer(text);
+    return 1;
 }
 
-ScriptString::ScriptString(const char *text) {
-    _len = strlen(text);
-    _text = (char*)malloc(_len + 1);
-    memcpy(_text, text, _len + 1);
+const char *ScriptString::GetType() {
+    return TypeName;
 }
 
-ScriptString::ScriptString(char *text, bool take_ownership) {
-    _len = strlen(text);
-    if (take_ownership)
-    {
-        _text = text;
-    }
-    else
-    {
-        _text = (char*)malloc(_len + 1);
-        memcpy(_text, text, _len + 1);
-    }
+size_t ScriptString::CalcSerializeSize(void *address)
+{
+    return GetHeader(address).Length + 1 + sizeof(int32_t);
+}
+
+void ScriptString::Serialize(void *address, Stream *out) {
+    const Header &hdr = GetHeader(address);
+    out->WriteInt32(hdr.Length);
+    out->Write(address, hdr.Length + 1);
+}
+
+void ScriptString::Unserialize(int index, Stream *in, size_t /*data_sz*/) {
+    const size_t len = static_cast<uint32_t>(in->ReadInt32());
+    char *buffer = AllocBuffer(len);
+    in->Read(buffer, len + 1);
+    buffer[len] = 0; // for safety
+    ccRegisterUnserializedObject(index, buffer, this);
 }
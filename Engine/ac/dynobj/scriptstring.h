@@ -11,23 +11,65 @@
 // http://www.opensource.org/licenses/artistic-license-2.0.php
 //
 //=============================================================================
+//
+// ScriptString is the managed String object manager. The text of each
+// string is stored in a single memory block, right after a small header;
+// the blocks for the short strings are taken from the size-classed slabs,
+// while the long ones are allocated on the heap.
+//
+// The strings created from the script literals are interned: while there's
+// a String with the same text made this way, it is reused instead of
+// creating a new one.
+//
+//=============================================================================
 #ifndef __AC_SCRIPTSTRING_H
 #define __AC_SCRIPTSTRING_H
 
 #include "ac/dynobj/cc_agsdynamicobject.h"
 
 struct ScriptString final : AGSCCDynamicObject, ICCStringClass {
+public:
+    static const char *TypeName;
+
+    struct Header
+    {
+        uint32_t Length = 0u; // in bytes, not including the null terminator
+        // Managed handle of this object
+        int32_t Handle = 0;
+        // Index of the slab size class, or HeapBlock
+        uint8_t SizeClass = 0u;
+        // Whether the string is registered in the interned strings
+        bool Interned = false;
+    };
+
+    inline static const Header &GetHeader(const void *address)
+    {
+        return reinterpret_cast<const Header&>(*(static_cast<const uint8_t*>(address) - MemHeaderSz));
+    }
+
+    // Allocates the text buffer for a new string of the given length in
+    // bytes; the caller must fill it, along with the null terminator, and
+    // then pass to Register()
+    static char *AllocBuffer(size_t len);
+    // Registers the filled text buffer as a new managed string
+    static DynObjectRef Register(char *buffer);
+    // Creates a new managed string, copying the text
+    static DynObjectRef Create(const char *text);
+    // Creates a managed string, or reuses an existing interned one with the same text
+    static DynObjectRef CreateInterned(const char *text);
+
     int Dispose(void *address, bool force) override;
     const char *GetType() override;
     void Unserialize(int index, AGS::Common::Stream *in, size_t data_sz) override;
+    // Handle is kept in the string's header
+    int32_t *GetHandleSlot(void *address) override
+    {
+        return &reinterpret_cast<Header&>(*(static_cast<uint8_t*>(address) - MemHeaderSz)).Handle;
+    }
 
+    // Creates strings from the script literals
     DynObjectRef CreateString(const char *fromText) override;
 
-    ScriptString() = default;
-    ScriptString(const char *text);
-    ScriptString(char *text, bool take_ownership);
-    char *GetTextPtr() const { return _text; }
-
 protected:
     // Calculate and return required space for serialization, in bytes
     size_t CalcSerializeSize(void *address) override;
@@ -35,10 +77,10 @@ protected:
     void Serialize(void *address, AGS::Common::Stream *out) override;
 
 private:
-    // TODO: the preallocated text buffer may be assigned externally;
-    // find out if it's possible to refactor while keeping same functionality
-    char *_text = nullptr;
-    size_t _len = 0;
+    static const size_t MemHeaderSz = sizeof(Header);
+    static const uint8_t HeapBlock = UINT8_MAX;
+
+    static void FreeBuffer(char *buffer);
 };
 
-#endif // __AC_SCRIPTSTRING_H
\ No newline at end of file
+#endif // __AC_SCRIPTSTRING_H
@@ -36,6 +36,8 @@ public:
         // enough. Since this interface is also a part of Plugin API, we would
         // need more significant change to program before we could use different
         // approach.
+        // Managed handle of this object
+        int32_t Handle = 0;
     };
 
     ScriptUserObject() = default;
@@ -53,6 +55,11 @@ public:
     const char *GetType() override;
     int Dispose(void *address, bool force) override;
     void Unserialize(int index, AGS::Common::Stream *in, size_t data_sz) override;
+    // Handle is kept in the object's header
+    int32_t *GetHandleSlot(void *address) override
+    {
+        return &reinterpret_cast<Header&>(*(static_cast<uint8_t*>(address) - MemHeaderSz)).Handle;
+    }
 
 private:
     // The size of the array's header in memory, prepended to the element data
@@ -23,6 +23,7 @@
 #include "ac/runtime_defines.h"
 #include "ac/string.h"
 #include "ac/dynobj/dynobj_manager.h"
+#include "ac/dynobj/scriptstring.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
 #include "platform/base/agsplatformdriver.h"
@@ -173,10 +174,12 @@ const char* File_ReadStringBack(sc_File *fil) {
     return CreateNewScriptString("");;
   }
 
-  char *retVal = (char*)malloc(lle);
+  // the length includes the null terminator
+  char *retVal = ScriptString::AllocBuffer(lle - 1);
   in->Read(retVal, lle);
+  retVal[lle - 1] = 0;
 
-  return CreateNewScriptString(retVal, false);
+  return (const char*)ScriptString::Register(retVal).Obj;
 }
 
 int File_ReadInt(sc_File *fil) {
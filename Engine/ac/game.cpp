@@ -1399,11 +1399,9 @@ void get_message_text (int msnum, char *buffer, char giveErr) {
     replace_tokens(get_translation(thisroom.Messages[msnum].GetCStr()), buffer, maxlen);
 }
 
-void game_sprite_updated(int sprnum, bool deleted)
+// Marks GUI and controls which display the given sprite for redraw
+static void gui_sprite_updated(int sprnum)
 {
-    // Notify draw system about dynamic sprite change
-    notify_sprite_changed(sprnum, deleted);
-
     // GUI still have a special draw route, so cannot rely on object caches;
     // will have to do a per-GUI and per-control check.
     //
@@ -1433,6 +1431,19 @@ void game_sprite_updated(int sprnum, bool deleted)
     }
 }
 
+void game_sprite_updated(int sprnum, bool deleted)
+{
+    // Notify draw system about dynamic sprite change
+    notify_sprite_changed(sprnum, deleted);
+    gui_sprite_updated(sprnum);
+}
+
+void game_sprite_updated(int sprnum, const Rect &dirty)
+{
+    notify_sprite_changed(sprnum, dirty);
+    gui_sprite_updated(sprnum);
+}
+
 //=============================================================================
 //
 // Script API Functions
@@ -21,6 +21,7 @@
 
 #include "ac/dynobj/scriptviewframe.h"
 #include "main/game_file.h"
+#include "util/geometry.h"
 #include "util/string.h"
 
 // Forward declaration
@@ -195,6 +196,8 @@ void get_message_text (int msnum, char *buffer, char giveErr = 1);
 // Notifies the game objects that certain sprite was updated.
 // This make them update their render states, caches, and so on.
 void game_sprite_updated(int sprnum, bool deleted = false);
+// Notifies the game objects that only the given rect of the sprite was changed.
+void game_sprite_updated(int sprnum, const Rect &dirty);
 
 extern int in_new_room;
 extern int new_room_pos;
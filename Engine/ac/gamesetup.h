@@ -16,6 +16,7 @@
 
 #include "ac/game_version.h"
 #include "ac/sys_events.h"
+#include "core/assetmanager.h"
 #include "main/graphics_mode.h"
 #include "util/string.h"
 
@@ -63,6 +64,7 @@ struct GameSetup
     static const size_t DefTexCacheSize = (128 * 1024); // 128 MB
     static const size_t DefSoundLoadAtOnce = 1024; // 1 MB
     static const size_t DefSoundCache = 1024u * 32; // 32 MB
+    static const size_t DefRoomPreloadBudget = 1024u * 16; // 16 MB
 
 
     bool  audio_enabled;
@@ -98,15 +100,27 @@ struct GameSetup
     //
     bool  RenderAtScreenRes; // render sprites at screen resolution, as opposed to native one
     int   Supersampling;
+    int   RenderThreads = 1; // number of threads for drawing sprites, 0 = number of CPU cores
+    bool  RenderUnlocked = false; // render frames between the game updates, interpolating the positions
+    int   PathfindThreads = 1; // number of threads for searching batched routes, 0 = number of CPU cores, 1 = no batching
     size_t SpriteCacheSize = DefSpriteCacheSize; // in KB
+    bool  SpriteAsyncLoad = true; // load sprites in background ahead of their use
+    size_t RoomPreloadBudget = DefRoomPreloadBudget; // max memory for preloading room sprites, in KB
     size_t TextureCacheSize = DefTexCacheSize; // in KB
     size_t SoundLoadAtOnceSize = DefSoundLoadAtOnce; // threshold for loading sounds immediately, in KB
     size_t SoundCacheSize = DefSoundCache; // sound cache limit, in KB
     bool  clear_cache_on_room_change; // for low-end devices: clear resource caches on room change
+    AGS::Common::AssetAccessMode AssetAccess = AGS::Common::kAssetAccessBuffered; // how to read assets from the game packages
     bool  load_latest_save; // load latest saved game on launch
     ScreenRotation rotation;
     bool  show_fps;
     bool  multitasking = false; // whether run on background, when game is switched out
+    bool  legacy_script_exec = false; // execute the original script byte-code (for debugging)
+    bool  script_profiler = false; // collect script execution stats and write them on exit
+    int   BenchmarkFrames = 0; // run the game headless for this number of frames and print timings
+    String BenchmarkInput; // file with the input events to simulate during benchmark
+    String InputRecordFile; // file to record the player input into
+    String InputReplayFile; // file to replay the recorded player input from
 
     DisplayModeSetup Screen;
     String software_render_driver;
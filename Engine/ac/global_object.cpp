@@ -28,6 +28,7 @@
 #include "ac/object.h"
 #include "ac/properties.h"
 #include "ac/roomobject.h"
+#include "ac/route_finder.h"
 #include "ac/roomstatus.h"
 #include "ac/string.h"
 #include "ac/viewframe.h"
@@ -249,6 +250,9 @@ void AnimateObjectImpl(int obn, int loopn, int spdd, int rept, int direction, in
     debug_script_log("Obj %d start anim view %d loop %d, speed %d, repeat %d, frame %d",
         obn, obj.view + 1, loopn, spdd, rept, sframe);
 
+    // Request the rest of the loop to be loaded while the first frame is shown
+    prefetch_view_loop(obj.view, loopn);
+
     obj.set_animating(rept, direction == 0, spdd);
     obj.loop = (uint16_t)loopn;
     obj.frame = (uint16_t)SetFirstAnimFrame(obj.view, loopn, sframe, direction);
@@ -314,6 +318,7 @@ void StopObjectMoving(int objj) {
     if (!is_valid_object(objj))
         quit("!StopObjectMoving: invalid object number");
     objs[objj].moving = 0;
+    cancel_queued_route(objj + 1);
 
     debug_script_log("Object %d stop moving", objj);
 }
@@ -449,13 +449,17 @@ void move_object(int objj,int tox,int toy,int spee,int ignwal) {
 
     set_route_move_speed(spee, spee);
     set_color_depth(8);
-    int mslot=find_route(objX, objY, tox, toy, prepare_walkable_areas(-1), objj+1, 1, ignwal);
+    // the route may be searched for later, if the route batch is open
+    queue_route(objX, objY, tox, toy, prepare_walkable_areas(-1), objj+1, 1, ignwal,
+        [objj, ignwal](int mslot)
+        {
+            if (mslot>0) {
+                objs[objj].moving = mslot;
+                mls[mslot].direct = ignwal;
+                convert_move_path_to_room_resolution(&mls[mslot]);
+            }
+        });
     set_color_depth(game.GetColorDepth());
-    if (mslot>0) {
-        objs[objj].moving = mslot;
-        mls[mslot].direct = ignwal;
-        convert_move_path_to_room_resolution(&mls[mslot]);
-    }
 }
 
 void Object_RunInteraction(ScriptObject *objj, int mode) {
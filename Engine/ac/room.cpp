@@ -39,15 +39,20 @@
 #include "ac/room.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
+#include "ac/route_finder.h"
 #include "ac/screen.h"
 #include "ac/string.h"
 #include "ac/system.h"
+#include "ac/timer.h"
+#include "ac/view.h"
 #include "ac/walkablearea.h"
 #include "ac/walkbehind.h"
 #include "ac/dynobj/scriptobject.h"
 #include "ac/dynobj/scripthotspot.h"
 #include "ac/dynobj/dynobj_manager.h"
+#include "gui/guibutton.h"
 #include "gui/guimain.h"
+#include "gui/guislider.h"
 #include "script/cc_instance.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
@@ -78,6 +83,7 @@ extern RoomStatus*croom;
 extern RoomStatus troom;    // used for non-saveable rooms, eg. intro
 extern int displayed_room;
 extern RoomObject*objs;
+extern std::vector<ViewStruct> views;
 extern AGSPlatformDriver *platform;
 extern int done_es_error;
 extern int our_eip;
@@ -260,6 +266,136 @@ void save_room_data_segment () {
 
 }
 
+// Collects sprites which the room is likely to display right away:
+// room objects, current views of the characters in the room, and GUI graphics;
+// the list is ordered by the expected order of use
+static void collect_room_sprites(std::vector<sprkey_t> &sprites)
+{
+    std::vector<bool> added(spriteset.GetSpriteSlotCount());
+    auto add_sprite = [&sprites, &added](int sprnum)
+    {
+        if ((sprnum > 0) && ((size_t)sprnum < added.size()) && !added[sprnum])
+        {
+            sprites.push_back(sprnum);
+            added[sprnum] = true;
+        }
+    };
+    auto add_view_loop = [&add_sprite](int view, int loop)
+    {
+        if ((view < 0) || (view >= game.numviews) ||
+            (loop < 0) || (loop >= views[view].numLoops))
+            return;
+        for (int i = 0; i < views[view].loops[loop].numFrames; ++i)
+            add_sprite(views[view].loops[loop].frames[i].pic);
+    };
+
+    // Current images first
+    for (uint32_t i = 0; i < croom->numobj; ++i)
+    {
+        if (objs[i].on)
+            add_sprite(objs[i].num);
+    }
+    for (int i = 0; i < game.numcharacters; ++i)
+    {
+        const CharacterInfo &chinfo = game.chars[i];
+        if ((chinfo.room == displayed_room) && chinfo.on)
+            add_view_loop(chinfo.view, chinfo.loop);
+    }
+    for (const auto &gui : guis)
+    {
+        if (!gui.IsDisplayed())
+            continue;
+        add_sprite(gui.BgImage);
+        for (int i = 0; i < gui.GetControlCount(); ++i)
+        {
+            const int ctrl_id = gui.GetControlID(i);
+            switch (gui.GetControlType(i))
+            {
+            case kGUIButton:
+                add_sprite(guibuts[ctrl_id].Image);
+                add_sprite(guibuts[ctrl_id].MouseOverImage);
+                add_sprite(guibuts[ctrl_id].PushedImage);
+                break;
+            case kGUISlider:
+                add_sprite(guislider[ctrl_id].BgImage);
+                add_sprite(guislider[ctrl_id].HandleImage);
+                break;
+            default: break;
+            }
+        }
+    }
+    // Then the animations which may start soon
+    for (uint32_t i = 0; i < croom->numobj; ++i)
+    {
+        if (objs[i].on && (objs[i].view != RoomObject::NoView))
+            add_view_loop(objs[i].view, objs[i].loop);
+    }
+    for (int i = 0; i < game.numcharacters; ++i)
+    {
+        const CharacterInfo &chinfo = game.chars[i];
+        if ((chinfo.room != displayed_room) || !chinfo.on ||
+            (chinfo.view < 0) || (chinfo.view >= game.numviews))
+            continue;
+        for (int loop = 0; loop < views[chinfo.view].numLoops; ++loop)
+            add_view_loop(chinfo.view, loop);
+    }
+}
+
+// Loads the room's sprites and creates their textures in advance,
+// so that the first frames after the room change do not stall;
+// stops when the configured memory budget is exhausted
+static void preload_room_sprites()
+{
+    if (usetup.RoomPreloadBudget == 0)
+        return;
+
+    const auto t_start = AGS_Clock::now();
+    std::vector<sprkey_t> sprites;
+    collect_room_sprites(sprites);
+    // Let the background loader (if enabled) work ahead of us
+    for (const auto sprnum : sprites)
+        spriteset.Prefetch(sprnum);
+
+    // Never use more than a half of the sprite cache, or preloaded
+    // sprites will start pushing out each other
+    const size_t budget = std::min(usetup.RoomPreloadBudget * 1024, spriteset.GetMaxCacheSize() / 2);
+    const int color_depth = game.GetColorDepth();
+    size_t used = 0u, spr_count = 0u, tx_size = 0u;
+    for (const auto sprnum : sprites)
+    {
+        if (!spriteset.DoesSpriteExist(sprnum))
+            continue;
+        const SpriteInfo &info = game.SpriteInfos[sprnum];
+        if (used + info.Width * info.Height * ((color_depth + 7) / 8) > budget)
+            break;
+        Bitmap *image = spriteset[sprnum];
+        if (!image)
+            continue;
+        used += image->GetDataSize();
+        const size_t tx_mem = texturecache_precache(sprnum);
+        used += tx_mem;
+        tx_size += tx_mem;
+        spr_count++;
+    }
+    // Hand over the sprites which were loaded in background meanwhile
+    spriteset.ProcessPrefetched();
+
+    Debug::Printf(kDbgMsg_Info, "Room %d preload: %zu of %zu sprites, %zu KB (textures: %zu KB), took %lld ms",
+        displayed_room, spr_count, sprites.size(), used / 1024, tx_size / 1024,
+        static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(AGS_Clock::now() - t_start).count()));
+}
+
+// Prints sprite cache usage in the last room, and resets the counters
+static void log_sprite_cache_stats()
+{
+    const auto stats = spriteset.GetStats();
+    Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Info,
+        "Sprite cache: %u hits, %u misses, %u waits, %u prefetched, %u in flight; size %zu / %zu KB",
+        stats.Hits, stats.Misses, stats.Waits, stats.Prefetched, stats.InFlight,
+        spriteset.GetCacheSize() / 1024, spriteset.GetMaxCacheSize() / 1024);
+    spriteset.ResetStats();
+}
+
 void unload_old_room() {
     // if switching games on restore, don't do this
     if (displayed_room < 0)
@@ -273,7 +409,10 @@ void unload_old_room() {
     run_on_event(GE_LEAVE_ROOM_AFTERFADE, RuntimeScriptValue().SetInt32(displayed_room));
 
     debug_script_log("Unloading room %d", displayed_room);
+    log_sprite_cache_stats();
 
+    // the pending walks were found on this room's walkable areas
+    clear_route_batch();
     dispose_room_drawdata();
 
     for (uint32_t ff=0;ff<croom->numobj;ff++)
@@ -878,6 +1017,7 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
         play.UpdateRoomCameras(); // update auto tracking
     }
     init_room_drawdata();
+    preload_room_sprites();
 
     our_eip = 212;
     invalidate_screen();
@@ -1001,7 +1141,9 @@ void compile_room_script() {
         quitprintf("Unable to create local script:\n%s", cc_get_error().ErrorString.GetCStr());
     }
 
-    if (!roominst->ResolveScriptImports(roominst->instanceof.get()))
+    // Room scripts are reloaded each time the room is entered, while their imports
+    // normally stay the same, so cache their resolution per room
+    if (!roominst->ResolveScriptImports(roominst->instanceof.get(), String::FromFormat("room%d", displayed_room)))
         quitprintf("Unable to resolve imports in room script:\n%s", cc_get_error().ErrorString.GetCStr());
 
     if (!roominst->ResolveImportFixups(roominst->instanceof.get()))
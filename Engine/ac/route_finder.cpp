@@ -12,12 +12,16 @@
 //
 //=============================================================================
 #include "ac/route_finder.h"
+#include <algorithm>
 #include <memory>
 #include "ac/route_finder_impl.h"
 #include "ac/route_finder_impl_legacy.h"
 #include "debug/out.h"
+#include "util/threadpool.h"
 
 using AGS::Common::Bitmap;
+using AGS::Common::ThreadPool;
+using AGS::Engine::RouteFinder::RouteRequest;
 
 class IRouteFinder 
 {
@@ -32,6 +36,20 @@ public:
     virtual void set_route_move_speed(int speed_x, int speed_y) = 0;
     virtual int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0) = 0;
     virtual void calculate_move_stage(MoveList * mlsp, int aaa) = 0;
+    // Default path finder does not keep anything between the searches
+    virtual void set_walkable_areas(Bitmap */*mask*/) {}
+    // Default batch search runs the requests one by one
+    virtual void find_route_batch(std::vector<RouteRequest> &requests, ThreadPool &/*pool*/)
+    {
+        for (auto &req : requests)
+        {
+            set_route_move_speed(req.SpeedX, req.SpeedY);
+            const int mslot = find_route(req.SrcX, req.SrcY, req.DstX, req.DstY, req.Mask.get(),
+                req.MoveList, req.NoCross, req.IgnoreWalls);
+            if (req.Callback)
+                req.Callback(mslot);
+        }
+    }
 };
 
 class AGSRouteFinder : public IRouteFinder 
@@ -69,6 +87,14 @@ public:
     { 
         AGS::Engine::RouteFinder::calculate_move_stage(mlsp, aaa); 
     }
+    void set_walkable_areas(Bitmap *mask) override
+    {
+        AGS::Engine::RouteFinder::set_walkable_areas(mask);
+    }
+    void find_route_batch(std::vector<RouteRequest> &requests, ThreadPool &pool) override
+    {
+        AGS::Engine::RouteFinder::find_route_batch(requests, pool);
+    }
 };
 
 class AGSLegacyRouteFinder : public IRouteFinder 
@@ -110,6 +136,13 @@ public:
 
 std::unique_ptr<IRouteFinder> route_finder_impl;
 
+// Route batch: requests made while it's open are searched all together
+static ThreadPool route_pool;
+static bool route_batch_open = false;
+static std::vector<RouteRequest> route_batch;
+// Last move speed, saved for the queued requests
+static int route_speed_x = 0, route_speed_y = 0;
+
 void init_pathfinder(GameDataVersion game_file_version)
 {
     if (game_file_version >= kGameVersion_350) 
@@ -128,15 +161,96 @@ void init_pathfinder(GameDataVersion game_file_version)
 
 void shutdown_pathfinder()
 {
+    route_batch_open = false;
+    route_batch.clear();
+    route_pool.Stop();
     if (route_finder_impl)
         route_finder_impl->shutdown_pathfinder();
 }
 
+void set_route_thread_count(int count)
+{
+    const size_t threads = (count > 0) ? static_cast<size_t>(count) : ThreadPool::GetHardwareThreads();
+    route_pool.Start(threads - 1);
+    if (route_pool.GetWorkerCount() > 0)
+        AGS::Common::Debug::Printf(AGS::Common::MessageType::kDbgMsg_Info,
+            "Path finder: batching route requests, using %zu threads", route_pool.GetWorkerCount() + 1);
+}
+
+void begin_route_batch()
+{
+    // there's no gain in queuing requests if they will be searched one by one anyway
+    route_batch_open = route_pool.GetWorkerCount() > 0;
+}
+
+void end_route_batch()
+{
+    route_batch_open = false;
+}
+
+void apply_route_batch()
+{
+    if (route_batch.empty())
+        return;
+    // the callbacks may request new routes, which will be queued for the next batch
+    std::vector<RouteRequest> requests;
+    std::swap(requests, route_batch);
+    route_finder_impl->find_route_batch(requests, route_pool);
+    // keep the allocated storage for the next batch
+    requests.clear();
+    if (route_batch.empty())
+        std::swap(requests, route_batch);
+}
+
+void cancel_queued_route(int movlst)
+{
+    route_batch.erase(std::remove_if(route_batch.begin(), route_batch.end(),
+        [movlst](const RouteRequest &req) { return req.MoveList == movlst; }), route_batch.end());
+}
+
+void clear_route_batch()
+{
+    route_batch.clear();
+}
+
+void queue_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross, int ignore_walls,
+    const std::function<void(int)> &callback)
+{
+    // the newer request for the same move list overrides the queued one
+    cancel_queued_route(movlst);
+    if (!route_batch_open)
+    {
+        callback(find_route(srcx, srcy, xx, yy, onscreen, movlst, nocross, ignore_walls));
+        return;
+    }
+
+    RouteRequest req;
+    req.SrcX = srcx;
+    req.SrcY = srcy;
+    req.DstX = xx;
+    req.DstY = yy;
+    req.MoveList = movlst;
+    req.NoCross = nocross;
+    req.IgnoreWalls = ignore_walls;
+    req.SpeedX = route_speed_x;
+    req.SpeedY = route_speed_y;
+    // the mask is rebuilt for each requester, so make a copy
+    req.Mask.reset(AGS::Common::BitmapHelper::CreateBitmapCopy(onscreen, 8));
+    req.Callback = callback;
+    route_batch.push_back(std::move(req));
+}
+
 void set_wallscreen(Bitmap *wallscreen)
 {
     route_finder_impl->set_wallscreen(wallscreen);
 }
 
+void set_route_walkable_areas(Bitmap *mask)
+{
+    if (route_finder_impl)
+        route_finder_impl->set_walkable_areas(mask);
+}
+
 int can_see_from(int x1, int y1, int x2, int y2)
 {
     return route_finder_impl->can_see_from(x1, y1, x2, y2);
@@ -149,6 +263,8 @@ void get_lastcpos(int &lastcx, int &lastcy)
 
 void set_route_move_speed(int speed_x, int speed_y)
 {
+    route_speed_x = speed_x;
+    route_speed_y = speed_y;
     route_finder_impl->set_route_move_speed(speed_x, speed_y);
 }
 
@@ -15,6 +15,7 @@
 #ifndef __AC_ROUTEFND_H
 #define __AC_ROUTEFND_H
 
+#include <functional>
 #include "ac/game_version.h"
 
 // Forward declaration
@@ -25,6 +26,9 @@ void init_pathfinder(GameDataVersion game_file_version);
 void shutdown_pathfinder();
 
 void set_wallscreen(AGS::Common::Bitmap *wallscreen);
+// Sets the room's walkable areas, without any blocking characters or objects;
+// the path finder may keep its navigation data for these until they change
+void set_route_walkable_areas(AGS::Common::Bitmap *mask);
 
 int can_see_from(int x1, int y1, int x2, int y2);
 void get_lastcpos(int &lastcx, int &lastcy);
@@ -34,4 +38,25 @@ void set_route_move_speed(int speed_x, int speed_y);
 int find_route(short srcx, short srcy, short xx, short yy, AGS::Common::Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0);
 void calculate_move_stage(MoveList * mlsp, int aaa);
 
+// Sets the number of threads used for searching batched routes,
+// 0 means as many as there are CPU cores; batching is off with 1 thread
+void set_route_thread_count(int count);
+// Opens the route batch: the routes requested with queue_route
+// are not searched for until apply_route_batch is called
+void begin_route_batch();
+// Closes the route batch; the queued routes stay pending
+void end_route_batch();
+// Searches for all the pending routes in parallel, then fills their
+// move lists and passes results to their callbacks, in the order they
+// were requested
+void apply_route_batch();
+// Drops the pending route for the given move list, if there's one
+void cancel_queued_route(int movlst);
+// Drops all the pending routes
+void clear_route_batch();
+// Finds the route like find_route, and passes the result to the callback;
+// if the route batch is open, then this is postponed until it's applied
+void queue_route(short srcx, short srcy, short xx, short yy, AGS::Common::Bitmap *onscreen, int movlst, int nocross, int ignore_walls,
+    const std::function<void(int)> &callback);
+
 #endif // __AC_ROUTEFND_H
\ No newline at end of file
@@ -26,6 +26,7 @@
 #include "ac/common_defines.h"
 #include "gfx/bitmap.h"
 #include "debug/out.h"
+#include "util/threadpool.h"
 
 #include "route_finder_jps.inl"
 
@@ -45,16 +46,69 @@ static const int MAXNAVPOINTS = MAXNEEDSTAGES;
 static int navpoints[MAXNAVPOINTS];
 static int num_navpoints;
 static fixed move_speed_x, move_speed_y;
-static Navigation nav;
 static Bitmap *wallscreen;
 static int lastcx, lastcy;
 
+// Room's walkable areas, as last set by set_walkable_areas()
+static std::vector<uint8_t> walkareas;
+static int walkareas_width = 0, walkareas_height = 0;
+// Incremented each time the walkable areas change, 0 is never used
+static uint32_t walkareas_version = 1;
+
+// Navigation, and the copy of the walkable areas it is based on;
+// the mask passed for each route has the blocking characters and objects
+// cut out, these are set as navigation blockers and don't touch the copy
+struct NavContext
+{
+  Navigation nav;
+  std::vector<uint8_t> navmap;
+  int navmap_width = 0, navmap_height = 0;
+  // Version of the walkable areas the navigation map was synced with,
+  // 0 if it was changed since
+  uint32_t navmap_version = 0;
+  // Path buffers, kept to avoid reallocations
+  std::vector<int> path, cpath;
+};
+
+static NavContext main_nav;
+// Contexts for the batched searches, one per parallel job
+static std::vector<std::unique_ptr<NavContext>> batch_navs;
+
+// Cache of the recently found routes, most recent first;
+// only valid for the same walkable areas and blockers
+struct CachedRoute
+{
+  uint32_t map_version = 0;
+  std::vector<Navigation::BlockRect> blockers;
+  int fromx = 0, fromy = 0, destx = 0, desty = 0;
+  bool found = false;
+  std::vector<int> navpoints;
+};
+static const size_t ROUTE_CACHE_SIZE = 32;
+static std::vector<CachedRoute> route_cache;
+
+static void reset_navmap()
+{
+  main_nav.navmap.clear();
+  main_nav.navmap_width = main_nav.navmap_height = 0;
+  main_nav.navmap_version = 0;
+  walkareas.clear();
+  walkareas_width = walkareas_height = 0;
+  route_cache.clear();
+}
+
 void init_pathfinder()
 {
+  main_nav.nav.SetUseJumpTables(true);
+  reset_navmap();
 }
 
 void shutdown_pathfinder()
 {
+  main_nav.nav.SetUseJumpTables(false);
+  main_nav.nav.Resize(0, 0);
+  reset_navmap();
+  batch_navs.clear();
 }
 
 void set_wallscreen(Bitmap *wallscreen_) 
@@ -62,26 +116,165 @@ void set_wallscreen(Bitmap *wallscreen_)
   wallscreen = wallscreen_;
 }
 
-static void sync_nav_wallscreen()
+void set_walkable_areas(Bitmap *mask)
 {
-  // FIXME: this is dumb, but...
-  nav.Resize(wallscreen->GetWidth(), wallscreen->GetHeight());
+  const int width = mask->GetWidth();
+  const int height = mask->GetHeight();
+  bool changed = (width != walkareas_width) || (height != walkareas_height);
+  walkareas_width = width;
+  walkareas_height = height;
+  walkareas.resize(width * height);
+  for (int y = 0; y < height; y++)
+  {
+    uint8_t *dst = &walkareas[y * width];
+    if (changed || (memcmp(dst, mask->GetScanLine(y), width) != 0))
+    {
+      memcpy(dst, mask->GetScanLine(y), width);
+      changed = true;
+    }
+  }
+  if (changed && (++walkareas_version == 0))
+    walkareas_version = 1;
+}
 
-  for (int y=0; y<wallscreen->GetHeight(); y++)
-    nav.SetMapRow(y, wallscreen->GetScanLine(y));
+// Copies the rows into the navigation map, passing only the differences
+// to the navigation, unless the map size changes
+static void sync_nav_rows(NavContext &ctx, int width, int height,
+  const std::function<const uint8_t*(int)> &get_row)
+{
+  Navigation &nav = ctx.nav;
+  std::vector<uint8_t> &navmap = ctx.navmap;
+  if ((width != ctx.navmap_width) || (height != ctx.navmap_height))
+  {
+    ctx.navmap_width = width;
+    ctx.navmap_height = height;
+    navmap.resize(width * height);
+    nav.Resize(width, height);
+    for (int y = 0; y < height; y++)
+    {
+      memcpy(&navmap[y * width], get_row(y), width);
+      nav.SetMapRow(y, &navmap[y * width]);
+    }
+    nav.MapChanged(0, 0, width - 1, height - 1);
+    return;
+  }
+
+  for (int y = 0; y < height; y++)
+  {
+    const uint8_t *src = get_row(y);
+    uint8_t *dst = &navmap[y * width];
+    if (memcmp(src, dst, width) == 0)
+      continue;
+    int x0 = 0, x1 = width - 1;
+    for (; src[x0] == dst[x0]; ++x0);
+    for (; src[x1] == dst[x1]; --x1);
+    memcpy(dst + x0, src + x0, x1 - x0 + 1);
+    nav.MapChanged(x0, y, x1, y);
+  }
 }
 
-int can_see_from(int x1, int y1, int x2, int y2)
+// Syncs the navigation with the walkable areas, and sets the cells
+// which are cut out of the given mask as blockers
+static void sync_nav_map(NavContext &ctx, Bitmap *mask)
+{
+  const int width = mask->GetWidth();
+  const int height = mask->GetHeight();
+  if ((ctx.navmap_version != walkareas_version) ||
+      (width != ctx.navmap_width) || (height != ctx.navmap_height))
+  {
+    if ((width == walkareas_width) && (height == walkareas_height))
+      sync_nav_rows(ctx, width, height, [width](int y) { return &walkareas[y * width]; });
+    else // walkable areas were not set for this mask, so use the mask itself
+      sync_nav_rows(ctx, width, height, [mask](int y) { return mask->GetScanLine(y); });
+    ctx.navmap_version = walkareas_version;
+  }
+
+  Navigation &nav = ctx.nav;
+  nav.ClearBlockers();
+  for (int y = 0; y < height; y++)
+  {
+    const uint8_t *src = mask->GetScanLine(y);
+    uint8_t *dst = &ctx.navmap[y * width];
+    if (memcmp(src, dst, width) == 0)
+      continue;
+    for (int x = 0; x < width;)
+    {
+      if (src[x] == dst[x])
+      {
+        ++x;
+      }
+      else if (src[x] != 0)
+      {
+        // walkable in the mask: the walkable areas were changed without
+        // telling us, so fix the copy, and resync it on the next search
+        if (dst[x] == 0)
+          nav.MapChanged(x, y, x, y);
+        dst[x] = src[x];
+        ctx.navmap_version = 0;
+        ++x;
+      }
+      else
+      {
+        const int x0 = x;
+        for (; (x < width) && (src[x] == 0) && (dst[x] != 0); ++x);
+        nav.AddBlockedSpan(y, x0, x - 1);
+      }
+    }
+  }
+}
+
+static const CachedRoute *find_cached_route(int fromx, int fromy, int destx, int desty)
+{
+  for (size_t i = 0; i < route_cache.size(); ++i)
+  {
+    const CachedRoute &route = route_cache[i];
+    if ((route.map_version == main_nav.navmap_version) &&
+        (route.fromx == fromx) && (route.fromy == fromy) &&
+        (route.destx == destx) && (route.desty == desty) &&
+        (route.blockers == main_nav.nav.GetBlockers()))
+    {
+      // move to front
+      std::rotate(route_cache.begin(), route_cache.begin() + i, route_cache.begin() + i + 1);
+      return &route_cache.front();
+    }
+  }
+  return nullptr;
+}
+
+static void add_cached_route(int fromx, int fromy, int destx, int desty, bool found,
+  const int *points, int num_points)
+{
+  if (route_cache.size() < ROUTE_CACHE_SIZE)
+    route_cache.emplace_back();
+  // reuse the least recently used entry
+  std::rotate(route_cache.begin(), route_cache.end() - 1, route_cache.end());
+  CachedRoute &route = route_cache.front();
+  route.map_version = main_nav.navmap_version;
+  route.blockers = main_nav.nav.GetBlockers();
+  route.fromx = fromx;
+  route.fromy = fromy;
+  route.destx = destx;
+  route.desty = desty;
+  route.found = found;
+  route.navpoints.assign(points, points + num_points);
+}
+
+static int trace_line(NavContext &ctx, Bitmap *mask, int x1, int y1, int x2, int y2, int &lastx, int &lasty)
 {
-  lastcx = x1;
-  lastcy = y1;
+  lastx = x1;
+  lasty = y1;
 
   if ((x1 == x2) && (y1 == y2))
     return 1;
 
-  sync_nav_wallscreen();
+  sync_nav_map(ctx, mask);
 
-  return !nav.TraceLine(x1, y1, x2, y2, lastcx, lastcy);
+  return !ctx.nav.TraceLine(x1, y1, x2, y2, lastx, lasty);
+}
+
+int can_see_from(int x1, int y1, int x2, int y2)
+{
+  return trace_line(main_nav, wallscreen, x1, y1, x2, y2, lastcx, lastcy);
 }
 
 void get_lastcpos(int &lastcx_, int &lastcy_) 
@@ -90,19 +283,33 @@ void get_lastcpos(int &lastcx_, int &lastcy_)
   lastcy_ = lastcy;
 }
 
-// new routing using JPS
-static int find_route_jps(int fromx, int fromy, int destx, int desty)
+// new routing using JPS; writes navpoints and returns their number,
+// or 0 if there's no route; the found routes are only cached for the main context
+static int find_route_jps(NavContext &ctx, Bitmap *mask, int fromx, int fromy, int destx, int desty, int *points)
 {
-  sync_nav_wallscreen();
+  sync_nav_map(ctx, mask);
 
-  static std::vector<int> path, cpath;
+  // version 0 means that the map may not match any walkable areas
+  const bool use_cache = (&ctx == &main_nav) && (ctx.navmap_version != 0);
+  const CachedRoute *cached = use_cache ? find_cached_route(fromx, fromy, destx, desty) : nullptr;
+  if (cached)
+  {
+    std::copy(cached->navpoints.begin(), cached->navpoints.end(), points);
+    return static_cast<int>(cached->navpoints.size());
+  }
+
+  std::vector<int> &path = ctx.path, &cpath = ctx.cpath;
   path.clear();
   cpath.clear();
 
-  if (nav.NavigateRefined(fromx, fromy, destx, desty, path, cpath) == Navigation::NAV_UNREACHABLE)
+  if (ctx.nav.NavigateRefined(fromx, fromy, destx, desty, path, cpath) == Navigation::NAV_UNREACHABLE)
+  {
+    if (use_cache)
+      add_cached_route(fromx, fromy, destx, desty, false, points, 0);
     return 0;
+  }
 
-  num_navpoints = 0;
+  int num_points = 0;
 
   // new behavior: cut path if too complex rather than abort with error message
   int count = std::min<int>((int)cpath.size(), MAXNAVPOINTS);
@@ -110,12 +317,14 @@ static int find_route_jps(int fromx, int fromy, int destx, int desty)
   for (int i = 0; i<count; i++)
   {
     int x, y;
-    nav.UnpackSquare(cpath[i], x, y);
+    ctx.nav.UnpackSquare(cpath[i], x, y);
 
-    navpoints[num_navpoints++] = MAKE_INTCOORD(x, y);
+    points[num_points++] = MAKE_INTCOORD(x, y);
   }
 
-  return 1;
+  if (use_cache)
+    add_cached_route(fromx, fromy, destx, desty, true, points, num_points);
+  return num_points;
 }
 
 void set_route_move_speed(int speed_x, int speed_y)
@@ -214,47 +423,50 @@ void calculate_move_stage(MoveList * mlsp, int aaa)
 }
 
 
-int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross, int ignore_walls)
+// Searches for the route on the given navigation context and walkable mask;
+// writes navpoints and returns their number, or 0 if there's no route
+static int search_route(NavContext &ctx, Bitmap *mask, int srcx, int srcy, int xx, int yy,
+  int nocross, int ignore_walls, int *points, int &lastx, int &lasty)
 {
-  int i;
+  if (ignore_walls || trace_line(ctx, mask, srcx, srcy, xx, yy, lastx, lasty))
+  {
+    points[0] = MAKE_INTCOORD(srcx, srcy);
+    points[1] = MAKE_INTCOORD(xx, yy);
+    return 2;
+  }
 
-  wallscreen = onscreen;
+  if ((nocross == 0) && (mask->GetPixel(xx, yy) == 0))
+    return 0; // clicked on a wall
 
-  num_navpoints = 0;
+  return find_route_jps(ctx, mask, srcx, srcy, xx, yy, points);
+}
 
-  if (ignore_walls || can_see_from(srcx, srcy, xx, yy))
-  {
-    num_navpoints = 2;
-    navpoints[0] = MAKE_INTCOORD(srcx, srcy);
-    navpoints[1] = MAKE_INTCOORD(xx, yy);
-  } else {
-    if ((nocross == 0) && (wallscreen->GetPixel(xx, yy) == 0))
-      return 0; // clicked on a wall
-
-    find_route_jps(srcx, srcy, xx, yy);
-  }
+// Fills the move list with the found navpoints, using current move speed
+static int fill_move_list(int srcx, int srcy, int movlst, int *points, int num_points)
+{
+  int i;
 
-  if (!num_navpoints)
+  if (!num_points)
     return 0;
 
   // FIXME: really necessary?
-  if (num_navpoints == 1)
-    navpoints[num_navpoints++] = navpoints[0];
+  if (num_points == 1)
+    points[num_points++] = points[0];
 
-  assert(num_navpoints <= MAXNAVPOINTS);
+  assert(num_points <= MAXNAVPOINTS);
 
 #ifdef DEBUG_PATHFINDER
-  AGS::Common::Debug::Printf("Route from %d,%d to %d,%d - %d stages", srcx,srcy,xx,yy,num_navpoints);
+  AGS::Common::Debug::Printf("Route from %d,%d - %d stages", srcx,srcy,num_points);
 #endif
 
   int mlist = movlst;
-  mls[mlist].numstage = num_navpoints;
-  memcpy(&mls[mlist].pos[0], &navpoints[0], sizeof(int) * num_navpoints);
+  mls[mlist].numstage = num_points;
+  memcpy(&mls[mlist].pos[0], &points[0], sizeof(int) * num_points);
 #ifdef DEBUG_PATHFINDER
-  AGS::Common::Debug::Printf("stages: %d\n",num_navpoints);
+  AGS::Common::Debug::Printf("stages: %d\n",num_points);
 #endif
 
-  for (i=0; i<num_navpoints-1; i++)
+  for (i=0; i<num_points-1; i++)
     calculate_move_stage(&mls[mlist], i);
 
   mls[mlist].fromx = srcx;
@@ -267,6 +479,51 @@ int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int
   return mlist;
 }
 
+int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross, int ignore_walls)
+{
+  wallscreen = onscreen;
+
+  num_navpoints = search_route(main_nav, wallscreen, srcx, srcy, xx, yy, nocross, ignore_walls,
+    navpoints, lastcx, lastcy);
+  return fill_move_list(srcx, srcy, movlst, navpoints, num_navpoints);
+}
+
+void find_route_batch(std::vector<RouteRequest> &requests, AGS::Common::ThreadPool &pool)
+{
+  // Each job has its own navigation context, and takes every Nth request;
+  // the found routes do not depend on which context was used
+  const size_t job_count = std::min(requests.size(), pool.GetWorkerCount() + 1);
+  for (size_t i = batch_navs.size(); i < job_count; ++i)
+  {
+    batch_navs.emplace_back(new NavContext());
+    batch_navs.back()->nav.SetUseJumpTables(true);
+  }
+
+  const size_t max_points = MAXNAVPOINTS;
+  std::vector<int> points(requests.size() * max_points);
+  std::vector<int> num_points(requests.size());
+  pool.RunParallel(job_count, [&](size_t job)
+  {
+    NavContext &ctx = *batch_navs[job];
+    for (size_t i = job; i < requests.size(); i += job_count)
+    {
+      const RouteRequest &req = requests[i];
+      int lastx, lasty;
+      num_points[i] = search_route(ctx, req.Mask.get(), req.SrcX, req.SrcY, req.DstX, req.DstY,
+        req.NoCross, req.IgnoreWalls, &points[i * max_points], lastx, lasty);
+    }
+  });
+
+  for (size_t i = 0; i < requests.size(); ++i)
+  {
+    const RouteRequest &req = requests[i];
+    set_route_move_speed(req.SpeedX, req.SpeedY);
+    const int mslot = fill_move_list(req.SrcX, req.SrcY, req.MoveList, &points[i * max_points], num_points[i]);
+    if (req.Callback)
+      req.Callback(mslot);
+  }
+}
+
 
 } // namespace RouteFinder
 } // namespace Engine
@@ -15,10 +15,14 @@
 #ifndef __AC_ROUTE_FINDER_IMPL
 #define __AC_ROUTE_FINDER_IMPL
 
+#include <functional>
+#include <memory>
+#include <vector>
 #include "ac/game_version.h"
+#include "gfx/bitmap.h"
 
 // Forward declaration
-namespace AGS { namespace Common { class Bitmap; }}
+namespace AGS { namespace Common { class ThreadPool; }}
 struct MoveList;
 
 namespace AGS {
@@ -29,6 +33,7 @@ void init_pathfinder();
 void shutdown_pathfinder();
 
 void set_wallscreen(AGS::Common::Bitmap *wallscreen);
+void set_walkable_areas(AGS::Common::Bitmap *mask);
 
 int can_see_from(int x1, int y1, int x2, int y2);
 void get_lastcpos(int &lastcx, int &lastcy);
@@ -38,6 +43,23 @@ void set_route_move_speed(int speed_x, int speed_y);
 int find_route(short srcx, short srcy, short xx, short yy, AGS::Common::Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0);
 void calculate_move_stage(MoveList * mlsp, int aaa);
 
+// A queued route search, which has its own copy of the walkable mask
+struct RouteRequest
+{
+    short SrcX = 0, SrcY = 0, DstX = 0, DstY = 0;
+    int MoveList = 0;
+    int NoCross = 0;
+    int IgnoreWalls = 0;
+    int SpeedX = 0, SpeedY = 0;
+    std::unique_ptr<AGS::Common::Bitmap> Mask;
+    // Receives the result of find_route
+    std::function<void(int)> Callback;
+};
+
+// Searches for all the requested routes, using the pool threads; then fills
+// the move lists and runs the callbacks, strictly in the order of requests
+void find_route_batch(std::vector<RouteRequest> &requests, AGS::Common::ThreadPool &pool);
+
 } // namespace RouteFinder
 } // namespace Engine
 } // namespace AGS
@@ -23,6 +23,7 @@
 #include <functional>
 #include <assert.h>
 #include <stddef.h>
+#include <string.h>
 #include <math.h>
 
 // TODO: this could be cleaned up/simplified ...
@@ -30,6 +31,15 @@
 // further optimizations possible:
 //    - forward refinement should use binary search
 
+// Orthogonal jumps may be looked up in the precomputed tables instead of
+// testing each map cell in turn: for each cell and direction, a table tells
+// how many steps there are to the next jump point, or to the wall.
+// The tables persist between the searches, and are updated only for the
+// parts of the map which were reported as changed.
+// Cells may also be blocked for the time of a search (e.g. under the blocking
+// characters) without changing the map; the tables do not know about these,
+// so the runs which pass near a blocked cell are tested cell by cell.
+
 class Navigation
 {
 public:
@@ -59,6 +69,28 @@ public:
 
 	inline void SetMapRow(int y, const unsigned char *row) {map[y] = row;}
 
+	// enables or disables use of the jump tables
+	void SetUseJumpTables(bool use);
+	// tells that the map cells in the given rectangle were changed,
+	// jump tables will be updated before the next search
+	void MapChanged(int x0, int y0, int x1, int y1);
+
+	// rectangle of the blocked cells, inclusive
+	struct BlockRect
+	{
+		int x0, y0, x1, y1;
+
+		inline bool operator ==(const BlockRect &b) const
+		{
+			return x0 == b.x0 && y0 == b.y0 && x1 == b.x1 && y1 == b.y1;
+		}
+	};
+
+	// makes the walkable cells in the row span unwalkable, until ClearBlockers
+	void AddBlockedSpan(int y, int x0, int x1);
+	void ClearBlockers();
+	inline const std::vector<BlockRect> &GetBlockers() const {return blockRects;}
+
 	inline static int PackSquare(int x, int y);
 	inline static void UnpackSquare(int sq, int &x, int &y);
 
@@ -134,6 +166,45 @@ private:
 
 	bool navLock;
 
+	// jump table direction indexes
+	enum
+	{
+		JUMP_RIGHT,
+		JUMP_LEFT,
+		JUMP_DOWN,
+		JUMP_UP,
+		JUMP_NUM_DIRS
+	};
+
+	// jump table entry is a number of steps, with a flag telling
+	// whether it ends on a jump point, or right before the wall
+	static const unsigned short JUMP_STEPS_MASK = 0x7fff;
+	static const unsigned short JUMP_POINT_FLAG = 0x8000;
+
+	bool useJumpTables;
+	std::vector<unsigned short> jumpTables[JUMP_NUM_DIRS];
+	// rows and columns, which jump tables have to be recalculated
+	std::vector<bool> dirtyRows, dirtyColumns;
+	bool jumpTablesDirty;
+
+	// blocked cells flags, and the rectangles made of them
+	std::vector<unsigned char> blocked;
+	std::vector<BlockRect> blockRects;
+	// whether blocked cells are tested, off while updating the jump tables
+	bool checkBlocked;
+
+	static inline int JumpDir(int dx, int dy)
+	{
+		return dx > 0 ? JUMP_RIGHT : (dx < 0 ? JUMP_LEFT : (dy > 0 ? JUMP_DOWN : JUMP_UP));
+	}
+
+	bool CanUseJumpTables() const;
+	bool IsRunBlocked(int x, int y, int dx, int dy) const;
+	void UpdateJumpTables();
+	void UpdateRowJumps(int y);
+	void UpdateColumnJumps(int x);
+	int FindOrthoJumpInTable(int x, int y, int dx, int dy, int ex, int ey);
+
 	void IncFrameId();
 
 	// outside map test
@@ -190,6 +261,9 @@ Navigation::Navigation()
 	// no diagonal route - this should correspond to what AGS does
 	, nodiag(true)
 	, navLock(false)
+	, useJumpTables(false)
+	, jumpTablesDirty(false)
+	, checkBlocked(false)
 {
 }
 
@@ -202,6 +276,234 @@ void Navigation::Resize(int width, int height)
 
 	map.resize(mapHeight);
 	mapNodes.resize(size);
+	blocked.assign(size, 0);
+	blockRects.clear();
+	checkBlocked = false;
+
+	if (useJumpTables)
+	{
+		for (int i=0; i<JUMP_NUM_DIRS; i++)
+			jumpTables[i].resize(size);
+
+		MapChanged(0, 0, mapWidth-1, mapHeight-1);
+	}
+}
+
+bool Navigation::CanUseJumpTables() const
+{
+	// jump lengths must fit into the table entries
+	return useJumpTables && mapWidth <= JUMP_STEPS_MASK && mapHeight <= JUMP_STEPS_MASK;
+}
+
+void Navigation::SetUseJumpTables(bool use)
+{
+	if (use == useJumpTables)
+		return;
+
+	useJumpTables = use;
+
+	if (use)
+	{
+		Resize(mapWidth, mapHeight);
+	}
+	else
+	{
+		for (int i=0; i<JUMP_NUM_DIRS; i++)
+			std::vector<unsigned short>().swap(jumpTables[i]);
+
+		dirtyRows.clear();
+		dirtyColumns.clear();
+		jumpTablesDirty = false;
+	}
+}
+
+void Navigation::MapChanged(int x0, int y0, int x1, int y1)
+{
+	if (!useJumpTables)
+		return;
+
+	dirtyRows.resize(mapHeight);
+	dirtyColumns.resize(mapWidth);
+
+	// forced neighbors are tested on the adjacent rows and columns too
+	x0 = iclamp(x0-1, 0, mapWidth-1);
+	x1 = iclamp(x1+1, 0, mapWidth-1);
+	y0 = iclamp(y0-1, 0, mapHeight-1);
+	y1 = iclamp(y1+1, 0, mapHeight-1);
+
+	for (int y=y0; y<=y1; y++)
+		dirtyRows[y] = true;
+
+	for (int x=x0; x<=x1; x++)
+		dirtyColumns[x] = true;
+
+	jumpTablesDirty = true;
+}
+
+void Navigation::AddBlockedSpan(int y, int x0, int x1)
+{
+	assert(!Outside(x0, y) && !Outside(x1, y) && x0 <= x1);
+
+	memset(&blocked[y*mapWidth+x0], 1, x1-x0+1);
+	checkBlocked = true;
+
+	// blockers are usually rectangles, so join the span with the one above
+	for (int i=(int)blockRects.size()-1; i>=0; i--)
+	{
+		BlockRect &r = blockRects[i];
+
+		if (r.y1 == y-1 && r.x0 == x0 && r.x1 == x1)
+		{
+			r.y1 = y;
+			return;
+		}
+	}
+
+	BlockRect r = {x0, y, x1, y};
+	blockRects.push_back(r);
+}
+
+void Navigation::ClearBlockers()
+{
+	for (const BlockRect &r : blockRects)
+	{
+		for (int y=r.y0; y<=r.y1; y++)
+			memset(&blocked[y*mapWidth+r.x0], 0, r.x1-r.x0+1);
+	}
+
+	blockRects.clear();
+	checkBlocked = false;
+}
+
+// Tells if the run from the given cell, as stored in the jump table,
+// may be changed by the blocked cells: that is if any of them is on the run,
+// on the cell which ends it, or next to them
+bool Navigation::IsRunBlocked(int x, int y, int dx, int dy) const
+{
+	if (!checkBlocked)
+		return false;
+
+	int steps = jumpTables[JumpDir(dx, dy)][y*mapWidth+x] & JUMP_STEPS_MASK;
+	int x0 = x+dx, x1 = x+(steps+1)*dx;
+	int y0 = y+dy, y1 = y+(steps+1)*dy;
+
+	if (dx)
+	{
+		y0 = y-1;
+		y1 = y+1;
+	}
+	else
+	{
+		x0 = x-1;
+		x1 = x+1;
+	}
+
+	if (x0 > x1)
+		std::swap(x0, x1);
+
+	if (y0 > y1)
+		std::swap(y0, y1);
+
+	for (const BlockRect &r : blockRects)
+	{
+		if (r.x0 <= x1 && r.x1 >= x0 && r.y0 <= y1 && r.y1 >= y0)
+			return true;
+	}
+
+	return false;
+}
+
+void Navigation::UpdateJumpTables()
+{
+	if (!jumpTablesDirty)
+		return;
+
+	// the tables are made for the map itself
+	bool check = checkBlocked;
+	checkBlocked = false;
+
+	for (int y=0; y<mapHeight; y++)
+	{
+		if (dirtyRows[y])
+		{
+			UpdateRowJumps(y);
+			dirtyRows[y] = false;
+		}
+	}
+
+	for (int x=0; x<mapWidth; x++)
+	{
+		if (dirtyColumns[x])
+		{
+			UpdateColumnJumps(x);
+			dirtyColumns[x] = false;
+		}
+	}
+
+	jumpTablesDirty = false;
+	checkBlocked = check;
+}
+
+// Each entry is based on the entry of the next cell in the same direction,
+// so the row or column is walked backwards
+void Navigation::UpdateRowJumps(int y)
+{
+	unsigned short *right = &jumpTables[JUMP_RIGHT][y*mapWidth];
+	unsigned short *left = &jumpTables[JUMP_LEFT][y*mapWidth];
+
+	for (int x=mapWidth-1; x>=0; x--)
+	{
+		int nx = x+1;
+
+		if (!Passable(nx, y))
+			right[x] = 0;
+		else if (HasForcedNeighbor(nx, y, 1, 0))
+			right[x] = 1 | JUMP_POINT_FLAG;
+		else
+			right[x] = right[nx] + 1;
+	}
+
+	for (int x=0; x<mapWidth; x++)
+	{
+		int nx = x-1;
+
+		if (!Passable(nx, y))
+			left[x] = 0;
+		else if (HasForcedNeighbor(nx, y, -1, 0))
+			left[x] = 1 | JUMP_POINT_FLAG;
+		else
+			left[x] = left[nx] + 1;
+	}
+}
+
+void Navigation::UpdateColumnJumps(int x)
+{
+	std::vector<unsigned short> &down = jumpTables[JUMP_DOWN];
+	std::vector<unsigned short> &up = jumpTables[JUMP_UP];
+
+	for (int y=mapHeight-1; y>=0; y--)
+	{
+		int ny = y+1;
+
+		if (!Passable(x, ny))
+			down[y*mapWidth+x] = 0;
+		else if (HasForcedNeighbor(x, ny, 0, 1))
+			down[y*mapWidth+x] = 1 | JUMP_POINT_FLAG;
+		else
+			down[y*mapWidth+x] = down[ny*mapWidth+x] + 1;
+	}
+
+	for (int y=0; y<mapHeight; y++)
+	{
+		int ny = y-1;
+
+		if (!Passable(x, ny))
+			up[y*mapWidth+x] = 0;
+		else if (HasForcedNeighbor(x, ny, 0, -1))
+			up[y*mapWidth+x] = 1 | JUMP_POINT_FLAG;
+		else
+			up[y*mapWidth+x] = up[ny*mapWidth+x] + 1;
+	}
 }
 
 void Navigation::IncFrameId()
@@ -236,7 +538,7 @@ inline bool Navigation::Outside(int x, int y) const
 inline bool Navigation::Walkable(int x, int y) const
 {
 	// invert condition because of AGS
-	return map[y][x] != 0;
+	return map[y][x] != 0 && !(checkBlocked && blocked[y*mapWidth+x]);
 }
 
 bool Navigation::Passable(int x, int y) const
@@ -285,6 +587,9 @@ int Navigation::FindOrthoJump(int x, int y, int dx, int dy, int ex, int ey)
 {
 	assert((!dx || !dy) && (dx || dy));
 
+	if (CanUseJumpTables() && !IsRunBlocked(x, y, dx, dy))
+		return FindOrthoJumpInTable(x, y, dx, dy, ex, ey);
+
 	for (;;)
 	{
 		x += dx;
@@ -310,6 +615,43 @@ int Navigation::FindOrthoJump(int x, int y, int dx, int dy, int ex, int ey)
 	return -1;
 }
 
+// Same as FindOrthoJump, but gets the length of the run from the jump table
+int Navigation::FindOrthoJumpInTable(int x, int y, int dx, int dy, int ex, int ey)
+{
+	assert(Passable(x, y));
+
+	unsigned short jump = jumpTables[JumpDir(dx, dy)][y*mapWidth+x];
+	int steps = jump & JUMP_STEPS_MASK;
+
+	if (!steps)
+		return -1;
+
+	// position of the target along the run
+	int t = dx ? (ex - x) * dx : (ey - y) * dy;
+	bool onRun = dx ? (ey == y) : (ex == x);
+
+	// distance to the target falls and then grows along the run,
+	// so the closest cell is the only one that may update the closest node
+	int ct = iclamp(t, 1, steps);
+	int cx = x + ct*dx;
+	int cy = y + ct*dy;
+	int edist = ClosestDist(cx - ex, cy - ey);
+
+	if (edist < closest)
+	{
+		closest = edist;
+		cnode = PackSquare(cx, cy);
+	}
+
+	if (onRun && t >= 1 && t <= steps)
+		return PackSquare(ex, ey);
+
+	if (jump & JUMP_POINT_FLAG)
+		return PackSquare(x + steps*dx, y + steps*dy);
+
+	return -1;
+}
+
 int Navigation::FindJump(int x, int y, int dx, int dy, int ex, int ey)
 {
 	if (!(dx && dy))
@@ -351,6 +693,9 @@ Navigation::NavResult Navigation::Navigate(int sx, int sy, int ex, int ey, std::
 {
 	IncFrameId();
 
+	if (CanUseJumpTables())
+		UpdateJumpTables();
+
 	if (!Passable(sx, sy))
 	{
 		opath.clear();
@@ -46,19 +46,27 @@ const char* String_Copy(const char *srcString) {
     return CreateNewScriptString(srcString);
 }
 
+// Registers the filled buffer, allocated by ScriptString::AllocBuffer, as a new script string
+static const char *CreateNewScriptStringFromBuffer(char *buffer) {
+    return (const char*)ScriptString::Register(buffer).Obj;
+}
+
 const char* String_Append(const char *thisString, const char *extrabit) {
-    char *buffer = (char*)malloc(strlen(thisString) + strlen(extrabit) + 1);
-    strcpy(buffer, thisString);
-    strcat(buffer, extrabit);
-    return CreateNewScriptString(buffer, false);
+    size_t len1 = strlen(thisString), len2 = strlen(extrabit);
+    char *buffer = ScriptString::AllocBuffer(len1 + len2);
+    memcpy(buffer, thisString, len1);
+    memcpy(buffer + len1, extrabit, len2 + 1);
+    return CreateNewScriptStringFromBuffer(buffer);
 }
 
 const char* String_AppendChar(const char *thisString, int extraOne) {
     char chr[5]{};
     size_t chw = usetc(chr, extraOne);
-    char *buffer = (char*)malloc(strlen(thisString) + chw + 1);
-    sprintf(buffer, "%s%s", thisString, chr);
-    return CreateNewScriptString(buffer, false);
+    size_t len = strlen(thisString);
+    char *buffer = ScriptString::AllocBuffer(len + chw);
+    memcpy(buffer, thisString, len);
+    memcpy(buffer + len, chr, chw + 1);
+    return CreateNewScriptStringFromBuffer(buffer);
 }
 
 const char* String_ReplaceCharAt(const char *thisString, int index, int newChar) {
@@ -72,12 +80,12 @@ const char* String_ReplaceCharAt(const char *thisString, int index, int newChar)
     size_t old_sz = ucwidth(uchar);
     char new_chr[5]{};
     size_t new_chw = usetc(new_chr, newChar);
-    size_t total_sz = off + remain_sz + new_chw - old_sz + 1;
-    char *buffer = (char*)malloc(total_sz);
+    size_t total_len = off + remain_sz + new_chw - old_sz;
+    char *buffer = ScriptString::AllocBuffer(total_len);
     memcpy(buffer, thisString, off);
     memcpy(buffer + off, new_chr, new_chw);
     memcpy(buffer + off + new_chw, thisString + off + old_sz, remain_sz - old_sz + 1);
-    return CreateNewScriptString(buffer, false);
+    return CreateNewScriptStringFromBuffer(buffer);
 }
 
 const char* String_Truncate(const char *thisString, int length) {
@@ -88,10 +96,10 @@ const char* String_Truncate(const char *thisString, int length) {
         return thisString;
 
     size_t sz = uoffset(thisString, length);
-    char *buffer = (char*)malloc(sz + 1);
+    char *buffer = ScriptString::AllocBuffer(sz);
     memcpy(buffer, thisString, sz);
     buffer[sz] = 0;
-    return CreateNewScriptString(buffer, false);
+    return CreateNewScriptStringFromBuffer(buffer);
 }
 
 const char* String_Substring(const char *thisString, int index, int length) {
@@ -105,10 +113,10 @@ const char* String_Substring(const char *thisString, int index, int length) {
     size_t end = uoffset(thisString + start, sublen) + start;
     size_t copysz = end - start;
 
-    char *buffer = (char*)malloc(copysz + 1);
+    char *buffer = ScriptString::AllocBuffer(copysz);
     memcpy(buffer, thisString + start, copysz);
     buffer[copysz] = 0;
-    return CreateNewScriptString(buffer, false);
+    return CreateNewScriptStringFromBuffer(buffer);
 }
 
 int String_CompareTo(const char *thisString, const char *otherString, bool caseSensitive) {
@@ -193,19 +201,23 @@ const char* String_Replace(const char *thisString, const char *lookForText, cons
     }
 
     resultBuffer[outputSize] = 0; // terminate
-    return CreateNewScriptString(resultBuffer, true);
+    return CreateNewScriptString(resultBuffer);
 }
 
 const char* String_LowerCase(const char *thisString) {
-    char *buffer = ags_strdup(thisString);
+    size_t len = strlen(thisString);
+    char *buffer = ScriptString::AllocBuffer(len);
+    memcpy(buffer, thisString, len + 1);
     ustrlwr(buffer);
-    return CreateNewScriptString(buffer, false);
+    return CreateNewScriptStringFromBuffer(buffer);
 }
 
 const char* String_UpperCase(const char *thisString) {
-    char *buffer = ags_strdup(thisString);
+    size_t len = strlen(thisString);
+    char *buffer = ScriptString::AllocBuffer(len);
+    memcpy(buffer, thisString, len + 1);
     ustrupr(buffer);
-    return CreateNewScriptString(buffer, false);
+    return CreateNewScriptStringFromBuffer(buffer);
 }
 
 int String_GetChars(const char *texx, int index) {
@@ -245,34 +257,20 @@ int StrContains (const char *s1, const char *s2) {
 //=============================================================================
 
 const char *CreateNewScriptString(const String &fromText) {
-    return (const char*)CreateNewScriptStringObj(fromText.GetCStr(), true).Obj;
+    return (const char*)CreateNewScriptStringObj(fromText.GetCStr()).Obj;
 }
 
-const char *CreateNewScriptString(const char *fromText, bool reAllocate) {
-    return (const char*)CreateNewScriptStringObj(fromText, reAllocate).Obj;
+const char *CreateNewScriptString(const char *fromText) {
+    return (const char*)CreateNewScriptStringObj(fromText).Obj;
 }
 
 DynObjectRef CreateNewScriptStringObj(const String &fromText) {
-    return CreateNewScriptStringObj(fromText.GetCStr(), true);
+    return CreateNewScriptStringObj(fromText.GetCStr());
 }
 
-DynObjectRef CreateNewScriptStringObj(const char *fromText, bool reAllocate)
+DynObjectRef CreateNewScriptStringObj(const char *fromText)
 {
-    ScriptString *str;
-    if (reAllocate) {
-        str = new ScriptString(fromText);
-    }
-    else { // TODO: refactor to avoid const casts!
-        str = new ScriptString((char*)fromText, true);
-    }
-    void *obj_ptr = str->GetTextPtr();
-    int32_t handle = ccRegisterManagedObject(obj_ptr, str);
-    if (handle == 0)
-    {
-        delete str;
-        return DynObjectRef();
-    }
-    return DynObjectRef(handle, obj_ptr, str);
+    return ScriptString::Create(fromText);
 }
 
 size_t break_up_text_into_lines(const char *todis, bool apply_direction, SplitLines &lines, int wii, int fonnt, size_t max_lines) {
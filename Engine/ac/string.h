@@ -50,9 +50,9 @@ int StrContains (const char *s1, const char *s2);
 //=============================================================================
 
 const char* CreateNewScriptString(const AGS::Common::String &fromText);
-const char* CreateNewScriptString(const char *fromText, bool reAllocate = true);
+const char* CreateNewScriptString(const char *fromText);
 DynObjectRef CreateNewScriptStringObj(const AGS::Common::String &fromText);
-DynObjectRef CreateNewScriptStringObj(const char *fromText, bool reAllocate = true);
+DynObjectRef CreateNewScriptStringObj(const char *fromText);
 class SplitLines;
 // Break up the text into lines restricted by the given width;
 // returns number of lines, or 0 if text cannot be split well to fit in this width.
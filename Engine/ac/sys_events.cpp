@@ -23,6 +23,7 @@
 #include "ac/keycode.h"
 #include "ac/mouse.h"
 #include "ac/timer.h"
+#include "debug/inputrecorder.h"
 #include "device/mousew32.h"
 #include "gfx/graphicsdriver.h"
 #include "platform/base/agsplatformdriver.h"
@@ -298,10 +299,13 @@ int ags_iskeydown(eAGSKeyCode ags_key)
     if (game.options[OPT_KEYHANDLEAPI] == 0)
         SDL_PumpEvents();
 
-    const Uint8 *state = SDL_GetKeyboardState(NULL);
     SDL_Scancode scan[3];
     if (!ags_key_to_sdl_scan(ags_key, scan))
         return 0;
+    if (InputRecorder::IsReplaying())
+        return InputRecorder::IsKeyDown(scan[0]) || InputRecorder::IsKeyDown(scan[1]) ||
+            InputRecorder::IsKeyDown(scan[2]);
+    const Uint8 *state = SDL_GetKeyboardState(NULL);
     return (state[scan[0]] || state[scan[1]] || state[scan[2]]);
 }
 
@@ -1015,6 +1019,15 @@ void sys_evt_process_one(const SDL_Event &event) {
 void sys_evt_process_pending(void) {
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
+        if (InputRecorder::IsInputEvent(event)) {
+            // real player input is ignored during replay
+            if (InputRecorder::IsReplaying())
+                continue;
+            InputRecorder::RecordEvent(event);
+        }
+        sys_evt_process_one(event);
+    }
+    while (InputRecorder::PollReplayEvent(event)) {
         sys_evt_process_one(event);
     }
 }
@@ -25,6 +25,7 @@
 #include "ac/system.h"
 #include "ac/dynobj/scriptsystem.h"
 #include "debug/debug_log.h"
+#include "debug/inputrecorder.h"
 #include "debug/out.h"
 #include "gfx/graphicsdriver.h"
 #include "main/config.h"
@@ -107,20 +108,19 @@ int System_GetHardwareAcceleration()
 
 int System_GetNumLock()
 {
-    SDL_Keymod mod_state = SDL_GetModState();
+    SDL_Keymod mod_state = InputRecorder::GetModState();
     return (mod_state & KMOD_NUM) ? 1 : 0;
 }
 
 int System_GetCapsLock()
 {
-    SDL_Keymod mod_state = SDL_GetModState();
+    SDL_Keymod mod_state = InputRecorder::GetModState();
     return (mod_state & KMOD_CAPS) ? 1 : 0;
 }
 
 int System_GetScrollLock()
 {
-    const Uint8 *state = SDL_GetKeyboardState(NULL);
-    return (state[SDL_SCANCODE_SCROLLLOCK]) ? 1 : 0;
+    return InputRecorder::IsScrollLockDown() ? 1 : 0;
 }
 
 int System_GetVsync() {
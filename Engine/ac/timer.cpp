@@ -15,6 +15,7 @@
 #include "core/platform.h"
 #include <thread>
 #include "ac/sys_events.h"
+#include "debug/profiler.h"
 #include "platform/base/agsplatformdriver.h"
 #if defined(AGS_DISABLE_THREADS)
 #include "media/audio/audio_core.h"
@@ -33,6 +34,7 @@ const auto MAXIMUM_FALL_BEHIND = 3; // number of full frames
 auto tick_duration = std::chrono::microseconds(1000000LL/40);
 auto framerate = 0;
 auto framerate_maxed = false;
+auto framerate_freerun = false;
 
 auto last_tick_time = AGS_Clock::now();
 auto next_frame_timestamp = AGS_Clock::now();
@@ -41,7 +43,7 @@ auto next_frame_timestamp = AGS_Clock::now();
 
 std::chrono::microseconds GetFrameDuration()
 {
-    if (framerate_maxed) {
+    if (framerate_maxed || framerate_freerun) {
         return std::chrono::microseconds(0);
     }
     return tick_duration;
@@ -66,8 +68,23 @@ bool isTimerFpsMaxed()
     return framerate_maxed;
 }
 
+void setTimerFreeRun(bool on)
+{
+    framerate_freerun = on;
+}
+
+float GetFrameProgress()
+{
+    const auto frameDuration = GetFrameDuration();
+    if (frameDuration <= std::chrono::milliseconds::zero())
+        return 1.f;
+    return std::chrono::duration_cast<std::chrono::microseconds>(AGS_Clock::now() - last_tick_time).count()
+        / static_cast<float>(frameDuration.count());
+}
+
 void WaitForNextFrame()
 {
+    AGS_PROFILE_ZONE("Wait");
     // Do the last polls on this frame, if necessary
 #if defined(AGS_DISABLE_THREADS)
     audio_core_entry_poll();
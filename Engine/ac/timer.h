@@ -36,6 +36,12 @@ extern void WaitForNextFrame();
 extern int setTimerFps(int new_fps);
 // Tells whether maxed FPS mode is currently set
 extern bool isTimerFpsMaxed();
+// Sets the free run mode, in which the game frames are run without waiting,
+// regardless of the FPS set; the game still counts its time in frames
+extern void setTimerFreeRun(bool on);
+// Returns the time passed since the current frame's scheduled start, as a
+// fraction of the frame duration; 1 or more means that next frame is due
+extern float GetFrameProgress();
 // If more than N frames, just skip all, start a fresh.
 extern void skipMissedTicks();
 
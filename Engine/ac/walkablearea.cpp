@@ -21,6 +21,7 @@
 #include "ac/room.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
+#include "ac/route_finder.h"
 #include "ac/walkablearea.h"
 #include "game/roomstruct.h"
 #include "gfx/bitmap.h"
@@ -49,6 +50,7 @@ void redo_walkable_areas()
                 walls_scanline[w] = 0;
         }
     }
+    set_route_walkable_areas(thisroom.WalkAreaMask.get());
 }
 
 int get_walkable_area_pixel(int x, int y)
@@ -0,0 +1,232 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "debug/benchmark.h"
+#include <algorithm>
+#include <memory>
+#include <stdio.h>
+#include <vector>
+#include <SDL.h>
+#include "ac/common.h"
+#include "ac/sys_events.h"
+#include "ac/timer.h"
+#include "debug/out.h"
+#include "device/mousew32.h"
+#include "platform/base/agsplatformdriver.h"
+#include "util/file.h"
+#include "util/stream.h"
+#include "util/string_compat.h"
+#include "util/textstreamreader.h"
+
+using namespace AGS::Common;
+
+extern int frames_per_second;
+
+namespace AGS
+{
+namespace Engine
+{
+namespace Benchmark
+{
+
+enum InputEventType
+{
+    kInputKey,
+    kInputMouse,
+    kInputClick,
+    kInputWheel
+};
+
+struct InputEvent
+{
+    int Frame = 0;
+    InputEventType Type = kInputKey;
+    int Arg1 = 0;
+    int Arg2 = 0;
+};
+
+static bool Running = false;
+static bool ResultsPrinted = false;
+static int TotalFrames = 0;
+static int FrameIndex = 0;
+static std::vector<InputEvent> Input;
+static size_t NextInput = 0u;
+static AGS_Clock::time_point StartTime;
+static AGS_Clock::time_point FrameTime;
+static std::vector<float> FrameDurations; // in milliseconds
+
+static bool LoadInput(const String &input_file)
+{
+    std::unique_ptr<Stream> in(File::OpenFileRead(input_file));
+    if (!in)
+    {
+        Debug::Printf(kDbgMsg_Error, "Benchmark: failed to open input file %s", input_file.GetCStr());
+        return false;
+    }
+    TextStreamReader reader(in.get());
+    in.release(); // TextStreamReader got it
+    for (int line_num = 1; !reader.EOS(); ++line_num)
+    {
+        String line = reader.ReadLine();
+        line.Trim();
+        if (line.IsEmpty() || line[0u] == '#')
+            continue;
+        InputEvent evt;
+        char type[16] = {};
+        const int args = sscanf(line.GetCStr(), "%d %15s %d %d", &evt.Frame, type, &evt.Arg1, &evt.Arg2);
+        bool valid = (args >= 3) && (evt.Frame >= 0);
+        if (ags_stricmp(type, "key") == 0)
+            evt.Type = kInputKey;
+        else if (ags_stricmp(type, "mouse") == 0)
+            { evt.Type = kInputMouse; valid &= (args == 4); }
+        else if (ags_stricmp(type, "click") == 0)
+            { evt.Type = kInputClick; valid &= (evt.Arg1 > kMouseNone) && (evt.Arg1 < kNumMouseButtons); }
+        else if (ags_stricmp(type, "wheel") == 0)
+            evt.Type = kInputWheel;
+        else
+            valid = false;
+        if (!valid)
+        {
+            Debug::Printf(kDbgMsg_Error, "Benchmark: invalid input event at %s, line %d",
+                input_file.GetCStr(), line_num);
+            return false;
+        }
+        Input.push_back(evt);
+    }
+    std::stable_sort(Input.begin(), Input.end(),
+        [](const InputEvent &e1, const InputEvent &e2) { return e1.Frame < e2.Frame; });
+    Debug::Printf(kDbgMsg_Info, "Benchmark: loaded %zu input events", Input.size());
+    return true;
+}
+
+static void SimulateInput(const InputEvent &evt)
+{
+    switch (evt.Type)
+    {
+    case kInputKey:
+        ags_simulate_keypress(static_cast<eAGSKeyCode>(evt.Arg1));
+        break;
+    case kInputMouse:
+        Mouse::SetPosition(Point(evt.Arg1, evt.Arg2));
+        break;
+    case kInputClick:
+        ags_simulate_mouseclick(static_cast<eAGSMouseButton>(evt.Arg1));
+        break;
+    case kInputWheel:
+    {
+        SDL_Event sdlevent = {};
+        sdlevent.type = SDL_MOUSEWHEEL;
+        sdlevent.wheel.y = evt.Arg1;
+        SDL_PushEvent(&sdlevent);
+        break;
+    }
+    }
+}
+
+static float GetPercentile(const std::vector<float> &sorted, float percent)
+{
+    const size_t index = static_cast<size_t>(percent * (sorted.size() - 1) / 100.f + 0.5f);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+static void PrintResults()
+{
+    if (ResultsPrinted)
+        return;
+    ResultsPrinted = true;
+
+    const float run_time = std::chrono::duration_cast<std::chrono::microseconds>(
+        FrameTime - StartTime).count() / 1000000.f;
+    const size_t frames = FrameDurations.size();
+    String results = String::FromFormat("Benchmark: %zu frames in %.3f s, %.1f fps (game time %.3f s at %d fps)",
+        frames, run_time, run_time > 0.f ? frames / run_time : 0.f,
+        frames_per_second > 0 ? static_cast<float>(frames) / frames_per_second : 0.f, frames_per_second);
+    if (frames > 0)
+    {
+        std::vector<float> sorted = FrameDurations;
+        std::sort(sorted.begin(), sorted.end());
+        results.AppendFmt("\nFrame time, ms: min %.3f, p50 %.3f, p90 %.3f, p99 %.3f, max %.3f",
+            sorted.front(), GetPercentile(sorted, 50.f), GetPercentile(sorted, 90.f),
+            GetPercentile(sorted, 99.f), sorted.back());
+    }
+    const uint64_t peak_mem = platform->GetPeakMemoryUsage();
+    if (peak_mem > 0)
+        results.AppendFmt("\nPeak memory: %.1f MB", peak_mem / (1024.0 * 1024.0));
+    else
+        results.Append("\nPeak memory: unknown");
+
+    platform->WriteStdOut("%s", results.GetCStr());
+    Debug::Printf(kDbgMsg_Info, "%s", results.GetCStr());
+}
+
+bool Start(int frames, const String &input_file)
+{
+    if (frames <= 0)
+        return false;
+    if (!input_file.IsEmpty() && !LoadInput(input_file))
+        return false;
+
+    Debug::Printf(kDbgMsg_Info, "Benchmark: running for %d frames", frames);
+    TotalFrames = frames;
+    FrameIndex = 0;
+    NextInput = 0u;
+    FrameDurations.clear();
+    FrameDurations.reserve(frames);
+    ResultsPrinted = false;
+    // Run the game frames one after another, not waiting for the real time
+    setTimerFreeRun(true);
+    Running = true;
+    return true;
+}
+
+bool IsRunning()
+{
+    return Running;
+}
+
+void NextFrame()
+{
+    if (!Running)
+        return;
+
+    const auto now = AGS_Clock::now();
+    if (FrameIndex == 0)
+        StartTime = now;
+    else
+        FrameDurations.push_back(std::chrono::duration_cast<std::chrono::microseconds>(now - FrameTime).count() / 1000.f);
+    FrameTime = now;
+
+    if (FrameIndex == TotalFrames)
+    {
+        PrintResults();
+        Running = false;
+        setTimerFreeRun(false);
+        quit("|Benchmark finished");
+        return;
+    }
+
+    for (; NextInput < Input.size() && Input[NextInput].Frame <= FrameIndex; ++NextInput)
+        SimulateInput(Input[NextInput]);
+    FrameIndex++;
+}
+
+void Shutdown()
+{
+    if (Running)
+        PrintResults();
+    Running = false;
+}
+
+} // namespace Benchmark
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,55 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Benchmark runner: runs the game for the given number of frames without
+// waiting between them, optionally simulating the player input read from
+// a text file, then prints the frame timing stats and quits. Meant to be
+// used along with the headless graphics driver, to compare the engine
+// performance between the builds on the same game and input.
+//
+// The input file has one event per line, in the following format:
+//   <frame> key <agskeycode>
+//   <frame> mouse <x> <y>       (in game coordinates)
+//   <frame> click <button>      (1 - left, 2 - right, 3 - middle)
+//   <frame> wheel <delta>
+// Empty lines and the lines starting with '#' are skipped.
+//
+//=============================================================================
+#ifndef __AGS_EE_DEBUG__BENCHMARK_H
+#define __AGS_EE_DEBUG__BENCHMARK_H
+
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Engine
+{
+namespace Benchmark
+{
+
+// Starts the benchmark run, which lasts for the given number of frames
+bool Start(int frames, const Common::String &input_file);
+// Tells if the benchmark is being run
+bool IsRunning();
+// Marks the start of the new game frame: simulates the input scheduled for it,
+// and quits the game after the last frame
+void NextFrame();
+// Prints the results, if the game has quit before the benchmark has ended
+void Shutdown();
+
+} // namespace Benchmark
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_DEBUG__BENCHMARK_H
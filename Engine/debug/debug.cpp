@@ -25,13 +25,16 @@
 #include "ac/gamestate.h"
 #include "ac/runtime_defines.h"
 #include "debug/agseditordebugger.h"
+#include "debug/benchmark.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
 #include "debug/debugmanager.h"
+#include "debug/inputrecorder.h"
 #include "debug/out.h"
 #include "debug/consoleoutputtarget.h"
 #include "debug/logfile.h"
 #include "debug/messagebuffer.h"
+#include "debug/profiler.h"
 #include "main/config.h"
 #include "main/game_run.h"
 #include "media/audio/audio_system.h"
@@ -375,6 +378,18 @@ void apply_debug_config(const ConfigTree &cfg)
         apply_log_config(cfg, OutputDebuggerLogID, false, {});
     }
 
+#if AGS_FRAME_PROFILER
+    String trace_file = CfgReadString(cfg, "profiler", "trace_file");
+    if (trace_file.IsEmpty())
+    {
+        FSLocation fs = platform->GetAppOutputDirectory();
+        CreateFSDirs(fs);
+        trace_file = Path::ConcatPaths(fs.FullDir, "ags_trace.json");
+    }
+    Profiler::Configure(CfgReadBoolInt(cfg, "profiler", "overlay"), trace_file,
+        CfgReadBoolInt(cfg, "profiler", "trace_on_exit"));
+#endif
+
     // We don't need message buffer beyond this point
     DbgMgr.UnregisterOutput(OutputMsgBufID);
     DebugMsgBuff.reset();
@@ -382,6 +397,11 @@ void apply_debug_config(const ConfigTree &cfg)
 
 void shutdown_debug()
 {
+#if AGS_FRAME_PROFILER
+    Profiler::Shutdown();
+#endif
+    Benchmark::Shutdown();
+    InputRecorder::Shutdown();
     // Shutdown output subsystem
     DbgMgr.UnregisterAll();
 
@@ -694,10 +714,10 @@ void check_debug_keys() {
     if (play.debug_mode) {
         // do the run-time script debugging
 
-        const Uint8 *ks = SDL_GetKeyboardState(nullptr);
-        if ((!ks[SDL_SCANCODE_SCROLLLOCK]) && (scrlockWasDown))
+        const bool scrlockDown = InputRecorder::IsScrollLockDown();
+        if ((!scrlockDown) && (scrlockWasDown))
             scrlockWasDown = 0;
-        else if ((ks[SDL_SCANCODE_SCROLLLOCK]) && (!scrlockWasDown)) {
+        else if ((scrlockDown) && (!scrlockWasDown)) {
 
             break_on_next_script_step = 1;
             scrlockWasDown = 1;
@@ -0,0 +1,417 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "debug/inputrecorder.h"
+#include <algorithm>
+#include <memory>
+#include <string.h>
+#include <vector>
+#include "ac/common.h"
+#include "debug/out.h"
+#include "main/graphics_mode.h"
+#include "util/file.h"
+#include "util/stream.h"
+
+using namespace AGS::Common;
+
+namespace AGS
+{
+namespace Engine
+{
+namespace InputRecorder
+{
+
+// Input log format:
+//   header: signature, version, random seed, game's unique id;
+//   records: type (byte), frame delta (varint), event data.
+// The modifier and lock keys state is logged on the frames where it changed.
+static const char *LogSignature = "AGSINLOG";
+static const size_t LogSignatureLen = 8u;
+static const int32_t LogVersion = 2;
+
+enum RecordType
+{
+    kRecord_End = 0,
+    kRecord_KeyDown,
+    kRecord_KeyUp,
+    kRecord_TextInput,
+    kRecord_MouseMotion,
+    kRecord_MouseDown,
+    kRecord_MouseUp,
+    kRecord_MouseWheel,
+    kRecord_KeyMods
+};
+
+static std::unique_ptr<Stream> LogStream;
+static bool Recording = false;
+static bool Replaying = false;
+static uint32_t Frame = 0u; // current game frame
+static uint32_t LogFrame = 0u; // frame of the last logged event
+// Next replayed event
+static bool HasNextEvent = false;
+static bool ReplayEnded = false;
+static RecordType NextType = kRecord_End;
+static SDL_Event NextEvent;
+static std::vector<bool> KeyState;
+// Modifier and lock keys state, sampled once per frame when recording
+static uint16_t ModState = 0u;
+static bool ScrollLockDown = false;
+
+static void WriteVarUInt(Stream *out, uint32_t val)
+{
+    for (; val >= 0x80; val >>= 7)
+        out->WriteByte(static_cast<uint8_t>(val | 0x80));
+    out->WriteByte(static_cast<uint8_t>(val));
+}
+
+static uint32_t ReadVarUInt(Stream *in)
+{
+    uint32_t val = 0u;
+    for (int shift = 0; shift < 32; shift += 7)
+    {
+        const int32_t b = in->ReadByte();
+        if (b < 0)
+            break;
+        val |= static_cast<uint32_t>(b & 0x7F) << shift;
+        if ((b & 0x80) == 0)
+            break;
+    }
+    return val;
+}
+
+static void WritePoint(Stream *out, int x, int y)
+{
+    const Point pt = GameScaling.UnScale(Point(x, y));
+    out->WriteInt16(static_cast<int16_t>(pt.X));
+    out->WriteInt16(static_cast<int16_t>(pt.Y));
+}
+
+static Point ReadPoint(Stream *in)
+{
+    const int x = in->ReadInt16();
+    const int y = in->ReadInt16();
+    return GameScaling.Scale(Point(x, y));
+}
+
+static void WriteRecordHeader(RecordType type)
+{
+    LogStream->WriteByte(static_cast<uint8_t>(type));
+    WriteVarUInt(LogStream.get(), Frame - LogFrame);
+    LogFrame = Frame;
+}
+
+// Samples the modifier and lock keys state, and logs it if it has changed
+static void RecordKeyMods(bool force)
+{
+    const uint16_t mod_state = static_cast<uint16_t>(SDL_GetModState());
+    const bool scroll_lock = SDL_GetKeyboardState(nullptr)[SDL_SCANCODE_SCROLLLOCK] != 0;
+    if (!force && mod_state == ModState && scroll_lock == ScrollLockDown)
+        return;
+    ModState = mod_state;
+    ScrollLockDown = scroll_lock;
+    WriteRecordHeader(kRecord_KeyMods);
+    LogStream->WriteInt16(static_cast<int16_t>(ModState));
+    LogStream->WriteBool(ScrollLockDown);
+}
+
+bool StartRecording(const String &filename, int rand_seed, int game_uid)
+{
+    LogStream.reset(File::CreateFile(filename));
+    if (!LogStream)
+    {
+        Debug::Printf(kDbgMsg_Error, "Input recorder: failed to open file %s", filename.GetCStr());
+        return false;
+    }
+    LogStream->Write(LogSignature, LogSignatureLen);
+    LogStream->WriteInt32(LogVersion);
+    LogStream->WriteInt32(rand_seed);
+    LogStream->WriteInt32(game_uid);
+    Frame = LogFrame = 0u;
+    Recording = true;
+    RecordKeyMods(true);
+    Debug::Printf(kDbgMsg_Info, "Input recorder: recording into %s", filename.GetCStr());
+    return true;
+}
+
+static void ReadNextEvent()
+{
+    Stream *in = LogStream.get();
+    HasNextEvent = false;
+    const int32_t type = in->ReadByte();
+    if (type <= kRecord_End || type > kRecord_KeyMods)
+    {
+        // End of log, or the log was cut short
+        if (type != kRecord_End)
+            LogFrame = Frame;
+        else
+            LogFrame += ReadVarUInt(in);
+        ReplayEnded = true;
+        return;
+    }
+    LogFrame += ReadVarUInt(in);
+
+    SDL_Event &evt = NextEvent;
+    evt = {};
+    NextType = static_cast<RecordType>(type);
+    switch (NextType)
+    {
+    case kRecord_KeyDown:
+    case kRecord_KeyUp:
+        evt.type = (NextType == kRecord_KeyDown) ? SDL_KEYDOWN : SDL_KEYUP;
+        evt.key.state = (NextType == kRecord_KeyDown) ? SDL_PRESSED : SDL_RELEASED;
+        evt.key.keysym.scancode = static_cast<SDL_Scancode>(in->ReadInt16());
+        evt.key.keysym.sym = in->ReadInt32();
+        evt.key.keysym.mod = static_cast<uint16_t>(in->ReadInt16());
+        evt.key.repeat = static_cast<uint8_t>(in->ReadByte());
+        break;
+    case kRecord_TextInput:
+    {
+        evt.type = SDL_TEXTINPUT;
+        const size_t len = std::min<size_t>(static_cast<uint8_t>(in->ReadByte()), sizeof(evt.text.text) - 1);
+        in->Read(evt.text.text, len);
+        break;
+    }
+    case kRecord_MouseMotion:
+    {
+        evt.type = SDL_MOUSEMOTION;
+        const Point pt = ReadPoint(in);
+        evt.motion.x = pt.X;
+        evt.motion.y = pt.Y;
+        evt.motion.xrel = GameScaling.X.ScaleDistance(in->ReadInt16());
+        evt.motion.yrel = GameScaling.Y.ScaleDistance(in->ReadInt16());
+        evt.motion.which = in->ReadBool() ? SDL_TOUCH_MOUSEID : 0;
+        break;
+    }
+    case kRecord_MouseDown:
+    case kRecord_MouseUp:
+    {
+        evt.type = (NextType == kRecord_MouseDown) ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+        evt.button.state = (NextType == kRecord_MouseDown) ? SDL_PRESSED : SDL_RELEASED;
+        evt.button.button = static_cast<uint8_t>(in->ReadByte());
+        evt.button.clicks = static_cast<uint8_t>(in->ReadByte());
+        const Point pt = ReadPoint(in);
+        evt.button.x = pt.X;
+        evt.button.y = pt.Y;
+        evt.button.which = in->ReadBool() ? SDL_TOUCH_MOUSEID : 0;
+        break;
+    }
+    case kRecord_MouseWheel:
+        evt.type = SDL_MOUSEWHEEL;
+        evt.wheel.x = in->ReadInt16();
+        evt.wheel.y = in->ReadInt16();
+        evt.wheel.which = in->ReadBool() ? SDL_TOUCH_MOUSEID : 0;
+        break;
+    case kRecord_KeyMods:
+        // not an event, only kept in the SDL_Event until applied
+        evt.key.keysym.mod = static_cast<uint16_t>(in->ReadInt16());
+        evt.key.state = in->ReadBool() ? SDL_PRESSED : SDL_RELEASED;
+        break;
+    default:
+        break;
+    }
+    HasNextEvent = true;
+}
+
+// Applies the logged modifier and lock keys states, which are due
+static void ReplayKeyMods()
+{
+    while (HasNextEvent && NextType == kRecord_KeyMods && LogFrame <= Frame)
+    {
+        ModState = NextEvent.key.keysym.mod;
+        ScrollLockDown = NextEvent.key.state == SDL_PRESSED;
+        ReadNextEvent();
+    }
+}
+
+bool StartReplay(const String &filename, int game_uid, int &rand_seed)
+{
+    LogStream.reset(File::OpenFileRead(filename));
+    if (!LogStream)
+    {
+        Debug::Printf(kDbgMsg_Error, "Input recorder: failed to open file %s", filename.GetCStr());
+        return false;
+    }
+    char sig[LogSignatureLen] = {};
+    LogStream->Read(sig, LogSignatureLen);
+    const int32_t version = LogStream->ReadInt32();
+    if (memcmp(sig, LogSignature, LogSignatureLen) != 0 || version != LogVersion)
+    {
+        Debug::Printf(kDbgMsg_Error, "Input recorder: %s is not a supported input log", filename.GetCStr());
+        LogStream.reset();
+        return false;
+    }
+    rand_seed = LogStream->ReadInt32();
+    if (LogStream->ReadInt32() != game_uid)
+        Debug::Printf(kDbgMsg_Warn, "Input recorder: WARNING: the input log was recorded for another game");
+
+    Frame = LogFrame = 0u;
+    ReplayEnded = false;
+    KeyState.assign(SDL_NUM_SCANCODES, false);
+    ModState = 0u;
+    ScrollLockDown = false;
+    Replaying = true;
+    ReadNextEvent();
+    ReplayKeyMods();
+    Debug::Printf(kDbgMsg_Info, "Input recorder: replaying %s", filename.GetCStr());
+    return true;
+}
+
+void Shutdown()
+{
+    if (Recording)
+    {
+        WriteRecordHeader(kRecord_End);
+        Debug::Printf(kDbgMsg_Info, "Input recorder: recorded %u frames", Frame);
+    }
+    LogStream.reset();
+    Recording = false;
+    Replaying = false;
+}
+
+bool IsRecording()
+{
+    return Recording;
+}
+
+bool IsReplaying()
+{
+    return Replaying;
+}
+
+void NextFrame()
+{
+    if (!Recording && !Replaying)
+        return;
+    Frame++;
+    if (Recording)
+        RecordKeyMods(false);
+    else
+        ReplayKeyMods();
+    if (Replaying && ReplayEnded && !HasNextEvent && Frame > LogFrame)
+    {
+        Debug::Printf(kDbgMsg_Info, "Input recorder: replay finished at frame %u", Frame);
+        Shutdown();
+        quit("|Input replay finished");
+    }
+}
+
+bool IsInputEvent(const SDL_Event &event)
+{
+    switch (event.type)
+    {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+    case SDL_TEXTINPUT:
+    case SDL_MOUSEMOTION:
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+    case SDL_MOUSEWHEEL:
+    case SDL_FINGERDOWN:
+    case SDL_FINGERUP:
+    case SDL_FINGERMOTION:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void RecordEvent(const SDL_Event &event)
+{
+    if (!Recording)
+        return;
+    Stream *out = LogStream.get();
+    switch (event.type)
+    {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        WriteRecordHeader(event.type == SDL_KEYDOWN ? kRecord_KeyDown : kRecord_KeyUp);
+        out->WriteInt16(static_cast<int16_t>(event.key.keysym.scancode));
+        out->WriteInt32(event.key.keysym.sym);
+        out->WriteInt16(static_cast<int16_t>(event.key.keysym.mod));
+        out->WriteByte(event.key.repeat);
+        break;
+    case SDL_TEXTINPUT:
+    {
+        WriteRecordHeader(kRecord_TextInput);
+        const size_t len = strnlen(event.text.text, sizeof(event.text.text));
+        out->WriteByte(static_cast<uint8_t>(len));
+        out->Write(event.text.text, len);
+        break;
+    }
+    case SDL_MOUSEMOTION:
+        WriteRecordHeader(kRecord_MouseMotion);
+        WritePoint(out, event.motion.x, event.motion.y);
+        out->WriteInt16(static_cast<int16_t>(GameScaling.X.UnScaleDistance(event.motion.xrel)));
+        out->WriteInt16(static_cast<int16_t>(GameScaling.Y.UnScaleDistance(event.motion.yrel)));
+        out->WriteBool(event.motion.which == SDL_TOUCH_MOUSEID);
+        break;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+        WriteRecordHeader(event.type == SDL_MOUSEBUTTONDOWN ? kRecord_MouseDown : kRecord_MouseUp);
+        out->WriteByte(event.button.button);
+        out->WriteByte(event.button.clicks);
+        WritePoint(out, event.button.x, event.button.y);
+        out->WriteBool(event.button.which == SDL_TOUCH_MOUSEID);
+        break;
+    case SDL_MOUSEWHEEL:
+        WriteRecordHeader(kRecord_MouseWheel);
+        out->WriteInt16(static_cast<int16_t>(event.wheel.x));
+        out->WriteInt16(static_cast<int16_t>(event.wheel.y));
+        out->WriteBool(event.wheel.which == SDL_TOUCH_MOUSEID);
+        break;
+    default:
+        // Touch events are recorded as the mouse events emulated from them
+        break;
+    }
+}
+
+bool PollReplayEvent(SDL_Event &event)
+{
+    ReplayKeyMods();
+    if (!Replaying || !HasNextEvent || LogFrame > Frame)
+        return false;
+    event = NextEvent;
+    if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP)
+    {
+        const size_t scan = static_cast<size_t>(event.key.keysym.scancode);
+        if (scan < KeyState.size())
+            KeyState[scan] = (event.type == SDL_KEYDOWN);
+    }
+    ReadNextEvent();
+    ReplayKeyMods();
+    return true;
+}
+
+bool IsKeyDown(SDL_Scancode scan)
+{
+    const size_t index = static_cast<size_t>(scan);
+    return index < KeyState.size() && KeyState[index];
+}
+
+SDL_Keymod GetModState()
+{
+    if (Recording || Replaying)
+        return static_cast<SDL_Keymod>(ModState);
+    return SDL_GetModState();
+}
+
+bool IsScrollLockDown()
+{
+    if (Recording || Replaying)
+        return ScrollLockDown;
+    return SDL_GetKeyboardState(nullptr)[SDL_SCANCODE_SCROLLLOCK] != 0;
+}
+
+} // namespace InputRecorder
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,78 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Input recorder: writes the keyboard and mouse events handled by the engine
+// into a binary log, along with the number of the game frame on which they
+// were handled, and the random seed the game was started with. In replay
+// mode the real player input is ignored, and the logged events are fed back
+// on the same frames, while the game is started with the logged seed.
+// The game quits when the replay reaches the end of the log.
+//
+// Mouse positions are logged in the game coordinates, so the replay does not
+// depend on the window size; touch input is logged as the mouse events
+// emulated from it.
+//
+// The modifier and lock keys state is sampled once per frame, and the
+// engine reads it through the recorder, so that it's same in the replay.
+//
+// NOTE: the replay is only deterministic as long as the game does not
+// depend on the real time (e.g. DateTime).
+//
+//=============================================================================
+#ifndef __AGS_EE_DEBUG__INPUTRECORDER_H
+#define __AGS_EE_DEBUG__INPUTRECORDER_H
+
+#include <SDL_events.h>
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Engine
+{
+namespace InputRecorder
+{
+
+// Starts recording the input into the file
+bool StartRecording(const Common::String &filename, int rand_seed, int game_uid);
+// Starts replaying the input from the file; returns the random seed
+// which the game should use
+bool StartReplay(const Common::String &filename, int game_uid, int &rand_seed);
+// Finishes recording or replay
+void Shutdown();
+
+bool IsRecording();
+bool IsReplaying();
+
+// Marks the start of the new game frame
+void NextFrame();
+// Tells if the event is a player input, which is handled by the recorder
+bool IsInputEvent(const SDL_Event &event);
+// Writes the input event into the log, if recording
+void RecordEvent(const SDL_Event &event);
+// Gets the next logged input event, which is due on the current frame
+bool PollReplayEvent(SDL_Event &event);
+// Tells if the key is pressed according to the replayed events
+bool IsKeyDown(SDL_Scancode scan);
+// Gets the modifier and lock keys state; while recording or replaying
+// this is the state logged for the current frame
+SDL_Keymod GetModState();
+// Tells if the Scroll Lock key is held down; while recording or replaying
+// this is the state logged for the current frame
+bool IsScrollLockDown();
+
+} // namespace InputRecorder
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_DEBUG__INPUTRECORDER_H
@@ -0,0 +1,259 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "debug/profiler.h"
+
+#if AGS_FRAME_PROFILER
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string.h>
+#include "ac/timer.h"
+#include "debug/out.h"
+#include "util/file.h"
+#include "util/textstreamwriter.h"
+
+using namespace AGS::Common;
+
+namespace AGS
+{
+namespace Engine
+{
+namespace Profiler
+{
+
+// Number of records kept per thread, must be a power of 2
+static const uint64_t ThreadBufferSize = 1u << 15;
+// Max zone nesting which is recorded
+static const size_t MaxZoneDepth = 64u;
+// Weight of the last frame in the averaged zone stats
+static const float FrameStatWeight = 0.1f;
+
+struct ZoneRecord
+{
+    const char *Name = nullptr;
+    uint64_t Start = 0u; // in nanoseconds since the profiler start
+    uint64_t End = 0u;
+    uint32_t Depth = 0u;
+    // Zone is nested in another zone of the same name
+    // (e.g. recursive script run), and its time is already counted
+    bool Nested = false;
+};
+
+struct ThreadBuffer
+{
+    uint32_t Index = 0u;
+    std::vector<ZoneRecord> Records;
+    // Total number of records written by the thread
+    std::atomic<uint64_t> Head { 0u };
+    // Currently open zones; only accessed by the owning thread
+    const char *Stack[MaxZoneDepth] {};
+    uint64_t StackStart[MaxZoneDepth] {};
+    size_t Depth = 0u;
+
+    ThreadBuffer(uint32_t index) : Index(index), Records(ThreadBufferSize) {}
+};
+
+static const AGS_Clock::time_point StartTime = AGS_Clock::now();
+static std::mutex ThreadsMutex;
+static std::vector<std::unique_ptr<ThreadBuffer>> Threads;
+static thread_local ThreadBuffer *CurThread = nullptr;
+
+static ThreadBuffer *MainThread = nullptr;
+static uint64_t FrameHead = 0u; // main thread's records at the frame start
+static std::vector<ZoneStat> FrameStats;
+static std::vector<ZoneStat> CurFrameStats;
+
+static bool OverlayEnabled = false;
+static String TraceFile;
+static bool TraceOnExit = false;
+
+static uint64_t GetTime()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(AGS_Clock::now() - StartTime).count();
+}
+
+static ThreadBuffer *GetThreadBuffer()
+{
+    if (!CurThread)
+    {
+        // Buffers are never removed, so that the records of finished threads remain
+        std::lock_guard<std::mutex> lk(ThreadsMutex);
+        Threads.emplace_back(new ThreadBuffer(static_cast<uint32_t>(Threads.size())));
+        CurThread = Threads.back().get();
+    }
+    return CurThread;
+}
+
+void BeginZone(const char *name)
+{
+    ThreadBuffer *buf = GetThreadBuffer();
+    if (buf->Depth < MaxZoneDepth)
+    {
+        buf->Stack[buf->Depth] = name;
+        buf->StackStart[buf->Depth] = GetTime();
+    }
+    buf->Depth++;
+}
+
+void EndZone()
+{
+    ThreadBuffer *buf = CurThread;
+    if (!buf || buf->Depth == 0u)
+        return;
+    const size_t depth = --buf->Depth;
+    if (depth >= MaxZoneDepth)
+        return;
+
+    const uint64_t head = buf->Head.load(std::memory_order_relaxed);
+    ZoneRecord &rec = buf->Records[head & (ThreadBufferSize - 1)];
+    rec.Name = buf->Stack[depth];
+    rec.Start = buf->StackStart[depth];
+    rec.End = GetTime();
+    rec.Depth = static_cast<uint32_t>(depth);
+    rec.Nested = false;
+    for (size_t i = 0; i < depth && !rec.Nested; ++i)
+        rec.Nested = strcmp(buf->Stack[i], rec.Name) == 0;
+    buf->Head.store(head + 1, std::memory_order_release);
+}
+
+void NextFrame()
+{
+    ThreadBuffer *buf = GetThreadBuffer();
+    MainThread = buf;
+    const uint64_t head = buf->Head.load(std::memory_order_relaxed);
+    const uint64_t from = std::max(FrameHead, head > ThreadBufferSize ? head - ThreadBufferSize : 0u);
+    FrameHead = head;
+
+    // Sum the time of the zones completed during the last frame
+    CurFrameStats.clear();
+    for (uint64_t i = from; i < head; ++i)
+    {
+        const ZoneRecord &rec = buf->Records[i & (ThreadBufferSize - 1)];
+        if (rec.Nested)
+            continue;
+        const float time = (rec.End - rec.Start) / 1000000.f;
+        auto it = std::find_if(CurFrameStats.begin(), CurFrameStats.end(),
+            [&rec](const ZoneStat &st) { return strcmp(st.Name, rec.Name) == 0; });
+        if (it != CurFrameStats.end())
+        {
+            it->Time += time;
+        }
+        else
+        {
+            ZoneStat st;
+            st.Name = rec.Name;
+            st.Time = time;
+            CurFrameStats.push_back(st);
+        }
+    }
+
+    // Average with the previous frames; the zones are kept in the order of appearance
+    for (auto &st : FrameStats)
+        st.Time *= (1.f - FrameStatWeight);
+    for (const auto &cur : CurFrameStats)
+    {
+        auto it = std::find_if(FrameStats.begin(), FrameStats.end(),
+            [&cur](const ZoneStat &st) { return strcmp(st.Name, cur.Name) == 0; });
+        if (it != FrameStats.end())
+        {
+            it->Time += cur.Time * FrameStatWeight;
+        }
+        else
+        {
+            FrameStats.push_back(cur);
+        }
+    }
+}
+
+const std::vector<ZoneStat> &GetFrameStats()
+{
+    return FrameStats;
+}
+
+void Configure(bool overlay, const String &trace_file, bool trace_on_exit)
+{
+    OverlayEnabled = overlay;
+    TraceFile = trace_file;
+    TraceOnExit = trace_on_exit;
+}
+
+void Shutdown()
+{
+    if (TraceOnExit)
+        WriteTrace();
+}
+
+bool IsOverlayEnabled()
+{
+    return OverlayEnabled;
+}
+
+bool WriteTrace(const String &filename)
+{
+    const String &trace_file = filename.IsEmpty() ? TraceFile : filename;
+    if (trace_file.IsEmpty())
+        return false;
+    Stream *out = File::CreateFile(trace_file);
+    if (!out)
+    {
+        Debug::Printf(kDbgMsg_Error, "Profiler: failed to open trace file %s", trace_file.GetCStr());
+        return false;
+    }
+
+    std::vector<ThreadBuffer*> threads;
+    {
+        std::lock_guard<std::mutex> lk(ThreadsMutex);
+        for (const auto &buf : Threads)
+            threads.push_back(buf.get());
+    }
+
+    TextStreamWriter writer(out);
+    writer.WriteString("{\"traceEvents\":[\n");
+    bool first = true;
+    std::vector<ZoneRecord> records;
+    for (const auto *buf : threads)
+    {
+        writer.WriteFormat("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}",
+            first ? "" : ",\n", buf->Index, (buf == MainThread) ? "Main" : "Thread", buf->Index);
+        first = false;
+
+        // Other threads keep writing while we read, so after copying the
+        // records drop the oldest ones, which could have been overwritten
+        uint64_t head = buf->Head.load(std::memory_order_acquire);
+        uint64_t from = head > ThreadBufferSize ? head - ThreadBufferSize : 0u;
+        records.clear();
+        for (uint64_t i = from; i < head; ++i)
+            records.push_back(buf->Records[i & (ThreadBufferSize - 1)]);
+        const uint64_t new_head = buf->Head.load(std::memory_order_acquire);
+        const uint64_t skip = (new_head > ThreadBufferSize + from) ? (new_head - ThreadBufferSize - from) : 0u;
+
+        for (size_t i = static_cast<size_t>(std::min<uint64_t>(skip, records.size())); i < records.size(); ++i)
+        {
+            const ZoneRecord &rec = records[i];
+            writer.WriteFormat(",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                rec.Name, buf->Index, rec.Start / 1000.0, (rec.End - rec.Start) / 1000.0);
+        }
+    }
+    writer.WriteString("\n],\"displayTimeUnit\":\"ms\"}\n");
+    Debug::Printf(kDbgMsg_Info, "Profiler: written trace file %s", trace_file.GetCStr());
+    return true;
+}
+
+} // namespace Profiler
+} // namespace Engine
+} // namespace AGS
+
+#endif // AGS_FRAME_PROFILER
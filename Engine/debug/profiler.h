@@ -0,0 +1,93 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Frame profiler: records the timing of named code zones, which are marked
+// with AGS_PROFILE_ZONE macro, and may be nested. Each thread writes its
+// records into its own ring buffer without locking, so only the latest
+// records are kept. These may be written into a JSON file in Chrome's trace
+// event format (for chrome://tracing or Perfetto), and the time spent in
+// each zone during the last frames may be displayed on screen.
+//
+// The profiler is compiled in only when AGS_FRAME_PROFILER is enabled,
+// otherwise the zone macros expand to nothing.
+//
+//=============================================================================
+#ifndef __AGS_EE_DEBUG__PROFILER_H
+#define __AGS_EE_DEBUG__PROFILER_H
+
+#ifndef AGS_FRAME_PROFILER
+#define AGS_FRAME_PROFILER 0
+#endif
+
+#if AGS_FRAME_PROFILER
+
+#include <vector>
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Engine
+{
+namespace Profiler
+{
+
+// Average time spent in a zone per frame
+struct ZoneStat
+{
+    const char *Name = nullptr;
+    float Time = 0.f; // in milliseconds
+};
+
+// Applies profiler settings
+void Configure(bool overlay, const Common::String &trace_file, bool trace_on_exit);
+// Writes trace file, if it was requested to do so on exit
+void Shutdown();
+
+// Marks the start of the new game frame; must be called on the main thread
+void NextFrame();
+// Tells whether the zone stats should be displayed on screen
+bool IsOverlayEnabled();
+// Gets the zone stats collected on the main thread
+const std::vector<ZoneStat> &GetFrameStats();
+// Writes the recorded zones into the trace file; uses configured file if none is passed
+bool WriteTrace(const Common::String &filename = "");
+
+// Zone recording; name must be a string literal, or otherwise remain valid
+void BeginZone(const char *name);
+void EndZone();
+
+class ScopedZone
+{
+public:
+    ScopedZone(const char *name) { BeginZone(name); }
+    ~ScopedZone() { EndZone(); }
+};
+
+} // namespace Profiler
+} // namespace Engine
+} // namespace AGS
+
+#define AGS_PROFILE_CONCAT_IMPL(a, b) a##b
+#define AGS_PROFILE_CONCAT(a, b) AGS_PROFILE_CONCAT_IMPL(a, b)
+// Records the time spent until the end of the current scope
+#define AGS_PROFILE_ZONE(name) \
+    AGS::Engine::Profiler::ScopedZone AGS_PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+
+#else // !AGS_FRAME_PROFILER
+
+#define AGS_PROFILE_ZONE(name)
+
+#endif // AGS_FRAME_PROFILER
+
+#endif // __AGS_EE_DEBUG__PROFILER_H
@@ -45,6 +45,7 @@
 #include "script/cc_common.h"
 #include "script/exports.h"
 #include "script/script.h"
+#include "script/script_profiler.h"
 #include "script/script_runtime.h"
 #include "util/string_compat.h"
 #include "util/string_utils.h"
@@ -559,6 +560,12 @@ HGameInitError InitGameState(const LoadedGameEntities &ents, GameDataVersion dat
     // require access to script API at initialization time.
     //
     ccSetScriptAliveTimer(1000 / 60u, 1000u, 150000u);
+    ccSetOption(SCOPT_LEGACYEXEC, usetup.legacy_script_exec);
+    if (usetup.script_profiler)
+    {
+        scriptProfiler.reset(new ScriptProfiler());
+        ccSetScriptProfiler(scriptProfiler.get());
+    }
     ccSetStringClassImpl(&myScriptStringImpl);
     setup_script_exports(base_api, compat_api);
 
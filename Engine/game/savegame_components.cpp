@@ -1259,7 +1259,7 @@ ComponentHandler ComponentHandlers[] =
     },
     {
         "Managed Pool",
-        0,
+        1, // handles with generations; older engines must refuse it
         0,
         WriteManagedPool,
         ReadManagedPool
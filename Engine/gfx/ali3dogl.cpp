@@ -74,8 +74,12 @@ OGLTexture::~OGLTexture()
 {
     if (_tiles)
     {
-        for (size_t i = 0; i < _numTiles; ++i)
-            glDeleteTextures(1, &(_tiles[i].texture));
+        // The atlas page's texture is shared, and is deleted by the atlas
+        if (_atlas)
+            _atlas->Release(_atlasRegion);
+        else
+            for (size_t i = 0; i < _numTiles; ++i)
+                glDeleteTextures(1, &(_tiles[i].texture));
         delete[] _tiles;
     }
     if (_vertex)
@@ -84,6 +88,48 @@ OGLTexture::~OGLTexture()
     }
 }
 
+OGLTextureAtlas::~OGLTextureAtlas()
+{
+    for (auto &tex : _pageTextures)
+    {
+        if (tex)
+            glDeleteTextures(1, &tex);
+    }
+}
+
+AtlasRegion OGLTextureAtlas::Allocate(int width, int height, unsigned int &texture)
+{
+    bool new_page;
+    AtlasRegion region = _atlas.Allocate(width, height, new_page);
+    if (!region.IsValid())
+        return region;
+
+    if (_pageTextures.size() <= region.Page)
+        _pageTextures.resize(region.Page + 1);
+    if (new_page)
+    {
+        const int page_size = GetPageSize();
+        glGenTextures(1, &_pageTextures[region.Page]);
+        glBindTexture(GL_TEXTURE_2D, _pageTextures[region.Page]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, page_size, page_size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+    texture = _pageTextures[region.Page];
+    return region;
+}
+
+void OGLTextureAtlas::Release(const AtlasRegion &region)
+{
+    if (_atlas.Release(region))
+    {
+        glDeleteTextures(1, &_pageTextures[region.Page]);
+        _pageTextures[region.Page] = 0;
+    }
+}
+
 size_t OGLTexture::GetMemSize() const
 {
     // FIXME: a proper size in video memory, check OpenGL docs
@@ -244,6 +290,25 @@ bool OGLGraphicsDriver::FirstTimeInit()
     SDL_SetError("Failed to create Shaders.");
     return false;
   }
+
+  // Small textures are put on the atlas pages, so that the sprites
+  // using them may be drawn together
+  GLint max_texture_size = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+  const int atlas_page_size = std::min(1024, max_texture_size);
+  _atlasMaxTextureSize = atlas_page_size / 4;
+  if (_atlasMaxTextureSize >= 16)
+    _textureAtlas.reset(new OGLTextureAtlas(atlas_page_size));
+
+#if !AGS_OPENGL_ES2
+  // Texture pixels are streamed through the pixel buffers, where supported
+  if (GLAD_GL_VERSION_2_1)
+  {
+    glGenBuffers(PixelBufferCount, _pixelBuffers);
+    _pixelBufferIndex = 0;
+    Debug::Printf(kDbgMsg_Info, "OGL: using pixel buffers for texture uploads");
+  }
+#endif
   _firstTimeInit = true;
   return true;
 }
@@ -896,6 +961,15 @@ void OGLGraphicsDriver::UnInit()
   DeleteShaderProgram(_transparencyShader);
   DeleteShaderProgram(_tintShader);
   DeleteShaderProgram(_lightShader);
+  // Remaining atlas pages are deleted along with the last textures using them
+  _textureAtlas.reset();
+#if !AGS_OPENGL_ES2
+  if (_pixelBuffers[0] != 0)
+  {
+    glDeleteBuffers(PixelBufferCount, _pixelBuffers);
+    std::fill(std::begin(_pixelBuffers), std::end(_pixelBuffers), 0u);
+  }
+#endif
 
   DeleteWindowAndGlContext();
   sys_window_destroy();
@@ -999,46 +1073,38 @@ void OGLGraphicsDriver::_renderSprite(const OGLDrawListEntry *drawListEntry,
 
   const int alpha = (color.Alpha * bmpToDraw->_alpha) / 255;
 
-  ShaderProgram program;
+  OGLSpriteState state;
 
   const bool do_tint = bmpToDraw->_tintSaturation > 0 && _tintShader.Program > 0;
   const bool do_light = bmpToDraw->_tintSaturation == 0 && bmpToDraw->_lightLevel > 0 && _lightShader.Program > 0;
   if (do_tint)
   {
     // Use tinting shader
-    program = _tintShader;
-    glUseProgram(_tintShader.Program);
+    state.Program = &_tintShader;
 
-    float rgb[3];
-    float sat_trs_lum[3]; // saturation / transparency / luminance
     if (_legacyPixelShader)
     {
-      rgb_to_hsv(bmpToDraw->_red, bmpToDraw->_green, bmpToDraw->_blue, &rgb[0], &rgb[1], &rgb[2]);
-      rgb[0] /= 360.0; // In HSV, Hue is 0-360
+      rgb_to_hsv(bmpToDraw->_red, bmpToDraw->_green, bmpToDraw->_blue, &state.Tint[0], &state.Tint[1], &state.Tint[2]);
+      state.Tint[0] /= 360.0; // In HSV, Hue is 0-360
     }
     else
     {
-      rgb[0] = (float)bmpToDraw->_red / 255.0;
-      rgb[1] = (float)bmpToDraw->_green / 255.0;
-      rgb[2] = (float)bmpToDraw->_blue / 255.0;
+      state.Tint[0] = (float)bmpToDraw->_red / 255.0;
+      state.Tint[1] = (float)bmpToDraw->_green / 255.0;
+      state.Tint[2] = (float)bmpToDraw->_blue / 255.0;
     }
 
-    sat_trs_lum[0] = (float)bmpToDraw->_tintSaturation / 255.0;
+    state.TintAmount = (float)bmpToDraw->_tintSaturation / 255.0;
 
     if (bmpToDraw->_lightLevel > 0)
-      sat_trs_lum[2] = (float)bmpToDraw->_lightLevel / 255.0;
+      state.TintLuminance = (float)bmpToDraw->_lightLevel / 255.0;
     else
-      sat_trs_lum[2] = 1.0f;
-
-    glUniform3f(_tintShader.TintHSV, rgb[0], rgb[1], rgb[2]);
-    glUniform1f(_tintShader.TintAmount, sat_trs_lum[0]);
-    glUniform1f(_tintShader.TintLuminance, sat_trs_lum[2]);
+      state.TintLuminance = 1.0f;
   }
   else if (do_light)
   {
     // Use light shader
-    program = _lightShader;
-    glUseProgram(_lightShader.Program);
+    state.Program = &_lightShader;
     float light_lev = 1.0f;
 
     // Light level parameter in DDB is weird, it is measured in units of
@@ -1057,17 +1123,25 @@ void OGLGraphicsDriver::_renderSprite(const OGLDrawListEntry *drawListEntry,
       light_lev = ((bmpToDraw->_lightLevel - 256) / 2) / 255.f; // brighter, uses ADD op
     }
 
-    glUniform1f(_lightShader.LightingAmount, light_lev);
+    state.LightingAmount = light_lev;
   }
   else
   {
     // Use default processing
-    program = _transparencyShader;
-    glUseProgram(_transparencyShader.Program);
+    state.Program = &_transparencyShader;
   }
 
-  glUniform1i(program.TextureId, 0);
-  glUniform1f(program.Alpha, alpha / 255.0f);
+  state.Alpha = alpha / 255.0f;
+  state.RenderHint = bmpToDraw->_renderHint;
+
+  if ((_smoothScaling) && bmpToDraw->_useResampler && (bmpToDraw->_stretchToHeight > 0) &&
+      ((bmpToDraw->_stretchToHeight != bmpToDraw->_height) ||
+       (bmpToDraw->_stretchToWidth != bmpToDraw->_width)))
+    state.Filter = OGLSpriteState::kFilter_Linear;
+  else if (_do_render_to_texture)
+    state.Filter = OGLSpriteState::kFilter_Nearest;
+  else
+    state.Filter = OGLSpriteState::kFilter_Standard;
 
   float width = bmpToDraw->GetWidthToRender();
   float height = bmpToDraw->GetHeightToRender();
@@ -1116,67 +1190,108 @@ void OGLGraphicsDriver::_renderSprite(const OGLDrawListEntry *drawListEntry,
     // Self sprite transform (first scale, then rotate and then translate, reversed)
     transform = glmex::transform2d(transform, thisX, thisY, widthToScale, heightToScale, 0.f);
 
-    glUniformMatrix4fv(program.MVPMatrix, 1, GL_FALSE, glm::value_ptr(transform));
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, txdata->_tiles[ti].texture);
-
-    if ((_smoothScaling) && bmpToDraw->_useResampler && (bmpToDraw->_stretchToHeight > 0) &&
-        ((bmpToDraw->_stretchToHeight != bmpToDraw->_height) ||
-         (bmpToDraw->_stretchToWidth != bmpToDraw->_width)))
+    // Draw the pending quads if this one cannot be drawn along with them
+    state.Texture = txdata->_tiles[ti].texture;
+    if (state != _quadState)
     {
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    }
-    else if (_do_render_to_texture)
-    {
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      FlushSpriteQuads();
+      _quadState = state;
     }
-    else
+
+    // Transform the quad here, as the quads drawn together cannot have their own matrixes
+    const OGLCUSTOMVERTEX *vertices = (txdata->_vertex != nullptr) ? &txdata->_vertex[ti * 4] : defaultVertices;
+    OGLCUSTOMVERTEX quad[4];
+    for (int i = 0; i < 4; ++i)
     {
-      _filter->SetFilteringForStandardSprite();
+      const glm::vec4 pos = transform * glm::vec4(vertices[i].position.x, vertices[i].position.y, 0.f, 1.f);
+      quad[i].position.x = pos.x;
+      quad[i].position.y = pos.y;
+      quad[i].tu = vertices[i].tu;
+      quad[i].tv = vertices[i].tv;
     }
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+    // Same two triangles that a strip of 4 vertices has
+    const int quad_order[6] = { 0, 1, 2, 1, 3, 2 };
+    for (int i : quad_order)
+      _quadVertices.push_back(quad[i]);
+    _quadCount++;
+  }
+}
 
-    if (txdata->_vertex != nullptr)
-    {
-        glEnableVertexAttribArray(0);
-        GLint a_Position = glGetAttribLocation(program.Program, "a_Position");
-        glVertexAttribPointer(a_Position, 2, GL_FLOAT, GL_FALSE, sizeof(OGLCUSTOMVERTEX), &(txdata->_vertex[ti * 4].position));
+void OGLGraphicsDriver::FlushSpriteQuads()
+{
+  if (_quadVertices.empty())
+    return;
 
-        glEnableVertexAttribArray(1);
-        GLint a_TexCoord = glGetAttribLocation(program.Program, "a_TexCoord");
-        glVertexAttribPointer(a_TexCoord, 2, GL_FLOAT, GL_FALSE, sizeof(OGLCUSTOMVERTEX), &(txdata->_vertex[ti * 4].tu));
-    }
-    else
-    {
-        glEnableVertexAttribArray(0);
-        GLint a_Position = glGetAttribLocation(program.Program, "a_Position");
-        glVertexAttribPointer(a_Position, 2, GL_FLOAT, GL_FALSE, sizeof(OGLCUSTOMVERTEX), &(defaultVertices[0].position));
+  const ShaderProgram &program = *_quadState.Program;
+  glUseProgram(program.Program);
+  if (_quadState.Program == &_tintShader)
+  {
+    glUniform3f(program.TintHSV, _quadState.Tint[0], _quadState.Tint[1], _quadState.Tint[2]);
+    glUniform1f(program.TintAmount, _quadState.TintAmount);
+    glUniform1f(program.TintLuminance, _quadState.TintLuminance);
+  }
+  else if (_quadState.Program == &_lightShader)
+  {
+    glUniform1f(program.LightingAmount, _quadState.LightingAmount);
+  }
 
-        glEnableVertexAttribArray(1);
-        GLint a_TexCoord = glGetAttribLocation(program.Program, "a_TexCoord");
-        glVertexAttribPointer(a_TexCoord, 2, GL_FLOAT, GL_FALSE, sizeof(OGLCUSTOMVERTEX), &(defaultVertices[0].tu));
-    }
+  glUniform1i(program.TextureId, 0);
+  glUniform1f(program.Alpha, _quadState.Alpha);
+  // Quads are transformed already
+  const glm::mat4 identity(1.f);
+  glUniformMatrix4fv(program.MVPMatrix, 1, GL_FALSE, glm::value_ptr(identity));
 
-    // Treat special render modes
-    switch (bmpToDraw->_renderHint)
-    {
-    case kTxHint_PremulAlpha:
-        glBlendColor(alpha / 255.0f, alpha / 255.0f, alpha / 255.0f, 1.0);
-        SetBlendOpRGB(GL_FUNC_ADD, GL_CONSTANT_COLOR, GL_ONE_MINUS_SRC_ALPHA);
-        break;
-    default: break;
-    }
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, _quadState.Texture);
 
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  switch (_quadState.Filter)
+  {
+  case OGLSpriteState::kFilter_Linear:
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    break;
+  case OGLSpriteState::kFilter_Nearest:
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    break;
+  default:
+    _filter->SetFilteringForStandardSprite();
+    break;
+  }
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+
+  glEnableVertexAttribArray(0);
+  GLint a_Position = glGetAttribLocation(program.Program, "a_Position");
+  glVertexAttribPointer(a_Position, 2, GL_FLOAT, GL_FALSE, sizeof(OGLCUSTOMVERTEX), &(_quadVertices[0].position));
+
+  glEnableVertexAttribArray(1);
+  GLint a_TexCoord = glGetAttribLocation(program.Program, "a_TexCoord");
+  glVertexAttribPointer(a_TexCoord, 2, GL_FLOAT, GL_FALSE, sizeof(OGLCUSTOMVERTEX), &(_quadVertices[0].tu));
 
-    // Restore default blending mode
-    SetBlendOpRGB(GL_FUNC_ADD, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  // Treat special render modes
+  switch (_quadState.RenderHint)
+  {
+  case kTxHint_PremulAlpha:
+    glBlendColor(_quadState.Alpha, _quadState.Alpha, _quadState.Alpha, 1.0);
+    SetBlendOpRGB(GL_FUNC_ADD, GL_CONSTANT_COLOR, GL_ONE_MINUS_SRC_ALPHA);
+    break;
+  default: break;
   }
+
+  glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(_quadVertices.size()));
+
+  // Restore default blending mode
+  SetBlendOpRGB(GL_FUNC_ADD, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
   glUseProgram(0);
+
+  _frameStats.DrawCalls++;
+  _frameStats.Sprites += _quadCount;
+  if (_quadCount > 1)
+    _frameStats.Batches++;
+  _quadVertices.clear();
+  _quadCount = 0u;
+  _quadState = OGLSpriteState();
 }
 
 void OGLGraphicsDriver::_render(bool clearDrawListAfterwards)
@@ -1196,6 +1311,7 @@ void OGLGraphicsDriver::_render(bool clearDrawListAfterwards)
   }
 #endif
   glm::mat4 projection;
+  _frameStats = RenderStats();
 
   if (_do_render_to_texture)
   {
@@ -1265,10 +1381,12 @@ void OGLGraphicsDriver::_render(bool clearDrawListAfterwards)
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    _frameStats.DrawCalls++;
 
     glEnable(GL_BLEND);
     glUseProgram(0);
   }
+  _lastFrameStats = _frameStats;
 
   glFinish();
 
@@ -1438,7 +1556,9 @@ size_t OGLGraphicsDriver::RenderSpriteBatch(const OGLSpriteBatch &batch, size_t
         switch (reinterpret_cast<intptr_t>(e.ddb))
         {
         case DRAWENTRY_STAGECALLBACK:
-            // raw-draw plugin support
+            // raw-draw plugin support; plugin may draw on its own,
+            // so the sprites before this must be drawn first
+            FlushSpriteQuads();
             int sx, sy;
             if (auto *ddb = DoSpriteEvtCallback(e.x, 0, sx, sy))
             {
@@ -1451,6 +1571,8 @@ size_t OGLGraphicsDriver::RenderSpriteBatch(const OGLSpriteBatch &batch, size_t
             break;
         }
     }
+    // Draw remaining sprites before the render target or clip changes
+    FlushSpriteQuads();
     return from;
 }
 
@@ -1595,14 +1717,25 @@ void OGLGraphicsDriver::DestroyDDB(IDriverDependantBitmap* ddb)
 }
 
 
-void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap, bool has_alpha, bool opaque)
+void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap, bool has_alpha, bool opaque,
+    const Rect &dirty)
 {
   int textureHeight = tile->height;
   int textureWidth = tile->width;
 
-  // TODO: this seem to be tad overcomplicated, these conversions were made
-  // when texture is just created. Check later if this operation here may be removed.
-  AdjustSizeToNearestSupportedByCard(&textureWidth, &textureHeight);
+  const bool in_atlas = tile->atlasX >= 0;
+  if (in_atlas)
+  {
+    // The region on the atlas page has a 1 pixel border around the image
+    textureWidth += 2;
+    textureHeight += 2;
+  }
+  else
+  {
+    // TODO: this seem to be tad overcomplicated, these conversions were made
+    // when texture is just created. Check later if this operation here may be removed.
+    AdjustSizeToNearestSupportedByCard(&textureWidth, &textureHeight);
+  }
 
   int tilex = 0, tiley = 0, tileWidth = tile->width, tileHeight = tile->height;
   if (textureWidth > tile->width)
@@ -1618,64 +1751,149 @@ void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap
       tileHeight += 1 + texyoff;
   }
 
+  // Find the changed part of the tile, in the tile's coordinates; with linear
+  // filtering the transparent pixels take the colour of their neighbours,
+  // so the pixels around the changed ones have to be updated too
   const bool usingLinearFiltering = _filter->UseLinearFiltering();
-  uint8_t *origPtr = new uint8_t[sizeof(int) * tileWidth * tileHeight];
-  const int pitch = tileWidth * sizeof(int);
-  uint8_t *memPtr = origPtr + pitch * tiley + tilex * sizeof(int);
-
-  TextureTile fixedTile;
-  fixedTile.x = tile->x;
-  fixedTile.y = tile->y;
-  fixedTile.width = std::min(tile->width, tileWidth);
-  fixedTile.height = std::min(tile->height, tileHeight);
-  if (opaque)
-    BitmapToVideoMemOpaque(bitmap, has_alpha, &fixedTile, memPtr, pitch);
-  else
-    BitmapToVideoMem(bitmap, has_alpha, &fixedTile, memPtr, pitch, usingLinearFiltering);
+  const int margin = usingLinearFiltering ? 1 : 0;
+  const Rect tile_rc = RectWH(0, 0, tile->width, tile->height);
+  const Rect upd_rc = IntersectRects(tile_rc,
+      Rect(dirty.Left - tile->x - margin, dirty.Top - tile->y - margin,
+           dirty.Right - tile->x + margin, dirty.Bottom - tile->y + margin));
+  if (upd_rc.IsEmpty())
+    return;
 
-  // Mimic the behaviour of GL_CLAMP_EDGE for the tile edges
-  // NOTE: on some platforms GL_CLAMP_EDGE does not work with the version of OpenGL we're using.
-  if (tile->width < tileWidth)
+  // Uploaded part of the texture includes the edges around the image, if they are affected
+  const int edge_left = (tilex > 0 && upd_rc.Left == 0) ? 1 : 0;
+  const int edge_right = (tile->width < tileWidth && upd_rc.Right == tile->width - 1) ? 1 : 0;
+  const int edge_top = (tiley > 0 && upd_rc.Top == 0) ? 1 : 0;
+  const int edge_bottom = (tile->height < tileHeight && upd_rc.Bottom == tile->height - 1) ? 1 : 0;
+  Rect tex_rc(tilex + upd_rc.Left - edge_left, tiley + upd_rc.Top - edge_top,
+      tilex + upd_rc.Right + edge_right, tiley + upd_rc.Bottom + edge_bottom);
+
+  // 32-bit bitmaps with alpha channel, which do not have a mask colour,
+  // may have their pixels in the texture's format already
+  GLenum direct_format = 0;
+  if (opaque && has_alpha && bitmap->GetColorDepth() == 32 && _rgb_a_shift_32 == 24 && _rgb_g_shift_32 == 8)
   {
-    if (tilex > 0)
+    if (_rgb_r_shift_32 == 0 && _rgb_b_shift_32 == 16)
+      direct_format = GL_RGBA;
+#if !AGS_OPENGL_ES2
+    else if (_rgb_r_shift_32 == 16 && _rgb_b_shift_32 == 0)
+      direct_format = GL_BGRA;
+#endif
+  }
+
+  auto fill_pixels = [&](uint8_t *buf, int pitch)
+  {
+    uint8_t *memPtr = buf + pitch * edge_top + edge_left * sizeof(int);
+    TextureTile fixedTile;
+    fixedTile.x = tile->x + upd_rc.Left;
+    fixedTile.y = tile->y + upd_rc.Top;
+    fixedTile.width = upd_rc.GetWidth();
+    fixedTile.height = upd_rc.GetHeight();
+    if (direct_format)
     {
-      for (int y = 0; y < tileHeight; y++)
+      for (int y = 0; y < fixedTile.height; ++y)
+        memcpy(memPtr + y * pitch, bitmap->GetScanLine(fixedTile.y + y) + fixedTile.x * sizeof(int),
+          fixedTile.width * sizeof(int));
+    }
+    else if (opaque)
+    {
+      BitmapToVideoMemOpaque(bitmap, has_alpha, &fixedTile, memPtr, pitch);
+    }
+    else
+    {
+      // Conversion has to see the neighbours of the updated pixels too
+      const Rect cvt_rc = IntersectRects(tile_rc,
+        Rect(upd_rc.Left - margin, upd_rc.Top - margin, upd_rc.Right + margin, upd_rc.Bottom + margin));
+      if (cvt_rc == upd_rc)
+      {
+        BitmapToVideoMem(bitmap, has_alpha, &fixedTile, memPtr, pitch, usingLinearFiltering);
+      }
+      else
       {
-        unsigned int* edge_left_col = (unsigned int*)(origPtr + y * pitch + (tilex - 1) * sizeof(int));
-        unsigned int* bm_left_col = (unsigned int*)(origPtr + y * pitch + (tilex) * sizeof(int));
-        *edge_left_col = *bm_left_col & 0x00FFFFFF;
+        TextureTile cvtTile;
+        cvtTile.x = tile->x + cvt_rc.Left;
+        cvtTile.y = tile->y + cvt_rc.Top;
+        cvtTile.width = cvt_rc.GetWidth();
+        cvtTile.height = cvt_rc.GetHeight();
+        const int cvt_pitch = cvtTile.width * sizeof(int);
+        _convertBuffer.resize(cvt_pitch * cvtTile.height);
+        BitmapToVideoMem(bitmap, has_alpha, &cvtTile, _convertBuffer.data(), cvt_pitch, usingLinearFiltering);
+        const uint8_t *src_ptr = _convertBuffer.data() + cvt_pitch * (upd_rc.Top - cvt_rc.Top) +
+          (upd_rc.Left - cvt_rc.Left) * sizeof(int);
+        for (int y = 0; y < fixedTile.height; ++y)
+          memcpy(memPtr + y * pitch, src_ptr + y * cvt_pitch, fixedTile.width * sizeof(int));
       }
     }
-    for (int y = 0; y < tileHeight; y++)
+
+    // Mimic the behaviour of GL_CLAMP_EDGE for the tile edges
+    // NOTE: on some platforms GL_CLAMP_EDGE does not work with the version of OpenGL we're using.
+    const int width = tex_rc.GetWidth();
+    const int height = tex_rc.GetHeight();
+    for (int y = 0; y < height; y++)
     {
-      unsigned int* edge_right_col = (unsigned int*)(origPtr + y * pitch + (tilex + tile->width) * sizeof(int));
-      unsigned int* bm_right_col = edge_right_col - 1;
-      *edge_right_col = *bm_right_col & 0x00FFFFFF;
+      unsigned int *row = (unsigned int*)(buf + y * pitch);
+      if (edge_left)
+        row[0] = row[1] & 0x00FFFFFF;
+      if (edge_right)
+        row[width - 1] = row[width - 2] & 0x00FFFFFF;
     }
-  }
-  if (tile->height < tileHeight)
-  {
-    if (tiley > 0)
+    if (edge_top)
     {
-      unsigned int* edge_top_row = (unsigned int*)(origPtr + pitch * (tiley - 1));
-      unsigned int* bm_top_row = (unsigned int*)(origPtr + pitch * (tiley));
-      for (int x = 0; x < tileWidth; x++)
-      {
+      unsigned int *edge_top_row = (unsigned int*)(buf);
+      unsigned int *bm_top_row = (unsigned int*)(buf + pitch);
+      for (int x = 0; x < width; x++)
         edge_top_row[x] = bm_top_row[x] & 0x00FFFFFF;
-      }
     }
-    unsigned int* edge_bottom_row = (unsigned int*)(origPtr + pitch * (tiley + tile->height));
-    unsigned int* bm_bottom_row = (unsigned int*)(origPtr + pitch * (tiley + tile->height - 1));
-    for (int x = 0; x < tileWidth; x++)
+    if (edge_bottom)
     {
-      edge_bottom_row[x] = bm_bottom_row[x] & 0x00FFFFFF;
+      unsigned int *edge_bottom_row = (unsigned int*)(buf + pitch * (height - 1));
+      unsigned int *bm_bottom_row = (unsigned int*)(buf + pitch * (height - 2));
+      for (int x = 0; x < width; x++)
+        edge_bottom_row[x] = bm_bottom_row[x] & 0x00FFFFFF;
     }
-  }
+  };
 
-  glBindTexture(GL_TEXTURE_2D, tile->texture);
-  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tileWidth, tileHeight, GL_RGBA, GL_UNSIGNED_BYTE, origPtr);
+  if (in_atlas)
+    tex_rc = OffsetRect(tex_rc, Point(tile->atlasX, tile->atlasY));
+  UploadTexturePixels(tile->texture, tex_rc, direct_format ? direct_format : GL_RGBA, fill_pixels);
+}
 
-  delete []origPtr;
+void OGLGraphicsDriver::UploadTexturePixels(unsigned int texture, const Rect &rc, GLenum format,
+    const std::function<void(uint8_t *buf, int pitch)> &fill)
+{
+  const int pitch = rc.GetWidth() * sizeof(int);
+  const size_t size = pitch * rc.GetHeight();
+  glBindTexture(GL_TEXTURE_2D, texture);
+#if !AGS_OPENGL_ES2
+  if (_pixelBuffers[0] != 0)
+  {
+    // Take the next buffer in turn, and let GL give it a new storage, so that
+    // we don't have to wait until the previous transfer from it is complete
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pixelBuffers[_pixelBufferIndex]);
+    _pixelBufferIndex = (_pixelBufferIndex + 1) % PixelBufferCount;
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    uint8_t *buf = static_cast<uint8_t*>(glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY));
+    if (buf)
+    {
+      fill(buf, pitch);
+      // Unmapping may fail if the buffer's contents got lost, then do a usual upload
+      if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER))
+      {
+        // The texture is updated from the buffer asynchronously
+        glTexSubImage2D(GL_TEXTURE_2D, 0, rc.Left, rc.Top, rc.GetWidth(), rc.GetHeight(), format, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return;
+      }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  }
+#endif
+  _uploadBuffer.resize(size);
+  fill(_uploadBuffer.data(), pitch);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, rc.Left, rc.Top, rc.GetWidth(), rc.GetHeight(), format, GL_UNSIGNED_BYTE, _uploadBuffer.data());
 }
 
 void OGLGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* ddb, Bitmap *bitmap, bool has_alpha)
@@ -1687,6 +1905,11 @@ void OGLGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* ddb, Bitmap
 }
 
 void OGLGraphicsDriver::UpdateTexture(Texture *txdata, Bitmap *bitmap, bool has_alpha, bool opaque)
+{
+  UpdateTextureRect(txdata, bitmap, has_alpha, opaque, RectWH(0, 0, bitmap->GetWidth(), bitmap->GetHeight()));
+}
+
+void OGLGraphicsDriver::UpdateTextureRect(Texture *txdata, Bitmap *bitmap, bool has_alpha, bool opaque, const Rect &dirty)
 {
   const int color_depth = bitmap->GetColorDepth();
   if (bitmap->GetColorDepth() != txdata->Res.ColorDepth)
@@ -1700,7 +1923,7 @@ void OGLGraphicsDriver::UpdateTexture(Texture *txdata, Bitmap *bitmap, bool has_
   auto *ogldata = reinterpret_cast<OGLTexture*>(txdata);
   for (size_t i = 0; i < ogldata->_numTiles; ++i)
   {
-    UpdateTextureRegion(&ogldata->_tiles[i], bitmap, has_alpha, opaque);
+    UpdateTextureRegion(&ogldata->_tiles[i], bitmap, has_alpha, opaque, dirty);
   }
 
   if (color_depth == 8)
@@ -1787,6 +2010,52 @@ std::shared_ptr<Texture> OGLGraphicsDriver::GetTexture(IDriverDependantBitmap *d
     return std::static_pointer_cast<Texture>((reinterpret_cast<OGLBitmap*>(ddb))->_data);
 }
 
+OGLTexture *OGLGraphicsDriver::CreateAtlasTexture(int width, int height, int color_depth)
+{
+  unsigned int page_texture;
+  // Reserve a 1 pixel border around the image, same as the standalone textures
+  // have, so that the neighbouring images do not show with linear filtering
+  const AtlasRegion region = _textureAtlas->Allocate(width + 2, height + 2, page_texture);
+  if (!region.IsValid())
+    return nullptr;
+
+  auto *txdata = new OGLTexture(GraphicResolution(width, height, color_depth), false);
+  txdata->_atlas = _textureAtlas;
+  txdata->_atlasRegion = region;
+  txdata->_numTiles = 1;
+  txdata->_tiles = new OGLTextureTile[1];
+  OGLTextureTile &tile = txdata->_tiles[0];
+  tile.width = width;
+  tile.height = height;
+  tile.texture = page_texture;
+  tile.atlasX = region.X;
+  tile.atlasY = region.Y;
+
+  // Only the image's part of the page is drawn
+  const float page_size = static_cast<float>(_textureAtlas->GetPageSize());
+  txdata->_vertex = new OGLCUSTOMVERTEX[4];
+  for (int i = 0; i < 4; ++i)
+  {
+    txdata->_vertex[i] = defaultVertices[i];
+    txdata->_vertex[i].tu = (region.X + 1 + (defaultVertices[i].tu > 0.f ? width : 0)) / page_size;
+    txdata->_vertex[i].tv = (region.Y + 1 + (defaultVertices[i].tv > 0.f ? height : 0)) / page_size;
+  }
+  return txdata;
+}
+
+Texture *OGLGraphicsDriver::CreateTexture(Bitmap *bmp, bool has_alpha, bool opaque)
+{
+  // Small sprite textures are put on the shared atlas pages
+  const int width = bmp->GetWidth(), height = bmp->GetHeight();
+  Texture *txdata = nullptr;
+  if (_textureAtlas && (width + 2 <= _atlasMaxTextureSize) && (height + 2 <= _atlasMaxTextureSize))
+    txdata = CreateAtlasTexture(width, height, bmp->GetColorDepth());
+  if (!txdata)
+    return VideoMemoryGraphicsDriver::CreateTexture(bmp, has_alpha, opaque);
+  UpdateTexture(txdata, bmp, has_alpha, opaque);
+  return txdata;
+}
+
 Texture *OGLGraphicsDriver::CreateTexture(int width, int height, int color_depth, bool /*opaque*/, bool as_render_target)
 {
   assert(width > 0);
@@ -2074,6 +2343,11 @@ void OGLGraphicsDriver::SetScreenTint(int red, int green, int blue)
     _spriteList.push_back(OGLDrawListEntry(ddb, _actSpriteBatch, 0, 0));
 }
 
+bool OGLGraphicsDriver::GetRenderStats(RenderStats &stats)
+{
+    stats = _lastFrameStats;
+    return true;
+}
 
 bool OGLGraphicsDriver::SetVsyncImpl(bool enabled, bool &vsync_res)
 {
@@ -19,7 +19,9 @@
 #ifndef __AGS_EE_GFX__ALI3DOGL_H
 #define __AGS_EE_GFX__ALI3DOGL_H
 
+#include <functional>
 #include <memory>
+#include <vector>
 
 #include "glm/glm.hpp"
 
@@ -27,6 +29,7 @@
 #include "gfx/ddb.h"
 #include "gfx/gfxdriverfactorybase.h"
 #include "gfx/gfxdriverbase.h"
+#include "gfx/texture_atlas.h"
 #include "util/string.h"
 #include "util/version.h"
 
@@ -60,6 +63,28 @@ struct OGLCUSTOMVERTEX
 struct OGLTextureTile : public TextureTile
 {
     unsigned int texture = 0;
+    // Position of the tile's region on the atlas page, if it's placed on one
+    int atlasX = -1, atlasY = -1;
+};
+
+// Atlas of the small textures, which are placed on the shared GL textures
+// (pages), letting the driver draw many different sprites with one call.
+class OGLTextureAtlas
+{
+public:
+    OGLTextureAtlas(int page_size) : _atlas(page_size, page_size) {}
+    ~OGLTextureAtlas();
+
+    int GetPageSize() const { return _atlas.GetPageWidth(); }
+    // Allocates a region, and gets the page's texture, which is created if necessary;
+    // returns an invalid region if it does not fit
+    AtlasRegion Allocate(int width, int height, unsigned int &texture);
+    // Releases the region, and deletes the page's texture if it's no longer used
+    void Release(const AtlasRegion &region);
+
+private:
+    TextureAtlas _atlas;
+    std::vector<unsigned int> _pageTextures;
 };
 
 // Full OpenGL texture data
@@ -68,6 +93,9 @@ struct OGLTexture : Texture
     OGLCUSTOMVERTEX *_vertex = nullptr;
     OGLTextureTile *_tiles = nullptr;
     size_t _numTiles = 0;
+    // The atlas which this texture's single tile is placed on, if any
+    std::shared_ptr<OGLTextureAtlas> _atlas;
+    AtlasRegion _atlasRegion;
 
     OGLTexture(const GraphicResolution &res, bool rt)
         : Texture(res, rt) {}
@@ -219,6 +247,39 @@ struct ShaderProgram
     GLuint LightingAmount = 0;
 };
 
+// Shader and texture settings of a sprite; the sprites with the same
+// settings may be drawn together
+struct OGLSpriteState
+{
+    enum Filtering
+    {
+        kFilter_Standard, // as set by the graphics filter
+        kFilter_Nearest,
+        kFilter_Linear
+    };
+
+    const ShaderProgram *Program = nullptr;
+    GLuint Texture = 0;
+    Filtering Filter = kFilter_Standard;
+    TextureHint RenderHint = kTxHint_Normal;
+    float Alpha = 0.f;
+    float Tint[3] {};
+    float TintAmount = 0.f;
+    float TintLuminance = 0.f;
+    float LightingAmount = 0.f;
+
+    bool operator ==(const OGLSpriteState &other) const
+    {
+        return Program == other.Program && Texture == other.Texture &&
+            Filter == other.Filter && RenderHint == other.RenderHint &&
+            Alpha == other.Alpha && Tint[0] == other.Tint[0] &&
+            Tint[1] == other.Tint[1] && Tint[2] == other.Tint[2] &&
+            TintAmount == other.TintAmount && TintLuminance == other.TintLuminance &&
+            LightingAmount == other.LightingAmount;
+    }
+    bool operator !=(const OGLSpriteState &other) const { return !(*this == other); }
+};
+
 class OGLGfxFilter;
 
 class OGLGraphicsDriver : public VideoMemoryGraphicsDriver
@@ -251,8 +312,12 @@ public:
     
     // Create texture data with the given parameters
     Texture *CreateTexture(int width, int height, int color_depth, bool opaque, bool as_render_target = false) override;
+    // Create texture and initialize its pixels from the given bitmap; small sprites are put on the atlas
+    Texture *CreateTexture(Bitmap *bmp, bool has_alpha, bool opaque = false) override;
     // Update texture data from the given bitmap
     void UpdateTexture(Texture *txdata, Bitmap *bitmap, bool has_alpha, bool opaque) override;
+    // Update the part of texture data corresponding to the given bitmap rectangle
+    void UpdateTextureRect(Texture *txdata, Bitmap *bitmap, bool has_alpha, bool opaque, const Rect &rc) override;
     // Retrieve shared texture data object from the given DDB
     std::shared_ptr<Texture> GetTexture(IDriverDependantBitmap *ddb) override;
 
@@ -271,6 +336,7 @@ public:
     void UseSmoothScaling(bool enabled) override { _smoothScaling = enabled; }
     void SetScreenFade(int red, int green, int blue) override;
     void SetScreenTint(int red, int green, int blue) override;
+    bool GetRenderStats(RenderStats &stats) override;
 
     typedef std::shared_ptr<OGLGfxFilter> POGLFilter;
 
@@ -306,6 +372,26 @@ private:
     ShaderProgram _lightShader;
     ShaderProgram _transparencyShader;
 
+    // Shared pages for the small sprite textures
+    std::shared_ptr<OGLTextureAtlas> _textureAtlas;
+    // Largest texture which may be put on the atlas page
+    int _atlasMaxTextureSize = 0;
+    // Sprite quads which are waiting to be drawn with the same settings;
+    // these are transformed to the clip space already
+    OGLSpriteState _quadState;
+    std::vector<OGLCUSTOMVERTEX> _quadVertices;
+    uint32_t _quadCount = 0u;
+    // Statistics of the frame being rendered, and the last rendered one
+    RenderStats _frameStats;
+    RenderStats _lastFrameStats;
+    // Pixel buffers for streaming the texture uploads, used in turns
+    static const int PixelBufferCount = 3;
+    unsigned int _pixelBuffers[PixelBufferCount] {};
+    int _pixelBufferIndex = 0;
+    // Buffers for the texture uploads and conversions when pixel buffers are not available
+    std::vector<uint8_t> _uploadBuffer;
+    std::vector<uint8_t> _convertBuffer;
+
     int device_screen_physical_width;
     int device_screen_physical_height;
 
@@ -371,11 +457,21 @@ private:
     // Unset parameters and release resources related to the display mode
     void ReleaseDisplayMode();
     void AdjustSizeToNearestSupportedByCard(int *width, int *height);
-    void UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap, bool has_alpha, bool opaque);
+    // Updates the tile's texture from the bitmap, only where it intersects the dirty rect
+    void UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap, bool has_alpha, bool opaque, const Rect &dirty);
+    // Writes pixels into the texture rect, using pixel buffer if available;
+    // fill callback receives the buffer to write pixels to, and its pitch
+    void UploadTexturePixels(unsigned int texture, const Rect &rc, GLenum format,
+        const std::function<void(uint8_t *buf, int pitch)> &fill);
+    // Creates texture data on the atlas page; returns null if there's no room for it
+    OGLTexture *CreateAtlasTexture(int width, int height, int color_depth);
     void CreateVirtualScreen();
     void do_fade(bool fadingOut, int speed, int targetColourRed, int targetColourGreen, int targetColourBlue);
+    // Adds sprite's quads to the pending ones, drawing those first if the sprite's settings are different
     void _renderSprite(const OGLDrawListEntry *entry, const glm::mat4 &projection, const glm::mat4 &matGlobal,
         const SpriteColorTransform &color, const Size &surface_size);
+    // Draws the pending sprite quads with one call
+    void FlushSpriteQuads();
     void SetupViewport();
     // Converts rectangle in top->down coordinates into OpenGL's native bottom->up coordinates
     Rect ConvertTopDownRect(const Rect &top_down_rect, int surface_height);
@@ -16,6 +16,7 @@
 #include <stack>
 #include "ac/sys_events.h"
 #include "gfx/ali3dexception.h"
+#include "gfx/blender.h"
 #include "gfx/gfxfilter_sdl_renderer.h"
 #include "gfx/gfx_util.h"
 #include "platform/base/agsplatformdriver.h"
@@ -31,7 +32,6 @@ namespace ALSW
 
 using namespace Common;
 
-static uint32_t _trans_alpha_blender32(uint32_t x, uint32_t y, uint32_t n);
 RGB faded_out_palette[256];
 
 
@@ -51,7 +51,8 @@ static auto fix_alpha_blender = SDL_ComposeCustomBlendMode(
 );
 #endif
 
-SDLRendererGraphicsDriver::SDLRendererGraphicsDriver()
+SDLRendererGraphicsDriver::SDLRendererGraphicsDriver(bool headless)
+    : _headless(headless)
 {
   _tint_red = 0;
   _tint_green = 0;
@@ -114,6 +115,17 @@ void SDLRendererGraphicsDriver::SetTintMethod(TintMethod /*method*/)
   // TODO: support new D3D-style tint method
 }
 
+void SDLRendererGraphicsDriver::SetRenderThreadCount(int count)
+{
+    const size_t threads = (count > 0) ? static_cast<size_t>(count) : ThreadPool::GetHardwareThreads();
+    // the calling thread is drawing too
+    const size_t workers = threads - 1;
+    if (workers == _renderPool.GetWorkerCount())
+        return;
+    _renderPool.Start(workers);
+    Debug::Printf("SDLRenderer: drawing sprites using %zu thread(s)", _renderPool.GetWorkerCount() + 1);
+}
+
 bool SDLRendererGraphicsDriver::SetDisplayMode(const DisplayMode &mode)
 {
   ReleaseDisplayMode();
@@ -129,7 +141,11 @@ bool SDLRendererGraphicsDriver::SetDisplayMode(const DisplayMode &mode)
   _capsVsync = true; // reset vsync flag, allow to try setting again
 
   SDL_Window *window = sys_get_window();
-  if (!window)
+  if (_headless)
+  {
+    Debug::Printf(kDbgMsg_Info, "Null renderer: no display output");
+  }
+  else if (!window)
   {
     window = sys_window_create("", mode.Width, mode.Height, mode.Mode);
 
@@ -194,6 +210,10 @@ void SDLRendererGraphicsDriver::CreateVirtualScreen()
   virtualScreen = _origVirtualScreen.get();
   _stageVirtualScreen = virtualScreen;
 
+  // Headless driver has no renderer to present the virtual screen with
+  if (!_renderer)
+    return;
+
   _screenTex = SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, vscreen_w, vscreen_h);
 
   // Fake bitmap that will wrap over texture pixels for simplier conversion
@@ -557,6 +577,17 @@ void SDLRendererGraphicsDriver::RenderToBackBuffer()
 
 size_t SDLRendererGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch, size_t from, Bitmap *surface, int surf_offx, int surf_offy)
 {
+  if (_renderPool.GetWorkerCount() > 0)
+  {
+    size_t to = from;
+    for (; (to < _spriteList.size()) && (_spriteList[to].node == batch.ID); ++to);
+    if (CanRenderSpritesTiled(from, to, surface))
+    {
+      RenderSpritesTiled(from, to, surface, surf_offx, surf_offy);
+      return to;
+    }
+  }
+
   for (; (from < _spriteList.size()) && (_spriteList[from].node == batch.ID); ++from)
   {
     const auto &sprite = _spriteList[from];
@@ -570,12 +601,56 @@ size_t SDLRendererGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch,
       surface = _stageVirtualScreen;
       continue;
     }
-    else if (sprite.ddb == reinterpret_cast<ALSoftwareBitmap*>(DRAWENTRY_TINT))
+    RenderSprite(sprite, surface, surf_offx, surf_offy);
+  }
+  return from;
+}
+
+bool SDLRendererGraphicsDriver::CanRenderSpritesTiled(size_t from, size_t to, Bitmap *surface) const
+{
+  // Only 32-bit drawing does not depend on Allegro's global blender state,
+  // and plugin callbacks must be run on the main thread
+  if ((from == to) || (surface->GetColorDepth() != 32))
+    return false;
+  for (size_t i = from; i < to; ++i)
+  {
+    const ALSoftwareBitmap *bitmap = _spriteList[i].ddb;
+    if (bitmap == nullptr)
+      return false;
+    if (bitmap == reinterpret_cast<ALSoftwareBitmap*>(DRAWENTRY_TINT))
+      continue;
+    if (!bitmap->_bmp || (bitmap->_bmp == surface) || (bitmap->_bmp->GetColorDepth() != 32))
+      return false;
+  }
+  return true;
+}
+
+void SDLRendererGraphicsDriver::RenderSpritesTiled(size_t from, size_t to, Bitmap *surface, int surf_offx, int surf_offy)
+{
+  // Each band is clipped to its rows, so every thread draws all the sprites
+  // in order, but only over its own part of the surface
+  GfxUtil::DrawInBands(surface, _renderPool, [this, from, to, surf_offx, surf_offy](Bitmap *band, int band_top)
+  {
+    for (size_t i = from; i < to; ++i)
+      RenderSprite(_spriteList[i], band, surf_offx, surf_offy - band_top);
+  });
+}
+
+void SDLRendererGraphicsDriver::RenderSprite(const ALDrawListEntry &sprite, Bitmap *surface, int surf_offx, int surf_offy)
+{
+    if (sprite.ddb == reinterpret_cast<ALSoftwareBitmap*>(DRAWENTRY_TINT))
     {
       // draw screen tint fx
-      set_trans_blender(_tint_red, _tint_green, _tint_blue, 0);
-      surface->LitBlendBlt(surface, 0, 0, 128);
-      continue;
+      if (surface->GetColorDepth() == 32)
+      {
+        GfxUtil::LitBlendBlt32(surface, surface, 0, 0, kRowBlend_Trans, _tint_red, _tint_green, _tint_blue, 128);
+      }
+      else
+      {
+        set_trans_blender(_tint_red, _tint_green, _tint_blue, 0);
+        surface->LitBlendBlt(surface, 0, 0, 128);
+      }
+      return;
     }
 
     ALSoftwareBitmap* bitmap = sprite.ddb;
@@ -593,12 +668,22 @@ size_t SDLRendererGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch,
     }
     else if (bitmap->_hasAlpha)
     {
-      if (bitmap->_alpha == 255) // no global transparency, simple alpha blend
-        set_alpha_blender();
+      if (surface->GetColorDepth() == 32 && bitmap->_bmp->GetColorDepth() == 32)
+      {
+        if (bitmap->_alpha == 255) // no global transparency, simple alpha blend
+          GfxUtil::BlendBlt32(surface, bitmap->_bmp, drawAtX, drawAtY, kRowBlend_ArgbToRgb, 0);
+        else
+          GfxUtil::BlendBlt32(surface, bitmap->_bmp, drawAtX, drawAtY, kRowBlend_TransAlpha, bitmap->_alpha);
+      }
       else
-        set_blender_mode(nullptr, nullptr, _trans_alpha_blender32, 0, 0, 0, bitmap->_alpha);
+      {
+        if (bitmap->_alpha == 255) // no global transparency, simple alpha blend
+          set_alpha_blender();
+        else
+          set_blender_mode(nullptr, nullptr, _trans_alpha_blender32, 0, 0, 0, bitmap->_alpha);
 
-      surface->TransBlendBlt(bitmap->_bmp, drawAtX, drawAtY);
+        surface->TransBlendBlt(bitmap->_bmp, drawAtX, drawAtY);
+      }
     }
     else
     {
@@ -606,8 +691,6 @@ size_t SDLRendererGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch,
       GfxUtil::DrawSpriteWithTransparency(surface, bitmap->_bmp, drawAtX, drawAtY,
           bitmap->_alpha);
     }
-  }
-  return from;
 }
 
 void SDLRendererGraphicsDriver::BlitToTexture()
@@ -946,30 +1029,10 @@ void SDLRendererGraphicsDriver::BoxOutEffect(bool blackingOut, int speed, int de
 }
 // end fading routines
 
-// add the alpha values together, used for compositing alpha images
-// TODO: why is this here, move to gfx/blender? check if there's already similar function there
-static uint32_t _trans_alpha_blender32(uint32_t x, uint32_t y, uint32_t n)
-{
-   uint32_t res, g;
-
-   n = (n * geta32(x)) / 256;
-
-   if (n)
-      n++;
-
-   res = ((x & 0xFF00FF) - (y & 0xFF00FF)) * n / 256 + y;
-   y &= 0xFF00;
-   x &= 0xFF00;
-   g = (x - y) * n / 256 + y;
-
-   res &= 0xFF00FF;
-   g &= 0xFF00;
-
-   return res | g;
-}
-
 bool SDLRendererGraphicsDriver::SetVsyncImpl(bool enabled, bool &vsync_res)
 {
+    if (!_renderer)
+        return false;
     #if SDL_VERSION_ATLEAST(2, 0, 18)
     if (SDL_RenderSetVSync(_renderer, enabled) == 0) // 0 on success
     {
@@ -1034,6 +1097,50 @@ SDLRendererGfxFilter *SDLRendererGraphicsFactory::CreateFilter(const String &id)
     return nullptr;
 }
 
+
+NullGraphicsFactory *NullGraphicsFactory::_factory = nullptr;
+
+NullGraphicsFactory::~NullGraphicsFactory()
+{
+    _factory = nullptr;
+}
+
+size_t NullGraphicsFactory::GetFilterCount() const
+{
+    return 1;
+}
+
+const GfxFilterInfo *NullGraphicsFactory::GetFilterInfo(size_t index) const
+{
+    return (index == 0) ? &SDLRendererGfxFilter::FilterInfo : nullptr;
+}
+
+String NullGraphicsFactory::GetDefaultFilterID() const
+{
+    return SDLRendererGfxFilter::FilterInfo.Id;
+}
+
+/* static */ NullGraphicsFactory *NullGraphicsFactory::GetFactory()
+{
+    if (!_factory)
+        _factory = new NullGraphicsFactory();
+    return _factory;
+}
+
+SDLRendererGraphicsDriver *NullGraphicsFactory::EnsureDriverCreated()
+{
+    if (!_driver)
+        _driver = new SDLRendererGraphicsDriver(true);
+    return _driver;
+}
+
+SDLRendererGfxFilter *NullGraphicsFactory::CreateFilter(const String &id)
+{
+    if (SDLRendererGfxFilter::FilterInfo.Id.CompareNoCase(id) == 0)
+        return new SDLRendererGfxFilter();
+    return nullptr;
+}
+
 } // namespace ALSW
 } // namespace Engine
 } // namespace AGS
@@ -15,6 +15,9 @@
 // Software graphics factory, draws raw bitmaps onto a virtual screen,
 // converts to SDL_Texture and finally presents with SDL_Renderer.
 //
+// Null graphics factory creates the same driver in a headless mode: it draws
+// on the virtual screen, but has no window and never presents anything.
+//
 // TODO: replace nearest-neighbour software filter with SDL's own accelerated
 // scaling, maybe add more filter types if SDL renderer supports them.
 // Only keep Hqx filter as a software option (might need to change how the 
@@ -30,6 +33,7 @@
 #include "gfx/ddb.h"
 #include "gfx/gfxdriverfactorybase.h"
 #include "gfx/gfxdriverbase.h"
+#include "util/threadpool.h"
 
 namespace AGS
 {
@@ -148,10 +152,11 @@ typedef std::vector<ALSpriteBatch> ALSpriteBatches;
 class SDLRendererGraphicsDriver : public GraphicsDriverBase
 {
 public:
-    SDLRendererGraphicsDriver();
+    // Headless driver creates no window, and only draws on the virtual screen
+    SDLRendererGraphicsDriver(bool headless = false);
 
-    const char*GetDriverName() override { return "SDL 2D Software renderer"; }
-    const char*GetDriverID() override { return "Software"; }
+    const char*GetDriverName() override { return _headless ? "Null renderer" : "SDL 2D Software renderer"; }
+    const char*GetDriverID() override { return _headless ? "Null" : "Software"; }
 
     bool RequiresFullRedrawEachFrame() override { return false; }
     bool HasAcceleratedTransform() override { return false; }
@@ -207,6 +212,7 @@ public:
     void UseSmoothScaling(bool /*enabled*/) override { }
     bool DoesSupportVsyncToggle() override { return (SDL_VERSION_ATLEAST(2, 0, 18)) && _capsVsync; }
     void RenderSpritesAtScreenResolution(bool /*enabled*/, int /*supersampling*/) override { }
+    void SetRenderThreadCount(int count) override;
     Bitmap *GetMemoryBackBuffer() override;
     void SetMemoryBackBuffer(Bitmap *backBuffer) override;
     Bitmap *GetStageBackBuffer(bool mark_dirty) override;
@@ -223,6 +229,7 @@ protected:
     size_t GetLastDrawEntryIndex() override { return _spriteList.size(); }
 
 private:
+    const bool _headless = false;
     PSDLRenderFilter _filter;
 
     bool _hasGamma = false;
@@ -254,6 +261,8 @@ private:
     ALSpriteBatches _spriteBatches;
     // List of sprites to render
     std::vector<ALDrawListEntry> _spriteList;
+    // Worker threads for drawing sprite batches in parallel, band by band
+    Common::ThreadPool _renderPool;
 
     void InitSpriteBatch(size_t index, const SpriteBatchDesc &desc) override;
     void ResetAllBatches() override;
@@ -265,6 +274,13 @@ private:
     void ReleaseDisplayMode();
     // Renders single sprite batch on the precreated surface
     size_t RenderSpriteBatch(const ALSpriteBatch &batch, size_t from, Common::Bitmap *surface, int surf_offx, int surf_offy);
+    // Tells if the range of sprites may be drawn by several threads at once
+    bool CanRenderSpritesTiled(size_t from, size_t to, Common::Bitmap *surface) const;
+    // Splits the surface into horizontal bands, and draws the range of sprites
+    // on each band in parallel; the result is the same as drawing them in order
+    void RenderSpritesTiled(size_t from, size_t to, Common::Bitmap *surface, int surf_offx, int surf_offy);
+    // Draws a single sprite or effect entry on the surface
+    void RenderSprite(const ALDrawListEntry &sprite, Common::Bitmap *surface, int surf_offx, int surf_offy);
 
     void highcolor_fade_in(Bitmap *vs, void(*draw_callback)(), int speed, int targetColourRed, int targetColourGreen, int targetColourBlue);
     void highcolor_fade_out(Bitmap *vs, void(*draw_callback)(), int speed, int targetColourRed, int targetColourGreen, int targetColourBlue);
@@ -295,6 +311,25 @@ private:
     static SDLRendererGraphicsFactory *_factory;
 };
 
+
+class NullGraphicsFactory : public GfxDriverFactoryBase<SDLRendererGraphicsDriver, SDLRendererGfxFilter>
+{
+public:
+    ~NullGraphicsFactory() override;
+
+    size_t               GetFilterCount() const override;
+    const GfxFilterInfo *GetFilterInfo(size_t index) const override;
+    String               GetDefaultFilterID() const override;
+
+    static NullGraphicsFactory *GetFactory();
+
+private:
+    SDLRendererGraphicsDriver *EnsureDriverCreated() override;
+    SDLRendererGfxFilter      *CreateFilter(const String &id) override;
+
+    static NullGraphicsFactory *_factory;
+};
+
 } // namespace ALSW
 } // namespace Engine
 } // namespace AGS
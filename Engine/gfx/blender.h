@@ -41,6 +41,8 @@ uint32_t _myblender_color32_light(uint32_t x, uint32_t y, uint32_t n);
 // Customizable alpha blender that uses the supplied alpha value as src alpha,
 // and preserves destination's alpha channel (if there was one);
 void set_my_trans_blender(int r, int g, int b, int a);
+// The 32-bit blender set by set_my_trans_blender
+uint32_t _myblender_alpha_trans24(uint32_t x, uint32_t y, uint32_t n);
 // Argb2argb alpha blender combines RGBs proportionally to src alpha, but also
 // applies dst alpha factor to the dst RGB used in the merge;
 // The final alpha is calculated by multiplying two translucences (1 - .alpha).
@@ -54,6 +56,11 @@ uint32_t _argb2rgb_blender(uint32_t src_col, uint32_t dst_col, uint32_t src_alph
 uint32_t _rgb2argb_blender(uint32_t src_col, uint32_t dst_col, uint32_t src_alpha);
 // Sets the alpha channel to opaque. Used when drawing a non-alpha sprite onto an alpha-sprite.
 uint32_t _opaque_alpha_blender(uint32_t src_col, uint32_t dst_col, uint32_t src_alpha);
+// Combines RGBs proportionally to src alpha multiplied by the custom alpha parameter,
+// discards alpha in the end. Used for compositing alpha images onto opaque surface.
+uint32_t _trans_alpha_blender32(uint32_t src_col, uint32_t dst_col, uint32_t src_alpha);
+// The 32-bit blender set by set_additive_alpha_blender
+uint32_t _additive_alpha_copysrc_blender(uint32_t src_col, uint32_t dst_col, uint32_t src_alpha);
 
 // Additive alpha blender plain copies src over, applying a summ of src and
 // dst alpha values.
@@ -0,0 +1,403 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "gfx/blender_simd.h"
+#include <allegro.h>
+#include "gfx/blender.h"
+
+#if defined(__AVX2__)
+#define AGS_BLEND_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define AGS_BLEND_SSE2
+#include <emmintrin.h>
+#endif
+
+extern "C" {
+    // Standard Allegro 4 trans blender for 24 and 32-bit color modes
+    uint32_t _blender_trans24(uint32_t x, uint32_t y, uint32_t n);
+}
+
+typedef uint32_t (*PfnPixelBlender)(uint32_t x, uint32_t y, uint32_t n);
+
+// Per-pixel blenders, matching RowBlender values
+static const PfnPixelBlender PixelBlenders[kNumRowBlenders] =
+{
+    _argb2argb_blender,
+    _argb2rgb_blender,
+    _rgb2argb_blender,
+    _opaque_alpha_blender,
+    _additive_alpha_copysrc_blender,
+    _trans_alpha_blender32,
+    _blender_trans24,
+    _myblender_alpha_trans24,
+    _myblender_color32,
+    _myblender_color32_light
+};
+
+static void blend_row32_scalar(PfnPixelBlender blender, const uint32_t *src, uint32_t *dst,
+    size_t count, uint32_t n)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t c = src[i];
+        if (c != MASK_COLOR_32)
+            dst[i] = blender(c, dst[i], n);
+    }
+}
+
+static void lit_row32_scalar(PfnPixelBlender blender, uint32_t color, const uint32_t *src, uint32_t *dst,
+    size_t count, uint32_t n)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t c = src[i];
+        if (c != MASK_COLOR_32)
+            dst[i] = blender(color, c, n);
+    }
+}
+
+
+#if defined(AGS_BLEND_AVX2) || defined(AGS_BLEND_SSE2)
+
+//-----------------------------------------------------------------------------
+// Vector backends.
+// Each backend provides the same set of operations over a vector of
+// unsigned 32-bit lanes, which let write the pixel blenders only once.
+// All the arithmetic is done in 32-bit lanes and wraps around same as the
+// per-pixel blenders do, so that the results are exactly the same.
+// A backend for another instruction set (e.g. ARM NEON) may be added by
+// implementing the same operations.
+//-----------------------------------------------------------------------------
+#if defined(AGS_BLEND_AVX2)
+struct VecOps
+{
+    typedef __m256i V;
+    static const size_t Width = 8;
+    static const char *Name() { return "AVX2"; }
+
+    static inline V Load(const uint32_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static inline void Store(uint32_t *p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static inline V Set1(uint32_t x) { return _mm256_set1_epi32(static_cast<int>(x)); }
+    static inline V Add(V a, V b) { return _mm256_add_epi32(a, b); }
+    static inline V Sub(V a, V b) { return _mm256_sub_epi32(a, b); }
+    static inline V Mul(V a, V b) { return _mm256_mullo_epi32(a, b); }
+    static inline V And(V a, V b) { return _mm256_and_si256(a, b); }
+    static inline V AndNot(V mask, V a) { return _mm256_andnot_si256(mask, a); }
+    static inline V Or(V a, V b) { return _mm256_or_si256(a, b); }
+    template <int N> static inline V Shr(V a) { return _mm256_srli_epi32(a, N); }
+    template <int N> static inline V Shl(V a) { return _mm256_slli_epi32(a, N); }
+    static inline V CmpEq(V a, V b) { return _mm256_cmpeq_epi32(a, b); }
+    // NOTE: signed comparison, only valid for values below INT32_MAX
+    static inline V CmpGt(V a, V b) { return _mm256_cmpgt_epi32(a, b); }
+    static inline V Select(V mask, V a, V b) { return _mm256_blendv_epi8(b, a, mask); }
+    static inline bool AllSet(V mask) { return _mm256_movemask_epi8(mask) == -1; }
+    // Calculates 0x10000 / d; d must be in [1; 256] range
+    static inline V Div65536(V d)
+    {
+        // for such divisors float division is precise enough to give exact integer result
+        return _mm256_cvttps_epi32(_mm256_div_ps(_mm256_set1_ps(65536.f), _mm256_cvtepi32_ps(d)));
+    }
+};
+#else // AGS_BLEND_SSE2
+struct VecOps
+{
+    typedef __m128i V;
+    static const size_t Width = 4;
+    static const char *Name() { return "SSE2"; }
+
+    static inline V Load(const uint32_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static inline void Store(uint32_t *p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static inline V Set1(uint32_t x) { return _mm_set1_epi32(static_cast<int>(x)); }
+    static inline V Add(V a, V b) { return _mm_add_epi32(a, b); }
+    static inline V Sub(V a, V b) { return _mm_sub_epi32(a, b); }
+    // SSE2 does not have 32-bit low multiplication, so multiply even and odd lanes separately
+    static inline V Mul(V a, V b)
+    {
+        const V even = _mm_mul_epu32(a, b);
+        const V odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+    static inline V And(V a, V b) { return _mm_and_si128(a, b); }
+    static inline V AndNot(V mask, V a) { return _mm_andnot_si128(mask, a); }
+    static inline V Or(V a, V b) { return _mm_or_si128(a, b); }
+    template <int N> static inline V Shr(V a) { return _mm_srli_epi32(a, N); }
+    template <int N> static inline V Shl(V a) { return _mm_slli_epi32(a, N); }
+    static inline V CmpEq(V a, V b) { return _mm_cmpeq_epi32(a, b); }
+    // NOTE: signed comparison, only valid for values below INT32_MAX
+    static inline V CmpGt(V a, V b) { return _mm_cmpgt_epi32(a, b); }
+    static inline V Select(V mask, V a, V b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+    static inline bool AllSet(V mask) { return _mm_movemask_epi8(mask) == 0xFFFF; }
+    // Calculates 0x10000 / d; d must be in [1; 256] range
+    static inline V Div65536(V d)
+    {
+        // for such divisors float division is precise enough to give exact integer result
+        return _mm_cvttps_epi32(_mm_div_ps(_mm_set1_ps(65536.f), _mm_cvtepi32_ps(d)));
+    }
+};
+#endif
+
+typedef VecOps::V V;
+
+// Mixes RGB proportionally to the alpha factor a (0 - 256), zeroes the alpha;
+// the common part of the Allegro-style blenders:
+// ((x & 0xFF00FF) - (y & 0xFF00FF)) * a / 256 + y, and same for the green
+static inline V MixRgb(V x, V y, V a)
+{
+    const V rb_mask = VecOps::Set1(0xFF00FF);
+    const V g_mask = VecOps::Set1(0xFF00);
+    V rb = VecOps::Add(VecOps::Shr<8>(VecOps::Mul(
+        VecOps::Sub(VecOps::And(x, rb_mask), VecOps::And(y, rb_mask)), a)), y);
+    const V yg = VecOps::And(y, g_mask);
+    V g = VecOps::Add(VecOps::Shr<8>(VecOps::Mul(
+        VecOps::Sub(VecOps::And(x, g_mask), yg), a)), yg);
+    return VecOps::Or(VecOps::And(rb, rb_mask), VecOps::And(g, g_mask));
+}
+
+// Returns a + 1 for the non-zero lanes
+static inline V IncNonZero(V a)
+{
+    const V zero = VecOps::Set1(0);
+    return VecOps::Add(a, VecOps::AndNot(VecOps::CmpEq(a, zero), VecOps::Set1(1)));
+}
+
+// Calculates the source alpha factor for the argb2argb and argb2rgb blenders
+static inline V SrcAlpha(V src, uint32_t n)
+{
+    V sa = VecOps::Shr<24>(src);
+    if (n > 0)
+        sa = VecOps::Shr<8>(VecOps::Mul(sa, VecOps::Set1((n & 0xFF) + 1)));
+    return sa;
+}
+
+// See argb2argb_blend_core
+static inline V Argb2ArgbCore(V src, V dst, V src_alpha)
+{
+    const V rb_mask = VecOps::Set1(0xFF00FF);
+    const V g_mask = VecOps::Set1(0xFF00);
+    const V v256 = VecOps::Set1(256);
+    const V sa = VecOps::Add(src_alpha, VecOps::Set1(1));
+    const V da = IncNonZero(VecOps::Shr<24>(dst));
+
+    V dst_g = VecOps::Shr<8>(VecOps::Mul(VecOps::And(dst, g_mask), da));
+    V dst_rb = VecOps::Shr<8>(VecOps::Mul(VecOps::And(dst, rb_mask), da));
+    dst_g = VecOps::And(VecOps::Add(VecOps::Shr<8>(VecOps::Mul(
+        VecOps::Sub(VecOps::And(src, g_mask), VecOps::And(dst_g, g_mask)), sa)), dst_g), g_mask);
+    dst_rb = VecOps::And(VecOps::Add(VecOps::Shr<8>(VecOps::Mul(
+        VecOps::Sub(VecOps::And(src, rb_mask), VecOps::And(dst_rb, rb_mask)), sa)), dst_rb), rb_mask);
+
+    const V final_alpha = VecOps::Sub(v256, VecOps::Shr<8>(VecOps::Mul(
+        VecOps::Sub(v256, sa), VecOps::Sub(v256, da))));
+    const V factor = VecOps::Div65536(final_alpha);
+    dst_g = VecOps::And(VecOps::Shr<8>(VecOps::Mul(dst_g, factor)), g_mask);
+    dst_rb = VecOps::And(VecOps::Shr<8>(VecOps::Mul(dst_rb, factor)), rb_mask);
+    return VecOps::Or(VecOps::Or(dst_rb, dst_g),
+        VecOps::Shl<24>(VecOps::Sub(final_alpha, VecOps::Set1(1))));
+}
+
+// Vector pixel blenders: each calculates result for x blended over y
+struct BlendArgbToArgb
+{
+    static inline V Blend(V x, V y, uint32_t n)
+    {
+        const V sa = SrcAlpha(x, n);
+        // fully transparent source leaves destination as is
+        return VecOps::Select(VecOps::CmpEq(sa, VecOps::Set1(0)), y, Argb2ArgbCore(x, y, sa));
+    }
+};
+
+struct BlendArgbToRgb
+{
+    static inline V Blend(V x, V y, uint32_t n)
+    {
+        return MixRgb(x, y, IncNonZero(SrcAlpha(x, n)));
+    }
+};
+
+struct BlendRgbToArgb
+{
+    static inline V Blend(V x, V y, uint32_t n)
+    {
+        const V opaque = VecOps::Or(x, VecOps::Set1(0xFF000000));
+        if (n == 0 || n == 0xFF)
+            return opaque;
+        return Argb2ArgbCore(opaque, y, VecOps::Set1(n));
+    }
+};
+
+struct BlendOpaqueAlpha
+{
+    static inline V Blend(V x, V /*y*/, uint32_t /*n*/)
+    {
+        return VecOps::Or(x, VecOps::Set1(0xFF000000));
+    }
+};
+
+struct BlendAdditiveAlpha
+{
+    static inline V Blend(V x, V y, uint32_t /*n*/)
+    {
+        const V v255 = VecOps::Set1(0xFF);
+        V alpha = VecOps::Add(VecOps::Shr<24>(x), VecOps::Shr<24>(y));
+        alpha = VecOps::Select(VecOps::CmpGt(alpha, v255), v255, alpha);
+        return VecOps::Or(VecOps::Shl<24>(alpha), VecOps::And(x, VecOps::Set1(0x00FFFFFF)));
+    }
+};
+
+struct BlendTransAlpha
+{
+    static inline V Blend(V x, V y, uint32_t n)
+    {
+        const V a = VecOps::Shr<8>(VecOps::Mul(VecOps::Set1(n), VecOps::Shr<24>(x)));
+        return MixRgb(x, y, IncNonZero(a));
+    }
+};
+
+struct BlendTrans
+{
+    static inline V Blend(V x, V y, uint32_t n)
+    {
+        return MixRgb(x, y, VecOps::Set1(n ? n + 1 : 0));
+    }
+};
+
+struct BlendTransKeepAlpha
+{
+    static inline V Blend(V x, V y, uint32_t n)
+    {
+        const V alpha_mask = VecOps::Set1(0xFF000000);
+        return VecOps::Or(MixRgb(x, VecOps::AndNot(alpha_mask, y), VecOps::Set1(n ? n + 1 : 0)),
+            VecOps::And(y, alpha_mask));
+    }
+};
+
+// Vector row blenders process the multiples of the vector width,
+// and return the number of processed pixels
+template <typename TBlender>
+static size_t blend_row32_vec(const uint32_t *src, uint32_t *dst, size_t count, uint32_t n)
+{
+    const V mask_color = VecOps::Set1(MASK_COLOR_32);
+    size_t i = 0;
+    for (; i + VecOps::Width <= count; i += VecOps::Width)
+    {
+        const V s = VecOps::Load(src + i);
+        const V is_mask = VecOps::CmpEq(s, mask_color);
+        if (VecOps::AllSet(is_mask))
+            continue; // fully transparent part
+        const V d = VecOps::Load(dst + i);
+        VecOps::Store(dst + i, VecOps::Select(is_mask, d, TBlender::Blend(s, d, n)));
+    }
+    return i;
+}
+
+template <typename TBlender>
+static size_t lit_row32_vec(uint32_t color, const uint32_t *src, uint32_t *dst, size_t count, uint32_t n)
+{
+    const V mask_color = VecOps::Set1(MASK_COLOR_32);
+    const V col = VecOps::Set1(color);
+    size_t i = 0;
+    for (; i + VecOps::Width <= count; i += VecOps::Width)
+    {
+        const V s = VecOps::Load(src + i);
+        const V is_mask = VecOps::CmpEq(s, mask_color);
+        if (VecOps::AllSet(is_mask))
+            continue; // fully transparent part
+        const V res = TBlender::Blend(col, s, n);
+        VecOps::Store(dst + i, VecOps::Select(is_mask, VecOps::Load(dst + i), res));
+    }
+    return i;
+}
+
+typedef size_t (*PfnBlendRowVec)(const uint32_t *src, uint32_t *dst, size_t count, uint32_t n);
+typedef size_t (*PfnLitRowVec)(uint32_t color, const uint32_t *src, uint32_t *dst, size_t count, uint32_t n);
+
+// Vector row blenders, matching RowBlender values;
+// null means that there's no vector implementation
+static const PfnBlendRowVec BlendRowsVec[kNumRowBlenders] =
+{
+    blend_row32_vec<BlendArgbToArgb>,
+    blend_row32_vec<BlendArgbToRgb>,
+    blend_row32_vec<BlendRgbToArgb>,
+    blend_row32_vec<BlendOpaqueAlpha>,
+    blend_row32_vec<BlendAdditiveAlpha>,
+    blend_row32_vec<BlendTransAlpha>,
+    blend_row32_vec<BlendTrans>,
+    blend_row32_vec<BlendTransKeepAlpha>,
+    nullptr, // tint is done in HSV, keep it per-pixel for the exact float results
+    nullptr
+};
+
+static const PfnLitRowVec LitRowsVec[kNumRowBlenders] =
+{
+    lit_row32_vec<BlendArgbToArgb>,
+    lit_row32_vec<BlendArgbToRgb>,
+    lit_row32_vec<BlendRgbToArgb>,
+    lit_row32_vec<BlendOpaqueAlpha>,
+    lit_row32_vec<BlendAdditiveAlpha>,
+    lit_row32_vec<BlendTransAlpha>,
+    lit_row32_vec<BlendTrans>,
+    lit_row32_vec<BlendTransKeepAlpha>,
+    nullptr,
+    nullptr
+};
+
+#endif // AGS_BLEND_AVX2 || AGS_BLEND_SSE2
+
+
+void blend_row32(RowBlender blender, const uint32_t *src, uint32_t *dst, size_t count,
+    uint32_t n, bool use_simd)
+{
+    if (blender < 0 || blender >= kNumRowBlenders)
+        return;
+#if defined(AGS_BLEND_AVX2) || defined(AGS_BLEND_SSE2)
+    if (use_simd && BlendRowsVec[blender])
+    {
+        const size_t done = BlendRowsVec[blender](src, dst, count, n);
+        src += done;
+        dst += done;
+        count -= done;
+    }
+#else
+    (void)use_simd;
+#endif
+    blend_row32_scalar(PixelBlenders[blender], src, dst, count, n);
+}
+
+void lit_row32(RowBlender blender, uint32_t color, const uint32_t *src, uint32_t *dst, size_t count,
+    uint32_t n, bool use_simd)
+{
+    if (blender < 0 || blender >= kNumRowBlenders)
+        return;
+#if defined(AGS_BLEND_AVX2) || defined(AGS_BLEND_SSE2)
+    if (use_simd && LitRowsVec[blender])
+    {
+        const size_t done = LitRowsVec[blender](color, src, dst, count, n);
+        src += done;
+        dst += done;
+        count -= done;
+    }
+#else
+    (void)use_simd;
+#endif
+    lit_row32_scalar(PixelBlenders[blender], color, src, dst, count, n);
+}
+
+const char *get_row_blender_simd()
+{
+#if defined(AGS_BLEND_AVX2) || defined(AGS_BLEND_SSE2)
+    return VecOps::Name();
+#else
+    return "none";
+#endif
+}
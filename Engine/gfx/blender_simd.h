@@ -0,0 +1,60 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Row blenders: process whole rows of 32-bit pixels at once, instead of
+// calling a blender callback per pixel like Allegro's drawing functions do.
+// Each row blender produces exactly the same result as the corresponding
+// per-pixel blender function, and same as Allegro it skips the source pixels
+// of the mask color.
+//
+// When the engine is compiled with SSE2 or AVX2 enabled, the row blenders
+// process several pixels at a time using vector instructions; otherwise,
+// or if asked explicitly, they fallback to the per-pixel blenders.
+//
+//=============================================================================
+#ifndef __AC_BLENDER_SIMD_H
+#define __AC_BLENDER_SIMD_H
+
+#include <stddef.h>
+#include "core/types.h"
+
+enum RowBlender
+{
+    kRowBlend_ArgbToArgb,     // _argb2argb_blender
+    kRowBlend_ArgbToRgb,      // _argb2rgb_blender; same as Allegro's alpha blender when n = 0
+    kRowBlend_RgbToArgb,      // _rgb2argb_blender
+    kRowBlend_OpaqueAlpha,    // _opaque_alpha_blender
+    kRowBlend_AdditiveAlpha,  // _additive_alpha_copysrc_blender
+    kRowBlend_TransAlpha,     // _trans_alpha_blender32
+    kRowBlend_Trans,          // Allegro's trans blender
+    kRowBlend_TransKeepAlpha, // _myblender_alpha_trans24
+    kRowBlend_Tint,           // _myblender_color32
+    kRowBlend_TintLight,      // _myblender_color32_light
+    kNumRowBlenders
+};
+
+// Blends a row of source pixels into the destination row:
+// dst = blender(src, dst, n), skipping the source pixels of the mask color.
+void blend_row32(RowBlender blender, const uint32_t *src, uint32_t *dst, size_t count,
+    uint32_t n, bool use_simd = true);
+// Writes a row of source pixels lit by the color into the destination row:
+// dst = blender(color, src, n), skipping the source pixels of the mask color.
+// Source and destination may be the same row.
+void lit_row32(RowBlender blender, uint32_t color, const uint32_t *src, uint32_t *dst, size_t count,
+    uint32_t n, bool use_simd = true);
+// Gets the name of the vector instruction set used by the row blenders,
+// or "none" if there's no vector implementation on this platform
+const char *get_row_blender_simd();
+
+#endif // __AC_BLENDER_SIMD_H
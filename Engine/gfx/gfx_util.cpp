@@ -14,7 +14,12 @@
 
 #include "core/platform.h"
 #include "gfx/gfx_util.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <assert.h>
 #include "gfx/blender.h"
+#include "util/threadpool.h"
 
 namespace AGS
 {
@@ -42,46 +47,35 @@ Bitmap *ConvertBitmap(Bitmap *src, int dst_color_depth)
 }
 
 
-typedef BLENDER_FUNC PfnBlenderCb;
-
 struct BlendModeSetter
 {
-    // Blender setter for destination with and without alpha channel;
-    // assign null pointer if not supported
-    PfnBlenderCb AllAlpha;       // src w alpha   -> dst w alpha
-    PfnBlenderCb AlphaToOpaque;  // src w alpha   -> dst w/o alpha
-    PfnBlenderCb OpaqueToAlpha;  // src w/o alpha -> dst w alpha
-    PfnBlenderCb OpaqueToAlphaNoTrans; // src w/o alpha -> dst w alpha (opt-ed for no transparency)
-    PfnBlenderCb AllOpaque;      // src w/o alpha -> dst w/o alpha
+    // Row blender for destination with and without alpha channel;
+    // assign kNumRowBlenders if not supported
+    RowBlender AllAlpha;       // src w alpha   -> dst w alpha
+    RowBlender AlphaToOpaque;  // src w alpha   -> dst w/o alpha
+    RowBlender OpaqueToAlpha;  // src w/o alpha -> dst w alpha
+    RowBlender OpaqueToAlphaNoTrans; // src w/o alpha -> dst w alpha (opt-ed for no transparency)
+    RowBlender AllOpaque;      // src w/o alpha -> dst w/o alpha
 };
 
 // Array of blender descriptions
-// NOTE: set NULL function pointer to fallback to common image blitting
+// NOTE: set kNumRowBlenders to fallback to common image blitting
 static const BlendModeSetter BlendModeSets[kNumBlendModes] =
 {
-    { nullptr, nullptr, nullptr, nullptr, nullptr }, // kBlendMode_NoAlpha
-    { _argb2argb_blender, _argb2rgb_blender, _rgb2argb_blender, _opaque_alpha_blender, nullptr }, // kBlendMode_Alpha
+    { kNumRowBlenders, kNumRowBlenders, kNumRowBlenders, kNumRowBlenders, kNumRowBlenders }, // kBlendMode_NoAlpha
+    { kRowBlend_ArgbToArgb, kRowBlend_ArgbToRgb, kRowBlend_RgbToArgb, kRowBlend_OpaqueAlpha, kNumRowBlenders }, // kBlendMode_Alpha
     // NOTE: add new modes here
 };
 
-bool SetBlender(BlendMode blend_mode, bool dst_has_alpha, bool src_has_alpha, int blend_alpha)
+static RowBlender GetBlender(BlendMode blend_mode, bool dst_has_alpha, bool src_has_alpha, int blend_alpha)
 {
     if (blend_mode < 0 || blend_mode >= kNumBlendModes)
-        return false;
+        return kNumRowBlenders;
     const BlendModeSetter &set = BlendModeSets[blend_mode];
-    PfnBlenderCb blender;
     if (dst_has_alpha)
-        blender = src_has_alpha ? set.AllAlpha :
+        return src_has_alpha ? set.AllAlpha :
             (blend_alpha == 0xFF ? set.OpaqueToAlphaNoTrans : set.OpaqueToAlpha);
-    else
-        blender = src_has_alpha ? set.AlphaToOpaque : set.AllOpaque;
-
-    if (blender)
-    {
-        set_blender_mode(nullptr, nullptr, blender, 0, 0, 0, blend_alpha);
-        return true;
-    }
-    return false;
+    return src_has_alpha ? set.AlphaToOpaque : set.AllOpaque;
 }
 
 void DrawSpriteBlend(Bitmap *ds, const Point &ds_at, Bitmap *sprite,
@@ -90,12 +84,13 @@ void DrawSpriteBlend(Bitmap *ds, const Point &ds_at, Bitmap *sprite,
     if (blend_alpha <= 0)
         return; // do not draw 100% transparent image
 
+    const RowBlender blender = GetBlender(blend_mode, dst_has_alpha, src_has_alpha, blend_alpha);
     if (// support only 32-bit blending at the moment
         ds->GetColorDepth() == 32 && sprite->GetColorDepth() == 32 &&
-        // set blenders if applicable and tell if succeeded
-        SetBlender(blend_mode, dst_has_alpha, src_has_alpha, blend_alpha))
+        // use blenders if applicable
+        blender != kNumRowBlenders)
     {
-        ds->TransBlendBlt(sprite, ds_at.X, ds_at.Y);
+        BlendBlt32(ds, sprite, ds_at.X, ds_at.Y, blender, blend_alpha);
     }
     else
     {
@@ -152,7 +147,11 @@ void DrawSpriteWithTransparency(Bitmap *ds, Bitmap *sprite, int x, int y, int al
         sprite = &hctemp;
     }
 
-    if ((alpha < 0xFF) && (surface_depth > 8) && (sprite_depth > 8))
+    if ((alpha < 0xFF) && (surface_depth == 32) && (sprite->GetColorDepth() == 32))
+    {
+        BlendBlt32(ds, sprite, x, y, kRowBlend_Trans, alpha);
+    }
+    else if ((alpha < 0xFF) && (surface_depth > 8) && (sprite_depth > 8))
     {
         set_trans_blender(0, 0, 0, alpha);
         ds->TransBlendBlt(sprite, x, y);
@@ -163,6 +162,86 @@ void DrawSpriteWithTransparency(Bitmap *ds, Bitmap *sprite, int x, int y, int al
     }
 }
 
+// Clips the source rectangle drawn at the given position by the surface's clip rect;
+// returns false if nothing is left to draw
+static bool ClipBlit(const Bitmap *ds, const Bitmap *sprite, int &x, int &y, Rect &src_rc)
+{
+    const Rect clip = ds->GetClip();
+    const int sx = std::max(0, clip.Left - x);
+    const int sy = std::max(0, clip.Top - y);
+    const int w = std::min(sprite->GetWidth(), clip.Right + 1 - x) - sx;
+    const int h = std::min(sprite->GetHeight(), clip.Bottom + 1 - y) - sy;
+    if (w <= 0 || h <= 0)
+        return false;
+    src_rc = RectWH(sx, sy, w, h);
+    x += sx;
+    y += sy;
+    return true;
+}
+
+void BlendBlt32(Bitmap *ds, Bitmap *sprite, int x, int y, RowBlender blender, int alpha)
+{
+    assert(ds->GetColorDepth() == 32 && sprite->GetColorDepth() == 32);
+    Rect src_rc;
+    if (!ClipBlit(ds, sprite, x, y, src_rc))
+        return;
+    for (int row = 0; row < src_rc.GetHeight(); ++row)
+    {
+        blend_row32(blender,
+            reinterpret_cast<const uint32_t*>(sprite->GetScanLine(src_rc.Top + row)) + src_rc.Left,
+            reinterpret_cast<uint32_t*>(ds->GetScanLineForWriting(y + row)) + x,
+            src_rc.GetWidth(), alpha);
+    }
+}
+
+void LitBlendBlt32(Bitmap *ds, Bitmap *sprite, int x, int y, RowBlender blender,
+    int r, int g, int b, int light_amount)
+{
+    assert(ds->GetColorDepth() == 32 && sprite->GetColorDepth() == 32);
+    Rect src_rc;
+    if (!ClipBlit(ds, sprite, x, y, src_rc))
+        return;
+    const uint32_t color = makecol32(r, g, b);
+    for (int row = 0; row < src_rc.GetHeight(); ++row)
+    {
+        lit_row32(blender, color,
+            reinterpret_cast<const uint32_t*>(sprite->GetScanLine(src_rc.Top + row)) + src_rc.Left,
+            reinterpret_cast<uint32_t*>(ds->GetScanLineForWriting(y + row)) + x,
+            src_rc.GetWidth(), light_amount);
+    }
+}
+
+void DrawInBands(Bitmap *surface, ThreadPool &pool,
+    const std::function<void(Bitmap *band, int band_top)> &draw)
+{
+    // Split into more bands than there are threads, to let them balance the work
+    const int MinBandHeight = 16;
+    const Rect clip = surface->GetClip();
+    const size_t max_bands = (pool.GetWorkerCount() + 1) * 4;
+    const size_t band_count = std::max<size_t>(1u,
+        std::min<size_t>(max_bands, clip.GetHeight() / MinBandHeight));
+    const int band_height = (clip.GetHeight() + static_cast<int>(band_count) - 1) / static_cast<int>(band_count);
+
+    // Creating subbitmaps is not thread-safe in Allegro, so do that beforehand
+    std::vector<std::unique_ptr<Bitmap>> bands(band_count);
+    for (size_t i = 0; i < band_count; ++i)
+    {
+        const int top = clip.Top + static_cast<int>(i) * band_height;
+        const int bottom = std::min(clip.Bottom, top + band_height - 1);
+        if (top > bottom)
+            continue;
+        bands[i].reset(BitmapHelper::CreateSubBitmap(surface,
+            Rect(0, top, surface->GetWidth() - 1, bottom)));
+        bands[i]->SetClip(Rect(clip.Left, 0, clip.Right, bottom - top));
+    }
+
+    pool.RunParallel(band_count, [&bands, &draw, clip, band_height](size_t band)
+    {
+        if (bands[band])
+            draw(bands[band].get(), clip.Top + static_cast<int>(band) * band_height);
+    });
+}
+
 } // namespace GfxUtil
 
 } // namespace Engine
@@ -24,9 +24,13 @@
 #ifndef __AGS_EE_GFX__GFXUTIL_H
 #define __AGS_EE_GFX__GFXUTIL_H
 
+#include <functional>
 #include "gfx/bitmap.h"
+#include "gfx/blender_simd.h"
 #include "gfx/gfx_def.h"
 
+namespace AGS { namespace Common { class ThreadPool; } }
+
 namespace AGS
 {
 namespace Engine
@@ -51,6 +55,23 @@ namespace GfxUtil
     // ignores image's alpha channel, even if there's one;
     // does proper conversion depending on respected color depths.
     void DrawSpriteWithTransparency(Bitmap *ds, Bitmap *sprite, int x, int y, int alpha = 0xFF);
+
+    // Draws a 32-bit bitmap over the 32-bit surface using the row blender;
+    // same as setting the respective blender and calling TransBlendBlt.
+    void BlendBlt32(Bitmap *ds, Bitmap *sprite, int x, int y, RowBlender blender, int alpha);
+    // Draws a 32-bit bitmap lit by the color over the 32-bit surface using
+    // the row blender; same as setting the respective blender and color,
+    // and calling LitBlendBlt.
+    void LitBlendBlt32(Bitmap *ds, Bitmap *sprite, int x, int y, RowBlender blender,
+        int r, int g, int b, int light_amount);
+
+    // Splits the surface's clip rect into horizontal bands, and runs the
+    // draw function for each band on the pool's threads. The band is passed
+    // as a subbitmap clipped to its rows, along with its top on the surface.
+    // Result is the same as drawing on the whole surface, as long as drawing
+    // does not depend on any global state, like Allegro's blenders.
+    void DrawInBands(Bitmap *surface, Common::ThreadPool &pool,
+        const std::function<void(Bitmap *band, int band_top)> &draw);
 } // namespace GfxUtil
 
 } // namespace Engine
@@ -128,6 +128,10 @@ public:
                 { _drawScreenCallback = callback; _drawPostScreenCallback = post_callback; }
     void        SetCallbackOnInit(GFXDRV_CLIENTCALLBACKINITGFX callback) override { _initGfxCallback = callback; }
     void        SetCallbackOnSpriteEvt(GFXDRV_CLIENTCALLBACKEVT callback) override { _spriteEvtCallback = callback; }
+    bool        GetRenderStats(RenderStats &/*stats*/) override { return false; /* not supported */ }
+    // Default implementation updates the whole texture
+    void        UpdateTextureRect(Texture *txdata, Common::Bitmap *bmp, bool has_alpha, bool opaque, const Rect &/*rc*/) override
+                { UpdateTexture(txdata, bmp, has_alpha, opaque); }
 
 protected:
     // Special internal values, applied to DrawListEntry
@@ -273,6 +277,7 @@ public:
     // only plugin handling are allowed to request our mem buffer
     // for compatibility reasons.
     bool UsesMemoryBackBuffer() override { return false; }
+    void SetRenderThreadCount(int /*count*/) override { /* drawing is done by GPU */ }
 
     Bitmap *GetMemoryBackBuffer() override;
     void SetMemoryBackBuffer(Bitmap *backBuffer) override;
@@ -81,6 +81,14 @@ struct RenderMatrixes
     glm::mat4 Projection;
 };
 
+// Statistics of a rendered frame
+struct RenderStats
+{
+    uint32_t Sprites = 0u;   // number of sprite quads drawn
+    uint32_t DrawCalls = 0u; // number of draw calls issued
+    uint32_t Batches = 0u;   // number of draw calls which had several sprites merged
+};
+
 
 typedef void (*GFXDRV_CLIENTCALLBACK)();
 typedef bool (*GFXDRV_CLIENTCALLBACKEVT)(int evt, int data);
@@ -159,6 +167,8 @@ public:
   virtual Texture *CreateTexture(Common::Bitmap *bmp, bool has_alpha = true, bool opaque = false) = 0;
   // Update texture data from the given bitmap
   virtual void UpdateTexture(Texture *txdata, Common::Bitmap *bmp, bool has_alpha, bool opaque = false) = 0;
+  // Update only the part of texture data which corresponds to the given bitmap rectangle
+  virtual void UpdateTextureRect(Texture *txdata, Common::Bitmap *bmp, bool has_alpha, bool opaque, const Rect &rc) = 0;
   // Retrieve shared texture object from the given DDB
   virtual std::shared_ptr<Texture> GetTexture(IDriverDependantBitmap *ddb) = 0;
 
@@ -215,6 +225,10 @@ public:
   // the rest of the game. The effect is stronger for the low-res games being
   // rendered in the high-res mode.
   virtual void RenderSpritesAtScreenResolution(bool enabled, int supersampling = 1) = 0;
+  // Sets the number of threads used for drawing sprites; 0 or 1 means that
+  // everything is drawn on the calling thread. Ignored by the renderers
+  // which do not draw sprites on their own.
+  virtual void SetRenderThreadCount(int count) = 0;
   // TODO: move fade-in/out/boxout functions out of the graphics driver!! make everything render through
   // main drawing procedure. Since currently it does not - we need to init our own sprite batch
   // internally to let it set up correct viewport settings instead of relying on a chance.
@@ -245,6 +259,9 @@ public:
   // These matrixes will be filled in accordance to the renderer's compatible format;
   // returns false if renderer does not use matrixes (not a 3D renderer).
   virtual bool GetStageMatrixes(RenderMatrixes &rm) = 0;
+  // Retrieves the statistics of the last rendered frame;
+  // returns false if renderer does not collect them.
+  virtual bool GetRenderStats(RenderStats &stats) = 0;
 
   virtual ~IGraphicsDriver() = default;
 };
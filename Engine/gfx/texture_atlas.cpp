@@ -0,0 +1,135 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "gfx/texture_atlas.h"
+#include <assert.h>
+
+namespace AGS
+{
+namespace Engine
+{
+
+TextureAtlas::TextureAtlas(int page_width, int page_height)
+    : _pageWidth(page_width)
+    , _pageHeight(page_height)
+{
+}
+
+AtlasRegion TextureAtlas::Allocate(int width, int height, bool &new_page)
+{
+    new_page = false;
+    AtlasRegion region;
+    if (width <= 0 || height <= 0 || width > _pageWidth || height > _pageHeight)
+        return region;
+
+    region.Width = width;
+    region.Height = height;
+    // Try the pages in use first, then take the first unused one
+    uint32_t free_page = UINT32_MAX;
+    for (uint32_t i = 0; i < _pages.size(); ++i)
+    {
+        if (_pages[i].Regions == 0u)
+        {
+            if (free_page == UINT32_MAX)
+                free_page = i;
+            continue;
+        }
+        if (AllocateOnPage(_pages[i], width, height, region.X, region.Y))
+        {
+            region.Page = i;
+            return region;
+        }
+    }
+
+    if (free_page == UINT32_MAX)
+    {
+        free_page = static_cast<uint32_t>(_pages.size());
+        _pages.emplace_back();
+    }
+    _pages[free_page] = Page();
+    AllocateOnPage(_pages[free_page], width, height, region.X, region.Y);
+    region.Page = free_page;
+    new_page = true;
+    return region;
+}
+
+bool TextureAtlas::AllocateOnPage(Page &page, int width, int height, int &x, int &y)
+{
+    // Find the shelf which has least height to spare
+    Shelf *best = nullptr;
+    for (auto &shelf : page.Shelves)
+    {
+        if (shelf.Height < height || shelf.Used + width > _pageWidth)
+            continue;
+        if (!best || shelf.Height < best->Height)
+            best = &shelf;
+    }
+    // Start a new shelf if the best one is too tall for this region,
+    // or if there's none; but use any that fits when the page is full
+    const bool can_add_shelf = page.Top + height <= _pageHeight;
+    if (can_add_shelf && (!best || best->Height - height > height / 2))
+    {
+        Shelf shelf;
+        shelf.Y = page.Top;
+        shelf.Height = height;
+        page.Shelves.push_back(shelf);
+        page.Top += height;
+        best = &page.Shelves.back();
+    }
+    if (!best)
+        return false;
+
+    x = best->Used;
+    y = best->Y;
+    best->Used += width;
+    best->Regions++;
+    page.Regions++;
+    return true;
+}
+
+bool TextureAtlas::Release(const AtlasRegion &region)
+{
+    if (!region.IsValid() || region.Page >= _pages.size())
+        return false;
+    Page &page = _pages[region.Page];
+    for (size_t i = 0; i < page.Shelves.size(); ++i)
+    {
+        Shelf &shelf = page.Shelves[i];
+        if (shelf.Y != region.Y)
+            continue;
+
+        assert(shelf.Regions > 0u && page.Regions > 0u);
+        shelf.Regions--;
+        page.Regions--;
+        if (shelf.Regions == 0u)
+        {
+            shelf.Used = 0;
+            // Empty shelves at the bottom may be removed, freeing their height
+            while (!page.Shelves.empty() && page.Shelves.back().Regions == 0u)
+            {
+                page.Top = page.Shelves.back().Y;
+                page.Shelves.pop_back();
+            }
+        }
+        else if (region.X + region.Width == shelf.Used)
+        {
+            shelf.Used = region.X;
+        }
+        return page.Regions == 0u;
+    }
+    assert(false); // region does not belong to this atlas
+    return false;
+}
+
+} // namespace Engine
+} // namespace AGS
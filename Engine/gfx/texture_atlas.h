@@ -0,0 +1,92 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// TextureAtlas packs small images into the shared pages of a fixed size.
+// It only arranges the regions on pages, and does not deal with the actual
+// textures: the renderer creates a texture for each new page, and deletes
+// one when the atlas tells that the page is no longer used.
+//
+// Regions are placed on horizontal "shelves", each shelf being as tall as
+// the first region put on it. Released space is reused when the last region
+// on a shelf is released, or when the whole shelf becomes empty.
+//
+//=============================================================================
+#ifndef __AGS_EE_GFX__TEXTUREATLAS_H
+#define __AGS_EE_GFX__TEXTUREATLAS_H
+
+#include <vector>
+#include "core/types.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+struct AtlasRegion
+{
+    uint32_t Page = UINT32_MAX;
+    int X = 0, Y = 0;
+    int Width = 0, Height = 0;
+
+    bool IsValid() const { return Page != UINT32_MAX; }
+};
+
+class TextureAtlas
+{
+public:
+    TextureAtlas(int page_width, int page_height);
+
+    int GetPageWidth() const { return _pageWidth; }
+    int GetPageHeight() const { return _pageHeight; }
+    // Gets the number of page slots, including the unused ones
+    size_t GetPageCount() const { return _pages.size(); }
+    // Tells if the given page has any regions on it
+    bool IsPageUsed(uint32_t page) const { return page < _pages.size() && _pages[page].Regions > 0u; }
+
+    // Finds a place for the region of the given size; returns an invalid
+    // region if it's larger than a page. Sets new_page if the region was put
+    // on a new (or previously released) page, which requires a new texture.
+    AtlasRegion Allocate(int width, int height, bool &new_page);
+    // Releases the region; returns true if its page became unused,
+    // in which case the page's texture may be deleted
+    bool Release(const AtlasRegion &region);
+
+private:
+    struct Shelf
+    {
+        int Y = 0;
+        int Height = 0;
+        int Used = 0; // occupied width, from the left
+        size_t Regions = 0u;
+    };
+
+    struct Page
+    {
+        std::vector<Shelf> Shelves;
+        int Top = 0; // occupied height, from the top
+        size_t Regions = 0u;
+    };
+
+    // Tries to place the region on the given page
+    bool AllocateOnPage(Page &page, int width, int height, int &x, int &y);
+
+    int _pageWidth;
+    int _pageHeight;
+    std::vector<Page> _pages;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__TEXTUREATLAS_H
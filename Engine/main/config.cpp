@@ -332,6 +332,8 @@ void apply_config(const ConfigTree &cfg)
         usetup.Screen.Params.VSync = CfgReadBoolInt(cfg, "graphics", "vsync");
         usetup.RenderAtScreenRes = CfgReadBoolInt(cfg, "graphics", "render_at_screenres");
         usetup.Supersampling = CfgReadInt(cfg, "graphics", "supersampling", 1);
+        usetup.RenderThreads = CfgReadInt(cfg, "graphics", "render_threads", usetup.RenderThreads);
+        usetup.RenderUnlocked = CfgReadBoolInt(cfg, "graphics", "unlocked_render", usetup.RenderUnlocked);
         usetup.software_render_driver = CfgReadString(cfg, "graphics", "software_driver");
 
         usetup.rotation = (ScreenRotation)CfgReadInt(cfg, "graphics", "rotation", usetup.rotation);
@@ -354,9 +356,14 @@ void apply_config(const ConfigTree &cfg)
         // Resource caches and options
         usetup.clear_cache_on_room_change = CfgReadBoolInt(cfg, "misc", "clear_cache_on_room_change", usetup.clear_cache_on_room_change);
         usetup.SpriteCacheSize = CfgReadInt(cfg, "graphics", "sprite_cache_size", usetup.SpriteCacheSize);
+        usetup.SpriteAsyncLoad = CfgReadBoolInt(cfg, "graphics", "sprite_async_load", usetup.SpriteAsyncLoad);
+        usetup.RoomPreloadBudget = CfgReadInt(cfg, "graphics", "room_preload_size", usetup.RoomPreloadBudget);
         usetup.TextureCacheSize = CfgReadInt(cfg, "graphics", "texture_cache_size", usetup.TextureCacheSize);
         usetup.SoundCacheSize = CfgReadInt(cfg, "sound", "cache_size", usetup.SoundCacheSize);
         usetup.SoundLoadAtOnceSize = CfgReadInt(cfg, "sound", "stream_threshold", usetup.SoundLoadAtOnceSize);
+        usetup.AssetAccess = StrUtil::ParseEnum<AssetAccessMode>(
+            CfgReadString(cfg, "misc", "asset_access", "buffered"),
+            CstrArr<kNumAssetAccessModes>{ "buffered", "direct", "mmap" }, usetup.AssetAccess);
 
         // Mouse options
         usetup.mouse_auto_lock = CfgReadBoolInt(cfg, "mouse", "auto_lock");
@@ -380,6 +387,9 @@ void apply_config(const ConfigTree &cfg)
 
         // Various system options
         usetup.multitasking = CfgReadInt(cfg, "misc", "background", 0) != 0;
+        usetup.legacy_script_exec = CfgReadBoolInt(cfg, "misc", "script_legacy_exec", usetup.legacy_script_exec);
+        usetup.script_profiler = CfgReadBoolInt(cfg, "misc", "script_profiler", usetup.script_profiler);
+        usetup.PathfindThreads = CfgReadInt(cfg, "misc", "pathfind_threads", usetup.PathfindThreads);
 
         // User's overrides and hacks
         usetup.override_multitasking = CfgReadInt(cfg, "override", "multitasking", -1);
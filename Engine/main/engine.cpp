@@ -51,7 +51,9 @@
 #include "ac/dynobj/scriptobject.h"
 #include "ac/dynobj/scriptsystem.h"
 #include "core/assetmanager.h"
+#include "debug/benchmark.h"
 #include "debug/debug_log.h"
+#include "debug/inputrecorder.h"
 #include "debug/debugger.h"
 #include "debug/out.h"
 #include "device/mousew32.h"
@@ -109,7 +111,7 @@ bool engine_init_backend()
     platform->PreBackendInit();
     // Initialize SDL
     Debug::Printf(kDbgMsg_Info, "Initializing backend libs");
-    if (sys_main_init())
+    if (sys_main_init(usetup.BenchmarkFrames > 0))
     {
         const char *err = SDL_GetError();
         const char *user_hint = platform->GetBackendFailUserHint();
@@ -433,6 +435,7 @@ void engine_init_exit_handler()
 void engine_init_pathfinder()
 {
     init_pathfinder(loaded_game_file_version);
+    set_route_thread_count(usetup.PathfindThreads);
 }
 
 void engine_pre_init_gfx()
@@ -588,6 +591,7 @@ int engine_init_sprites()
     if (usetup.SpriteCacheSize > 0)
         spriteset.SetMaxCacheSize(usetup.SpriteCacheSize * 1024);
     Debug::Printf("Sprite cache set: %zu KB", spriteset.GetMaxCacheSize() / 1024);
+    spriteset.SetAsyncLoading(usetup.SpriteAsyncLoad);
     return 0;
 }
 
@@ -598,8 +602,20 @@ void engine_init_game_settings()
     our_eip=-7;
     Debug::Printf("Initialize game settings");
 
-    // Initialize randomizer
+    // Initialize randomizer; the replayed input requires the seed it was recorded with
     play.randseed = time(nullptr);
+    if (!usetup.InputReplayFile.IsEmpty())
+    {
+        int rand_seed;
+        if (!InputRecorder::StartReplay(usetup.InputReplayFile, game.uniqueid, rand_seed))
+            quit("Unable to replay the input log, see the log for details");
+        play.randseed = rand_seed;
+    }
+    else if (!usetup.InputRecordFile.IsEmpty())
+    {
+        if (!InputRecorder::StartRecording(usetup.InputRecordFile, play.randseed, game.uniqueid))
+            quit("Unable to record the input log, see the log for details");
+    }
     srand(play.randseed);
 
     if (usetup.audio_enabled)
@@ -885,6 +901,10 @@ void engine_prepare_to_start_game()
         if (slot >= 0)
             loadSaveGameOnStartup = get_save_game_path(slot);
     }
+
+    if (usetup.BenchmarkFrames > 0 &&
+        !Benchmark::Start(usetup.BenchmarkFrames, usetup.BenchmarkInput))
+        quit("Unable to start the benchmark, see the log for details");
 }
 
 // Define location of the game data either using direct settings or searching
@@ -963,6 +983,7 @@ bool engine_init_gamedata()
         return false;
 
     // Try init game lib
+    AssetMgr->SetAccessMode(usetup.AssetAccess);
     AssetError asset_err = AssetMgr->AddLibrary(usetup.main_data_file);
     if (asset_err != kAssetNoError)
     {
@@ -65,6 +65,7 @@ void engine_post_gfxmode_driver_setup()
     gfxDriver->SetCallbackForPolling(update_polled_stuff);
     gfxDriver->SetCallbackToDrawScreen(draw_game_screen_callback, construct_engine_overlay);
     gfxDriver->SetCallbackOnSpriteEvt(GfxDriverSpriteEvtCallback);
+    gfxDriver->SetRenderThreadCount(usetup.RenderThreads);
 }
 
 // Reset gfx driver callbacks
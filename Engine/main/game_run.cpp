@@ -46,11 +46,15 @@
 #include "ac/room.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
+#include "ac/timer.h"
 #include "ac/viewframe.h"
 #include "ac/walkablearea.h"
 #include "ac/walkbehind.h"
+#include "debug/benchmark.h"
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
+#include "debug/inputrecorder.h"
+#include "debug/profiler.h"
 #include "device/mousew32.h"
 #include "gui/animatingguibutton.h"
 #include "gui/guiinv.h"
@@ -123,6 +127,23 @@ struct RestrictUntil
 unsigned int loopcounter=0;
 static unsigned int lastcounter=0;
 
+// Game loop timings, accumulated until the next fps update
+struct LoopTimingsCounter
+{
+    unsigned int Updates = 0u;
+    unsigned int Renders = 0u;
+    float Lag = 0.f; // in ms
+    AGS_Clock::duration UpdateTime = AGS_Clock::duration::zero();
+    AGS_Clock::duration RenderTime = AGS_Clock::duration::zero();
+};
+static LoopTimingsCounter timings_acc;
+static LoopTimings loop_timings;
+
+static float to_milliseconds(AGS_Clock::duration d)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(d).count() / 1000.f;
+}
+
 static void ProperExit()
 {
     want_exit = false;
@@ -458,6 +479,14 @@ bool run_service_key_controls(KeyInput &out_key)
         return false;
     }
 
+#if AGS_FRAME_PROFILER
+    if ((agskey == eAGSKeyCodeCtrlP) && (ki.Mod & eAGSModAlt) != 0) {
+        // ctrl+alt+P - write profiler's trace
+        Profiler::WriteTrace();
+        return false;
+    }
+#endif
+
     if (((agskey == eAGSKeyCodeCtrlV) && (ki.Mod & eAGSModAlt) != 0)
         && (play.wait_counter < 1) && (play.text_overlay_on == 0) && (restrict_until.type == 0)) {
         // make sure we can't interrupt a Wait()
@@ -800,6 +829,7 @@ static void update_cursor_over_location(int mwasatx, int mwasaty)
 
 static void game_loop_update_events()
 {
+    AGS_PROFILE_ZONE("Events");
     new_room_was = in_new_room;
     if (in_new_room>0)
         setevent(EV_FADEIN,0,0,0);
@@ -850,6 +880,38 @@ static void game_loop_update_fps()
         fps = 1000.0f * frames / duration.count();
         t1 = t2;
         lastcounter = loopcounter;
+
+        const auto &acc = timings_acc;
+        loop_timings.Lag = acc.Updates > 0 ? acc.Lag / acc.Updates : 0.f;
+        loop_timings.UpdateTime = acc.Updates > 0 ? to_milliseconds(acc.UpdateTime) / acc.Updates : 0.f;
+        loop_timings.RenderTime = acc.Renders > 0 ? to_milliseconds(acc.RenderTime) / acc.Renders : 0.f;
+        loop_timings.RenderFps = 1000.0f * acc.Renders / duration.count();
+        timings_acc = LoopTimingsCounter();
+    }
+}
+
+const LoopTimings &get_loop_timings() {
+    return loop_timings;
+}
+
+// Renders extra frames in between the game updates, until the next update is due
+static void game_loop_render_between_updates(IDriverDependantBitmap *extraBitmap, int extraX, int extraY)
+{
+    if (!is_render_unlocked() || isTimerFpsMaxed() || play.fast_forward)
+        return;
+
+    float render_progress = 0.f; // part of the frame time taken by the last render
+    for (float progress = GetFrameProgress(); progress + render_progress < 1.f; )
+    {
+        if (want_exit || abort_engine)
+            break;
+        const auto render_start = AGS_Clock::now();
+        render_graphics_interpolated(extraBitmap, extraX, extraY);
+        timings_acc.RenderTime += AGS_Clock::now() - render_start;
+        timings_acc.Renders++;
+        const float new_progress = GetFrameProgress();
+        render_progress = new_progress - progress;
+        progress = new_progress;
     }
 }
 
@@ -871,6 +933,17 @@ void set_loop_counter(unsigned int new_counter) {
 
 void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int extraX, int extraY) {
 
+#if AGS_FRAME_PROFILER
+    Profiler::NextFrame();
+#endif
+    Benchmark::NextFrame();
+    InputRecorder::NextFrame();
+    AGS_PROFILE_ZONE("Frame");
+
+    const auto update_start = AGS_Clock::now();
+    AGS_Clock::duration render_time = AGS_Clock::duration::zero();
+    const float lag = isTimerFpsMaxed() ? 0.f : GetFrameProgress() * 1000.f / frames_per_second;
+
     int res;
 
     sys_evt_process_pending();
@@ -943,7 +1016,13 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
 
     // Only render if we are not skipping a cutscene
     if (!play.fast_forward)
+    {
+        const auto render_start = AGS_Clock::now();
         render_graphics(extraBitmap, extraX, extraY);
+        render_time = AGS_Clock::now() - render_start;
+        timings_acc.RenderTime += render_time;
+        timings_acc.Renders++;
+    }
 
     our_eip=6;
 
@@ -955,6 +1034,9 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
 
     game_loop_update_background_animation();
 
+    // Put sprites loaded in background into the cache
+    spriteset.ProcessPrefetched();
+
     game_loop_update_loop_counter();
 
     // Immediately start the next frame if we are skipping a cutscene
@@ -963,6 +1045,12 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
 
     our_eip=72;
 
+    timings_acc.UpdateTime += (AGS_Clock::now() - update_start) - render_time;
+    timings_acc.Lag += lag;
+    timings_acc.Updates++;
+
+    game_loop_render_between_updates(extraBitmap, extraX, extraY);
+
     game_loop_update_fps();
 
     update_polled_stuff();
@@ -972,6 +1060,11 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
 
 void UpdateGameAudioOnly()
 {
+#if AGS_FRAME_PROFILER
+    Profiler::NextFrame();
+#endif
+    Benchmark::NextFrame();
+    InputRecorder::NextFrame();
     update_audio_system_on_game_loop();
     game_loop_update_loop_counter();
     game_loop_update_fps();
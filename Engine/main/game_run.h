@@ -44,6 +44,15 @@ void UpdateCursorAndDrawables();
 // Gets current logical game FPS, this is normally a fixed number set in script;
 // in case of "maxed fps" mode this function returns real measured FPS.
 float get_current_fps();
+// Timings of the game loop, averaged over the last second
+struct LoopTimings
+{
+    float Lag = 0.f; // delay of the game update start past its scheduled time, in ms
+    float UpdateTime = 0.f; // time of the game update, not including render, in ms
+    float RenderTime = 0.f; // time of a single render, in ms
+    float RenderFps = 0.f; // number of renders per second
+};
+const LoopTimings &get_loop_timings();
 // Runs service key controls, returns false if no key was pressed or key input was claimed by the engine,
 // otherwise returns true and provides a keycode.
 bool run_service_key_controls(KeyInput &kgn);
@@ -443,6 +443,8 @@ bool graphics_mode_init_any(const GraphicResolution &game_res, const DisplayMode
     }
     if (it != ids.end())
         std::rotate(ids.begin(), it, ids.end());
+    else if (setup.DriverID.CompareNoCase("Null") == 0)
+        ids.assign(1, setup.DriverID); // headless driver is never picked as a fallback
     else
         Debug::Printf(kDbgMsg_Error, "Requested graphics driver '%s' not found, will try existing drivers instead", setup.DriverID.GetCStr());
 
@@ -111,6 +111,12 @@ void main_print_help() {
            "Options:\n"
            "  --background                 Keeps game running in background\n"
            "                               (this does not work in exclusive fullscreen)\n"
+           "  --bench-input FILEPATH       Simulate the player input listed in the file\n"
+           "                               during the benchmark run\n"
+           "  --benchmark FRAMES           Run the game without display, on the silent\n"
+           "                               \"dummy\" audio driver (sound is still mixed),\n"
+           "                               for the number of frames as fast as possible,\n"
+           "                               then print the frame timings and quit\n"
            "  --clear-cache-on-room-change Clears sprite cache on every room change\n"
            "  --conf FILEPATH              Specify explicit config file to read on startup\n"
 #if AGS_PLATFORM_OS_WINDOWS
@@ -166,6 +172,9 @@ void main_print_help() {
            "  --nospr                      Don't draw room objects and characters\n"
            "  --noupdate                   Don't run game update\n"
            "  --novideo                    Don't play game videos\n"
+           "  --record-input FILEPATH      Record the player input into the file\n"
+           "  --replay-input FILEPATH      Replay the player input recorded in the file,\n"
+           "                               and quit when it ends\n"
            "  --rotation <MODE>            Screen rotation preferences. MODEs are:\n"
            "                                 unlocked (0), portrait (1), landscape (2)\n"
            "  --sdl-log=LEVEL              Setup SDL backend logging level\n"
@@ -271,6 +280,26 @@ static int main_process_cmdline(ConfigTree &cfg, int argc, char *argv[])
         }
         else if (ags_stricmp(arg, "--clear-cache-on-room-change") == 0)
             cfg["misc"]["clear_cache_on_room_change"] = "1";
+        else if ((ags_stricmp(arg, "--benchmark") == 0) && (argc > ee + 1))
+        {
+            usetup.BenchmarkFrames = StrUtil::StringToInt(argv[++ee]);
+            if (usetup.BenchmarkFrames > 0)
+            {
+                // Run headless in the window of the game's size, on the silent audio driver
+                cfg["graphics"]["driver"] = "Null";
+                cfg["graphics"]["windowed"] = "1";
+                cfg["graphics"]["window"] = "x1";
+                cfg["graphics"]["game_scale_win"] = "round";
+                cfg["sound"]["driver"] = "dummy";
+                cfg["override"]["multitasking"] = "1";
+            }
+        }
+        else if ((ags_stricmp(arg, "--bench-input") == 0) && (argc > ee + 1))
+            usetup.BenchmarkInput = argv[++ee];
+        else if ((ags_stricmp(arg, "--record-input") == 0) && (argc > ee + 1))
+            usetup.InputRecordFile = argv[++ee];
+        else if ((ags_stricmp(arg, "--replay-input") == 0) && (argc > ee + 1))
+            usetup.InputReplayFile = argv[++ee];
         else if (ags_strnicmp(arg, "--tell", 6) == 0) {
             if (arg[6] == 0)
                 tellInfoKeys.insert(String("all"));
@@ -27,6 +27,7 @@
 #include "ac/roomstatus.h"
 #include "ac/route_finder.h"
 #include "ac/translation.h"
+#include "ac/path_helper.h"
 #include "ac/dynobj/dynobj_manager.h"
 #include "debug/agseditordebugger.h"
 #include "debug/debug_log.h"
@@ -45,8 +46,12 @@
 #include "platform/base/sys_main.h"
 #include "plugin/plugin_engine.h"
 #include "script/cc_common.h"
+#include "script/script.h"
+#include "script/script_profiler.h"
+#include "script/script_runtime.h"
 #include "media/audio/audio_system.h"
 #include "media/video/video.h"
+#include "util/path.h"
 
 using namespace AGS::Common;
 using namespace AGS::Engine;
@@ -86,6 +91,15 @@ void quit_stop_cd()
 
 void quit_shutdown_scripts()
 {
+    if (scriptProfiler)
+    {
+        ccSetScriptProfiler(nullptr);
+        FSLocation fs = platform->GetAppOutputDirectory();
+        CreateFSDirs(fs);
+        scriptProfiler->WriteProfile(Path::ConcatPaths(fs.FullDir, "ags_script_profile.txt"),
+            Path::ConcatPaths(fs.FullDir, "ags_script_profile.folded"));
+        scriptProfiler.reset();
+    }
     ccUnregisterAllObjects();
 }
 
@@ -217,6 +231,7 @@ void quit(const char *quitmsg)
     shutdown_pathfinder();
 
     // Release game data and unregister assets
+    spriteset.SetAsyncLoading(false);
     quit_check_dynamic_sprites(qreason);
     unload_game_file();
     AssetMgr.reset();
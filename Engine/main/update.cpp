@@ -31,9 +31,11 @@
 #include "ac/sys_events.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
+#include "ac/route_finder.h"
 #include "ac/timer.h"
 #include "ac/viewframe.h"
 #include "ac/walkablearea.h"
+#include "debug/profiler.h"
 #include "gfx/bitmap.h"
 #include "gfx/graphicsdriver.h"
 #include "main/game_run.h"
@@ -212,6 +214,12 @@ void update_player_view()
 
 void update_character_move_and_anim(std::vector<int> &followingAsSheep)
 {
+  // start the walks which the followers chose during the last update,
+  // before anyone moves; this is when they would start unbatched too
+  apply_route_batch();
+	// the walks started by the followers are searched for together,
+	// and applied in the order of characters on the next update
+  begin_route_batch();
 	// move & animate characters
   for (int aa=0;aa<game.numcharacters;aa++) {
     if (game.chars[aa].on != 1) continue;
@@ -221,6 +229,7 @@ void update_character_move_and_anim(std::vector<int> &followingAsSheep)
 
 	chi->UpdateMoveAndAnim(aa, chex, followingAsSheep);
   }
+  end_route_batch();
 }
 
 void update_following_exactly_characters(const std::vector<int> &followingAsSheep)
@@ -469,7 +478,8 @@ void update_sierra_speech()
 // update_stuff: moves and animates objects, executes repeat scripts, and
 // the like.
 void update_stuff() {
-  
+  AGS_PROFILE_ZONE("Update");
+
   our_eip = 20;
 
   update_script_timers();
@@ -30,6 +30,7 @@
 #include "media/audio/sound.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
+#include "debug/profiler.h"
 #include "ac/common.h"
 #include "ac/file.h"
 #include "ac/global_audio.h"
@@ -883,6 +884,7 @@ void sync_audio_playback()
 // (this should only be called once per game loop)
 void update_audio_system_on_game_loop ()
 {
+    AGS_PROFILE_ZONE("Audio");
     update_polled_stuff();
 
     // Sync logical game channels with the audio backend
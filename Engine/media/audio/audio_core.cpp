@@ -19,6 +19,7 @@
 #include <thread>
 #include <unordered_map>
 #include "debug/out.h"
+#include "debug/profiler.h"
 #include "media/audio/sdldecoder.h"
 #include "media/audio/openalsource.h"
 #include "util/memory_compat.h"
@@ -438,6 +439,7 @@ PlaybackState audio_core_slot_get_play_state(int slot_handle, float &pos_ms)
 
 void audio_core_entry_poll()
 {
+    AGS_PROFILE_ZONE("AudioPoll");
     // burn off any errors for new loop
     dump_al_errors();
 
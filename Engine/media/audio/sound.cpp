@@ -118,9 +118,12 @@ SOUNDCLIP *load_sound_clip(const AssetPath &apath, const char *extension_hint, b
     const auto ext_hint = asset_ext.IsEmpty() ? String(extension_hint) : asset_ext;
 
     int slot{};
+    // If the asset's data is already accessible in memory (e.g. mapped game package),
+    // then decode it right from there, without making a copy in the sound cache
+    const bool in_memory = s_in && s_in->GetData();
     // If sound data was cached, or asset's size is small enough to load at once,
     // then load/use it and update the cache if necessary
-    if (sounddata || asset_size <= MaxLoadAtOnce)
+    if (sounddata || (asset_size <= MaxLoadAtOnce && !in_memory))
     {
         if (!sounddata)
         {
@@ -130,7 +133,7 @@ SOUNDCLIP *load_sound_clip(const AssetPath &apath, const char *extension_hint, b
         }
         slot = audio_core_slot_init(sounddata, ext_hint, loop);
     }
-    // Otherwise, if asset's size is too large, start streaming
+    // Otherwise, if asset's size is too large, or it's in memory, start streaming
     else
     {
         slot = audio_core_slot_init(std::move(s_in), ext_hint, loop);
@@ -23,6 +23,7 @@
 #include "gfx/gfxdefines.h"
 #include "util/string.h"
 #include <pwd.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
 
 using AGS::Common::String;
@@ -101,6 +102,13 @@ unsigned long AGSPlatformXDGUnix::GetDiskFreeSpaceMB() {
     return 100;
 }
 
+uint64_t AGSPlatformXDGUnix::GetPeakMemoryUsage() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024; // in kilobytes
+}
+
 const char* AGSPlatformXDGUnix::GetBackendFailUserHint()
 {
     return "Make sure you have latest version of SDL2 libraries installed, and X server is running.";
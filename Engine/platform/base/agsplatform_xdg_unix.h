@@ -33,6 +33,7 @@ struct AGSPlatformXDGUnix : AGSPlatformDriver {
     FSLocation GetUserGlobalConfigDirectory() override;
     FSLocation GetAppOutputDirectory() override;
     unsigned long GetDiskFreeSpaceMB() override;
+    uint64_t GetPeakMemoryUsage() override;
     const char* GetBackendFailUserHint() override;
 };
 
@@ -99,6 +99,8 @@ public:
     virtual const char *GetDiskWriteAccessTroubleshootingText();
     virtual const char *GetGraphicsTroubleshootingText() { return ""; }
     virtual unsigned long GetDiskFreeSpaceMB() = 0;
+    // Returns the peak memory used by the process, in bytes, or 0 if unknown
+    virtual uint64_t GetPeakMemoryUsage() { return 0; }
     virtual const char* GetBackendFailUserHint();
     virtual eScriptSystemOSID GetSystemOSID() = 0;
     virtual void GetSystemTime(ScriptDateTime*);
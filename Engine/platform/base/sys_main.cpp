@@ -26,7 +26,7 @@ using namespace AGS::Engine;
 // INIT / SHUTDOWN
 // ----------------------------------------------------------------------------
 
-int sys_main_init(/*config*/) {
+int sys_main_init(bool headless) {
     SDL_version version;
     SDL_GetVersion(&version);
     Debug::Printf(kDbgMsg_Info, "SDL Version: %d.%d.%d", version.major, version.minor, version.patch);
@@ -38,6 +38,8 @@ int sys_main_init(/*config*/) {
 #elif defined (SDL_HINT_ANDROID_SEPARATE_MOUSE_AND_TOUCH)
     SDL_SetHint(SDL_HINT_ANDROID_SEPARATE_MOUSE_AND_TOUCH, "1");
 #endif
+    if (headless)
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
     // TODO: setup these subsystems in config rather than keep hardcoded?
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_EVENTS | SDL_INIT_GAMECONTROLLER) != 0) {
         Debug::Printf(kDbgMsg_Error, "Unable to initialize SDL: %s", SDL_GetError());
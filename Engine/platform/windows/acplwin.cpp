@@ -20,6 +20,7 @@
 #include "platform/windows/windows.h"
 #include <shlobj.h>
 #include <shlwapi.h>
+#include <psapi.h>
 #include <gameux.h>
 #include <libcda.h>
 
@@ -66,6 +67,7 @@ struct AGSWin32 : AGSPlatformDriver {
   const char *GetIllegalFileChars() override;
   const char *GetGraphicsTroubleshootingText() override;
   unsigned long GetDiskFreeSpaceMB() override;
+  uint64_t GetPeakMemoryUsage() override;
   const char* GetBackendFailUserHint() override;
   eScriptSystemOSID GetSystemOSID() override;
   int  InitializeCDPlayer() override;
@@ -342,6 +344,13 @@ unsigned long AGSWin32::GetDiskFreeSpaceMB() {
   return returnMb;
 }
 
+uint64_t AGSWin32::GetPeakMemoryUsage() {
+  PROCESS_MEMORY_COUNTERS counters = {};
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return 0;
+  return counters.PeakWorkingSetSize;
+}
+
 const char* AGSWin32::GetBackendFailUserHint()
 {
   return "Make sure you have DirectX 5 or above installed.";
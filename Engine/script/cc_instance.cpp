@@ -11,6 +11,7 @@
 // http://www.opensource.org/licenses/artistic-license-2.0.php
 //
 //=============================================================================
+#include <algorithm>
 #include <cstdio>
 #include <deque>
 #include <string.h>
@@ -23,8 +24,10 @@
 #include "script/cc_instance.h"
 #include "debug/debug_log.h"
 #include "debug/out.h"
+#include "debug/profiler.h"
 #include "script/cc_common.h"
 #include "script/script.h"
+#include "script/script_profiler.h"
 #include "script/script_runtime.h"
 #include "script/systemimports.h"
 #include "util/bbop.h"
@@ -146,6 +149,13 @@ const ScriptCommandInfo sccmd_info[CC_NUM_SCCMDS] =
     ScriptCommandInfo( SCMD_NEWUSEROBJECT   , "newuserobject"     , 2, kScOpOneArgIsReg ),
 };
 
+const char *scfuse_names[SCFUSE_NUM_CODES - SCFUSE_FIRST_CODE] =
+{
+    "movl+farpush", "movl+farcall", "movl+callscr", "movl+memread4", "movl+memwrite4",
+    "load.sp.offs+memread4", "load.sp.offs+memwrite4",
+    "cmpeq+jzi", "cmpne+jzi", "gt+jzi", "lt+jzi", "gte+jzi", "lte+jzi",
+};
+
 const char *regnames[] = { "null", "sp", "mar", "ax", "bx", "cx", "op", "dx" };
 const char *fixupnames[] = { "null", "fix_gldata", "fix_func", "fix_string", "fix_import", "fix_datadata", "fix_stack" };
 
@@ -212,6 +222,7 @@ struct FunctionCallStack
 unsigned ccInstance::_timeoutCheckMs = 60u;
 unsigned ccInstance::_timeoutAbortMs = 0u;
 unsigned ccInstance::_maxWhileLoops = 0u;
+ScriptProfiler *ccInstance::_profiler = nullptr;
 
 
 ccInstance *ccInstance::GetCurrentInstance()
@@ -243,6 +254,11 @@ void ccInstance::SetExecTimeout(unsigned sys_poll_ms, unsigned abort_ms,
     _maxWhileLoops = abort_loops;
 }
 
+void ccInstance::SetProfiler(ScriptProfiler *profiler)
+{
+    _profiler = profiler;
+}
+
 ccInstance::ccInstance()
 {
     flags               = 0;
@@ -578,7 +594,1165 @@ inline bool FixupArgument(RuntimeScriptValue &arg, int fixup, uintptr_t code,
 
 
 #define MAXNEST 50  // number of recursive function calls allowed
+
+// Computed goto ("labels as values") is a GNU extension, supported by GCC and Clang;
+// other compilers use the regular switch-based dispatch.
+#ifndef CC_EXEC_COMPUTED_GOTO
+#if defined(__GNUC__) || defined(__clang__)
+#define CC_EXEC_COMPUTED_GOTO 1
+#else
+#define CC_EXEC_COMPUTED_GOTO 0
+#endif
+#endif
+
 int ccInstance::Run(int32_t curpc)
+{
+    AGS_PROFILE_ZONE("Script");
+    if (!runningInst->prepared_code || (ccGetOption(SCOPT_LEGACYEXEC) != 0)
+#if DEBUG_CC_EXEC
+        || (ccGetOption(SCOPT_DEBUGRUN) != 0) // instruction dump is only supported by the legacy path
+#endif
+        )
+        return RunLegacy(curpc);
+
+    if (!_profiler)
+        return RunPrepared(curpc);
+    _profiler->OnRunBoundary();
+    const int result = RunPrepared(curpc);
+    _profiler->OnRunBoundary();
+    return result;
+}
+
+int ccInstance::RunPrepared(int32_t curpc)
+{
+    pc = curpc;
+    returnValue = -1;
+
+    if ((curpc < 0) || (curpc >= runningInst->codesize))
+    {
+        cc_error("specified code offset is not valid");
+        return -1;
+    }
+
+    int32_t thisbase[MAXNEST], funcstart[MAXNEST];
+    int was_just_callas = -1;
+    int curnest = 0;
+    int num_args_to_func = -1;
+    int next_call_needs_object = 0;
+    thisbase[0] = 0;
+    funcstart[0] = pc;
+    ccInstance *codeInst = runningInst;
+    const ScriptPreparedOp *ops = codeInst->prepared_code->Ops.data();
+    const RuntimeScriptValue *values = codeInst->prepared_code->Values.data();
+    const ScriptPreparedOp *op = nullptr;
+    FunctionCallStack func_callstack;
+    int loopIterationCheckDisabled = 0;
+    unsigned loopIterations = 0u; // any loop iterations (needed for timeout test)
+    unsigned loopCheckIterations = 0u; // loop iterations accumulated only if check is enabled
+
+    const auto timeout = std::chrono::milliseconds(_timeoutCheckMs);
+    _lastAliveTs = AGS_FastClock::now();
+
+    // WARNING: a time-critical code ahead;
+    // trying to pick some of the code out to separate function(s)
+    // may lead to a performance loss in script-heavy games.
+    // always compare execution speed before applying any major changes!
+    //
+    // Each operation ends with SCOP_NEXT, which advances program counter
+    // past the operation's arguments, or SCOP_JUMP if the pc was assigned
+    // explicitly; both test for abort and dispatch to the next operation.
+    // The fused operations which end with a call run their own part first,
+    // and then pass to the call's handler with SCOP_CHAIN.
+#define SCOP_CHAIN_TARGET(OP) chain_##OP:
+#define SCOP_CHAIN(OP) \
+    pc += op->ArgCount + 1; \
+    op = &ops[pc]; \
+    goto chain_##OP
+#if CC_EXEC_COMPUTED_GOTO
+    // NOTE: the table must follow the numeric order of SCMD_* and SCFUSE_* codes
+    static const void *dispatch_table[SCFUSE_NUM_CODES] = {
+        &&op_invalid,
+        &&op_SCMD_ADD, &&op_SCMD_SUB, &&op_SCMD_REGTOREG, &&op_SCMD_WRITELIT,
+        &&op_SCMD_RET, &&op_SCMD_LITTOREG, &&op_SCMD_MEMREAD, &&op_SCMD_MEMWRITE,
+        &&op_SCMD_MULREG, &&op_SCMD_DIVREG, &&op_SCMD_ADDREG, &&op_SCMD_SUBREG,
+        &&op_SCMD_BITAND, &&op_SCMD_BITOR, &&op_SCMD_ISEQUAL, &&op_SCMD_NOTEQUAL,
+        &&op_SCMD_GREATER, &&op_SCMD_LESSTHAN, &&op_SCMD_GTE, &&op_SCMD_LTE,
+        &&op_SCMD_AND, &&op_SCMD_OR, &&op_SCMD_CALL, &&op_SCMD_MEMREADB,
+        &&op_SCMD_MEMREADW, &&op_SCMD_MEMWRITEB, &&op_SCMD_MEMWRITEW, &&op_SCMD_JZ,
+        &&op_SCMD_PUSHREG, &&op_SCMD_POPREG, &&op_SCMD_JMP, &&op_SCMD_MUL,
+        &&op_SCMD_CALLEXT, &&op_SCMD_PUSHREAL, &&op_SCMD_SUBREALSTACK, &&op_SCMD_LINENUM,
+        &&op_SCMD_CALLAS, &&op_SCMD_THISBASE, &&op_SCMD_NUMFUNCARGS, &&op_SCMD_MODREG,
+        &&op_SCMD_XORREG, &&op_SCMD_NOTREG, &&op_SCMD_SHIFTLEFT, &&op_SCMD_SHIFTRIGHT,
+        &&op_SCMD_CALLOBJ, &&op_SCMD_CHECKBOUNDS, &&op_SCMD_MEMWRITEPTR, &&op_SCMD_MEMREADPTR,
+        &&op_SCMD_MEMZEROPTR, &&op_SCMD_MEMINITPTR, &&op_SCMD_LOADSPOFFS, &&op_SCMD_CHECKNULL,
+        &&op_SCMD_FADD, &&op_SCMD_FSUB, &&op_SCMD_FMULREG, &&op_SCMD_FDIVREG,
+        &&op_SCMD_FADDREG, &&op_SCMD_FSUBREG, &&op_SCMD_FGREATER, &&op_SCMD_FLESSTHAN,
+        &&op_SCMD_FGTE, &&op_SCMD_FLTE, &&op_SCMD_ZEROMEMORY, &&op_SCMD_CREATESTRING,
+        &&op_SCMD_STRINGSEQUAL, &&op_SCMD_STRINGSNOTEQ, &&op_SCMD_CHECKNULLREG, &&op_SCMD_LOOPCHECKOFF,
+        &&op_SCMD_MEMZEROPTRND, &&op_SCMD_JNZ, &&op_SCMD_DYNAMICBOUNDS, &&op_SCMD_NEWARRAY,
+        &&op_SCMD_NEWUSEROBJECT,
+        &&op_SCFUSE_LITTOREG_PUSHREAL, &&op_SCFUSE_LITTOREG_CALLEXT, &&op_SCFUSE_LITTOREG_CALLAS,
+        &&op_SCFUSE_LITTOREG_MEMREAD, &&op_SCFUSE_LITTOREG_MEMWRITE,
+        &&op_SCFUSE_LOADSPOFFS_MEMREAD, &&op_SCFUSE_LOADSPOFFS_MEMWRITE,
+        &&op_SCFUSE_ISEQUAL_JZ, &&op_SCFUSE_NOTEQUAL_JZ, &&op_SCFUSE_GREATER_JZ,
+        &&op_SCFUSE_LESSTHAN_JZ, &&op_SCFUSE_GTE_JZ, &&op_SCFUSE_LTE_JZ,
+    };
+
+#define SCOP_CASE(OP) op_##OP:
+#define SCOP_INVALID  op_invalid:
+#define SCOP_JUMP() \
+    if (flags & INSTF_ABORTED) \
+        return 0; \
+    op = &ops[pc]; \
+    goto *dispatch_table[op->Code]
+#define SCOP_NEXT() \
+    pc += op->ArgCount + 1; \
+    SCOP_JUMP()
+
+    SCOP_JUMP();
+#else
+#define SCOP_CASE(OP) case OP:
+#define SCOP_INVALID  default:
+#define SCOP_JUMP()   continue
+#define SCOP_NEXT() \
+    pc += op->ArgCount + 1; \
+    continue
+
+    while ((flags & INSTF_ABORTED) == 0)
+    {
+    op = &ops[pc];
+    switch (op->Code)
+    {
+#endif // CC_EXEC_COMPUTED_GOTO
+
+    SCOP_CASE(SCMD_LINENUM)
+        line_number = op->Args[0];
+        currentline = line_number;
+        if (new_line_hook)
+            new_line_hook(this, currentline);
+        if (_profiler)
+            _profiler->OnLine(this, codeInst, pc, line_number);
+        SCOP_NEXT();
+    SCOP_CASE(SCMD_ADD)
+    {
+        const auto arg_reg = op->Args[0];
+        const auto arg_lit = op->Args[1];
+        auto &reg1 = registers[arg_reg];
+        // If the the register is SREG_SP, we are allocating new variable on the stack
+        if (arg_reg == SREG_SP)
+        {
+            // Only allocate new data if current stack entry is invalid;
+            // in some cases this may be advancing over value that was written by MEMWRITE*
+            ASSERT_STACK_SPACE_AVAILABLE(1, arg_lit);
+            if (reg1.RValue->IsValid())
+            {
+                registers[SREG_SP].RValue++;
+                stackdata_ptr += arg_lit; // formality, to keep data ptr consistent
+            }
+            else
+            {
+                PushDataToStack(arg_lit);
+                ASSERT_CC_ERROR();
+            }
+        }
+        else
+        {
+            reg1.IValue += arg_lit;
+        }
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_SUB)
+    {
+        const auto arg_reg = op->Args[0];
+        const auto arg_lit = op->Args[1];
+        auto &reg1 = registers[arg_reg];
+        if (reg1.Type == kScValStackPtr)
+        {
+            // If this is SREG_SP, this is stack pop, which frees local variables;
+            // Other than SREG_SP this may be AGS 2.x method to offset stack in SREG_MAR
+            if (arg_reg == SREG_SP)
+            {
+                PopDataFromStack(arg_lit);
+            }
+            else
+            {
+                // This is practically LOADSPOFFS
+                reg1 = GetStackPtrOffsetRw(arg_lit);
+            }
+            ASSERT_CC_ERROR();
+        }
+        else
+        {
+            reg1.IValue -= arg_lit;
+        }
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_REGTOREG)
+    {
+        const auto &reg1 = registers[op->Args[0]];
+        auto       &reg2 = registers[op->Args[1]];
+        reg2 = reg1;
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_WRITELIT)
+    {
+        // Take the data address from reg[MAR] and copy there arg1 bytes from arg2 address
+        const auto arg_size = op->Args[0];
+        const RuntimeScriptValue arg_value = (op->Fixup == FIXUP_STACK) ?
+            GetStackPtrOffsetFw(this->stack, op->Args[1]) : values[op->Args[2]];
+        ASSERT_CC_ERROR();
+        switch (arg_size)
+        {
+        case sizeof(char) :
+            registers[SREG_MAR].WriteByte(arg_value.IValue);
+            break;
+        case sizeof(int16_t) :
+            registers[SREG_MAR].WriteInt16(arg_value.IValue);
+            break;
+        case sizeof(int32_t) :
+            // We do not know if this is math integer or some pointer, etc
+            registers[SREG_MAR].WriteValue(arg_value);
+            break;
+        default:
+            cc_error("unexpected data size for WRITELIT op: %d", arg_size);
+            break;
+        }
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_RET)
+    {
+        if (loopIterationCheckDisabled > 0)
+            loopIterationCheckDisabled--;
+
+        ASSERT_STACK_SIZE(1);
+        RuntimeScriptValue rval = PopValueFromStack();
+        curnest--;
+        pc = rval.IValue;
+        if (pc == 0)
+        {
+            returnValue = registers[SREG_AX].IValue;
+            return 0;
+        }
+        POP_CALL_STACK;
+        if (_profiler)
+            _profiler->OnReturn(this, codeInst, pc, line_number);
+        SCOP_JUMP(); // so that the PC doesn't get overwritten
+    }
+    SCOP_CASE(SCMD_LITTOREG)
+    {
+        auto &reg1 = registers[op->Args[0]];
+        if (op->Fixup == FIXUP_STACK)
+        {
+            reg1 = GetStackPtrOffsetFw(this->stack, op->Args[1]);
+            ASSERT_CC_ERROR();
+        }
+        else
+        {
+            reg1 = values[op->Args[2]];
+        }
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_MEMREAD)
+    {
+        // Take the data address from reg[MAR] and copy int32_t to reg[arg1]
+        auto &reg1 = registers[op->Args[0]];
+        reg1 = registers[SREG_MAR].ReadValue();
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_MEMWRITE)
+    {
+        // Take the data address from reg[MAR] and copy there int32_t from reg[arg1]
+        const auto &reg1 = registers[op->Args[0]];
+        registers[SREG_MAR].WriteValue(reg1);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_LOADSPOFFS)
+    {
+        registers[SREG_MAR] = GetStackPtrOffsetRw(op->Args[0]);
+        ASSERT_CC_ERROR();
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_MULREG)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetInt32(reg1.IValue * reg2.IValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_DIVREG)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        if (reg2.IValue == 0)
+        {
+            cc_error("!Integer divide by zero");
+            return -1;
+        }
+        reg1.SetInt32(reg1.IValue / reg2.IValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_ADDREG)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        // This may be pointer arithmetics, in which case IValue stores offset from base pointer
+        reg1.IValue += reg2.IValue;
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_SUBREG)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        // This may be pointer arithmetics, in which case IValue stores offset from base pointer
+        reg1.IValue -= reg2.IValue;
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_BITAND)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetInt32(reg1.IValue & reg2.IValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_BITOR)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetInt32(reg1.IValue | reg2.IValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_ISEQUAL)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetInt32AsBool(reg1 == reg2);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_NOTEQUAL)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetInt32AsBool(reg1 != reg2);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_GREATER)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetInt32AsBool(reg1.IValue > reg2.IValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_LESSTHAN)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetInt32AsBool(reg1.IValue < reg2.IValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_GTE)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetInt32AsBool(reg1.IValue >= reg2.IValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_LTE)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetInt32AsBool(reg1.IValue <= reg2.IValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_AND)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetInt32AsBool(reg1.IValue && reg2.IValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_OR)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetInt32AsBool(reg1.IValue || reg2.IValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_XORREG)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetInt32(reg1.IValue ^ reg2.IValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_MODREG)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        if (reg2.IValue == 0)
+        {
+            cc_error("!Integer divide by zero");
+            return -1;
+        }
+        reg1.SetInt32(reg1.IValue % reg2.IValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_NOTREG)
+    {
+        auto &reg1 = registers[op->Args[0]];
+        reg1 = !(reg1);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_CALL)
+    {
+        // Call another function within same script, just save PC
+        // and continue from there
+        if (curnest >= MAXNEST - 1)
+        {
+            cc_error("!call stack overflow, recursive call problem?");
+            return -1;
+        }
+
+        PUSH_CALL_STACK;
+
+        ASSERT_STACK_SPACE_VALS(1);
+        PushValueToStack(RuntimeScriptValue().SetInt32(pc + op->ArgCount + 1));
+
+        const auto &reg1 = registers[op->Args[0]];
+        if (thisbase[curnest] == 0)
+            pc = reg1.IValue;
+        else {
+            pc = funcstart[curnest];
+            pc += (reg1.IValue - thisbase[curnest]);
+        }
+
+        next_call_needs_object = 0;
+
+        if (loopIterationCheckDisabled)
+            loopIterationCheckDisabled++;
+
+        curnest++;
+        thisbase[curnest] = 0;
+        funcstart[curnest] = pc;
+        SCOP_JUMP(); // so that the PC doesn't get overwritten
+    }
+    SCOP_CASE(SCMD_MEMREADB)
+    {
+        // Take the data address from reg[MAR] and copy byte to reg[arg1]
+        auto &reg1 = registers[op->Args[0]];
+        reg1.SetUInt8(registers[SREG_MAR].ReadByte());
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_MEMREADW)
+    {
+        // Take the data address from reg[MAR] and copy int16_t to reg[arg1]
+        auto &reg1 = registers[op->Args[0]];
+        reg1.SetInt16(registers[SREG_MAR].ReadInt16());
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_MEMWRITEB)
+    {
+        // Take the data address from reg[MAR] and copy there byte from reg[arg1]
+        const auto &reg1 = registers[op->Args[0]];
+        registers[SREG_MAR].WriteByte(reg1.IValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_MEMWRITEW)
+    {
+        // Take the data address from reg[MAR] and copy there int16_t from reg[arg1]
+        const auto &reg1 = registers[op->Args[0]];
+        registers[SREG_MAR].WriteInt16(reg1.IValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_JZ)
+    {
+        if (registers[SREG_AX].IsNull())
+            pc += op->Args[0];
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_JNZ)
+    {
+        if (!registers[SREG_AX].IsNull())
+            pc += op->Args[0];
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_PUSHREG)
+    {
+        // Push reg[arg1] value to the stack
+        const auto &reg1 = registers[op->Args[0]];
+        ASSERT_STACK_SPACE_VALS(1);
+        PushValueToStack(reg1);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_POPREG)
+    {
+        auto &reg1 = registers[op->Args[0]];
+        ASSERT_STACK_SIZE(1);
+        reg1 = PopValueFromStack();
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_JMP)
+    {
+        const auto arg_lit = op->Args[0];
+        pc += arg_lit;
+
+        // Make sure it's not stuck in a While loop
+        if (arg_lit < 0)
+        {
+            ++loopIterations;
+            if (flags & INSTF_RUNNING)
+            { // was notified still running, don't do anything
+                flags &= ~INSTF_RUNNING;
+                loopIterations = 0u;
+                loopCheckIterations = 0u;
+            }
+            else if ((loopIterationCheckDisabled == 0) && (_maxWhileLoops > 0) &&
+                (++loopCheckIterations > _maxWhileLoops))
+            {
+                cc_error("!Script appears to be hung (a while loop ran %d times). The problem may be in a calling function; check the call stack.", loopCheckIterations);
+                return -1;
+            }
+            else if ((loopIterations & 0x3FF) == 0 && // test each 1024 loops (arbitrary)
+                (std::chrono::duration_cast<std::chrono::milliseconds>(
+                    AGS_FastClock::now() - _lastAliveTs) > timeout))
+            { // minimal timeout occured
+                sys_evt_process_pending();
+                _lastAliveTs = AGS_FastClock::now();
+            }
+        }
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_MUL)
+    {
+        auto &reg1 = registers[op->Args[0]];
+        reg1.IValue *= op->Args[1];
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_CHECKBOUNDS)
+    {
+        const auto &reg1 = registers[op->Args[0]];
+        const auto arg_lit = op->Args[1];
+        if ((reg1.IValue < 0) ||
+            (reg1.IValue >= arg_lit))
+        {
+            cc_error("!Array index out of bounds (index: %d, bounds: 0..%d)", reg1.IValue, arg_lit - 1);
+            return -1;
+        }
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_DYNAMICBOUNDS)
+    {
+        const auto &reg1 = registers[op->Args[0]];
+        void *arr_ptr = registers[SREG_MAR].GetPtrWithOffset();
+        const auto &hdr = CCDynamicArray::GetHeader(arr_ptr);
+        if ((reg1.IValue < 0) ||
+            (static_cast<uint32_t>(reg1.IValue) >= hdr.TotalSize))
+        {
+            int elem_count = hdr.ElemCount & (~ARRAY_MANAGED_TYPE_FLAG);
+            if (elem_count <= 0)
+            {
+                cc_error("!Array has an invalid size (%d) and cannot be accessed", elem_count);
+            }
+            else
+            {
+                int elementSize = (hdr.TotalSize / elem_count);
+                cc_error("!Array index out of bounds (index: %d, bounds: 0..%d)", reg1.IValue / elementSize, elem_count - 1);
+            }
+            return -1;
+        }
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_MEMREADPTR)
+    {
+        auto &reg1 = registers[op->Args[0]];
+        int32_t handle = registers[SREG_MAR].ReadInt32();
+        void *object;
+        IScriptObject *manager;
+        ScriptValueType obj_type = ccGetObjectAddressAndManagerFromHandle(handle, object, manager);
+        reg1.SetScriptObject(obj_type, object, manager);
+        ASSERT_CC_ERROR();
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_MEMWRITEPTR)
+    {
+        const auto &reg1 = registers[op->Args[0]];
+        int32_t handle = registers[SREG_MAR].ReadInt32();
+        void *address;
+        IScriptObject *manager = nullptr;
+
+        switch (reg1.Type)
+        {
+        case kScValStaticArray:
+            address = reg1.ArrMgr->GetElementPtr(reg1.Ptr, reg1.IValue);
+            break;
+        case kScValScriptObject:
+            address = reg1.Ptr;
+            manager = reg1.ObjMgr;
+            break;
+        case kScValPluginObject:
+            address = reg1.Ptr;
+            break;
+        case kScValPluginArg:
+            // FIXME: plugin API is currently strictly 32-bit, so this may break on 64-bit systems
+            address = Int32ToPtr<char>(reg1.IValue);
+            break;
+        default:
+            // There's one possible case when the reg1 is 0, which means writing nullptr
+            CC_ERROR_IF_RETCODE(!reg1.IsNull(), "internal error: MEMWRITEPTR argument is not a dynamic object");
+            address = nullptr;
+            break;
+        }
+
+        int32_t newHandle = ccGetObjectHandleFromAddress(address, manager);
+        if (newHandle == -1)
+            return -1;
+
+        if (handle != newHandle)
+        {
+            ccReleaseObjectReference(handle);
+            ccAddObjectReference(newHandle);
+        }
+        // Assign always, avoid leaving undefined value
+        registers[SREG_MAR].WriteInt32(newHandle);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_MEMINITPTR)
+    {
+        void *address;
+        IScriptObject *manager = nullptr;
+        const auto &reg1 = registers[op->Args[0]];
+
+        switch (reg1.Type)
+        {
+        case kScValStaticArray:
+            address = reg1.ArrMgr->GetElementPtr(reg1.Ptr, reg1.IValue);
+            break;
+        case kScValScriptObject:
+            address = reg1.Ptr;
+            manager = reg1.ObjMgr;
+            break;
+        case kScValPluginObject:
+            address = reg1.Ptr;
+            break;
+        case kScValPluginArg:
+            // FIXME: plugin API is currently strictly 32-bit, so this may break on 64-bit systems
+            address = Int32ToPtr<uint8_t>(reg1.IValue);
+            break;
+        default:
+            // There's one possible case when the reg1 is 0, which means writing nullptr
+            CC_ERROR_IF_RETCODE(!reg1.IsNull(), "internal error: SCMD_MEMINITPTR argument is not a dynamic object");
+            address = nullptr;
+            break;
+        }
+
+        // like memwriteptr, but doesn't attempt to free the old one
+        int32_t newHandle = ccGetObjectHandleFromAddress(address, manager);
+        if (newHandle == -1)
+            return -1;
+
+        ccAddObjectReference(newHandle);
+        registers[SREG_MAR].WriteInt32(newHandle);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_MEMZEROPTR)
+    {
+        int32_t handle = registers[SREG_MAR].ReadInt32();
+        ccReleaseObjectReference(handle);
+        registers[SREG_MAR].WriteInt32(0);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_MEMZEROPTRND)
+    {
+        int32_t handle = registers[SREG_MAR].ReadInt32();
+        // don't do the Dispose check for the object being returned -- this is
+        // for returning a String (or other pointer) from a custom function.
+        pool.disableDisposeForObject = registers[SREG_AX].Ptr;
+        ccReleaseObjectReference(handle);
+        pool.disableDisposeForObject = nullptr;
+        registers[SREG_MAR].WriteInt32(0);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_CHECKNULL)
+        if (registers[SREG_MAR].IsNull())
+        {
+            cc_error("!Null pointer referenced");
+            return -1;
+        }
+        SCOP_NEXT();
+    SCOP_CASE(SCMD_CHECKNULLREG)
+    {
+        const auto &reg1 = registers[op->Args[0]];
+        if (reg1.IsNull())
+        {
+            cc_error("!Null string referenced");
+            return -1;
+        }
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_NUMFUNCARGS)
+        num_args_to_func = op->Args[0];
+        SCOP_NEXT();
+    SCOP_CASE(SCMD_CALLAS)
+    SCOP_CHAIN_TARGET(SCMD_CALLAS)
+    {
+        PUSH_CALL_STACK;
+
+        // Call to a function in another script
+        const auto &reg1 = registers[op->Args[0]];
+
+        // If there are nested CALLAS calls, the stack might
+        // contain 2 calls worth of parameters, so only
+        // push args for this call
+        if (num_args_to_func < 0)
+        {
+            num_args_to_func = func_callstack.Count;
+        }
+        ASSERT_STACK_SPACE_VALS(num_args_to_func + 1 /* return address */);
+        for (const RuntimeScriptValue *prval = func_callstack.GetHead() + num_args_to_func;
+            prval > func_callstack.GetHead(); --prval)
+        {
+            PushValueToStack(*prval);
+        }
+
+        const RuntimeScriptValue oldstack = registers[SREG_SP];
+        const char *oldstackdata = stackdata_ptr;
+        // Push placeholder for the return value (it will be popped before ret)
+        PushValueToStack(RuntimeScriptValue().SetInt32(0));
+
+        int oldpc = pc;
+        ccInstance *wasRunning = runningInst;
+
+        // determine the offset into the code of the instance we want
+        runningInst = loadedInstances[op->InstanceId];
+        intptr_t callAddr = reg1.PtrU8 - reinterpret_cast<uint8_t*>(&runningInst->code[0]);
+        if (callAddr % sizeof(intptr_t) != 0)
+        {
+            cc_error("call address not aligned");
+            return -1;
+        }
+        callAddr /= sizeof(intptr_t); // size of ccScript::code elements
+
+        if (Run((int32_t)callAddr))
+            return -1;
+
+        runningInst = wasRunning;
+
+        if ((flags & INSTF_ABORTED) == 0)
+            ASSERT_STACK_UNWINDED(oldstack, oldstackdata);
+
+        next_call_needs_object = 0;
+
+        pc = oldpc;
+        was_just_callas = func_callstack.Count;
+        num_args_to_func = -1;
+        POP_CALL_STACK;
+        if (_profiler)
+            _profiler->OnReturn(this, codeInst, pc, line_number);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_CALLEXT)
+    SCOP_CHAIN_TARGET(SCMD_CALLEXT)
+    {
+        // Call to a real 'C' code function
+        const auto &reg1 = registers[op->Args[0]];
+
+        was_just_callas = -1;
+        if (num_args_to_func < 0)
+        {
+            num_args_to_func = func_callstack.Count;
+        }
+
+        // Convert pointer arguments to simple types
+        for (RuntimeScriptValue *prval = func_callstack.GetHead() + num_args_to_func;
+            prval > func_callstack.GetHead(); --prval)
+        {
+            prval->DirectPtr();
+        }
+
+        RuntimeScriptValue return_value;
+        if (_profiler)
+            _profiler->BeginExternalCall(reg1);
+
+        if (reg1.Type == kScValPluginFunction)
+        {
+            GlobalReturnValue.Invalidate();
+            int32_t int_ret_val;
+            if (next_call_needs_object)
+            {
+                RuntimeScriptValue obj_rval = registers[SREG_OP];
+                obj_rval.DirectPtrObj();
+                int_ret_val = call_function((intptr_t)reg1.Ptr, &obj_rval, num_args_to_func, func_callstack.GetHead() + 1);
+            }
+            else
+            {
+                int_ret_val = call_function((intptr_t)reg1.Ptr, nullptr, num_args_to_func, func_callstack.GetHead() + 1);
+            }
+
+            if (GlobalReturnValue.IsValid())
+            {
+                return_value = GlobalReturnValue;
+            }
+            else
+            {
+                return_value.SetPluginArgument(int_ret_val);
+            }
+        }
+        else if (next_call_needs_object)
+        {
+            // member function call
+            if (reg1.Type == kScValObjectFunction)
+            {
+                RuntimeScriptValue obj_rval = registers[SREG_OP];
+                obj_rval.DirectPtrObj();
+                return_value = reg1.ObjPfn(obj_rval.Ptr, func_callstack.GetHead() + 1, num_args_to_func);
+            }
+            else
+            {
+                cc_error("invalid pointer type for object function call: %d", reg1.Type);
+            }
+        }
+        else if (reg1.Type == kScValStaticFunction)
+        {
+            return_value = reg1.SPfn(func_callstack.GetHead() + 1, num_args_to_func);
+        }
+        else if (reg1.Type == kScValObjectFunction)
+        {
+            cc_error("unexpected object function pointer on SCMD_CALLEXT");
+        }
+        else
+        {
+            cc_error("invalid pointer type for function call: %d", reg1.Type);
+        }
+        if (_profiler)
+            _profiler->EndExternalCall();
+
+        if (cc_has_error())
+        {
+            return -1;
+        }
+
+        registers[SREG_AX] = return_value;
+        next_call_needs_object = 0;
+        num_args_to_func = -1;
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_PUSHREAL)
+    {
+        const auto &reg1 = registers[op->Args[0]];
+        PushToFuncCallStack(func_callstack, reg1);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_SUBREALSTACK)
+    {
+        const auto arg_lit = op->Args[0];
+        PopFromFuncCallStack(func_callstack, arg_lit);
+        if (was_just_callas >= 0)
+        {
+            ASSERT_STACK_SIZE(arg_lit);
+            PopValuesFromStack(arg_lit);
+            was_just_callas = -1;
+        }
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_CALLOBJ)
+    {
+        // set the OP register
+        const auto &reg1 = registers[op->Args[0]];
+        if (reg1.IsNull())
+        {
+            cc_error("!Null pointer referenced");
+            return -1;
+        }
+        switch (reg1.Type)
+        {
+            // This might be a static object, passed to the user-defined extender function
+        case kScValScriptObject:
+        case kScValPluginObject:
+        case kScValPluginArg:
+            // This might be an object of USER-DEFINED type, calling its MEMBER-FUNCTION.
+        case kScValGlobalVar:
+        case kScValStackPtr:
+            registers[SREG_OP] = reg1;
+            break;
+        case kScValStaticArray:
+            registers[SREG_OP].SetScriptObject(
+                    reg1.ArrMgr->GetElementPtr(reg1.Ptr, reg1.IValue),
+                    reg1.ArrMgr->GetObjectManager());
+            break;
+        default:
+            cc_error("internal error: SCMD_CALLOBJ argument is not an object of built-in or user-defined type");
+            return -1;
+        }
+        next_call_needs_object = 1;
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_SHIFTLEFT)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetInt32(reg1.IValue << reg2.IValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_SHIFTRIGHT)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetInt32(reg1.IValue >> reg2.IValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_THISBASE)
+        thisbase[curnest] = op->Args[0];
+        SCOP_NEXT();
+    SCOP_CASE(SCMD_NEWARRAY)
+    {
+        auto &reg1 = registers[op->Args[0]];
+        const auto arg_elsize = op->Args[1];
+        const auto arg_managed = op->Args[2] != 0;
+        int numElements = reg1.IValue;
+        if (numElements < 1)
+        {
+            cc_error("invalid size for dynamic array; requested: %d, range: 1..%d", numElements, INT32_MAX);
+            return -1;
+        }
+        DynObjectRef ref = CCDynamicArray::Create(numElements, arg_elsize, arg_managed);
+        reg1.SetScriptObject(ref.Obj, &globalDynamicArray);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_NEWUSEROBJECT)
+    {
+        auto &reg1 = registers[op->Args[0]];
+        const auto arg_size = op->Args[1];
+        if (arg_size < 0)
+        {
+            cc_error("Invalid size for user object; requested: %d (or %d), range: 0..%d", arg_size, arg_size, INT_MAX);
+            return -1;
+        }
+        DynObjectRef ref = ScriptUserObject::Create(arg_size);
+        reg1.SetScriptObject(ref.Obj, ref.Mgr);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_FADD)
+    {
+        auto &reg1 = registers[op->Args[0]];
+        reg1.SetFloat(reg1.FValue + op->Args[1]); // arg2 was used as int here originally
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_FSUB)
+    {
+        auto &reg1 = registers[op->Args[0]];
+        reg1.SetFloat(reg1.FValue - op->Args[1]); // arg2 was used as int here originally
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_FMULREG)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetFloat(reg1.FValue * reg2.FValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_FDIVREG)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        if (reg2.FValue == 0.0)
+        {
+            cc_error("!Floating point divide by zero");
+            return -1;
+        }
+        reg1.SetFloat(reg1.FValue / reg2.FValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_FADDREG)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetFloat(reg1.FValue + reg2.FValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_FSUBREG)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetFloat(reg1.FValue - reg2.FValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_FGREATER)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetFloatAsBool(reg1.FValue > reg2.FValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_FLESSTHAN)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetFloatAsBool(reg1.FValue < reg2.FValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_FGTE)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetFloatAsBool(reg1.FValue >= reg2.FValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_FLTE)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        reg1.SetFloatAsBool(reg1.FValue <= reg2.FValue);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_ZEROMEMORY)
+    {
+        const auto arg_size = op->Args[0];
+        // Check if we are zeroing at stack tail
+        if (registers[SREG_MAR] == registers[SREG_SP])
+        {
+            // creating a local variable -- check the stack to ensure no mem overrun
+            ASSERT_STACK_SPACE_BYTES(arg_size);
+            // NOTE: according to compiler's logic, this is always followed
+            // by SCMD_ADD, and that is where the data is "allocated", here we
+            // just clean the place.
+            memset(stackdata_ptr, 0, arg_size);
+        }
+        else
+        {
+            cc_error("internal error: stack tail address expected on SCMD_ZEROMEMORY instruction, reg[MAR] type is %d",
+                registers[SREG_MAR].Type);
+            return -1;
+        }
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_CREATESTRING)
+    {
+        auto &reg1 = registers[op->Args[0]];
+        if (stringClassImpl == nullptr)
+        {
+            cc_error("No string class implementation set, but opcode was used");
+            return -1;
+        }
+        const char *ptr = reinterpret_cast<const char*>(reg1.GetDirectPtr());
+        reg1.SetScriptObject(
+            stringClassImpl->CreateString(ptr).Obj,
+            &myScriptStringImpl);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_STRINGSEQUAL)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        if ((reg1.IsNull()) || (reg2.IsNull()))
+        {
+            cc_error("!Null pointer referenced");
+            return -1;
+        }
+        const char *ptr1 = reinterpret_cast<const char*>(reg1.GetDirectPtr());
+        const char *ptr2 = reinterpret_cast<const char*>(reg2.GetDirectPtr());
+        reg1.SetInt32AsBool(strcmp(ptr1, ptr2) == 0);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_STRINGSNOTEQ)
+    {
+        auto       &reg1 = registers[op->Args[0]];
+        const auto &reg2 = registers[op->Args[1]];
+        if ((reg1.IsNull()) || (reg2.IsNull()))
+        {
+            cc_error("!Null pointer referenced");
+            return -1;
+        }
+        const char *ptr1 = reinterpret_cast<const char*>(reg1.GetDirectPtr());
+        const char *ptr2 = reinterpret_cast<const char*>(reg2.GetDirectPtr());
+        reg1.SetInt32AsBool(strcmp(ptr1, ptr2) != 0);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCMD_LOOPCHECKOFF)
+        if (loopIterationCheckDisabled == 0)
+            loopIterationCheckDisabled++;
+        SCOP_NEXT();
+
+    // Fused operations, see FuseOperations() for the exact sequences
+    SCOP_CASE(SCFUSE_LITTOREG_PUSHREAL)
+    {
+        auto &reg1 = registers[op->Args[0]];
+        reg1 = values[op->Args[2]];
+        PushToFuncCallStack(func_callstack, reg1);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCFUSE_LITTOREG_CALLEXT)
+        registers[op->Args[0]] = values[op->Args[2]];
+        SCOP_CHAIN(SCMD_CALLEXT);
+    SCOP_CASE(SCFUSE_LITTOREG_CALLAS)
+        registers[op->Args[0]] = values[op->Args[2]];
+        SCOP_CHAIN(SCMD_CALLAS);
+    SCOP_CASE(SCFUSE_LITTOREG_MEMREAD)
+    {
+        registers[SREG_MAR] = values[op->Args[2]];
+        auto &reg1 = registers[op->Args[0]];
+        reg1 = registers[SREG_MAR].ReadValue();
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCFUSE_LITTOREG_MEMWRITE)
+    {
+        registers[SREG_MAR] = values[op->Args[2]];
+        const auto &reg1 = registers[op->Args[0]];
+        registers[SREG_MAR].WriteValue(reg1);
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCFUSE_LOADSPOFFS_MEMREAD)
+    {
+        registers[SREG_MAR] = GetStackPtrOffsetRw(op->Args[1]);
+        ASSERT_CC_ERROR();
+        auto &reg1 = registers[op->Args[0]];
+        reg1 = registers[SREG_MAR].ReadValue();
+        SCOP_NEXT();
+    }
+    SCOP_CASE(SCFUSE_LOADSPOFFS_MEMWRITE)
+    {
+        registers[SREG_MAR] = GetStackPtrOffsetRw(op->Args[1]);
+        ASSERT_CC_ERROR();
+        const auto &reg1 = registers[op->Args[0]];
+        registers[SREG_MAR].WriteValue(reg1);
+        SCOP_NEXT();
+    }
+#define SCOP_COMPARE_JZ(OP, EXPR) \
+    SCOP_CASE(OP) \
+    { \
+        auto       &reg1 = registers[op->Args[0]]; \
+        const auto &reg2 = registers[op->Args[1]]; \
+        const bool result = (EXPR); \
+        reg1.SetInt32AsBool(result); \
+        registers[SREG_AX] = reg1; \
+        if (!result) \
+            pc += op->Args[2]; \
+        SCOP_NEXT(); \
+    }
+    SCOP_COMPARE_JZ(SCFUSE_ISEQUAL_JZ, reg1 == reg2)
+    SCOP_COMPARE_JZ(SCFUSE_NOTEQUAL_JZ, reg1 != reg2)
+    SCOP_COMPARE_JZ(SCFUSE_GREATER_JZ, reg1.IValue > reg2.IValue)
+    SCOP_COMPARE_JZ(SCFUSE_LESSTHAN_JZ, reg1.IValue < reg2.IValue)
+    SCOP_COMPARE_JZ(SCFUSE_GTE_JZ, reg1.IValue >= reg2.IValue)
+    SCOP_COMPARE_JZ(SCFUSE_LTE_JZ, reg1.IValue <= reg2.IValue)
+#undef SCOP_COMPARE_JZ
+    SCOP_INVALID
+        cc_error("invalid instruction found in code stream at %d", pc);
+        return -1;
+
+#if !CC_EXEC_COMPUTED_GOTO
+    } // switch
+    } // while
+    return 0;
+#endif
+
+#undef SCOP_CASE
+#undef SCOP_INVALID
+#undef SCOP_JUMP
+#undef SCOP_NEXT
+#undef SCOP_CHAIN_TARGET
+#undef SCOP_CHAIN
+}
+
+int ccInstance::RunLegacy(int32_t curpc)
 {
     pc = curpc;
     returnValue = -1;
@@ -1132,6 +2306,7 @@ int ccInstance::Run(int32_t curpc)
             const auto &reg1 = registers[codeOp.Arg1i()];
             int32_t handle = registers[SREG_MAR].ReadInt32();
             void *address;
+            IScriptObject *manager = nullptr;
 
             switch (reg1.Type)
             {
@@ -1141,6 +2316,9 @@ int ccInstance::Run(int32_t curpc)
                 address = reg1.ArrMgr->GetElementPtr(reg1.Ptr, reg1.IValue);
                 break;
             case kScValScriptObject:
+                address = reg1.Ptr;
+                manager = reg1.ObjMgr;
+                break;
             case kScValPluginObject:
                 address = reg1.Ptr;
                 break;
@@ -1155,7 +2333,7 @@ int ccInstance::Run(int32_t curpc)
                 break;
             }
 
-            int32_t newHandle = ccGetObjectHandleFromAddress(address);
+            int32_t newHandle = ccGetObjectHandleFromAddress(address, manager);
             if (newHandle == -1)
                 return -1;
 
@@ -1171,6 +2349,7 @@ int ccInstance::Run(int32_t curpc)
         case SCMD_MEMINITPTR:
         {
             void *address;
+            IScriptObject *manager = nullptr;
             const auto &reg1 = registers[codeOp.Arg1i()];
 
             switch (reg1.Type)
@@ -1181,6 +2360,9 @@ int ccInstance::Run(int32_t curpc)
                 address = reg1.ArrMgr->GetElementPtr(reg1.Ptr, reg1.IValue);
                 break;
             case kScValScriptObject:
+                address = reg1.Ptr;
+                manager = reg1.ObjMgr;
+                break;
             case kScValPluginObject:
                 address = reg1.Ptr;
                 break;
@@ -1196,7 +2378,7 @@ int ccInstance::Run(int32_t curpc)
             }
 
             // like memwriteptr, but doesn't attempt to free the old one
-            int32_t newHandle = ccGetObjectHandleFromAddress(address);
+            int32_t newHandle = ccGetObjectHandleFromAddress(address, manager);
             if (newHandle == -1)
                 return -1;
 
@@ -1809,7 +2991,7 @@ bool ccInstance::_Create(PScript scri, ccInstance * joined)
     else {
         // create own memory space
         // NOTE: globalvars are created in CreateGlobalVars()
-        globalvars.reset(new ScVarMap());
+        globalvars.reset(new ScVarTable());
         globaldatasize = scri->globaldatasize;
         globaldata = nullptr;
         if (globaldatasize > 0)
@@ -1862,6 +3044,7 @@ bool ccInstance::_Create(PScript scri, ccInstance * joined)
     {
         resolved_imports = joined->resolved_imports;
         code_fixups = joined->code_fixups;
+        prepared_code = joined->prepared_code;
     }
     else
     {
@@ -1966,9 +3149,10 @@ void ccInstance::Free()
     }
     resolved_imports = nullptr;
     code_fixups = nullptr;
+    prepared_code.reset();
 }
 
-bool ccInstance::ResolveScriptImports(const ccScript *scri)
+bool ccInstance::ResolveScriptImports(const ccScript *scri, const String &cache_key)
 {
     // Script keeps the information of what imports are used as an array of names.
     // When an import is referenced in the code, it's addressed by its index in this
@@ -1988,6 +3172,9 @@ bool ccInstance::ResolveScriptImports(const ccScript *scri)
     }
 
     resolved_imports = new uint32_t[numimports];
+    if (!cache_key.IsEmpty() && simp.GetCachedIndexes(cache_key, resolved_imports, numimports))
+        return true;
+
     size_t errors = 0, last_err_idx = 0;
     for (int import_idx = 0; import_idx < scri->numimports; ++import_idx)
     {
@@ -2011,6 +3198,8 @@ bool ccInstance::ResolveScriptImports(const ccScript *scri)
             scri->numSections > 0 ? scri->sectionNames[0] : "<unknown>",
             errors,
             scri->imports[last_err_idx]);
+    else if (!cache_key.IsEmpty())
+        simp.CacheIndexes(cache_key, resolved_imports, numimports);
 
     return errors == 0;
 }
@@ -2073,6 +3262,14 @@ bool ccInstance::CreateGlobalVars(const ccScript *scri)
         }
     }
 
+    // Sort the variables by address for the lookup; if there are several
+    // entries for the same address, then the first registered one is kept
+    std::stable_sort(globalvars->begin(), globalvars->end(),
+        [](const ScriptVariable &v1, const ScriptVariable &v2) { return v1.ScAddress < v2.ScAddress; });
+    globalvars->erase(std::unique(globalvars->begin(), globalvars->end(),
+        [](const ScriptVariable &v1, const ScriptVariable &v2) { return v1.ScAddress == v2.ScAddress; }),
+        globalvars->end());
+    globalvars->shrink_to_fit();
     return true;
 }
 
@@ -2090,7 +3287,7 @@ bool ccInstance::AddGlobalVar(const ScriptVariable &glvar)
         /* return false; */
         Debug::Printf(kDbgMsg_Warn, "WARNING: global variable refers to data beyond allocated buffer (%d, %d)", glvar.ScAddress, globaldatasize);
     }
-    globalvars->insert(std::make_pair(glvar.ScAddress, glvar));
+    globalvars->push_back(glvar);
     return true;
 }
 
@@ -2104,8 +3301,9 @@ ScriptVariable *ccInstance::FindGlobalVar(int32_t var_addr)
         */
         Debug::Printf(kDbgMsg_Warn, "WARNING: looking up for global variable beyond allocated buffer (%d, %d)", var_addr, globaldatasize);
     }
-    ScVarMap::iterator it = globalvars->find(var_addr);
-    return it != globalvars->end() ? &it->second : nullptr;
+    auto it = std::lower_bound(globalvars->begin(), globalvars->end(), var_addr,
+        [](const ScriptVariable &var, int32_t addr) { return var.ScAddress < addr; });
+    return (it != globalvars->end() && it->ScAddress == var_addr) ? &*it : nullptr;
 }
 
 static int DetermineScriptLine(const int32_t *code, size_t codesz, size_t at_pc)
@@ -2202,6 +3400,177 @@ bool ccInstance::ResolveImportFixups(const ccScript *scri)
         if (import->InstancePtr != nullptr && (code[fixup + 1] & INSTANCE_ID_REMOVEMASK) == SCMD_CALLEXT)
             code[fixup + 1] = SCMD_CALLAS | (import->InstancePtr->loadedInstanceId << INSTANCE_ID_SHIFT);
     }
+    return PrepareCode(scri);
+}
+
+// Finds the fused operation which may replace the instruction sequence
+// starting with op1 (followed by op2 and op3, if there are such); returns
+// the fused operation's code and fills its arguments, or returns 0.
+static int FindFusedOperation(const ScriptPreparedOp &op1, const ScriptPreparedOp *op2,
+    const ScriptPreparedOp *op3, ScriptPreparedOp &fused)
+{
+    if (!op2)
+        return 0;
+    fused = op1;
+    switch (op1.Code)
+    {
+    case SCMD_LITTOREG:
+        // only the literals resolved at load time
+        if (op1.Fixup == FIXUP_STACK)
+            return 0;
+        switch (op2->Code)
+        {
+        case SCMD_PUSHREAL:
+            if (op2->Args[0] != op1.Args[0])
+                return 0;
+            fused.ArgCount = op1.ArgCount + op2->ArgCount + 1;
+            return SCFUSE_LITTOREG_PUSHREAL;
+        // calls run their own handler after the fused operation's part
+        case SCMD_CALLEXT:
+            return (op2->Args[0] == op1.Args[0]) ? SCFUSE_LITTOREG_CALLEXT : 0;
+        case SCMD_CALLAS:
+            return (op2->Args[0] == op1.Args[0]) ? SCFUSE_LITTOREG_CALLAS : 0;
+        case SCMD_MEMREAD:
+        case SCMD_MEMWRITE:
+            if (op1.Args[0] != SREG_MAR)
+                return 0;
+            fused.Args[0] = op2->Args[0];
+            fused.ArgCount = op1.ArgCount + op2->ArgCount + 1;
+            return (op2->Code == SCMD_MEMREAD) ? SCFUSE_LITTOREG_MEMREAD : SCFUSE_LITTOREG_MEMWRITE;
+        default:
+            return 0;
+        }
+    case SCMD_LOADSPOFFS:
+        if (op2->Code != SCMD_MEMREAD && op2->Code != SCMD_MEMWRITE)
+            return 0;
+        fused.Args[0] = op2->Args[0];
+        fused.Args[1] = op1.Args[0];
+        fused.ArgCount = op1.ArgCount + op2->ArgCount + 1;
+        return (op2->Code == SCMD_MEMREAD) ? SCFUSE_LOADSPOFFS_MEMREAD : SCFUSE_LOADSPOFFS_MEMWRITE;
+    case SCMD_ISEQUAL:
+    case SCMD_NOTEQUAL:
+    case SCMD_GREATER:
+    case SCMD_LESSTHAN:
+    case SCMD_GTE:
+    case SCMD_LTE:
+    {
+        // the result is either tested in ax right away, or copied to ax first
+        const ScriptPreparedOp *jump = op2;
+        fused.ArgCount = op1.ArgCount + 1;
+        if (op1.Args[0] != SREG_AX)
+        {
+            if (op2->Code != SCMD_REGTOREG || op2->Args[0] != op1.Args[0] || op2->Args[1] != SREG_AX || !op3)
+                return 0;
+            fused.ArgCount += op2->ArgCount + 1;
+            jump = op3;
+        }
+        if (jump->Code != SCMD_JZ)
+            return 0;
+        fused.Args[2] = jump->Args[0];
+        fused.ArgCount += jump->ArgCount;
+        return SCFUSE_ISEQUAL_JZ + (op1.Code - SCMD_ISEQUAL);
+    }
+    default:
+        return 0;
+    }
+}
+
+// Replaces the frequent instruction sequences with the fused operations
+static void FuseOperations(ScriptPreparedCode &prep)
+{
+    std::vector<ScriptPreparedOp> &ops = prep.Ops;
+    const int32_t codesize = static_cast<int32_t>(ops.size());
+    for (int32_t at = 0; at < codesize;)
+    {
+        ScriptPreparedOp &op = ops[at];
+        const int32_t next = at + op.ArgCount + 1;
+        const int32_t next2 = (next < codesize) ? next + ops[next].ArgCount + 1 : codesize;
+        ScriptPreparedOp fused;
+        const int fused_code = FindFusedOperation(op,
+            (next < codesize) ? &ops[next] : nullptr, (next2 < codesize) ? &ops[next2] : nullptr, fused);
+        if (fused_code != 0)
+        {
+            op = fused;
+            op.Code = static_cast<uint8_t>(fused_code);
+            prep.NumFused[fused_code - SCFUSE_FIRST_CODE]++;
+        }
+        prep.NumInstructions++;
+        at = next;
+    }
+}
+
+bool ccInstance::PrepareCode(const ccScript *scri)
+{
+    std::shared_ptr<ScriptPreparedCode> prep(new ScriptPreparedCode());
+    // Operations are stored per each code position; positions which are
+    // occupied by instruction arguments are left with invalid code
+    prep->Ops.resize(codesize);
+    for (int32_t at = 0; at < codesize; ++at)
+    {
+        const int32_t instr = static_cast<int32_t>(code[at]);
+        const int32_t op_code = instr & INSTANCE_ID_REMOVEMASK;
+        if (op_code <= 0 || op_code >= CC_NUM_SCCMDS)
+        {
+            // Unexpected data in the code stream; we cannot guarantee that the
+            // code is interpreted precisely same way, so fallback to the original
+            // byte-code for this script.
+            Debug::Printf(kDbgMsg_Warn, "WARNING: script '%s' cannot be prepared: invalid instruction %d at %d, will use legacy execution",
+                scri->numSections > 0 ? scri->sectionNames[0] : "<unknown>", op_code, at);
+            prepared_code.reset();
+            return true;
+        }
+        const ScriptCommandInfo &cmd_info = sccmd_info[op_code];
+        if (at + cmd_info.ArgCount >= codesize)
+        {
+            cc_error_fixups(scri, at, "unexpected end of code data (%d; %d)", at + cmd_info.ArgCount, codesize);
+            return false;
+        }
+
+        ScriptPreparedOp &op = prep->Ops[at];
+        op.Code = static_cast<uint8_t>(op_code);
+        op.InstanceId = static_cast<uint8_t>((instr >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK);
+        op.ArgCount = static_cast<uint8_t>(cmd_info.ArgCount);
+        for (int i = 0; i < cmd_info.ArgCount; ++i)
+            op.Args[i] = static_cast<int32_t>(code[at + 1 + i]);
+
+        // Only the second argument of these instructions may require a fixup
+        if (op_code == SCMD_LITTOREG || op_code == SCMD_WRITELIT)
+        {
+            const int fixup = code_fixups[at + 2];
+            if (fixup == FIXUP_STACK)
+            {
+                op.Fixup = FIXUP_STACK; // depends on the actual stack, resolve at runtime
+            }
+            else
+            {
+                RuntimeScriptValue arg;
+                arg.SetInt32(op.Args[1]);
+                if (!FixupArgument(arg, fixup, code[at + 2], nullptr, strings))
+                {
+                    cc_error_fixups(scri, at, "failed to resolve argument (bytecode pos %d, fixup %d)", at + 2, fixup);
+                    return false;
+                }
+                op.Fixup = static_cast<uint8_t>(fixup);
+                op.Args[2] = static_cast<int32_t>(prep->Values.size());
+                prep->Values.push_back(arg);
+            }
+        }
+        at += cmd_info.ArgCount;
+    }
+
+    FuseOperations(*prep);
+    String fused_stats;
+    uint32_t num_fused = 0u;
+    for (int i = 0; i < SCFUSE_NUM_CODES - SCFUSE_FIRST_CODE; ++i)
+    {
+        if (prep->NumFused[i] == 0u)
+            continue;
+        fused_stats.AppendFmt(" %s: %u;", scfuse_names[i], prep->NumFused[i]);
+        num_fused += prep->NumFused[i];
+    }
+    Debug::Printf(kDbgGroup_Script, kDbgMsg_Debug, "Script '%s' prepared: %u instructions, %u fused sequences;%s",
+        scri->numSections > 0 ? scri->sectionNames[0] : "<unknown>", prep->NumInstructions, num_fused, fused_stats.GetCStr());
+    prepared_code = prep;
     return true;
 }
 
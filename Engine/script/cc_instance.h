@@ -20,6 +20,7 @@
 
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "ac/timer.h"
 #include "script/cc_script.h"  // ccScript
@@ -81,6 +82,62 @@ struct ScriptOperation
     inline int Arg3i() const { return Args[2].IValue; }
 };
 
+// Pre-decoded instruction, prepared once when the script is loaded.
+// Arguments are stored as plain integers; the literal argument which
+// requires a fixup is resolved beforehand and kept in a separate table
+// (see ScriptPreparedCode::Values), with the index stored in the unused
+// third argument slot.
+struct ScriptPreparedOp
+{
+    uint8_t Code = 0;       // pure instruction code (0 marks an invalid position)
+    uint8_t InstanceId = 0; // instance id, used by the far calls
+    uint8_t ArgCount = 0;   // for the fused operation: length of the code it covers, minus one
+    uint8_t Fixup = 0;      // fixup type, only FIXUP_STACK is resolved at runtime
+    int32_t Args[MAX_SCMD_ARGS] = {};
+};
+
+// Engine-internal fused operations, which replace the frequent sequences
+// of instructions in the pre-decoded code. The fused operation is stored
+// at the position of the first instruction of a sequence, while the
+// following instructions are kept at their own positions, in case there's
+// a jump right to them.
+enum ScriptFusedCommand
+{
+    // reg1 = lit; farpush reg1
+    SCFUSE_LITTOREG_PUSHREAL = CC_NUM_SCCMDS,
+    // reg1 = lit; farcall reg1 (or callscr reg1)
+    SCFUSE_LITTOREG_CALLEXT,
+    SCFUSE_LITTOREG_CALLAS,
+    // MAR = lit; reg1 = m[MAR] (or m[MAR] = reg1)
+    SCFUSE_LITTOREG_MEMREAD,
+    SCFUSE_LITTOREG_MEMWRITE,
+    // MAR = SP - arg2; reg1 = m[MAR] (or m[MAR] = reg1)
+    SCFUSE_LOADSPOFFS_MEMREAD,
+    SCFUSE_LOADSPOFFS_MEMWRITE,
+    // reg1 = reg1 <cmp> reg2; [ax = reg1]; jump by arg3 if ax == 0
+    SCFUSE_ISEQUAL_JZ,
+    SCFUSE_NOTEQUAL_JZ,
+    SCFUSE_GREATER_JZ,
+    SCFUSE_LESSTHAN_JZ,
+    SCFUSE_GTE_JZ,
+    SCFUSE_LTE_JZ,
+    SCFUSE_NUM_CODES,
+    SCFUSE_FIRST_CODE = SCFUSE_LITTOREG_PUSHREAL
+};
+
+// Script's byte-code translated to the pre-decoded form. Operations are
+// indexed by the same program counter values as the original code array,
+// so that jumps, return addresses and callstack positions are interchangeable.
+struct ScriptPreparedCode
+{
+    std::vector<ScriptPreparedOp>   Ops;
+    std::vector<RuntimeScriptValue> Values; // resolved literal arguments
+    // Number of instructions in the code, and the number of the instruction
+    // sequences replaced by each of the fused operations
+    uint32_t NumInstructions = 0u;
+    uint32_t NumFused[SCFUSE_NUM_CODES - SCFUSE_FIRST_CODE] = {};
+};
+
 struct ScriptVariable
 {
     ScriptVariable()
@@ -89,11 +146,12 @@ struct ScriptVariable
     }
 
     int32_t             ScAddress;  // original 32-bit relative data address, written in compiled script;
-                                    // if we are to use Map or HashMap, this could be used as Key
+                                    // used as a key in the instance's table of global variables
     RuntimeScriptValue  RValue;
 };
 
 struct FunctionCallStack;
+class ScriptProfiler;
 
 struct ScriptPosition
 {
@@ -117,11 +175,13 @@ struct ScriptPosition
 struct ccInstance
 {
 public:
-    typedef std::unordered_map<int32_t, ScriptVariable> ScVarMap;
-    typedef std::shared_ptr<ScVarMap>                   PScVarMap;
+    // Global variables, sorted by their address; the table is complete before
+    // the code fixups are resolved, which then keep pointers to its elements
+    typedef std::vector<ScriptVariable>                 ScVarTable;
+    typedef std::shared_ptr<ScVarTable>                 PScVarTable;
 public:
     int32_t flags;
-    PScVarMap globalvars;
+    PScVarTable globalvars;
     char *globaldata;
     int32_t globaldatasize;
     // Executed byte-code. Unlike ccScript's code array which is int32_t, the one
@@ -158,6 +218,8 @@ public:
     int  numimports;
 
     char *code_fixups;
+    // pre-decoded code, shared with the forked instances
+    std::shared_ptr<ScriptPreparedCode> prepared_code;
 
     // returns the currently executing instance, or NULL if none
     static ccInstance *GetCurrentInstance(void);
@@ -165,6 +227,8 @@ public:
     static ccInstance *CreateFromScript(PScript script);
     static ccInstance *CreateEx(PScript scri, ccInstance * joined);
     static void SetExecTimeout(unsigned sys_poll_ms, unsigned abort_ms, unsigned abort_loops);
+    // Assigns the profiler which is notified about the script execution, or none
+    static void SetProfiler(ScriptProfiler *profiler);
 
     ccInstance();
     ~ccInstance();
@@ -192,10 +256,14 @@ public:
     void    NotifyAlive();
 
     // For each import, find the instance that corresponds to it and save it
-    // in resolved_imports[]. Return whether the function is successful
-    bool    ResolveScriptImports(const ccScript *scri);
+    // in resolved_imports[]. Return whether the function is successful.
+    // If cache_key is not empty, then the resolved imports are cached under
+    // this key, and reused when the script with the same key is loaded again.
+    bool    ResolveScriptImports(const ccScript *scri, const Common::String &cache_key = Common::String());
     // Using resolved_imports[], resolve the IMPORT fixups
-    // Also change CALLEXT op-codes to CALLAS when they pertain to a script instance 
+    // Also change CALLEXT op-codes to CALLAS when they pertain to a script instance.
+    // As this is the last step of fixing up the code, this also prepares
+    // the pre-decoded code for execution.
     bool    ResolveImportFixups(const ccScript *scri);
 
 private:
@@ -207,9 +275,16 @@ private:
     bool    AddGlobalVar(const ScriptVariable &glvar);
     ScriptVariable *FindGlobalVar(int32_t var_addr);
     bool    CreateRuntimeCodeFixups(const ccScript *scri);
+    // Translates fully fixed up byte-code into the pre-decoded form
+    bool    PrepareCode(const ccScript *scri);
 
     // Begin executing script starting from the given bytecode index
     int     Run(int32_t curpc);
+    // Executes the pre-decoded code
+    int     RunPrepared(int32_t curpc);
+    // Executes the original byte-code, decoding instructions as it goes;
+    // this is slower, and is kept for debugging purposes
+    int     RunLegacy(int32_t curpc);
 
     // Stack processing
     // Push writes new value and increments stack ptr;
@@ -239,6 +314,8 @@ private:
     // Maximal while loops without any engine update in between,
     // after which the interpreter will abort
     static unsigned _maxWhileLoops;
+    // Optional profiler of the script execution
+    static ScriptProfiler *_profiler;
     // Last time the script was noted of being "alive"
     AGS_FastClock::time_point _lastAliveTs;
 };
@@ -39,6 +39,7 @@
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
 #include "main/game_run.h"
+#include "script/script_profiler.h"
 #include "script/script_runtime.h"
 #include "util/string_compat.h"
 #include "media/audio/audio_system.h"
@@ -87,6 +88,8 @@ std::vector<UInstance> moduleInstFork;
 std::vector<RuntimeScriptValue> moduleRepExecAddr;
 size_t numScriptModules = 0;
 
+std::unique_ptr<ScriptProfiler> scriptProfiler;
+
 
 static bool DoRunScriptFuncCantBlock(ccInstance *sci, NonBlockingScriptFunction* funcToRun, bool hasTheFunc);
 
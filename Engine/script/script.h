@@ -33,6 +33,8 @@ using AGS::Common::InteractionVariable;
 #define REP_EXEC_ALWAYS_NAME "repeatedly_execute_always"
 #define REP_EXEC_NAME "repeatedly_execute"
 
+class ScriptProfiler;
+
 // ObjectEvent - a struct holds data of the object's interaction event,
 // such as object's reference and accompanying parameters
 struct ObjectEvent
@@ -174,4 +176,7 @@ extern std::vector<UInstance> moduleInstFork;
 extern std::vector<RuntimeScriptValue> moduleRepExecAddr;
 extern size_t numScriptModules;
 
+// Script profiler, created if it was enabled in config
+extern std::unique_ptr<ScriptProfiler> scriptProfiler;
+
 #endif // __AGS_EE_SCRIPT__SCRIPT_H
@@ -0,0 +1,292 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "script/script_profiler.h"
+#include <algorithm>
+#include "debug/out.h"
+#include "script/cc_instance.h"
+#include "script/cc_internal.h"
+#include "script/systemimports.h"
+#include "util/file.h"
+#include "util/textstreamwriter.h"
+
+using namespace AGS::Common;
+
+static uint64_t ToNanoseconds(AGS_Clock::duration d)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+size_t ScriptProfiler::StackHash::operator()(const std::vector<uint32_t> &stack) const
+{
+    // FNV-1a over the frame ids
+    size_t hash = 2166136261u;
+    for (uint32_t frame : stack)
+        hash = (hash ^ frame) * 16777619u;
+    return hash;
+}
+
+uint32_t ScriptProfiler::GetFrame(const String &name, bool external)
+{
+    auto it = _frameByName.find(name);
+    if (it != _frameByName.end())
+        return it->second;
+    Frame frame;
+    frame.Name = name;
+    frame.IsExternal = external;
+    _frames.push_back(frame);
+    const uint32_t id = static_cast<uint32_t>(_frames.size() - 1);
+    _frameByName.insert(std::make_pair(name, id));
+    return id;
+}
+
+ScriptProfiler::ScriptFunctions &ScriptProfiler::GetScriptFunctions(const PScript &script)
+{
+    ScriptFunctions &funcs = _scripts[script.get()];
+    if (funcs.Script.lock() == script)
+        return funcs;
+
+    // New script, or another one loaded at the same address
+    funcs.Script = script;
+    funcs.Functions.clear();
+    funcs.Functions.push_back(std::make_pair(0,
+        GetFrame(String::FromFormat("%s:(unknown)", script->GetSectionName(1)), false)));
+    for (int i = 0; i < script->numexports; ++i)
+    {
+        if ((script->export_addr[i] >> 24) != EXPORT_FUNCTION)
+            continue;
+        const int32_t addr = script->export_addr[i] & 0x00FFFFFF;
+        // Cut the number of args appended to the function name
+        String name = script->exports[i];
+        name.TruncateToLeftSection('$');
+        // NOTE: GetSectionName looks for the section which starts strictly
+        // before the given offset, and the function may start right at it
+        funcs.Functions.push_back(std::make_pair(addr,
+            GetFrame(String::FromFormat("%s:%s", script->GetSectionName(addr + 1), name.GetCStr()), false)));
+    }
+    std::stable_sort(funcs.Functions.begin(), funcs.Functions.end(),
+        [](const std::pair<int32_t, uint32_t> &f1, const std::pair<int32_t, uint32_t> &f2)
+        { return f1.first < f2.first; });
+    return funcs;
+}
+
+uint32_t ScriptProfiler::GetFunction(const ccInstance *code_inst, int32_t pc)
+{
+    const ccScript *script = code_inst->instanceof.get();
+    if (script != _lastScript || _lastFunctions->Script.expired())
+    {
+        _lastFunctions = &GetScriptFunctions(code_inst->instanceof);
+        _lastScript = script;
+    }
+    // Find the last function starting at or before the pc
+    const auto &funcs = _lastFunctions->Functions;
+    auto it = std::upper_bound(funcs.begin(), funcs.end(), pc,
+        [](int32_t pc, const std::pair<int32_t, uint32_t> &f) { return pc < f.first; });
+    return (it == funcs.begin()) ? funcs.front().second : (it - 1)->second;
+}
+
+void ScriptProfiler::Flush(AGS_Clock::time_point now)
+{
+    if (!_hasPosition)
+        return;
+    const uint64_t time = ToNanoseconds(now - _lastTime);
+    _frames[_func].Time += time;
+    _line->Time += time;
+    *_stackTime += time;
+    _hasPosition = false;
+}
+
+void ScriptProfiler::SetPosition(const ccInstance *inst, const ccInstance *code_inst,
+    int32_t pc, int32_t line, bool new_hit)
+{
+    const auto now = AGS_Clock::now();
+    Flush(now);
+
+    _tempStack.clear();
+    for (int i = 0; i < inst->callStackSize; ++i)
+        _tempStack.push_back(GetFunction(inst->callStackCodeInst[i], inst->callStackAddr[i]));
+    _func = GetFunction(code_inst, pc);
+    _tempStack.push_back(_func);
+    if (!_stackTime || (_tempStack != _stack))
+    {
+        _stack.swap(_tempStack);
+        _stackTime = &_stacks[_stack];
+    }
+    _line = &_lines[(static_cast<uint64_t>(_func) << 32) | static_cast<uint32_t>(line)];
+    if (new_hit)
+    {
+        _line->Hits++;
+        _frames[_func].Lines++;
+    }
+    _hasPosition = true;
+    _lastTime = now;
+}
+
+void ScriptProfiler::OnRunBoundary()
+{
+    Flush(AGS_Clock::now());
+}
+
+void ScriptProfiler::OnLine(const ccInstance *inst, const ccInstance *code_inst, int32_t pc, int32_t line)
+{
+    SetPosition(inst, code_inst, pc, line, true);
+}
+
+void ScriptProfiler::OnReturn(const ccInstance *inst, const ccInstance *code_inst, int32_t pc, int32_t line)
+{
+    SetPosition(inst, code_inst, pc, line, false);
+}
+
+void ScriptProfiler::BeginExternalCall(const RuntimeScriptValue &fn)
+{
+    const auto now = AGS_Clock::now();
+    // Save the script position, the API may run another script and change it
+    if (_extDepth == _extCalls.size())
+        _extCalls.emplace_back();
+    ExternalCall &call = _extCalls[_extDepth++];
+    call.HadPosition = _hasPosition;
+    call.Func = _func;
+    call.Line = _line;
+    call.Stack = _stack;
+    call.StackTime = _stackTime;
+    call.Fn = fn;
+    call.Start = now;
+    Flush(now);
+}
+
+void ScriptProfiler::EndExternalCall()
+{
+    if (_extDepth == 0u)
+        return;
+    const auto now = AGS_Clock::now();
+    Flush(now);
+    ExternalCall &call = _extCalls[--_extDepth];
+
+    auto it = _extFrames.find(call.Fn.Ptr);
+    if (it == _extFrames.end())
+    {
+        String name = simp.findName(call.Fn);
+        if (name.IsEmpty())
+            name = String::FromFormat("(engine API %p)", call.Fn.Ptr);
+        it = _extFrames.insert(std::make_pair(call.Fn.Ptr, GetFrame(name, true))).first;
+    }
+    const uint64_t time = ToNanoseconds(now - call.Start);
+    Frame &frame = _frames[it->second];
+    frame.Calls++;
+    frame.Time += time;
+    _tempStack = call.Stack;
+    _tempStack.push_back(it->second);
+    _stacks[_tempStack] += time;
+
+    // Resume counting the time of the calling line
+    _hasPosition = call.HadPosition;
+    _func = call.Func;
+    _line = call.Line;
+    _stack.swap(call.Stack);
+    _stackTime = call.StackTime;
+    _lastTime = now;
+}
+
+bool ScriptProfiler::WriteProfile(const String &profile_file, const String &stacks_file) const
+{
+    // Inclusive function time, counting each function once per stack
+    std::vector<uint64_t> total_time(_frames.size());
+    uint64_t script_time = 0u, ext_time = 0u;
+    for (const auto &stack : _stacks)
+    {
+        for (size_t i = 0; i < stack.first.size(); ++i)
+        {
+            const uint32_t frame = stack.first[i];
+            if (std::find(stack.first.begin(), stack.first.begin() + i, frame) == stack.first.begin() + i)
+                total_time[frame] += stack.second;
+        }
+    }
+    for (const auto &frame : _frames)
+        (frame.IsExternal ? ext_time : script_time) += frame.Time;
+
+    Stream *out = File::CreateFile(profile_file);
+    if (!out)
+    {
+        Debug::Printf(kDbgMsg_Error, "Script profiler: failed to open file %s", profile_file.GetCStr());
+        return false;
+    }
+    {
+        TextStreamWriter writer(out);
+        writer.WriteFormat("Script time: %.3f ms, engine API time: %.3f ms\n",
+            script_time / 1000000.0, ext_time / 1000000.0);
+
+        std::vector<uint32_t> order;
+        for (uint32_t i = 0; i < _frames.size(); ++i)
+            if (!_frames[i].IsExternal && _frames[i].Lines > 0)
+                order.push_back(i);
+        std::sort(order.begin(), order.end(),
+            [this](uint32_t f1, uint32_t f2) { return _frames[f1].Time > _frames[f2].Time; });
+        writer.WriteString("\nScript functions:\n");
+        writer.WriteFormat("%12s %12s %12s  %s\n", "self ms", "total ms", "lines run", "function");
+        for (uint32_t f : order)
+            writer.WriteFormat("%12.3f %12.3f %12llu  %s\n", _frames[f].Time / 1000000.0,
+                total_time[f] / 1000000.0, (unsigned long long)_frames[f].Lines, _frames[f].Name.GetCStr());
+
+        order.clear();
+        for (uint32_t i = 0; i < _frames.size(); ++i)
+            if (_frames[i].IsExternal)
+                order.push_back(i);
+        std::sort(order.begin(), order.end(),
+            [this](uint32_t f1, uint32_t f2) { return _frames[f1].Time > _frames[f2].Time; });
+        writer.WriteString("\nEngine API functions:\n");
+        writer.WriteFormat("%12s %12s  %s\n", "time ms", "calls", "function");
+        for (uint32_t f : order)
+            writer.WriteFormat("%12.3f %12llu  %s\n", _frames[f].Time / 1000000.0,
+                (unsigned long long)_frames[f].Calls, _frames[f].Name.GetCStr());
+
+        std::vector<std::pair<uint64_t, const LineStat*>> lines;
+        for (const auto &line : _lines)
+            lines.push_back(std::make_pair(line.first, &line.second));
+        std::sort(lines.begin(), lines.end(),
+            [](const std::pair<uint64_t, const LineStat*> &l1, const std::pair<uint64_t, const LineStat*> &l2)
+            { return l1.second->Time > l2.second->Time; });
+        writer.WriteString("\nScript lines:\n");
+        writer.WriteFormat("%12s %12s  %s\n", "time ms", "hits", "line");
+        for (const auto &line : lines)
+            writer.WriteFormat("%12.3f %12llu  %s, line %u\n", line.second->Time / 1000000.0,
+                (unsigned long long)line.second->Hits, _frames[line.first >> 32].Name.GetCStr(),
+                static_cast<uint32_t>(line.first));
+    }
+
+    // Collapsed stacks: frames separated by ';', followed by the time in microseconds
+    out = File::CreateFile(stacks_file);
+    if (!out)
+    {
+        Debug::Printf(kDbgMsg_Error, "Script profiler: failed to open file %s", stacks_file.GetCStr());
+        return false;
+    }
+    {
+        TextStreamWriter writer(out);
+        for (const auto &stack : _stacks)
+        {
+            const uint64_t time = stack.second / 1000u;
+            if (time == 0u)
+                continue;
+            for (size_t i = 0; i < stack.first.size(); ++i)
+            {
+                if (i > 0)
+                    writer.WriteChar(';');
+                writer.WriteString(_frames[stack.first[i]].Name);
+            }
+            writer.WriteFormat(" %llu\n", (unsigned long long)time);
+        }
+    }
+    Debug::Printf(kDbgMsg_Info, "Script profiler: written %s and %s",
+        profile_file.GetCStr(), stacks_file.GetCStr());
+    return true;
+}
@@ -0,0 +1,133 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Script profiler: counts how many times each script line is run, and
+// measures the time spent in script functions, lines, and in the engine API
+// functions called by the script. The time of a line is counted from its
+// start until the next line, call or return of the script.
+//
+// The results are written as a flat profile, and as the collapsed call
+// stacks, which may be turned into a flamegraph by the common tools.
+//
+// NOTE: only the pre-decoded code execution is profiled.
+// NOTE: the time of the engine API function includes the time of any
+// script which it had run itself.
+//
+//=============================================================================
+#ifndef __AGS_EE_SCRIPT__SCRIPTPROFILER_H
+#define __AGS_EE_SCRIPT__SCRIPTPROFILER_H
+
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "ac/timer.h"
+#include "script/cc_script.h"
+#include "script/runtimescriptvalue.h"
+#include "util/string.h"
+
+struct ccInstance;
+
+class ScriptProfiler
+{
+    using String = AGS::Common::String;
+public:
+    // Notifies that the script starts or stops running
+    void OnRunBoundary();
+    // Notifies that the script has reached a new line;
+    // code_inst is the instance which code is being run
+    void OnLine(const ccInstance *inst, const ccInstance *code_inst, int32_t pc, int32_t line);
+    // Notifies that the script has returned to the caller's line
+    void OnReturn(const ccInstance *inst, const ccInstance *code_inst, int32_t pc, int32_t line);
+    // Notifies that the script calls and returns from an engine API function
+    void BeginExternalCall(const RuntimeScriptValue &fn);
+    void EndExternalCall();
+
+    // Writes the flat profile and the collapsed call stacks into the text files
+    bool WriteProfile(const String &profile_file, const String &stacks_file) const;
+
+private:
+    // Script function or engine API function
+    struct Frame
+    {
+        String Name;
+        bool IsExternal = false;
+        uint64_t Time = 0u; // self time, in nanoseconds
+        uint64_t Lines = 0u; // number of lines run
+        uint64_t Calls = 0u; // number of calls (only counted for API)
+    };
+
+    struct LineStat
+    {
+        uint64_t Hits = 0u;
+        uint64_t Time = 0u;
+    };
+
+    // Functions of the script, sorted by code address
+    struct ScriptFunctions
+    {
+        std::weak_ptr<ccScript> Script;
+        std::vector<std::pair<int32_t, uint32_t>> Functions; // address, frame
+    };
+
+    struct ExternalCall
+    {
+        AGS_Clock::time_point Start;
+        RuntimeScriptValue Fn;
+        // Interrupted script position
+        bool HadPosition = false;
+        uint32_t Func = 0u;
+        LineStat *Line = nullptr;
+        std::vector<uint32_t> Stack;
+        uint64_t *StackTime = nullptr;
+    };
+
+    struct StackHash
+    {
+        size_t operator()(const std::vector<uint32_t> &stack) const;
+    };
+
+    uint32_t GetFrame(const String &name, bool external);
+    uint32_t GetFunction(const ccInstance *code_inst, int32_t pc);
+    ScriptFunctions &GetScriptFunctions(const PScript &script);
+    // Sets current script position, and starts counting its time
+    void SetPosition(const ccInstance *inst, const ccInstance *code_inst, int32_t pc, int32_t line, bool new_hit);
+    // Adds the time passed since the last event to the current position
+    void Flush(AGS_Clock::time_point now);
+
+    std::vector<Frame> _frames;
+    std::map<String, uint32_t> _frameByName;
+    std::unordered_map<void*, uint32_t> _extFrames;
+    std::unordered_map<const ccScript*, ScriptFunctions> _scripts;
+    const ccScript *_lastScript = nullptr;
+    ScriptFunctions *_lastFunctions = nullptr;
+    // NOTE: the elements of unordered_map are never relocated,
+    // so we may keep pointers to the current line and stack stats
+    std::unordered_map<uint64_t, LineStat> _lines; // function frame << 32 | line
+    std::unordered_map<std::vector<uint32_t>, uint64_t, StackHash> _stacks;
+
+    // Current position
+    bool _hasPosition = false;
+    AGS_Clock::time_point _lastTime;
+    uint32_t _func = 0u;
+    LineStat *_line = nullptr;
+    std::vector<uint32_t> _stack;
+    uint64_t *_stackTime = nullptr;
+    std::vector<uint32_t> _tempStack;
+    // Engine API calls in progress; may be nested if API runs another script
+    std::vector<ExternalCall> _extCalls;
+    size_t _extDepth = 0u;
+};
+
+#endif // __AGS_EE_SCRIPT__SCRIPTPROFILER_H
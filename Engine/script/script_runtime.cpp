@@ -122,6 +122,11 @@ void ccSetScriptAliveTimer(unsigned sys_poll_timeout, unsigned abort_timeout,
     ccInstance::SetExecTimeout(sys_poll_timeout, abort_timeout, abort_loops);
 }
 
+void ccSetScriptProfiler(ScriptProfiler *profiler)
+{
+    ccInstance::SetProfiler(profiler);
+}
+
 void ccNotifyScriptStillAlive () {
     ccInstance *cur_inst = ccInstance::GetCurrentInstance();
     if (cur_inst)
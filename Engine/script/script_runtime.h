@@ -96,6 +96,8 @@ void ccSetDebugHook(new_line_hook_type jibble);
 void ccSetScriptAliveTimer(unsigned sys_poll_timeout, unsigned abort_timeout, unsigned abort_loops);
 // reset the current while loop counter
 void ccNotifyScriptStillAlive();
+// Assigns the profiler of the script execution, or none
+void ccSetScriptProfiler(ScriptProfiler *profiler);
 // for calling exported plugin functions old-style
 int call_function(intptr_t addr, const RuntimeScriptValue *object, int numparm, const RuntimeScriptValue *parms);
 
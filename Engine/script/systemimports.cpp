@@ -11,9 +11,10 @@
 // http://www.opensource.org/licenses/artistic-license-2.0.php
 //
 //=============================================================================
+#include "script/systemimports.h"
+#include <algorithm>
 #include <stdlib.h>
 #include <string.h>
-#include "script/systemimports.h"
 
 SystemImports simp;
 SystemImports simp_for_plugin;
@@ -33,34 +34,63 @@ uint32_t SystemImports::add(const String &name, const RuntimeScriptValue &value,
         return ixof;
     }
 
-    ixof = imports.size();
-    for (size_t i = 0; i < imports.size(); ++i)
+    if (!free_slots.empty())
     {
-        if (imports[i].Name == nullptr)
-        {
-            ixof = i;
-            break;
-        }
+        ixof = free_slots.back();
+        free_slots.pop_back();
     }
-
-    btree[name] = ixof;
-    if (ixof == imports.size())
+    else
+    {
+        ixof = imports.size();
         imports.push_back(ScriptImport());
+    }
+
+    index_map[name] = ixof;
+    add_prefixes(name, ixof);
     imports[ixof].Name          = name;
     imports[ixof].Value         = value;
     imports[ixof].InstancePtr   = anotherscr;
     return ixof;
 }
 
+void SystemImports::add_prefixes(const String &name, uint32_t index)
+{
+    for (size_t c = name.FindChar('$'); c != String::NoIndex; c = name.FindChar('$', c + 1))
+        prefix_map[name.Left(c)].push_back(index);
+}
+
+void SystemImports::remove_prefixes(const String &name, uint32_t index)
+{
+    for (size_t c = name.FindChar('$'); c != String::NoIndex; c = name.FindChar('$', c + 1))
+    {
+        auto it = prefix_map.find(name.Left(c));
+        if (it == prefix_map.end())
+            continue;
+        auto &list = it->second;
+        list.erase(std::remove(list.begin(), list.end(), index), list.end());
+        if (list.empty())
+            prefix_map.erase(it);
+    }
+}
+
+void SystemImports::free_slot(uint32_t index)
+{
+    ScriptImport &import = imports[index];
+    index_map.erase(import.Name);
+    remove_prefixes(import.Name, index);
+    import.Name = nullptr;
+    import.Value.Invalidate();
+    import.InstancePtr = nullptr;
+    import.Version++;
+    free_slots.push_back(index);
+}
+
 void SystemImports::remove(const String &name)
 {
     uint32_t idx = get_index_of(name);
     if (idx == UINT32_MAX)
         return;
-    btree.erase(imports[idx].Name);
-    imports[idx].Name = nullptr;
-    imports[idx].Value.Invalidate();
-    imports[idx].InstancePtr = nullptr;
+    free_slot(idx);
 }
 
 const ScriptImport *SystemImports::getByName(const String &name)
@@ -82,16 +112,24 @@ const ScriptImport *SystemImports::getByIndex(uint32_t index)
 
 uint32_t SystemImports::get_index_of(const String &name)
 {
-    IndexMap::const_iterator it = btree.find(name);
-    if (it != btree.end())
+    IndexMap::const_iterator it = index_map.find(name);
+    if (it != index_map.end())
         return it->second;
 
     // CHECKME: what are "mangled names" and where do they come from?
-    String mangled_name = String::FromFormat("%s$", name.GetCStr());
-    // if it's a function with a mangled name, allow it
-    it = btree.lower_bound(mangled_name);
-    if (it != btree.end() && it->first.CompareLeft(mangled_name) == 0)
-        return it->second;
+    // if it's a function with a mangled name, allow it;
+    // if there are several, then choose the first one in alphabetical order
+    PrefixIndexMap::const_iterator pit = prefix_map.find(name);
+    if (pit != prefix_map.end())
+    {
+        uint32_t found = pit->second.front();
+        for (uint32_t index : pit->second)
+        {
+            if (imports[index].Name.Compare(imports[found].Name) < 0)
+                found = index;
+        }
+        return found;
+    }
 
     if (name.GetLength() > 3)
     {
@@ -125,23 +163,46 @@ void SystemImports::RemoveScriptExports(ccInstance *inst)
         return;
     }
 
-    for (auto &import : imports)
+    for (uint32_t i = 0; i < imports.size(); ++i)
     {
-        if (import.Name == nullptr)
+        if (imports[i].Name == nullptr)
             continue;
 
-        if (import.InstancePtr == inst)
-        {
-            btree.erase(import.Name);
-            import.Name = nullptr;
-            import.Value.Invalidate();
-            import.InstancePtr = nullptr;
-        }
+        if (imports[i].InstancePtr == inst)
+            free_slot(i);
     }
 }
 
 void SystemImports::clear()
 {
-    btree.clear();
+    index_map.clear();
+    prefix_map.clear();
+    free_slots.clear();
+    resolve_cache.clear();
     imports.clear();
 }
+
+bool SystemImports::GetCachedIndexes(const String &key, uint32_t *indexes, size_t count) const
+{
+    auto it = resolve_cache.find(key);
+    if (it == resolve_cache.end() || it->second.Indexes.size() != count)
+        return false;
+    const CachedIndexes &cache = it->second;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t index = cache.Indexes[i];
+        if ((index != UINT32_MAX) && (imports[index].Version != cache.Versions[i]))
+            return false; // the import was removed, and the slot may be reused
+    }
+    std::copy(cache.Indexes.begin(), cache.Indexes.end(), indexes);
+    return true;
+}
+
+void SystemImports::CacheIndexes(const String &key, const uint32_t *indexes, size_t count)
+{
+    CachedIndexes &cache = resolve_cache[key];
+    cache.Indexes.assign(indexes, indexes + count);
+    cache.Versions.resize(count);
+    for (size_t i = 0; i < count; ++i)
+        cache.Versions[i] = (indexes[i] != UINT32_MAX) ? imports[indexes[i]].Version : 0u;
+}
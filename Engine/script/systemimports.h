@@ -15,8 +15,10 @@
 #ifndef __CC_SYSTEMIMPORTS_H
 #define __CC_SYSTEMIMPORTS_H
 
-#include <map>
+#include <unordered_map>
+#include <vector>
 #include "script/cc_instance.h"    // ccInstance
+#include "util/string_types.h"
 
 struct IScriptObject;
 
@@ -27,22 +29,39 @@ struct ScriptImport
     ScriptImport()
     {
         InstancePtr = nullptr;
+        Version = 0u;
     }
 
     String              Name;           // import's uid
     RuntimeScriptValue  Value;
     ccInstance          *InstancePtr;   // script instance
+    uint32_t            Version;        // changes whenever the slot is freed
 };
 
 struct SystemImports
 {
 private:
-    // Note we can't use a hash-map here, because we sometimes need to search
-    // by partial keys.
-    typedef std::map<String, uint32_t> IndexMap;
+    typedef std::unordered_map<String, uint32_t> IndexMap;
+    // Partial key index: lists the imports which names begin with the
+    // "key$", for the search of the functions with the mangled names
+    typedef std::unordered_map<String, std::vector<uint32_t>> PrefixIndexMap;
+
+    // Import indexes resolved for a script, and the versions of their slots
+    struct CachedIndexes
+    {
+        std::vector<uint32_t> Indexes;
+        std::vector<uint32_t> Versions;
+    };
 
     std::vector<ScriptImport> imports;
-    IndexMap btree;
+    std::vector<uint32_t> free_slots;
+    IndexMap index_map;
+    PrefixIndexMap prefix_map;
+    std::unordered_map<String, CachedIndexes> resolve_cache;
+
+    void add_prefixes(const String &name, uint32_t index);
+    void remove_prefixes(const String &name, uint32_t index);
+    void free_slot(uint32_t index);
 
 public:
     uint32_t add(const String &name, const RuntimeScriptValue &value, ccInstance *inst);
@@ -53,6 +72,12 @@ public:
     String findName(const RuntimeScriptValue &value);
     void RemoveScriptExports(ccInstance *inst);
     void clear();
+
+    // Gets the import indexes previously cached under the given key;
+    // fails if there's no such cache, or any of these imports was removed since
+    bool GetCachedIndexes(const String &key, uint32_t *indexes, size_t count) const;
+    // Caches the resolved import indexes under the given key
+    void CacheIndexes(const String &key, const uint32_t *indexes, size_t count);
 };
 
 extern SystemImports simp;
@@ -0,0 +1,74 @@
+#include <random>
+#include <vector>
+#include "gtest/gtest.h"
+#include "gfx/blender_simd.h"
+
+static const uint32_t MaskColor32 = 0x00FF00FF;
+
+// Generates pixels with a mix of edge and random component values
+static std::vector<uint32_t> MakeTestPixels(size_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    const uint32_t edge_values[] = { 0x00, 0x01, 0x7F, 0x80, 0xFE, 0xFF };
+    std::vector<uint32_t> pixels(count);
+    for (auto &px : pixels)
+    {
+        uint32_t r = rng();
+        if (r % 16 == 0)
+        {
+            px = MaskColor32 | (rng() & 0xFF000000);
+            continue;
+        }
+        px = 0;
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            uint32_t c = (rng() % 4 == 0) ? edge_values[rng() % 6] : (rng() & 0xFF);
+            px |= c << shift;
+        }
+    }
+    return pixels;
+}
+
+TEST(RowBlender, SimdMatchesScalar) {
+    // Uneven width, to test both vector and tail processing
+    const size_t width = 1021;
+    const std::vector<uint32_t> src = MakeTestPixels(width, 1);
+    const std::vector<uint32_t> dst = MakeTestPixels(width, 2);
+    const uint32_t n_values[] = { 0, 1, 64, 127, 128, 200, 254, 255, 256 };
+    const uint32_t colors[] = { 0x00000000, 0x00080808, 0x00F8F8F8, 0x00FF4080 };
+
+    for (int b = 0; b < kNumRowBlenders; ++b)
+    {
+        const RowBlender blender = static_cast<RowBlender>(b);
+        for (uint32_t n : n_values)
+        {
+            // Test unaligned row starts too
+            for (size_t off = 0; off < 3; ++off)
+            {
+                std::vector<uint32_t> dst_simd(dst), dst_scalar(dst);
+                blend_row32(blender, &src[off], &dst_simd[off], width - off, n, true);
+                blend_row32(blender, &src[off], &dst_scalar[off], width - off, n, false);
+                ASSERT_EQ(dst_simd, dst_scalar) << "blend_row32, blender " << b << ", n " << n;
+            }
+
+            for (uint32_t color : colors)
+            {
+                std::vector<uint32_t> dst_simd(dst), dst_scalar(dst);
+                lit_row32(blender, color, &src[0], &dst_simd[0], width, n, true);
+                lit_row32(blender, color, &src[0], &dst_scalar[0], width, n, false);
+                ASSERT_EQ(dst_simd, dst_scalar) << "lit_row32, blender " << b << ", n " << n;
+                // In-place lighting
+                std::vector<uint32_t> inplace_simd(src), inplace_scalar(src);
+                lit_row32(blender, color, &inplace_simd[0], &inplace_simd[0], width, n, true);
+                lit_row32(blender, color, &inplace_scalar[0], &inplace_scalar[0], width, n, false);
+                ASSERT_EQ(inplace_simd, inplace_scalar) << "lit_row32 in place, blender " << b << ", n " << n;
+            }
+        }
+    }
+
+    // Mask color pixels must be left untouched
+    std::vector<uint32_t> mask_src(width, MaskColor32);
+    std::vector<uint32_t> mask_dst(dst);
+    blend_row32(kRowBlend_ArgbToRgb, &mask_src[0], &mask_dst[0], width, 0, true);
+    ASSERT_EQ(mask_dst, dst);
+}
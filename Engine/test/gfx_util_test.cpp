@@ -0,0 +1,108 @@
+#include <memory>
+#include <random>
+#include <vector>
+#include <string.h>
+#include "gtest/gtest.h"
+#include "gfx/bitmap.h"
+#include "gfx/gfx_util.h"
+#include "util/threadpool.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+// Sprite list entry, drawn in one of the ways the software renderer does
+struct TestSprite
+{
+    std::unique_ptr<Bitmap> Image;
+    int X = 0, Y = 0;
+    int Alpha = 255;
+    bool HasAlpha = false;
+    bool Opaque = false;
+    bool Tint = false; // screen tint effect, has no image
+};
+
+static Bitmap *MakeTestImage(int width, int height, std::mt19937 &rng)
+{
+    Bitmap *bmp = BitmapHelper::CreateBitmap(width, height, 32);
+    for (int y = 0; y < height; ++y)
+    {
+        uint32_t *row = reinterpret_cast<uint32_t*>(bmp->GetScanLineForWriting(y));
+        for (int x = 0; x < width; ++x)
+            row[x] = (rng() % 8 == 0) ? bmp->GetMaskColor() : static_cast<uint32_t>(rng());
+    }
+    return bmp;
+}
+
+static std::vector<TestSprite> MakeTestSprites(int surf_width, int surf_height, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<TestSprite> sprites(40);
+    for (auto &spr : sprites)
+    {
+        const int kind = rng() % 5;
+        if (kind == 4)
+        {
+            spr.Tint = true;
+            continue;
+        }
+        spr.Image.reset(MakeTestImage(1 + rng() % 120, 1 + rng() % 120, rng));
+        // some are partly off the surface
+        spr.X = static_cast<int>(rng() % (surf_width + 80)) - 60;
+        spr.Y = static_cast<int>(rng() % (surf_height + 80)) - 60;
+        spr.Alpha = (rng() % 2) ? 255 : static_cast<int>(1 + rng() % 254);
+        spr.Opaque = kind == 0;
+        spr.HasAlpha = kind == 1 || kind == 2;
+    }
+    return sprites;
+}
+
+static void DrawTestSprite(Bitmap *ds, const TestSprite &spr, int offx, int offy)
+{
+    if (spr.Tint)
+    {
+        GfxUtil::LitBlendBlt32(ds, ds, 0, 0, kRowBlend_Trans, 40, 80, 160, 128);
+        return;
+    }
+    Bitmap *image = spr.Image.get();
+    const int x = spr.X + offx, y = spr.Y + offy;
+    if (spr.Opaque)
+        ds->Blit(image, 0, 0, x, y, image->GetWidth(), image->GetHeight());
+    else if (spr.HasAlpha && spr.Alpha == 255)
+        GfxUtil::BlendBlt32(ds, image, x, y, kRowBlend_ArgbToRgb, 0);
+    else if (spr.HasAlpha)
+        GfxUtil::BlendBlt32(ds, image, x, y, kRowBlend_TransAlpha, spr.Alpha);
+    else
+        GfxUtil::DrawSpriteWithTransparency(ds, image, x, y, spr.Alpha);
+}
+
+TEST(GfxUtil, DrawInBandsMatchesSerial) {
+    const int width = 320, height = 200;
+    const int offx = 3, offy = -7;
+    const Rect clip(5, 3, width - 6, height - 10);
+    std::mt19937 rng(1);
+    std::unique_ptr<Bitmap> background(MakeTestImage(width, height, rng));
+
+    ThreadPool pool;
+    pool.Start(3);
+    for (uint32_t seed = 1; seed <= 4; ++seed)
+    {
+        const std::vector<TestSprite> sprites = MakeTestSprites(width, height, seed);
+
+        std::unique_ptr<Bitmap> serial(BitmapHelper::CreateBitmapCopy(background.get()));
+        serial->SetClip(clip);
+        for (const auto &spr : sprites)
+            DrawTestSprite(serial.get(), spr, offx, offy);
+
+        std::unique_ptr<Bitmap> parallel(BitmapHelper::CreateBitmapCopy(background.get()));
+        parallel->SetClip(clip);
+        GfxUtil::DrawInBands(parallel.get(), pool, [&sprites](Bitmap *band, int band_top)
+        {
+            for (const auto &spr : sprites)
+                DrawTestSprite(band, spr, offx, offy - band_top);
+        });
+
+        for (int y = 0; y < height; ++y)
+            ASSERT_EQ(memcmp(serial->GetScanLine(y), parallel->GetScanLine(y), width * 4), 0)
+                << "seed " << seed << ", row " << y;
+    }
+}
@@ -0,0 +1,198 @@
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "ac/dynobj/cc_agsdynamicobject.h"
+#include "ac/dynobj/managedobjectpool.h"
+#include "util/memorystream.h"
+
+using namespace AGS::Common;
+
+// Test object manager, which counts disposed objects
+struct TestObjectMgr final : CCBasicObject
+{
+    int Disposed = 0;
+    bool CanDispose = true;
+    bool UseHandleSlot = false;
+
+    int Dispose(void* /*address*/, bool force) override
+    {
+        if (!CanDispose && !force)
+            return 0;
+        Disposed++;
+        return 1;
+    }
+    const char *GetType() override { return "TestObject"; }
+    int32_t *GetHandleSlot(void *address) override
+    {
+        return UseHandleSlot ? &static_cast<TestObject*>(address)->Handle : nullptr;
+    }
+
+    struct TestObject
+    {
+        int32_t Handle = 0;
+        int32_t Value = 0;
+    };
+};
+
+// Registers the read objects at the same addresses again
+struct TestObjectReader : ICCObjectCollectionReader
+{
+    ManagedObjectPool &Pool;
+    TestObjectMgr &Mgr;
+    std::vector<TestObjectMgr::TestObject> &Objects;
+
+    TestObjectReader(ManagedObjectPool &pool, TestObjectMgr &mgr, std::vector<TestObjectMgr::TestObject> &objects)
+        : Pool(pool), Mgr(mgr), Objects(objects) {}
+
+    void Unserialize(int32_t handle, const char* /*objectType*/, const char* /*serializedData*/, int /*dataSize*/) override
+    {
+        for (auto &obj : Objects)
+        {
+            if (obj.Handle == handle)
+                Pool.AddUnserializedObject(&obj, &Mgr, kScValScriptObject, handle);
+        }
+    }
+};
+
+TEST(ManagedObjectPool, Handles) {
+    std::unique_ptr<ManagedObjectPool> pool(new ManagedObjectPool());
+    TestObjectMgr mgr;
+    TestObjectMgr::TestObject objs[2];
+
+    const int32_t h1 = pool->AddObject(&objs[0], &mgr, kScValScriptObject);
+    ASSERT_GT(h1, 0);
+    ASSERT_EQ(pool->AddRef(h1), 1);
+    ASSERT_EQ(pool->HandleToAddress(h1), &objs[0]);
+    ASSERT_EQ(pool->AddressToHandle(&objs[0]), h1);
+    ASSERT_EQ(pool->SubRef(h1), 0);
+    ASSERT_EQ(mgr.Disposed, 1);
+    ASSERT_EQ(pool->HandleToAddress(h1), nullptr);
+
+    // The new object reuses the freed slot, but must get a different handle,
+    // and the old handle must not resolve to the new object
+    const int32_t h2 = pool->AddObject(&objs[1], &mgr, kScValScriptObject);
+    ASSERT_GT(h2, 0);
+    ASSERT_NE(h1, h2);
+    ASSERT_EQ(pool->HandleToAddress(h1), nullptr);
+    ASSERT_EQ(pool->AddRef(h1), 0);
+    ASSERT_EQ(pool->HandleToAddress(h2), &objs[1]);
+
+    // Handle kept in the object's own memory
+    mgr.UseHandleSlot = true;
+    const int32_t h3 = pool->AddObject(&objs[0], &mgr, kScValScriptObject);
+    ASSERT_EQ(objs[0].Handle, h3);
+    ASSERT_EQ(pool->AddressToHandle(&objs[0], &mgr), h3);
+    ASSERT_EQ(pool->AddressToHandle(&objs[0]), h3);
+    ASSERT_EQ(pool->RemoveObject(&objs[0]), 1);
+    ASSERT_EQ(pool->AddressToHandle(&objs[0], &mgr), 0);
+    ASSERT_EQ(pool->AddressToHandle(&objs[0]), 0);
+    ASSERT_EQ(pool->AddressToHandle(&objs[1]), h2);
+    pool->reset();
+    ASSERT_EQ(pool->AddressToHandle(&objs[1]), 0);
+}
+
+TEST(ManagedObjectPool, GarbageCollection) {
+    std::unique_ptr<ManagedObjectPool> pool(new ManagedObjectPool());
+    TestObjectMgr mgr;
+    std::vector<TestObjectMgr::TestObject> objs(3000);
+    std::vector<int32_t> handles;
+    for (auto &obj : objs)
+        handles.push_back(pool->AddObject(&obj, &mgr, kScValScriptObject));
+    // Reference every third object
+    for (size_t i = 0; i < handles.size(); i += 3)
+        pool->AddRef(handles[i]);
+
+    pool->RunGarbageCollectionIfAppropriate();
+    ASSERT_EQ(mgr.Disposed, 2000);
+    for (size_t i = 0; i < handles.size(); ++i)
+        ASSERT_EQ(pool->HandleToAddress(handles[i]) != nullptr, i % 3 == 0);
+
+    // Objects which could not be disposed when released are collected later
+    mgr.CanDispose = false;
+    for (size_t i = 0; i < handles.size(); i += 6)
+        pool->SubRef(handles[i]);
+    ASSERT_EQ(mgr.Disposed, 2000);
+    mgr.CanDispose = true;
+    for (int i = 0; i < 1100; ++i)
+        pool->CheckDispose(pool->AddObject(&objs[0], &mgr, kScValScriptObject));
+    const int disposed_before = mgr.Disposed;
+    pool->RunGarbageCollectionIfAppropriate();
+    ASSERT_EQ(mgr.Disposed - disposed_before, 500);
+}
+
+TEST(ManagedObjectPool, SaveAndRestore) {
+    std::unique_ptr<ManagedObjectPool> pool(new ManagedObjectPool());
+    TestObjectMgr mgr;
+    std::vector<TestObjectMgr::TestObject> objs(10);
+    for (auto &obj : objs)
+    {
+        obj.Handle = pool->AddObject(&obj, &mgr, kScValScriptObject);
+        pool->AddRef(obj.Handle);
+    }
+    // Make some of the handles use the next generation
+    for (size_t i = 0; i < objs.size(); i += 2)
+        pool->SubRef(objs[i].Handle);
+    for (size_t i = 0; i < objs.size(); i += 2)
+    {
+        objs[i].Handle = pool->AddObject(&objs[i], &mgr, kScValScriptObject);
+        pool->AddRef(objs[i].Handle);
+        pool->AddRef(objs[i].Handle);
+    }
+
+    std::vector<uint8_t> data;
+    {
+        VectorStream out(data, kStream_Write);
+        pool->WriteToDisk(&out);
+    }
+
+    pool.reset(new ManagedObjectPool());
+    {
+        VectorStream in(data);
+        TestObjectReader reader(*pool, mgr, objs);
+        ASSERT_EQ(pool->ReadFromDisk(&in, &reader), 0);
+    }
+    for (size_t i = 0; i < objs.size(); ++i)
+    {
+        ASSERT_EQ(pool->HandleToAddress(objs[i].Handle), &objs[i]);
+        // refcounts must be restored too
+        ASSERT_EQ(pool->AddRef(objs[i].Handle), (i % 2 == 0) ? 3 : 2);
+    }
+    // new objects must not take the restored handles
+    TestObjectMgr::TestObject extra;
+    const int32_t h = pool->AddObject(&extra, &mgr, kScValScriptObject);
+    for (const auto &obj : objs)
+        ASSERT_NE(obj.Handle, h);
+}
+
+TEST(ManagedObjectPool, RestoreVersion2) {
+    // The saves of the engines before the handle generations
+    std::vector<uint8_t> data;
+    {
+        VectorStream out(data, kStream_Write);
+        out.WriteInt32(0xa30b);
+        out.WriteInt32(2);
+        out.WriteInt32(2);
+        for (int32_t handle = 1; handle <= 2; ++handle)
+        {
+            out.WriteInt32(handle * 3);
+            out.Write("TestObject", 11);
+            out.WriteInt32(0);
+            out.WriteInt32(handle);
+        }
+    }
+
+    std::unique_ptr<ManagedObjectPool> pool(new ManagedObjectPool());
+    TestObjectMgr mgr;
+    std::vector<TestObjectMgr::TestObject> objs(2);
+    objs[0].Handle = 3;
+    objs[1].Handle = 6;
+    {
+        VectorStream in(data);
+        TestObjectReader reader(*pool, mgr, objs);
+        ASSERT_EQ(pool->ReadFromDisk(&in, &reader), 0);
+    }
+    ASSERT_EQ(pool->HandleToAddress(3), &objs[0]);
+    ASSERT_EQ(pool->HandleToAddress(6), &objs[1]);
+    ASSERT_EQ(pool->AddRef(3), 2);
+    ASSERT_EQ(pool->AddRef(6), 3);
+}
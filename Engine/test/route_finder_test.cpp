@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include "gtest/gtest.h"
+#include "util/threadpool.h"
+
+// The engine has its own copy of the Navigation class, so put this one
+// into a separate namespace (standard headers are already included above)
+namespace RouteFinderTest
+{
+#include "ac/route_finder_jps.inl"
+}
+
+using RouteFinderTest::Navigation;
+
+// Room walkable mask, made of several walkable areas joined by corridors,
+// with obstacles in them, similar to how the room masks are drawn
+struct TestRoomMask
+{
+    int Width, Height;
+    std::vector<unsigned char> Pixels;
+
+    TestRoomMask(int width, int height, uint32_t seed)
+        : Width(width), Height(height), Pixels(width * height, 0)
+    {
+        std::mt19937 rng(seed);
+        // walkable areas
+        for (int i = 0; i < 8; ++i)
+            Fill(rng() % width, rng() % height, 40 + rng() % (width / 3), 20 + rng() % (height / 3), 1 + i);
+        // corridors
+        for (int i = 0; i < 6; ++i)
+        {
+            if (rng() % 2)
+                Fill(rng() % width, rng() % height, width / 2, 3 + rng() % 10, 10);
+            else
+                Fill(rng() % width, rng() % height, 3 + rng() % 10, height / 2, 10);
+        }
+        // obstacles and walls with gaps
+        for (int i = 0; i < 40; ++i)
+            Fill(rng() % width, rng() % height, 2 + rng() % 30, 2 + rng() % 30, 0);
+        for (int i = 0; i < 4; ++i)
+        {
+            const int x = rng() % width;
+            const int gap = rng() % height;
+            for (int y = 0; y < height; ++y)
+                if (y < gap || y > gap + 8)
+                    Pixels[y * width + x] = 0;
+        }
+    }
+
+    void Fill(int x, int y, int w, int h, unsigned char value)
+    {
+        for (int py = y; py < std::min(y + h, Height); ++py)
+            for (int px = x; px < std::min(x + w, Width); ++px)
+                Pixels[py * Width + px] = value;
+    }
+
+    void Attach(Navigation &nav)
+    {
+        nav.Resize(Width, Height);
+        for (int y = 0; y < Height; ++y)
+            nav.SetMapRow(y, &Pixels[y * Width]);
+    }
+};
+
+struct RouteQuery
+{
+    int SrcX, SrcY, DstX, DstY;
+};
+
+static std::vector<RouteQuery> MakeRouteQueries(const TestRoomMask &mask, size_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<RouteQuery> queries;
+    while (queries.size() < count)
+    {
+        RouteQuery q = { (int)(rng() % mask.Width), (int)(rng() % mask.Height),
+            (int)(rng() % mask.Width), (int)(rng() % mask.Height) };
+        // characters start on walkable areas
+        if (mask.Pixels[q.SrcY * mask.Width + q.SrcX] != 0)
+            queries.push_back(q);
+    }
+    return queries;
+}
+
+// Runs the queries, and returns the navpoint paths joined together
+static std::vector<int> RunRouteQueries(Navigation &nav, const std::vector<RouteQuery> &queries)
+{
+    std::vector<int> result, path, cpath;
+    for (const auto &q : queries)
+    {
+        const int res = nav.NavigateRefined(q.SrcX, q.SrcY, q.DstX, q.DstY, path, cpath);
+        result.push_back(res);
+        result.push_back(static_cast<int>(cpath.size()));
+        result.insert(result.end(), cpath.begin(), cpath.end());
+    }
+    return result;
+}
+
+TEST(RouteFinder, JumpTablesMatchPlainSearch) {
+    for (uint32_t seed = 1; seed <= 4; ++seed)
+    {
+        TestRoomMask mask(320, 200, seed);
+        const std::vector<RouteQuery> queries = MakeRouteQueries(mask, 500, seed);
+
+        Navigation plain_nav, table_nav;
+        mask.Attach(plain_nav);
+        table_nav.SetUseJumpTables(true);
+        mask.Attach(table_nav);
+        ASSERT_EQ(RunRouteQueries(plain_nav, queries), RunRouteQueries(table_nav, queries));
+
+        // Change part of the mask, as when a blocking character moves
+        mask.Fill(100, 60, 20, 40, 0);
+        mask.Fill(20, 150, 60, 10, 1);
+        table_nav.MapChanged(100, 60, 119, 99);
+        table_nav.MapChanged(20, 150, 79, 159);
+        ASSERT_EQ(RunRouteQueries(plain_nav, queries), RunRouteQueries(table_nav, queries));
+    }
+}
+
+TEST(RouteFinder, ParallelSearchMatchesSerial) {
+    // Every request has its own mask, as each character cuts out
+    // different blocking areas
+    const size_t request_count = 64;
+    std::vector<TestRoomMask> masks;
+    std::vector<RouteQuery> queries;
+    for (size_t i = 0; i < request_count; ++i)
+    {
+        masks.emplace_back(320, 200, 11);
+        masks.back().Fill(i * 5 % 300, i * 3 % 180, 20, 20, 0);
+        queries.push_back(MakeRouteQueries(masks.back(), 1, static_cast<uint32_t>(i)).front());
+    }
+
+    Navigation serial_nav;
+    serial_nav.SetUseJumpTables(true);
+    std::vector<std::vector<int>> serial(request_count);
+    for (size_t i = 0; i < request_count; ++i)
+    {
+        masks[i].Attach(serial_nav);
+        serial[i] = RunRouteQueries(serial_nav, { queries[i] });
+    }
+
+    // Each job has its own navigation, and takes every Nth request,
+    // like the engine's route batch does
+    AGS::Common::ThreadPool pool;
+    pool.Start(3);
+    const size_t job_count = pool.GetWorkerCount() + 1;
+    std::vector<Navigation> navs(job_count);
+    std::vector<std::vector<int>> parallel(request_count);
+    pool.RunParallel(job_count, [&](size_t job)
+    {
+        navs[job].SetUseJumpTables(true);
+        for (size_t i = job; i < request_count; i += job_count)
+        {
+            masks[i].Attach(navs[job]);
+            parallel[i] = RunRouteQueries(navs[job], { queries[i] });
+        }
+    });
+    ASSERT_EQ(serial, parallel);
+}
+
+TEST(RouteFinder, BlockersMatchPlainSearch) {
+    for (uint32_t seed = 1; seed <= 4; ++seed)
+    {
+        TestRoomMask mask(320, 200, seed);
+        const std::vector<RouteQuery> queries = MakeRouteQueries(mask, 500, seed);
+
+        Navigation table_nav;
+        table_nav.SetUseJumpTables(true);
+        mask.Attach(table_nav);
+        // Blockers are cut out of the walkable cells, like under the characters
+        TestRoomMask blocked = mask;
+        std::mt19937 rng(seed);
+        for (int i = 0; i < 10; ++i)
+        {
+            const int x = rng() % 300, y = rng() % 180, w = 4 + rng() % 16, h = 2 + rng() % 8;
+            blocked.Fill(x, y, w, h, 0);
+            for (int py = y; py < y + h; ++py)
+            {
+                for (int px = x; px < x + w;)
+                {
+                    if (mask.Pixels[py * mask.Width + px] == 0) { ++px; continue; }
+                    const int x0 = px;
+                    for (; px < x + w && mask.Pixels[py * mask.Width + px] != 0; ++px);
+                    table_nav.AddBlockedSpan(py, x0, px - 1);
+                }
+            }
+        }
+
+        Navigation plain_nav;
+        blocked.Attach(plain_nav);
+        ASSERT_EQ(RunRouteQueries(plain_nav, queries), RunRouteQueries(table_nav, queries));
+
+        // Removing the blockers gets the search on the map itself back
+        table_nav.ClearBlockers();
+        mask.Attach(plain_nav);
+        ASSERT_EQ(RunRouteQueries(plain_nav, queries), RunRouteQueries(table_nav, queries));
+    }
+}
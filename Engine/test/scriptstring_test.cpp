@@ -0,0 +1,103 @@
+#include <string.h>
+#include <string>
+#include "gtest/gtest.h"
+#include "ac/dynobj/cc_dynamicarray.h"
+#include "ac/dynobj/dynobj_manager.h"
+#include "ac/dynobj/managedobjectpool.h"
+#include "ac/dynobj/scriptstring.h"
+#include "util/memorystream.h"
+
+using namespace AGS::Common;
+
+ScriptString myScriptStringImpl;
+
+TEST(ScriptString, CreateAndDispose) {
+    pool.reset();
+    // Short strings are taken from the slabs, long ones from the heap
+    const std::string long_text(1000, 'x');
+    const char *texts[] = { "", "short", "a string which does not fit in the smallest slab", long_text.c_str() };
+    for (const char *text : texts)
+    {
+        DynObjectRef ref = ScriptString::Create(text);
+        ASSERT_NE(ref.Handle, 0);
+        ASSERT_EQ(ref.Mgr, &myScriptStringImpl);
+        ASSERT_STREQ(static_cast<const char*>(ref.Obj), text);
+        ASSERT_EQ(ScriptString::GetHeader(ref.Obj).Length, strlen(text));
+        ASSERT_EQ(ScriptString::GetHeader(ref.Obj).Handle, ref.Handle);
+        ASSERT_EQ(ccGetObjectHandleFromAddress(ref.Obj), ref.Handle);
+        ccAddObjectReference(ref.Handle);
+        ccReleaseObjectReference(ref.Handle);
+        ASSERT_EQ(ccGetObjectAddressFromHandle(ref.Handle), nullptr);
+    }
+
+    // Freed slab blocks are reused
+    DynObjectRef ref1 = ScriptString::Create("text1");
+    void *addr1 = ref1.Obj;
+    ccAddObjectReference(ref1.Handle);
+    ccReleaseObjectReference(ref1.Handle);
+    DynObjectRef ref2 = ScriptString::Create("text2");
+    ASSERT_EQ(ref2.Obj, addr1);
+    pool.reset();
+}
+
+TEST(ScriptString, Buffer) {
+    pool.reset();
+    char *buffer = ScriptString::AllocBuffer(5);
+    memcpy(buffer, "hello", 5);
+    DynObjectRef ref = ScriptString::Register(buffer);
+    ASSERT_NE(ref.Handle, 0);
+    ASSERT_STREQ(static_cast<const char*>(ref.Obj), "hello");
+    pool.reset();
+}
+
+TEST(ScriptString, Interned) {
+    pool.reset();
+    DynObjectRef ref1 = ScriptString::CreateInterned("literal");
+    DynObjectRef ref2 = myScriptStringImpl.CreateString("literal");
+    DynObjectRef ref3 = ScriptString::CreateInterned("another literal");
+    DynObjectRef ref4 = ScriptString::Create("literal");
+    ASSERT_EQ(ref1.Handle, ref2.Handle);
+    ASSERT_EQ(ref1.Obj, ref2.Obj);
+    ASSERT_NE(ref1.Handle, ref3.Handle);
+    // Regular strings are not interned
+    ASSERT_NE(ref1.Handle, ref4.Handle);
+    DynObjectRef arr = DynamicArrayHelpers::CreateStringArray({ "literal" });
+    ASSERT_NE(static_cast<const int32_t*>(arr.Obj)[0], ref1.Handle);
+
+    // The string is not interned anymore after it's disposed
+    ccAddObjectReference(ref1.Handle);
+    ccReleaseObjectReference(ref1.Handle);
+    DynObjectRef ref5 = ScriptString::CreateInterned("literal");
+    ASSERT_NE(ref5.Handle, ref1.Handle);
+    ASSERT_STREQ(static_cast<const char*>(ref5.Obj), "literal");
+    pool.reset();
+    DynObjectRef ref6 = ScriptString::CreateInterned("literal");
+    ASSERT_STREQ(static_cast<const char*>(ref6.Obj), "literal");
+    pool.reset();
+}
+
+TEST(ScriptString, SaveAndRestore) {
+    pool.reset();
+    DynObjectRef ref = ScriptString::Create("saved text");
+    ccAddObjectReference(ref.Handle);
+
+    // The serialized string is its length, followed by the text and null terminator
+    std::vector<uint8_t> data(64);
+    IScriptObject &mgr = myScriptStringImpl;
+    const int sz = mgr.Serialize(ref.Obj, data.data(), static_cast<int>(data.size()));
+    ASSERT_EQ(sz, static_cast<int>(sizeof(int32_t) + strlen("saved text") + 1));
+    int32_t len;
+    memcpy(&len, data.data(), sizeof(len));
+    ASSERT_EQ(len, static_cast<int32_t>(strlen("saved text")));
+    ASSERT_STREQ(reinterpret_cast<const char*>(data.data() + sizeof(int32_t)), "saved text");
+
+    pool.reset();
+    data.resize(sz);
+    MemoryStream mems(data.data(), data.size());
+    myScriptStringImpl.Unserialize(5, &mems, data.size());
+    const char *text = static_cast<const char*>(ccGetObjectAddressFromHandle(5));
+    ASSERT_NE(text, nullptr);
+    ASSERT_STREQ(text, "saved text");
+    ASSERT_EQ(ScriptString::GetHeader(text).Handle, 5);
+    pool.reset();
+}
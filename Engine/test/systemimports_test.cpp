@@ -0,0 +1,71 @@
+#include "gtest/gtest.h"
+#include "script/systemimports.h"
+
+static ccInstance *const TestInst = reinterpret_cast<ccInstance*>(1);
+
+TEST(SystemImports, FindByName) {
+    SystemImports si;
+    const uint32_t a1 = si.add("func_a$1", RuntimeScriptValue().SetInt32(1), TestInst);
+    const uint32_t a0 = si.add("func_a$0", RuntimeScriptValue().SetInt32(2), TestInst);
+    const uint32_t b = si.add("Object::Func^2", RuntimeScriptValue().SetInt32(3), nullptr);
+    const uint32_t c = si.add("func_c", RuntimeScriptValue().SetInt32(4), nullptr);
+    ASSERT_NE(a1, a0);
+    ASSERT_EQ(si.get_index_of("func_a$1"), a1);
+    ASSERT_EQ(si.get_index_of("Object::Func^2"), b);
+    ASSERT_EQ(si.get_index_of("func_c"), c);
+    // Mangled names are found by the name without the args count,
+    // the first one in alphabetical order
+    ASSERT_EQ(si.get_index_of("func_a"), a0);
+    // Functions are found by the name with the args count appended
+    ASSERT_EQ(si.get_index_of("func_c^3"), c);
+    ASSERT_EQ(si.get_index_of("func_a^12"), a0);
+    ASSERT_EQ(si.get_index_of("Object::Func"), UINT32_MAX);
+    ASSERT_EQ(si.get_index_of("func_"), UINT32_MAX);
+    ASSERT_EQ(si.get_index_of("func_d"), UINT32_MAX);
+    ASSERT_EQ(si.getByName("func_c")->Value.IValue, 4);
+}
+
+TEST(SystemImports, RemoveAndReuse) {
+    SystemImports si;
+    const uint32_t a = si.add("func_a$1", RuntimeScriptValue().SetInt32(1), TestInst);
+    const uint32_t b = si.add("func_b", RuntimeScriptValue().SetInt32(2), nullptr);
+    // Engine symbols may be overridden, but script exports may not
+    ASSERT_EQ(si.add("func_b", RuntimeScriptValue().SetInt32(3), nullptr), b);
+    ASSERT_EQ(si.getByIndex(b)->Value.IValue, 3);
+    ASSERT_EQ(si.add("func_a", RuntimeScriptValue().SetInt32(4), TestInst), a);
+    ASSERT_EQ(si.getByIndex(a)->Value.IValue, 1);
+
+    si.RemoveScriptExports(TestInst);
+    ASSERT_EQ(si.get_index_of("func_a"), UINT32_MAX);
+    ASSERT_EQ(si.get_index_of("func_a$1"), UINT32_MAX);
+    ASSERT_EQ(si.get_index_of("func_b"), b);
+    // The free slot is reused
+    ASSERT_EQ(si.add("func_c", RuntimeScriptValue().SetInt32(5), nullptr), a);
+    ASSERT_EQ(si.get_index_of("func_c"), a);
+    si.remove("func_b");
+    ASSERT_EQ(si.get_index_of("func_b"), UINT32_MAX);
+}
+
+TEST(SystemImports, CachedIndexes) {
+    SystemImports si;
+    const uint32_t a = si.add("func_a", RuntimeScriptValue().SetInt32(1), nullptr);
+    const uint32_t b = si.add("func_b$0", RuntimeScriptValue().SetInt32(2), TestInst);
+    const uint32_t resolved[3] = { a, UINT32_MAX, b };
+    uint32_t indexes[3] = {};
+    ASSERT_FALSE(si.GetCachedIndexes("room1", indexes, 3));
+    si.CacheIndexes("room1", resolved, 3);
+    ASSERT_FALSE(si.GetCachedIndexes("room1", indexes, 2));
+    ASSERT_TRUE(si.GetCachedIndexes("room1", indexes, 3));
+    ASSERT_EQ(indexes[0], a);
+    ASSERT_EQ(indexes[1], UINT32_MAX);
+    ASSERT_EQ(indexes[2], b);
+    // Adding more symbols keeps the cache valid
+    si.add("func_c", RuntimeScriptValue().SetInt32(3), nullptr);
+    ASSERT_TRUE(si.GetCachedIndexes("room1", indexes, 3));
+    // Removing and re-adding one of the cached symbols invalidates it
+    si.RemoveScriptExports(TestInst);
+    si.add("func_b$0", RuntimeScriptValue().SetInt32(2), TestInst);
+    ASSERT_FALSE(si.GetCachedIndexes("room1", indexes, 3));
+    si.clear();
+    ASSERT_FALSE(si.GetCachedIndexes("room1", indexes, 3));
+}
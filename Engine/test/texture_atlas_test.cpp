@@ -0,0 +1,87 @@
+#include <random>
+#include <vector>
+#include "gtest/gtest.h"
+#include "gfx/texture_atlas.h"
+
+using namespace AGS::Engine;
+
+static bool RegionsOverlap(const AtlasRegion &r1, const AtlasRegion &r2)
+{
+    return r1.Page == r2.Page &&
+        r1.X < r2.X + r2.Width && r2.X < r1.X + r1.Width &&
+        r1.Y < r2.Y + r2.Height && r2.Y < r1.Y + r1.Height;
+}
+
+TEST(TextureAtlas, Allocate) {
+    TextureAtlas atlas(256, 256);
+    bool new_page;
+    // Too large for a page
+    ASSERT_FALSE(atlas.Allocate(257, 10, new_page).IsValid());
+    ASSERT_FALSE(atlas.Allocate(0, 10, new_page).IsValid());
+
+    std::mt19937 rng(1);
+    std::vector<AtlasRegion> regions;
+    size_t new_pages = 0u;
+    for (int i = 0; i < 500; ++i)
+    {
+        const AtlasRegion r = atlas.Allocate(2 + rng() % 62, 2 + rng() % 62, new_page);
+        ASSERT_TRUE(r.IsValid());
+        ASSERT_GE(r.X, 0);
+        ASSERT_GE(r.Y, 0);
+        ASSERT_LE(r.X + r.Width, 256);
+        ASSERT_LE(r.Y + r.Height, 256);
+        if (new_page)
+            new_pages++;
+        regions.push_back(r);
+    }
+    ASSERT_EQ(new_pages, atlas.GetPageCount());
+    for (size_t i = 0; i < regions.size(); ++i)
+        for (size_t j = i + 1; j < regions.size(); ++j)
+            ASSERT_FALSE(RegionsOverlap(regions[i], regions[j]));
+}
+
+TEST(TextureAtlas, Release) {
+    TextureAtlas atlas(128, 128);
+    bool new_page;
+    std::vector<AtlasRegion> regions;
+    // Fill exactly two pages with 32x32 regions
+    for (int i = 0; i < 32; ++i)
+        regions.push_back(atlas.Allocate(32, 32, new_page));
+    ASSERT_EQ(atlas.GetPageCount(), 2u);
+
+    // Space is reused when a whole shelf, or the last region on a shelf,
+    // is released (4 regions fit in a shelf)
+    for (size_t i = 4; i < 8; ++i)
+        ASSERT_FALSE(atlas.Release(regions[i]));
+    ASSERT_FALSE(atlas.Release(regions[31]));
+    for (size_t i = 4; i < 8; ++i)
+    {
+        regions[i] = atlas.Allocate(32, 32, new_page);
+        ASSERT_FALSE(new_page);
+    }
+    regions[31] = atlas.Allocate(32, 32, new_page);
+    ASSERT_FALSE(new_page);
+    ASSERT_EQ(atlas.GetPageCount(), 2u);
+    for (size_t i = 0; i < regions.size(); ++i)
+        for (size_t j = i + 1; j < regions.size(); ++j)
+            ASSERT_FALSE(RegionsOverlap(regions[i], regions[j]));
+
+    // The page becomes unused when its last region is released,
+    // and then is given to the next region as a new one
+    int released_pages = 0;
+    for (const auto &r : regions)
+    {
+        if (atlas.Release(r))
+        {
+            ASSERT_FALSE(atlas.IsPageUsed(r.Page));
+            released_pages++;
+        }
+    }
+    ASSERT_EQ(released_pages, 2);
+    const AtlasRegion r = atlas.Allocate(100, 100, new_page);
+    ASSERT_TRUE(new_page);
+    ASSERT_EQ(r.Page, 0u);
+    ASSERT_EQ(r.X, 0);
+    ASSERT_EQ(r.Y, 0);
+    ASSERT_EQ(atlas.GetPageCount(), 2u);
+}